@@ -4,40 +4,125 @@
 #include "assets/Gltf.hh"
 #include "assets/PhysicsInfo.hh"
 #include "cooking/ConvexHull.hh"
+#include "core/DispatchQueue.hh"
 #include "core/Logging.hh"
 
 #include <PxPhysicsAPI.h>
+#include <algorithm>
+#include <cstdlib>
 #include <cxxopts.hpp>
 #include <extensions/PxDefaultAllocator.h>
 #include <extensions/PxDefaultErrorCallback.h>
 #include <filesystem>
 #include <fstream>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace {
+    struct HullJob {
+        size_t modelIndex;
+        sp::AsyncPtr<sp::Gltf> modelPtr;
+        std::string meshName;
+        sp::AsyncPtr<sp::HullSettings> settingsPtr;
+        bool updated = false;
+    };
+
+    // Writes to a temporary file and renames it, so other processes sharing the directory never see partial files
+    bool CopyFileAtomic(const std::filesystem::path &from, const std::filesystem::path &to) {
+        std::error_code ec;
+        std::filesystem::create_directories(to.parent_path(), ec);
+        // Other threads and hull_compiler processes may copy to the same file, so each copy gets a random suffix
+        static std::mutex randomMutex;
+        static std::random_device randomDevice;
+        static std::mt19937_64 random(((uint64_t)randomDevice() << 32) ^ randomDevice());
+        uint64_t suffix;
+        {
+            std::lock_guard lock(randomMutex);
+            suffix = random();
+        }
+        auto tmpPath = to;
+        tmpPath += ".tmp" + std::to_string(suffix);
+        if (!std::filesystem::copy_file(from, tmpPath, std::filesystem::copy_options::overwrite_existing, ec)) {
+            return false;
+        }
+        std::filesystem::rename(tmpPath, to, ec);
+        if (ec) {
+            std::filesystem::remove(tmpPath, ec);
+            return false;
+        }
+        return true;
+    }
+
+    // Defaults to the user's cache directory, so hulls are shared between checkouts without living in any of them
+    std::filesystem::path DefaultSharedCachePath() {
+        if (auto *cacheHome = std::getenv("XDG_CACHE_HOME"); cacheHome && *cacheHome) {
+            return std::filesystem::path(cacheHome) / "strayphotons/hulls";
+        } else if (auto *localAppData = std::getenv("LOCALAPPDATA"); localAppData && *localAppData) {
+            return std::filesystem::path(localAppData) / "strayphotons/hulls";
+        } else if (auto *home = std::getenv("HOME"); home && *home) {
+            return std::filesystem::path(home) / ".cache/strayphotons/hulls";
+        }
+        return {};
+    }
+} // namespace
 
 int main(int argc, char **argv) {
     cxxopts::Options options("hull_compiler", "");
-    options.positional_help("<model_name>");
-    options.add_options()("model-name", "", cxxopts::value<std::string>());
-    options.parse_positional({"model-name"});
+    options.positional_help("<model_name>...");
+    // clang-format off
+    options.add_options()
+        ("model-names", "", cxxopts::value<std::vector<std::string>>())
+        ("j,jobs", "Number of hulls to cook in parallel (defaults to the CPU count)", cxxopts::value<size_t>())
+        ("shared-cache", "Content-addressed hull cache directory, may be shared between checkouts "
+            "(defaults to the user's cache directory, an empty path disables it)", cxxopts::value<std::string>());
+    // clang-format on
+    options.parse_positional({"model-names"});
 
     auto optionsResult = options.parse(argc, argv);
 
-    if (!optionsResult.count("model-name")) {
+    if (!optionsResult.count("model-names")) {
         std::cout << options.help() << std::endl;
         return 1;
     }
 
-    std::string modelName = optionsResult["model-name"].as<std::string>();
+    auto modelNames = optionsResult["model-names"].as<std::vector<std::string>>();
+    auto sharedCachePath = DefaultSharedCachePath();
+    if (optionsResult.count("shared-cache")) sharedCachePath = optionsResult["shared-cache"].as<std::string>();
+    size_t jobCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+    if (optionsResult.count("jobs")) jobCount = std::max<size_t>(1, optionsResult["jobs"].as<size_t>());
 
     sp::logging::SetLogLevel(sp::logging::Level::Warn);
 
-    auto modelPtr = sp::Assets().LoadGltf(modelName);
-    auto model = modelPtr->Get();
-    if (!model) {
-        Errorf("hull_compiler could not load Gltf model: %s", modelName);
-        return 1;
+    std::vector<sp::AsyncPtr<sp::Gltf>> modelPtrs;
+    std::vector<sp::AsyncPtr<sp::PhysicsInfo>> physicsInfoPtrs;
+    for (auto &modelName : modelNames) {
+        modelPtrs.emplace_back(sp::Assets().LoadGltf(modelName));
+        physicsInfoPtrs.emplace_back(sp::Assets().LoadPhysicsInfo(modelName));
     }
 
-    auto physicsInfo = sp::Assets().LoadPhysicsInfo(modelName)->Get();
+    std::vector<HullJob> jobs;
+    for (size_t i = 0; i < modelNames.size(); i++) {
+        auto &modelName = modelNames[i];
+        auto model = modelPtrs[i]->Get();
+        if (!model) {
+            Errorf("hull_compiler could not load Gltf model: %s", modelName);
+            return 1;
+        }
+
+        auto physicsInfo = physicsInfoPtrs[i]->Get();
+        if (physicsInfo) {
+            for (auto &[meshName, settings] : physicsInfo->GetHulls()) {
+                auto settingsPtr = sp::Assets().LoadHullSettings(modelName, meshName);
+                jobs.emplace_back(HullJob{i, modelPtrs[i], meshName, settingsPtr});
+            }
+        }
+        for (size_t j = 0; j < model->meshes.size(); j++) {
+            std::string meshName("convex" + std::to_string(j));
+            auto settingsPtr = sp::Assets().LoadHullSettings(modelName, meshName);
+            jobs.emplace_back(HullJob{i, modelPtrs[i], meshName, settingsPtr});
+        }
+    }
 
     physx::PxDefaultErrorCallback defaultErrorCallback;
     physx::PxDefaultAllocator defaultAllocatorCallback;
@@ -53,42 +138,71 @@ int main(int argc, char **argv) {
     auto pxSerialization = physx::PxSerialization::createSerializationRegistry(*pxPhysics);
     Assert(pxSerialization, "PxSerialization::createSerializationRegistry");
 
-    bool updated = false;
-    if (physicsInfo) {
-        for (auto &[meshName, settings] : physicsInfo->GetHulls()) {
-            auto settingsPtr = sp::Assets().LoadHullSettings(modelName, meshName);
+    // Cooking is thread-safe, but every cache load and save shares the serialization registry
+    std::mutex serializationMutex;
+    auto cookHull = [&](HullJob &job) {
+        auto &modelName = modelNames[job.modelIndex];
+        {
+            std::lock_guard lock(serializationMutex);
+            if (sp::hullgen::LoadCollisionCache(*pxSerialization, job.modelPtr, job.settingsPtr)) return;
+        }
 
-            auto set = sp::hullgen::LoadCollisionCache(*pxSerialization, modelPtr, settingsPtr);
-            if (set) continue;
+        auto settings = job.settingsPtr->Get();
+        Assertf(settings, "hull_compiler could not load hull settings: %s.%s", modelName, job.meshName);
+        std::filesystem::path cachePath("../assets/cache/collision/" + settings->name);
+
+        auto key = sp::hullgen::GetCollisionCacheKey(*job.modelPtr->Get(), *settings);
+        std::filesystem::path sharedPath;
+        if (key && !sharedCachePath.empty()) {
+            sharedPath = sharedCachePath / key->String();
+            std::error_code ec;
+            if (std::filesystem::is_regular_file(sharedPath, ec) && CopyFileAtomic(sharedPath, cachePath)) {
+                Logf("Using shared physics collision cache: %s.%s", modelName, job.meshName);
+                job.updated = true;
+                return;
+            }
+        }
 
-            Logf("Updating physics collision cache: %s.%s", modelName, meshName);
+        Logf("Updating physics collision cache: %s.%s", modelName, job.meshName);
 
-            set = sp::hullgen::BuildConvexHulls(*pxCooking, *pxPhysics, modelPtr, settingsPtr);
-            sp::hullgen::SaveCollisionCache(*pxSerialization, modelPtr, settingsPtr, *set);
+        auto set = sp::hullgen::BuildConvexHulls(*pxCooking, *pxPhysics, job.modelPtr, job.settingsPtr);
+        if (!set) {
+            Errorf("hull_compiler failed to build hulls: %s.%s", modelName, job.meshName);
+            return;
+        }
 
-            updated = true;
+        std::lock_guard lock(serializationMutex);
+        sp::hullgen::SaveCollisionCache(*pxSerialization, job.modelPtr, job.settingsPtr, *set);
+        if (!sharedPath.empty() && !CopyFileAtomic(cachePath, sharedPath)) {
+            Warnf("Failed to store hulls in shared cache: %s", sharedPath.string());
+        }
+        job.updated = true;
+    };
+
+    {
+        // Every mesh of every model is an independent job, this thread only waits so at most jobCount run at once
+        sp::DispatchQueue workQueue("HullCompiler", jobCount);
+        std::vector<sp::AsyncPtr<void>> results;
+        for (auto &job : jobs) {
+            results.emplace_back(workQueue.Dispatch<void>([&cookHull, &job]() {
+                cookHull(job);
+            }));
+        }
+        for (auto &result : results) {
+            result->Get();
         }
     }
 
-    for (size_t i = 0; i < model->meshes.size(); i++) {
-        std::string meshName("convex" + std::to_string(i));
-        auto settingsPtr = sp::Assets().LoadHullSettings(modelName, meshName);
-
-        auto set = sp::hullgen::LoadCollisionCache(*pxSerialization, modelPtr, settingsPtr);
-        if (set) continue;
-
-        Logf("Updating physics collision cache: %s.%s", modelName, meshName);
-
-        set = sp::hullgen::BuildConvexHulls(*pxCooking, *pxPhysics, modelPtr, settingsPtr);
-        sp::hullgen::SaveCollisionCache(*pxSerialization, modelPtr, settingsPtr, *set);
-
-        updated = true;
+    std::vector<bool> modelUpdated(modelNames.size());
+    for (auto &job : jobs) {
+        if (job.updated) modelUpdated[job.modelIndex] = true;
     }
-
-    std::filesystem::path markerPath("../assets/cache/collision/" + modelName);
-    if (updated || !std::filesystem::exists(markerPath)) {
-        std::filesystem::create_directories(markerPath.parent_path());
-        std::ofstream(markerPath).close(); // Create or touch the marker file
+    for (size_t i = 0; i < modelNames.size(); i++) {
+        std::filesystem::path markerPath("../assets/cache/collision/" + modelNames[i]);
+        if (modelUpdated[i] || !std::filesystem::exists(markerPath)) {
+            std::filesystem::create_directories(markerPath.parent_path());
+            std::ofstream(markerPath).close(); // Create or touch the marker file
+        }
     }
     return 0;
 }
@@ -0,0 +1,146 @@
+#include "assets/Asset.hh"
+#include "assets/AssetManager.hh"
+#include "assets/Async.hh"
+#include "assets/CookedMesh.hh"
+#include "assets/Gltf.hh"
+#include "core/DispatchQueue.hh"
+#include "core/Logging.hh"
+
+#include <algorithm>
+#include <cxxopts.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace {
+    struct CookJob {
+        size_t modelIndex;
+        size_t meshIndex;
+        std::shared_ptr<const sp::Gltf> model;
+        sp::Hash128 sourceHash;
+        bool updated = false;
+        bool failed = false;
+    };
+
+    // Returns true if the asset already contains exactly the given bytes
+    bool AssetMatches(const std::string &path, const std::vector<uint8_t> &data) {
+        std::ifstream in;
+        size_t size = 0;
+        if (!sp::Assets().InputStream(path, sp::AssetType::Bundled, in, &size) || size != data.size()) return false;
+        std::vector<uint8_t> existing(size);
+        in.read(reinterpret_cast<char *>(existing.data()), size);
+        return in && existing == data;
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("mesh_cooker", "Converts gltf meshes into GPU-ready cooked meshes");
+    options.positional_help("<model_name>...");
+    // clang-format off
+    options.add_options()
+        ("model-names", "", cxxopts::value<std::vector<std::string>>())
+        ("j,jobs", "Number of meshes to cook in parallel (defaults to the CPU count)", cxxopts::value<size_t>())
+        ("no-optimize", "Keep the source triangle order instead of optimizing it");
+    // clang-format on
+    options.parse_positional({"model-names"});
+
+    auto optionsResult = options.parse(argc, argv);
+
+    if (!optionsResult.count("model-names")) {
+        std::cout << options.help() << std::endl;
+        return 1;
+    }
+
+    auto modelNames = optionsResult["model-names"].as<std::vector<std::string>>();
+    size_t jobCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+    if (optionsResult.count("jobs")) jobCount = std::max<size_t>(1, optionsResult["jobs"].as<size_t>());
+    bool optimize = !optionsResult.count("no-optimize");
+
+    sp::logging::SetLogLevel(sp::logging::Level::Warn);
+
+    std::vector<sp::AsyncPtr<sp::Gltf>> modelPtrs;
+    for (auto &modelName : modelNames) {
+        modelPtrs.emplace_back(sp::Assets().LoadGltf(modelName));
+    }
+
+    std::vector<CookJob> jobs;
+    for (size_t i = 0; i < modelNames.size(); i++) {
+        auto model = modelPtrs[i]->Get();
+        if (!model) {
+            Errorf("mesh_cooker could not load Gltf model: %s", modelNames[i]);
+            return 1;
+        }
+        // Asset::Hash() computes the hash on first use, so it is read here before any jobs run in parallel
+        auto sourceHash = model->asset->Hash();
+        for (size_t j = 0; j < model->meshes.size(); j++) {
+            if (model->meshes[j]) jobs.emplace_back(CookJob{i, j, model, sourceHash});
+        }
+    }
+
+    auto cookMesh = [&](CookJob &job) {
+        auto &modelName = modelNames[job.modelIndex];
+        auto &mesh = job.model->meshes[job.meshIndex];
+
+        auto cooked = sp::cookedmesh::Convert(*mesh);
+        if (optimize) {
+            float before = sp::cookedmesh::AverageCacheMissRatio(cooked.indices);
+            sp::cookedmesh::OptimizeIndices(cooked);
+            Logf("Cooked mesh %s.%u, vertex cache miss ratio %.3f -> %.3f",
+                modelName,
+                job.meshIndex,
+                before,
+                sp::cookedmesh::AverageCacheMissRatio(cooked.indices));
+        }
+
+        std::vector<uint8_t> data;
+        sp::cookedmesh::Serialize(cooked, job.sourceHash, data);
+
+        // Cooking is deterministic, so unchanged meshes are left alone to avoid rebuilding the asset bundle
+        auto cachePath = sp::cookedmesh::CachePath(modelName, job.meshIndex);
+        if (AssetMatches(cachePath, data)) return;
+
+        std::ofstream out;
+        if (!sp::Assets().OutputStream(cachePath, out)) {
+            Errorf("mesh_cooker failed to write: %s", cachePath);
+            job.failed = true;
+            return;
+        }
+        out.write(reinterpret_cast<const char *>(data.data()), data.size());
+        out.close();
+        if (out.fail()) {
+            Errorf("mesh_cooker failed to write: %s", cachePath);
+            job.failed = true;
+            return;
+        }
+        job.updated = true;
+    };
+
+    {
+        // Every mesh of every model is an independent job, this thread only waits so at most jobCount run at once
+        sp::DispatchQueue workQueue("MeshCooker", jobCount);
+        std::vector<sp::AsyncPtr<void>> results;
+        for (auto &job : jobs) {
+            results.emplace_back(workQueue.Dispatch<void>([&cookMesh, &job]() {
+                cookMesh(job);
+            }));
+        }
+        for (auto &result : results) {
+            result->Get();
+        }
+    }
+
+    std::vector<bool> modelUpdated(modelNames.size());
+    for (auto &job : jobs) {
+        if (job.failed) return 1;
+        if (job.updated) modelUpdated[job.modelIndex] = true;
+    }
+    for (size_t i = 0; i < modelNames.size(); i++) {
+        std::filesystem::path markerPath("../assets/cache/meshes/" + modelNames[i]);
+        if (modelUpdated[i] || !std::filesystem::exists(markerPath)) {
+            std::filesystem::create_directories(markerPath.parent_path());
+            std::ofstream(markerPath).close(); // Create or touch the marker file
+        }
+    }
+    return 0;
+}
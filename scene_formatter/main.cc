@@ -1,4 +1,7 @@
+#include "assets/Asset.hh"
+#include "assets/AssetManager.hh"
 #include "core/Logging.hh"
+#include "game/SceneCache.hh"
 #include "game/SceneManager.hh"
 
 #include <cxxopts.hpp>
@@ -8,7 +11,11 @@
 int main(int argc, char **argv) {
     cxxopts::Options options("scene_formatter", "");
     options.positional_help("<scene_name>");
-    options.add_options()("scene-name", "", cxxopts::value<std::string>());
+    // clang-format off
+    options.add_options()
+        ("scene-name", "", cxxopts::value<std::string>())
+        ("b,binary", "Also write the precompiled binary scene to the scene cache");
+    // clang-format on
     options.parse_positional({"scene-name"});
 
     auto optionsResult = options.parse(argc, argv);
@@ -27,5 +34,15 @@ int main(int argc, char **argv) {
     scenes.DisablePhysicsPreload();
     scenes.QueueActionAndBlock(sp::SceneAction::LoadScene, sceneName);
     scenes.QueueActionAndBlock(sp::SceneAction::SaveStagingScene, sceneName);
+
+    if (optionsResult.count("binary")) {
+        // The cache is keyed on the formatted JSON, so it is written after the scene has been saved
+        auto asset = sp::Assets().Load("scenes/" + sceneName + ".json", sp::AssetType::Bundled, true)->Get();
+        if (!asset || !sp::scenecache::SaveCache(sceneName, *asset)) {
+            Errorf("Failed to write binary scene: %s", sceneName);
+            return 1;
+        }
+        Logf("Wrote binary scene: %s", sceneName);
+    }
     return 0;
 }
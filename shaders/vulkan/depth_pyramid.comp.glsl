@@ -0,0 +1,34 @@
+layout(local_size_x = 16, local_size_y = 16) in;
+
+// Each texel is the farthest depth of the 2x2 texels below it, see culling::BuildDepthPyramid()
+#ifdef FROM_DEPTH_BUFFER
+layout(binding = 0) uniform sampler2DArray depthIn;
+#else
+layout(binding = 0) uniform sampler2D depthIn;
+#endif
+layout(binding = 1, r32f) writeonly uniform image2D depthOut;
+
+layout(push_constant) uniform PushConstants {
+    uvec2 inputExtent;
+    uvec2 outputExtent;
+};
+
+void main() {
+    uvec2 texel = gl_GlobalInvocationID.xy;
+    if (any(greaterThanEqual(texel, outputExtent))) return;
+
+    float farthest = 0.0;
+    for (uint y = 0; y < 2; y++) {
+        for (uint x = 0; x < 2; x++) {
+            // The last row and column are clamped for odd sized inputs
+            ivec2 inputTexel = ivec2(min(texel * 2 + uvec2(x, y), inputExtent - 1));
+#ifdef FROM_DEPTH_BUFFER
+            farthest = max(farthest, texelFetch(depthIn, ivec3(inputTexel, 0), 0).r);
+#else
+            farthest = max(farthest, texelFetch(depthIn, inputTexel, 0).r);
+#endif
+        }
+    }
+
+    imageStore(depthOut, ivec2(texel), vec4(farthest));
+}
@@ -0,0 +1,147 @@
+#extension GL_EXT_shader_16bit_storage : require
+#extension GL_EXT_shader_explicit_arithmetic_types_int16 : require
+
+#ifdef OCCLUDED_DRAWS
+layout(local_size_x = 64, local_size_y = 1) in;
+#else
+layout(local_size_x = 128, local_size_y = 1) in;
+#endif
+
+layout(push_constant) uniform PushConstants {
+    uint renderableCount;
+    uint instanceCount;
+    uint visibilityMask;
+};
+
+#include "../lib/indirect_commands.glsl"
+#include "lib/culling.glsl"
+#include "lib/scene.glsl"
+
+layout(std430, set = 0, binding = 0) readonly buffer Renderables {
+    RenderableEntity renderables[];
+};
+layout(std430, set = 0, binding = 1) readonly buffer MeshModels {
+    MeshModel models[];
+};
+layout(std430, set = 0, binding = 2) readonly buffer MeshPrimitives {
+    MeshPrimitive primitives[];
+};
+layout(std430, set = 0, binding = 3) buffer DrawCommands {
+    uint drawCount;
+    VkDrawIndexedIndirectCommand drawCommands[];
+};
+#include "lib/draw_params.glsl"
+layout(std430, set = 0, binding = 4) buffer DrawParamsList {
+    DrawParams drawParams[];
+};
+
+// Primitives that were culled by the previous frame's depth, which are retested once this frame's depth is known.
+// The dispatch size is incremented for each 64 primitives, so the list can be processed with DispatchIndirect.
+layout(std430, set = 0, binding = 5) buffer OccludedPrimitives {
+    VkDispatchIndirectCommand occludedDispatch;
+    uint occludedCount;
+    uvec2 occludedPrimitives[]; // Renderable index, primitive index
+};
+
+layout(binding = 6) uniform CullingViewUniform {
+    CullingView cullingView;
+};
+layout(binding = 7) uniform sampler2D depthPyramid;
+
+void AddDraw(RenderableEntity renderable, MeshModel model, MeshPrimitive prim) {
+    VkDrawIndexedIndirectCommand draw;
+    draw.indexCount = prim.indexCount;
+    draw.instanceCount = instanceCount;
+    draw.firstIndex = model.indexOffset + prim.firstIndex;
+    draw.vertexOffset = int(renderable.vertexOffset + prim.vertexOffset);
+
+    uint drawIndex = atomicAdd(drawCount, 1);
+    draw.firstInstance = drawIndex;
+    drawCommands[drawIndex] = draw;
+
+    drawParams[drawIndex].baseColorTexID = renderable.baseColorOverrideID >= 0
+                                               ? uint16_t(renderable.baseColorOverrideID)
+                                               : uint16_t(prim.baseColorTexID);
+    drawParams[drawIndex].metallicRoughnessTexID = renderable.metallicRoughnessOverrideID >= 0
+                                                       ? uint16_t(renderable.metallicRoughnessOverrideID)
+                                                       : uint16_t(prim.metallicRoughnessTexID);
+    drawParams[drawIndex].opticID = uint16_t(renderable.opticID);
+    drawParams[drawIndex].emissiveScale = float16_t(renderable.emissiveScale);
+}
+
+bool TestOcclusion(vec3 boundsMin, vec3 boundsMax) {
+    return IsOccluded(depthPyramid,
+        cullingView.occlusionLevels,
+        cullingView.occlusionViewProj,
+        cullingView.depthExtent,
+        boundsMin,
+        boundsMax);
+}
+
+#ifdef OCCLUDED_DRAWS
+
+void main() {
+    if (gl_GlobalInvocationID.x >= occludedCount) return;
+
+    uvec2 occluded = occludedPrimitives[gl_GlobalInvocationID.x];
+    RenderableEntity renderable = renderables[occluded.x];
+    MeshModel model = models[renderable.modelIndex];
+    MeshPrimitive prim = primitives[occluded.y];
+
+    vec3 boundsMin = BoundsVec3(prim.boundsMin);
+    vec3 boundsMax = BoundsVec3(prim.boundsMax);
+    TransformBounds(renderable.modelToWorld, boundsMin, boundsMax);
+    if (TestOcclusion(boundsMin, boundsMax)) return;
+
+    AddDraw(renderable, model, prim);
+}
+
+#else
+
+void main() {
+    if (gl_GlobalInvocationID.x >= renderableCount) return;
+
+    RenderableEntity renderable = renderables[gl_GlobalInvocationID.x];
+
+    uint entityVisibility = renderable.visibilityMask;
+    entityVisibility &= visibilityMask;
+    if (entityVisibility != visibilityMask) return;
+
+    MeshModel model = models[renderable.modelIndex];
+
+    // Skinned meshes move outside of their bind pose bounds, so they are always drawn
+    bool cull = renderable.jointPosesOffset == 0xffffffff;
+    bool frustumCulling = cull && cullingView.frustumCulling != 0;
+    bool occlusionCulling = cull && cullingView.occlusionLevels > 0;
+
+    bool modelOccluded = false;
+    if (cull) {
+        vec3 boundsMin = BoundsVec3(model.boundsMin);
+        vec3 boundsMax = BoundsVec3(model.boundsMax);
+        TransformBounds(renderable.modelToWorld, boundsMin, boundsMax);
+        if (frustumCulling && !IntersectsFrustum(cullingView.frustumPlanes, boundsMin, boundsMax)) return;
+        if (occlusionCulling) modelOccluded = TestOcclusion(boundsMin, boundsMax);
+    }
+
+    uint primitiveEnd = model.primitiveOffset + model.primitiveCount;
+    for (uint pi = model.primitiveOffset; pi < primitiveEnd; pi++) {
+        MeshPrimitive prim = primitives[pi];
+        if (cull) {
+            vec3 boundsMin = BoundsVec3(prim.boundsMin);
+            vec3 boundsMax = BoundsVec3(prim.boundsMax);
+            TransformBounds(renderable.modelToWorld, boundsMin, boundsMax);
+            if (frustumCulling && !IntersectsFrustum(cullingView.frustumPlanes, boundsMin, boundsMax)) continue;
+
+            if (occlusionCulling && (modelOccluded || TestOcclusion(boundsMin, boundsMax))) {
+                uint occludedIndex = atomicAdd(occludedCount, 1);
+                if (occludedIndex % 64 == 0) atomicAdd(occludedDispatch.x, 1);
+                occludedPrimitives[occludedIndex] = uvec2(gl_GlobalInvocationID.x, pi);
+                continue;
+            }
+        }
+
+        AddDraw(renderable, model, prim);
+    }
+}
+
+#endif
@@ -0,0 +1,105 @@
+// Draw culling math. src/core/core/Culling.cc is a CPU reference implementation of these functions, which is unit
+// tested. Any change to the culling math needs to be made in both places.
+
+struct CullingView {
+    vec4 frustumPlanes[6]; // Planes point inward
+    mat4 viewProj;
+    mat4 occlusionViewProj; // The view the depth pyramid was rendered from
+    uvec2 depthExtent;
+    uint occlusionLevels; // Depth pyramid mip levels, 0 if occlusion culling is disabled
+    uint frustumCulling;
+};
+
+vec3 BoundsVec3(float v[3]) {
+    return vec3(v[0], v[1], v[2]);
+}
+
+void TransformBounds(mat4 transform, inout vec3 boundsMin, inout vec3 boundsMax) {
+    vec3 center = (boundsMin + boundsMax) * 0.5;
+    vec3 extent = (boundsMax - boundsMin) * 0.5;
+
+    mat3 absRotation = mat3(abs(transform[0].xyz), abs(transform[1].xyz), abs(transform[2].xyz));
+    center = (transform * vec4(center, 1)).xyz;
+    extent = absRotation * extent;
+
+    boundsMin = center - extent;
+    boundsMax = center + extent;
+}
+
+bool IntersectsFrustum(vec4 planes[6], vec3 boundsMin, vec3 boundsMax) {
+    for (int i = 0; i < 6; i++) {
+        // Test the corner farthest along the plane's normal
+        vec3 corner = mix(boundsMin, boundsMax, greaterThanEqual(planes[i].xyz, vec3(0)));
+        if (dot(planes[i].xyz, corner) + planes[i].w < 0) return false;
+    }
+    return true;
+}
+
+// Returns false if the bounds cross the near plane or aren't entirely on screen
+bool ProjectBounds(mat4 viewProj,
+    vec3 boundsMin,
+    vec3 boundsMax,
+    uvec2 depthExtent,
+    out uvec2 minPixel,
+    out uvec2 maxPixel,
+    out float nearestDepth) {
+    vec2 ndcMin = vec2(3.402823e38);
+    vec2 ndcMax = vec2(-3.402823e38);
+    nearestDepth = 3.402823e38;
+    for (int i = 0; i < 8; i++) {
+        vec3 corner = mix(boundsMin, boundsMax, bvec3((i & 1) != 0, (i & 2) != 0, (i & 4) != 0));
+        vec4 clip = viewProj * vec4(corner, 1);
+        if (clip.w <= 0.0) return false;
+
+        vec3 ndc = clip.xyz / clip.w;
+        ndcMin = min(ndcMin, ndc.xy);
+        ndcMax = max(ndcMax, ndc.xy);
+        nearestDepth = min(nearestDepth, ndc.z);
+    }
+    if (nearestDepth < 0.0) return false;
+    if (any(lessThan(ndcMin, vec2(-1))) || any(greaterThan(ndcMax, vec2(1)))) return false;
+
+    // The renderer draws with YDirection::Up, so NDC y = 1 is the first row of the depth buffer
+    vec2 uvMin = vec2(ndcMin.x * 0.5 + 0.5, 0.5 - ndcMax.y * 0.5);
+    vec2 uvMax = vec2(ndcMax.x * 0.5 + 0.5, 0.5 - ndcMin.y * 0.5);
+
+    vec2 extent = vec2(depthExtent);
+    minPixel = min(uvec2(uvMin * extent), depthExtent - 1);
+    maxPixel = min(uvec2(uvMax * extent), depthExtent - 1);
+    return true;
+}
+
+// The smallest pyramid level where the pixel rectangle covers at most 2x2 texels
+uint DepthPyramidTestLevel(uvec2 minPixel, uvec2 maxPixel) {
+    uint level = 0;
+    while (any(greaterThan((maxPixel >> (level + 1)) - (minPixel >> (level + 1)), uvec2(1)))) {
+        level++;
+    }
+    return level;
+}
+
+// Returns true if the bounds are entirely behind the depth stored in the pyramid, level 0 of which is half the size
+// of the depth buffer
+bool IsOccluded(sampler2D depthPyramid,
+    uint levelCount,
+    mat4 viewProj,
+    uvec2 depthExtent,
+    vec3 boundsMin,
+    vec3 boundsMax) {
+    uvec2 minPixel, maxPixel;
+    float nearestDepth;
+    if (!ProjectBounds(viewProj, boundsMin, boundsMax, depthExtent, minPixel, maxPixel, nearestDepth)) return false;
+
+    uint level = DepthPyramidTestLevel(minPixel, maxPixel);
+    if (level >= levelCount) return false;
+
+    uvec2 minTexel = minPixel >> (level + 1);
+    uvec2 maxTexel = maxPixel >> (level + 1);
+    float farthest = 0.0;
+    for (uint y = minTexel.y; y <= maxTexel.y; y++) {
+        for (uint x = minTexel.x; x <= maxTexel.x; x++) {
+            farthest = max(farthest, texelFetch(depthPyramid, ivec2(x, y), int(level)).r);
+        }
+    }
+    return nearestDepth > farthest;
+}
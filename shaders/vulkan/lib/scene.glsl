@@ -2,6 +2,7 @@ struct MeshPrimitive {
     uint firstIndex, vertexOffset;
     uint indexCount, vertexCount;
     uint jointsVertexOffset;
+    float boundsMin[3], boundsMax[3]; // vec3 would be padded to 16 bytes
     uint16_t baseColorTexID, metallicRoughnessTexID;
 };
 
@@ -10,6 +11,7 @@ struct MeshModel {
     uint primitiveCount;
     uint indexOffset;
     uint vertexOffset;
+    float boundsMin[3], boundsMax[3];
 };
 
 struct RenderableEntity {
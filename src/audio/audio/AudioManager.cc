@@ -195,7 +195,11 @@ namespace sp {
                             auto audioBuffer = decoderCache.Load(asset.get());
                             if (!audioBuffer) {
                                 audioBuffer = make_shared<nqr::AudioData>();
-                                loader.Load(audioBuffer.get(), asset->extension, asset->Buffer());
+                                auto buffer = asset->Buffer();
+                                // The decoder requires an owned vector
+                                loader.Load(audioBuffer.get(),
+                                    asset->extension,
+                                    std::vector<uint8_t>(buffer.begin(), buffer.end()));
                                 decoderCache.Register(asset.get(), audioBuffer);
                             }
                             return audioBuffer;
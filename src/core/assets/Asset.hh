@@ -4,10 +4,15 @@
 
 #include <atomic>
 #include <filesystem>
+#include <memory>
 #include <optional>
+#include <span>
+#include <string_view>
 #include <vector>
 
 namespace sp {
+    class MappedFile;
+
     static std::string parseFileExtension(const std::string &path) {
         auto extension = std::filesystem::path(path).extension().string();
         if (extension.length() > 0 && extension[0] == '.') {
@@ -16,15 +21,23 @@ namespace sp {
         return to_lower(extension);
     }
 
+    /**
+     * The contents of an asset file. The buffer is usually a read-only view into a memory mapped file or asset bundle,
+     * so it must not be modified, and stays valid for as long as the Asset is alive.
+     */
     class Asset : public NonCopyable {
     public:
         Asset(const std::string &path = "") : path(path), extension(parseFileExtension(path)) {}
 
         std::string String() const {
-            return std::string((char *)buffer.data(), buffer.size());
+            return std::string((const char *)buffer.data(), buffer.size());
+        }
+
+        std::string_view StringView() const {
+            return std::string_view((const char *)buffer.data(), buffer.size());
         }
 
-        const std::vector<uint8_t> &Buffer() const {
+        std::span<const uint8_t> Buffer() const {
             return buffer;
         }
 
@@ -42,7 +55,11 @@ namespace sp {
         const std::string extension;
 
     private:
-        std::vector<uint8_t> buffer;
+        // Points into either the asset bundle mapping or ownedBuffer
+        std::span<const uint8_t> buffer;
+        std::shared_ptr<const MappedFile> mapping;
+        std::vector<uint8_t> ownedBuffer;
+
         std::optional<Hash128> hash;
 
         friend class AssetManager;
@@ -7,12 +7,14 @@ extern "C" {
 #include "assets/Asset.hh"
 #include "assets/Gltf.hh"
 #include "assets/Image.hh"
+#include "assets/MappedFile.hh"
 #include "assets/PhysicsInfo.hh"
 #include "core/Tracing.hh"
 #include "ecs/Components.hh"
 #include "ecs/Ecs.hh"
 #include "ecs/EcsImpl.hh"
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -56,6 +58,65 @@ namespace sp {
         for (auto &assets : loadedAssets) {
             assets.Tick(this->interval);
         }
+
+        {
+            // Started loads can no longer be reprioritized. Skipped loads are kept until their result is dropped,
+            // so that any new request dispatches them again.
+            std::lock_guard lock(controlMutex);
+            auto cleanup = [](ControlMap &controls, auto &loaded) {
+                for (auto it = controls.begin(); it != controls.end();) {
+                    auto state = it->second->GetState();
+                    if (state == DispatchControl::State::Started ||
+                        (state == DispatchControl::State::Skipped && !loaded.Contains(it->first))) {
+                        it = controls.erase(it);
+                    } else {
+                        it++;
+                    }
+                }
+            };
+            for (auto type : magic_enum::enum_values<AssetType>()) {
+                cleanup(assetControls[type], loadedAssets[type]);
+            }
+            cleanup(gltfControls, loadedGltfs);
+            cleanup(imageControls, loadedImages);
+        }
+    }
+
+    AssetPrefetch::~AssetPrefetch() {
+        for (auto &control : controls) {
+            control->Cancel((int)AssetPriority::Prefetch);
+        }
+    }
+
+    bool AssetPrefetch::Ready() const {
+        auto ready = [](auto &list) {
+            return std::all_of(list.begin(), list.end(), [](auto &async) {
+                return !async || async->Ready();
+            });
+        };
+        return ready(assets) && ready(gltfs) && ready(images);
+    }
+
+    bool AssetManager::RequestPending(ControlMap &controls, const std::string &key, AssetPriority priority) {
+        std::lock_guard lock(controlMutex);
+        auto it = controls.find(key);
+        if (it == controls.end()) return true;
+        return it->second->Request((int)priority);
+    }
+
+    void AssetManager::SetControl(ControlMap &controls, const std::string &key, const DispatchControlPtr &control) {
+        std::lock_guard lock(controlMutex);
+        controls[key] = control;
+    }
+
+    DispatchControlPtr AssetManager::GetControl(ControlMap &controls, const std::string &key) {
+        std::lock_guard lock(controlMutex);
+        auto it = controls.find(key);
+        return it != controls.end() ? it->second : nullptr;
+    }
+
+    DispatchQueueStats AssetManager::GetQueueStats() {
+        return workQueue.GetStats();
     }
 
     void AssetManager::UpdateTarIndex() {
@@ -73,6 +134,9 @@ namespace sp {
         }
 
         mtar_close(&tar);
+
+        tarMapping = MappedFile::Open(ASSETS_TAR);
+        if (!tarMapping) Warnf("Failed to map asset bundle, falling back to stream reads: %s", ASSETS_TAR);
     }
 
     bool AssetManager::InputStream(const std::string &path, AssetType type, std::ifstream &stream, size_t *size) {
@@ -125,44 +189,84 @@ namespace sp {
         std::filesystem::path p(ASSETS_DIR + path);
         std::filesystem::create_directories(p.parent_path());
 
+#ifndef _WIN32
+        // Unlink the existing file instead of truncating it, so any loaded assets still mapping it remain valid
+        std::error_code ec;
+        std::filesystem::remove(p, ec);
+#endif
+
         stream.open(ASSETS_DIR + path, std::ios::out | std::ios::binary);
         return !!stream;
     }
 
-    AsyncPtr<Asset> AssetManager::Load(const std::string &path, AssetType type, bool reload) {
+    AsyncPtr<Asset> AssetManager::Load(const std::string &path, AssetType type, bool reload, AssetPriority priority) {
+        return LoadInternal(path, type, reload, priority, nullptr);
+    }
+
+    AsyncPtr<Asset> AssetManager::LoadInternal(const std::string &path,
+        AssetType type,
+        bool reload,
+        AssetPriority priority,
+        const DispatchControlPtr &sharedControl) {
         Assert(!path.empty(), "AssetManager::Load called with empty path");
 
-        auto asset = loadedAssets[type].Load(path);
-        if (!asset || reload) {
-            std::lock_guard lock(assetMutex);
-            if (!reload) {
-                // Check again in case an inflight asset just completed on another thread
-                asset = loadedAssets[type].Load(path);
-                if (asset) return asset;
-            }
+        AsyncPtr<Asset> asset;
+        if (!reload) {
+            asset = loadedAssets[type].Load(path);
+            if (asset && RequestPending(assetControls[type], path, priority)) return asset;
+        }
 
-            asset = workQueue.Dispatch<Asset>([this, path, type] {
-                ZoneScopedN("LoadAsset");
-                ZoneStr(path);
-                std::ifstream in;
-                size_t size;
-
-                if (InputStream(path, type, in, &size)) {
-                    auto asset = std::make_shared<Asset>(path);
-                    asset->buffer.resize(size);
-                    in.read((char *)asset->buffer.data(), size);
-                    Assertf(in.good(), "Failed to read whole asset file: %s", path);
-                    in.close();
-
-                    return asset;
-                } else {
-                    Warnf("Asset does not exist: %s", path);
-                    return std::shared_ptr<Asset>();
-                }
-            });
-            loadedAssets[type].Register(path, asset, true /* allowReplace */);
+        std::lock_guard lock(assetMutex);
+        if (!reload) {
+            // Check again in case an inflight asset just completed on another thread
+            asset = loadedAssets[type].Load(path);
+            if (asset && RequestPending(assetControls[type], path, priority)) return asset;
+        }
+
+        auto control = sharedControl ? sharedControl : std::make_shared<DispatchControl>((int)priority);
+        asset = workQueue.DispatchControlled<Asset>(control, [this, path, type] {
+            ZoneScopedN("LoadAsset");
+            ZoneStr(path);
+            auto asset = ReadAsset(path, type);
+            if (!asset) Warnf("Asset does not exist: %s", path);
+            return asset;
+        });
+        loadedAssets[type].Register(path, asset, true /* allowReplace */);
+        SetControl(assetControls[type], path, control);
+        return asset;
+    }
+
+    std::shared_ptr<Asset> AssetManager::ReadAsset(const std::string &path, AssetType type) {
+#ifdef SP_PACKAGE_RELEASE
+        // The bundle is never modified while running, so assets are read from its mapping without copying
+        if (type == AssetType::Bundled && tarMapping) {
+            std::error_code ec;
+            auto it = tarIndex.find(path);
+            if (it != tarIndex.end() && !std::filesystem::is_regular_file(ASSETS_DIR + path, ec)) {
+                auto [offset, size] = it->second;
+                auto tarData = tarMapping->Data();
+                Assertf(offset + size <= tarData.size(), "Asset is outside of the bundle: %s", path);
+
+                auto asset = std::make_shared<Asset>(path);
+                asset->buffer = tarData.subspan(offset, size);
+                asset->mapping = tarMapping;
+                return asset;
+            }
         }
+#endif
 
+        // Loose files are always read into memory. They can be truncated and rewritten in place by an editor or
+        // OutputStream(), and touching a mapped page past the new end of the file raises SIGBUS.
+        std::ifstream in;
+        size_t size;
+        if (!InputStream(path, type, in, &size)) return nullptr;
+
+        auto asset = std::make_shared<Asset>(path);
+        asset->ownedBuffer.resize(size);
+        in.read((char *)asset->ownedBuffer.data(), size);
+        Assertf(in.good(), "Failed to read whole asset file: %s", path);
+        in.close();
+        asset->buffer = asset->ownedBuffer;
         return asset;
     }
 
@@ -190,43 +294,43 @@ namespace sp {
         return "";
     }
 
-    AsyncPtr<Gltf> AssetManager::LoadGltf(const std::string &name) {
+    AsyncPtr<Gltf> AssetManager::LoadGltf(const std::string &name, AssetPriority priority) {
         Assert(!name.empty(), "AssetManager::LoadGltf called with empty name");
 
         auto gltf = loadedGltfs.Load(name);
-        if (!gltf) {
-            {
-                std::lock_guard lock(gltfMutex);
-                // Check again in case an inflight model just completed on another thread
-                gltf = loadedGltfs.Load(name);
-                if (gltf) return gltf;
-
-                std::string path;
-                {
-                    std::lock_guard lock2(externalGltfMutex);
-                    auto it = externalGltfPaths.find(name);
-                    if (it != externalGltfPaths.end()) path = it->second;
-                }
+        if (gltf && RequestPending(gltfControls, name, priority)) return gltf;
 
-                AsyncPtr<Asset> asset;
-                if (path.empty()) {
-                    path = FindGltfByName(name);
-                    if (!path.empty()) asset = Load(path, AssetType::Bundled);
-                } else {
-                    asset = Load(path, AssetType::External);
-                }
+        std::lock_guard lock(gltfMutex);
+        // Check again in case an inflight model just completed on another thread
+        gltf = loadedGltfs.Load(name);
+        if (gltf && RequestPending(gltfControls, name, priority)) return gltf;
 
-                gltf = workQueue.Dispatch<Gltf>(asset, [name](std::shared_ptr<const Asset> asset) {
-                    if (!asset) {
-                        Logf("Gltf not found: %s", name);
-                        return std::shared_ptr<Gltf>();
-                    }
-                    return std::make_shared<Gltf>(name, asset);
-                });
-                loadedGltfs.Register(name, gltf);
-            }
+        std::string path;
+        {
+            std::lock_guard lock2(externalGltfMutex);
+            auto it = externalGltfPaths.find(name);
+            if (it != externalGltfPaths.end()) path = it->second;
+        }
+
+        // The file read and the parse share a control, so they are reprioritized and canceled together
+        auto control = std::make_shared<DispatchControl>((int)priority);
+        AsyncPtr<Asset> asset;
+        if (path.empty()) {
+            path = FindGltfByName(name);
+            if (!path.empty()) asset = LoadInternal(path, AssetType::Bundled, false, priority, control);
+        } else {
+            asset = LoadInternal(path, AssetType::External, false, priority, control);
         }
 
+        gltf = workQueue.DispatchControlled<Gltf>(control, asset, [name](std::shared_ptr<const Asset> asset) {
+            if (!asset) {
+                Logf("Gltf not found: %s", name);
+                return std::shared_ptr<Gltf>();
+            }
+            return std::make_shared<Gltf>(name, asset);
+        });
+        loadedGltfs.Register(name, gltf, true /* allowReplace */);
+        SetControl(gltfControls, name, control);
         return gltf;
     }
 
@@ -282,7 +386,7 @@ namespace sp {
 
         auto physicsInfo = LoadPhysicsInfo(modelName);
 
-        return workQueue.Dispatch<HullSettings>(physicsInfo,
+        return physicsInfo->Then<HullSettings>(workQueue,
             [modelName, meshName](std::shared_ptr<const PhysicsInfo> physicsInfo) {
                 if (!physicsInfo) {
                     Logf("PhysicsInfo not found: %s", modelName);
@@ -292,33 +396,55 @@ namespace sp {
             });
     }
 
-    AsyncPtr<Image> AssetManager::LoadImage(const std::string &path) {
+    AsyncPtr<Image> AssetManager::LoadImage(const std::string &path, AssetPriority priority) {
         Assert(!path.empty(), "AssetManager::LoadImage called with empty path");
 
         auto image = loadedImages.Load(path);
-        if (!image) {
-            {
-                std::lock_guard lock(imageMutex);
-                // Check again in case an inflight image just completed on another thread
-                image = loadedImages.Load(path);
-                if (image) return image;
-
-                auto asset = Load(path);
-                image = workQueue.Dispatch<Image>(asset, [path](std::shared_ptr<const Asset> asset) {
-                    if (!asset) {
-                        Logf("Image not found: %s", path);
-                        return std::shared_ptr<Image>();
-                    }
-                    return std::make_shared<Image>(asset);
-                });
-
-                loadedImages.Register(path, image);
+        if (image && RequestPending(imageControls, path, priority)) return image;
+
+        std::lock_guard lock(imageMutex);
+        // Check again in case an inflight image just completed on another thread
+        image = loadedImages.Load(path);
+        if (image && RequestPending(imageControls, path, priority)) return image;
+
+        auto control = std::make_shared<DispatchControl>((int)priority);
+        auto asset = LoadInternal(path, AssetType::Bundled, false, priority, control);
+        image = workQueue.DispatchControlled<Image>(control, asset, [path](std::shared_ptr<const Asset> asset) {
+            if (!asset) {
+                Logf("Image not found: %s", path);
+                return std::shared_ptr<Image>();
             }
-        }
-
+            return std::make_shared<Image>(asset);
+        });
+        loadedImages.Register(path, image, true /* allowReplace */);
+        SetControl(imageControls, path, control);
         return image;
     }
 
+    std::shared_ptr<AssetPrefetch> AssetManager::Prefetch(const std::vector<std::string> &gltfNames,
+        const std::vector<std::string> &imagePaths,
+        const std::vector<std::string> &assetPaths) {
+        ZoneScoped;
+        auto prefetch = std::make_shared<AssetPrefetch>();
+        auto addControl = [&](ControlMap &controls, const std::string &key) {
+            auto control = GetControl(controls, key);
+            if (control) prefetch->controls.emplace_back(control);
+        };
+        for (auto &name : gltfNames) {
+            prefetch->gltfs.emplace_back(LoadGltf(name, AssetPriority::Prefetch));
+            addControl(gltfControls, name);
+        }
+        for (auto &path : imagePaths) {
+            prefetch->images.emplace_back(LoadImage(path, AssetPriority::Prefetch));
+            addControl(imageControls, path);
+        }
+        for (auto &path : assetPaths) {
+            prefetch->assets.emplace_back(Load(path, AssetType::Bundled, false, AssetPriority::Prefetch));
+            addControl(assetControls[AssetType::Bundled], path);
+        }
+        return prefetch;
+    }
+
     void AssetManager::RegisterExternalGltf(const std::string &name, const std::string &path) {
         std::lock_guard lock(externalGltfMutex);
         auto result = externalGltfPaths.emplace(name, path);
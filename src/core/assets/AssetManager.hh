@@ -19,6 +19,7 @@ namespace sp {
     class Asset;
     class Gltf;
     class Image;
+    class MappedFile;
     class PhysicsInfo;
     struct HullSettings;
 
@@ -27,17 +28,64 @@ namespace sp {
         External,
     };
 
+    // Pending loads with a higher priority are processed first
+    enum class AssetPriority {
+        Prefetch = -2, // Content that may be needed soon, see AssetManager::Prefetch()
+        Low = -1,
+        Normal = 0,
+        High = 1, // Content that is needed immediately, such as visible models in a scene being loaded
+    };
+
+    /**
+     * Keeps a set of prefetched assets loaded.
+     * Prefetches that haven't started when this is destroyed are canceled, unless they were also requested by a
+     * regular load in the meantime.
+     */
+    class AssetPrefetch : public NonCopyable {
+    public:
+        ~AssetPrefetch();
+
+        // Returns true once every prefetched asset has finished loading
+        bool Ready() const;
+
+    private:
+        std::vector<DispatchControlPtr> controls;
+        std::vector<AsyncPtr<Asset>> assets;
+        std::vector<AsyncPtr<Gltf>> gltfs;
+        std::vector<AsyncPtr<Image>> images;
+
+        friend class AssetManager;
+    };
+
     class AssetManager : public RegisteredThread {
         LogOnExit logOnExit = "Assets shut down ======================================================";
 
     public:
         AssetManager();
 
-        AsyncPtr<Asset> Load(const std::string &path, AssetType type = AssetType::Bundled, bool reload = false);
-        AsyncPtr<Gltf> LoadGltf(const std::string &name);
+        /**
+         * Requesting an asset that is already being loaded raises the priority of the pending load.
+         * Priorities are never lowered by later requests.
+         */
+        AsyncPtr<Asset> Load(const std::string &path,
+            AssetType type = AssetType::Bundled,
+            bool reload = false,
+            AssetPriority priority = AssetPriority::Normal);
+        AsyncPtr<Gltf> LoadGltf(const std::string &name, AssetPriority priority = AssetPriority::Normal);
         AsyncPtr<PhysicsInfo> LoadPhysicsInfo(const std::string &name);
         AsyncPtr<HullSettings> LoadHullSettings(const std::string &modelName, const std::string &meshName);
-        AsyncPtr<Image> LoadImage(const std::string &path);
+        AsyncPtr<Image> LoadImage(const std::string &path, AssetPriority priority = AssetPriority::Normal);
+
+        /**
+         * Starts loading models, images, and bundled assets at AssetPriority::Prefetch.
+         * The returned handle keeps them loaded, and cancels any that haven't started when it is destroyed.
+         */
+        std::shared_ptr<AssetPrefetch> Prefetch(const std::vector<std::string> &gltfNames,
+            const std::vector<std::string> &imagePaths = {},
+            const std::vector<std::string> &assetPaths = {});
+
+        // Time spent by asset work waiting in the queue vs. running
+        DispatchQueueStats GetQueueStats();
 
         void RegisterExternalGltf(const std::string &name, const std::string &path);
         bool IsGltfRegistered(const std::string &name);
@@ -49,6 +97,19 @@ namespace sp {
         void Frame() override;
 
         void UpdateTarIndex();
+        std::shared_ptr<Asset> ReadAsset(const std::string &path, AssetType type);
+
+        using ControlMap = robin_hood::unordered_flat_map<std::string, DispatchControlPtr>;
+
+        AsyncPtr<Asset> LoadInternal(const std::string &path,
+            AssetType type,
+            bool reload,
+            AssetPriority priority,
+            const DispatchControlPtr &sharedControl);
+        // Raises the priority of a pending load, returns false if it was canceled and must be dispatched again
+        bool RequestPending(ControlMap &controls, const std::string &key, AssetPriority priority);
+        void SetControl(ControlMap &controls, const std::string &key, const DispatchControlPtr &control);
+        DispatchControlPtr GetControl(ControlMap &controls, const std::string &key);
         std::string FindGltfByName(const std::string &name);
         std::string FindPhysicsByName(const std::string &name);
 
@@ -67,7 +128,14 @@ namespace sp {
         std::mutex externalGltfMutex;
         robin_hood::unordered_flat_map<std::string, std::string> externalGltfPaths;
 
+        // Controls of loads that haven't started, or were canceled
+        std::mutex controlMutex;
+        EnumArray<ControlMap, AssetType> assetControls;
+        ControlMap gltfControls, imageControls;
+
         robin_hood::unordered_flat_map<std::string, std::pair<size_t, size_t>> tarIndex;
+        // The asset bundle is mapped once, and bundled assets are views into it
+        std::shared_ptr<const MappedFile> tarMapping;
     };
 
     AssetManager &Assets();
@@ -4,13 +4,23 @@
 #include "core/LockFreeMutex.hh"
 
 #include <chrono>
+#include <functional>
 #include <future>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 namespace sp {
+    class DispatchQueue;
+
+    template<typename T>
+    class Async;
+
+    template<typename T>
+    using AsyncPtr = std::shared_ptr<Async<T>>;
+
     template<typename T>
-    class Async {
+    class Async : public std::enable_shared_from_this<Async<T>> {
     public:
         Async() {}
         Async(const std::shared_ptr<T> &ptr) : value(ptr) {
@@ -30,15 +40,49 @@ namespace sp {
 
         void Set(const std::shared_ptr<T> &ptr) {
             value = ptr;
-            Assert(!valid.test_and_set(), "Async::Set called multiple times");
+            std::vector<std::function<void()>> readyCallbacks;
+            {
+                std::lock_guard lock(callbackMutex);
+                Assert(!valid.test_and_set(), "Async::Set called multiple times");
+                readyCallbacks.swap(callbacks);
+            }
             valid.notify_all();
+            for (auto &callback : readyCallbacks) {
+                callback();
+            }
         }
 
+        /**
+         * Calls the callback once a value has been set, or immediately if it is already set.
+         * Callbacks are run on the thread calling Set(), and should only do a small amount of work.
+         */
+        void OnReady(std::function<void()> &&callback) {
+            {
+                std::lock_guard lock(callbackMutex);
+                if (!valid.test()) {
+                    callbacks.emplace_back(std::move(callback));
+                    return;
+                }
+            }
+            callback();
+        }
+
+        /**
+         * Queues fn on the provided queue as soon as this value is set, and returns a future for its result.
+         * The function is called with the value of this future, and may itself return a future.
+         * The Async must be owned by a shared_ptr (see AsyncPtr).
+         *
+         * Usage: asyncImage->Then<ImageView>(queue, [](std::shared_ptr<Image> image) { return ...; });
+         * Defined in core/DispatchQueue.hh
+         */
+        template<typename ReturnType, typename Fn>
+        AsyncPtr<ReturnType> Then(DispatchQueue &queue, Fn &&fn);
+
     private:
         std::atomic_flag valid;
         std::shared_ptr<T> value;
-    };
 
-    template<typename T>
-    using AsyncPtr = std::shared_ptr<Async<T>>;
+        std::mutex callbackMutex;
+        std::vector<std::function<void()>> callbacks;
+    };
 } // namespace sp
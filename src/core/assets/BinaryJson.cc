@@ -0,0 +1,206 @@
+#include "BinaryJson.hh"
+
+#include "core/Logging.hh"
+#include "core/Tracing.hh"
+
+#include <cstring>
+#include <picojson/picojson.h>
+#include <robin_hood.h>
+#include <string_view>
+
+namespace sp::json {
+    enum class BinaryTag : uint8_t {
+        Null = 0,
+        False,
+        True,
+        Number,
+        String, // uint32 string index
+        Array, // uint32 count, followed by count values
+        Object, // uint32 count, followed by count (uint32 key index, value) pairs
+    };
+
+    // Nesting depth limit, so corrupt buffers can't overflow the stack while decoding
+    static const size_t MAX_BINARY_DEPTH = 256;
+
+    class BinaryEncoder {
+    public:
+        BinaryEncoder(std::vector<uint8_t> &out) : out(out) {}
+
+        void Encode(const picojson::value &src) {
+            // Strings are referenced from the source document, which outlives the encoder
+            CollectStrings(src);
+            Write((uint32_t)strings.size());
+            for (auto &str : strings) {
+                Write((uint32_t)str.size());
+                out.insert(out.end(), str.begin(), str.end());
+            }
+            EncodeValue(src);
+        }
+
+    private:
+        template<typename T>
+        void Write(const T &value) {
+            auto *bytes = reinterpret_cast<const uint8_t *>(&value);
+            out.insert(out.end(), bytes, bytes + sizeof(T));
+        }
+
+        uint32_t AddString(std::string_view str) {
+            auto [it, inserted] = stringIndex.emplace(str, (uint32_t)strings.size());
+            if (inserted) strings.emplace_back(str);
+            return it->second;
+        }
+
+        void CollectStrings(const picojson::value &src) {
+            if (src.is<std::string>()) {
+                AddString(src.get<std::string>());
+            } else if (src.is<picojson::array>()) {
+                for (auto &item : src.get<picojson::array>()) {
+                    CollectStrings(item);
+                }
+            } else if (src.is<picojson::object>()) {
+                for (auto &[key, item] : src.get<picojson::object>()) {
+                    AddString(key);
+                    CollectStrings(item);
+                }
+            }
+        }
+
+        void EncodeValue(const picojson::value &src) {
+            if (src.is<bool>()) {
+                Write(src.get<bool>() ? BinaryTag::True : BinaryTag::False);
+            } else if (src.is<double>()) {
+                Write(BinaryTag::Number);
+                Write(src.get<double>());
+            } else if (src.is<std::string>()) {
+                Write(BinaryTag::String);
+                Write(stringIndex[src.get<std::string>()]);
+            } else if (src.is<picojson::array>()) {
+                auto &arr = src.get<picojson::array>();
+                Write(BinaryTag::Array);
+                Write((uint32_t)arr.size());
+                for (auto &item : arr) {
+                    EncodeValue(item);
+                }
+            } else if (src.is<picojson::object>()) {
+                auto &obj = src.get<picojson::object>();
+                Write(BinaryTag::Object);
+                Write((uint32_t)obj.size());
+                for (auto &[key, item] : obj) {
+                    Write(stringIndex[key]);
+                    EncodeValue(item);
+                }
+            } else {
+                Write(BinaryTag::Null);
+            }
+        }
+
+        std::vector<uint8_t> &out;
+        std::vector<std::string_view> strings;
+        robin_hood::unordered_flat_map<std::string_view, uint32_t> stringIndex;
+    };
+
+    class BinaryDecoder {
+    public:
+        BinaryDecoder(std::span<const uint8_t> src) : src(src) {}
+
+        bool Decode(picojson::value &dst) {
+            uint32_t stringCount;
+            if (!Read(stringCount) || stringCount > Remaining() / sizeof(uint32_t)) return false;
+            strings.resize(stringCount);
+            for (auto &str : strings) {
+                uint32_t size;
+                if (!Read(size) || size > Remaining()) return false;
+                str.assign(reinterpret_cast<const char *>(src.data() + offset), size);
+                offset += size;
+            }
+            return DecodeValue(dst, 0) && offset == src.size();
+        }
+
+    private:
+        size_t Remaining() const {
+            return src.size() - offset;
+        }
+
+        template<typename T>
+        bool Read(T &value) {
+            if (Remaining() < sizeof(T)) return false;
+            std::memcpy(&value, src.data() + offset, sizeof(T));
+            offset += sizeof(T);
+            return true;
+        }
+
+        bool ReadString(uint32_t &index) {
+            return Read(index) && index < strings.size();
+        }
+
+        bool DecodeValue(picojson::value &dst, size_t depth) {
+            BinaryTag tag;
+            if (!Read(tag)) return false;
+
+            switch (tag) {
+            case BinaryTag::Null:
+                dst = picojson::value();
+                return true;
+            case BinaryTag::False:
+            case BinaryTag::True:
+                dst = picojson::value(tag == BinaryTag::True);
+                return true;
+            case BinaryTag::Number: {
+                double number;
+                if (!Read(number)) return false;
+                dst = picojson::value(number);
+                return true;
+            }
+            case BinaryTag::String: {
+                uint32_t index;
+                if (!ReadString(index)) return false;
+                dst = picojson::value(strings[index]);
+                return true;
+            }
+            case BinaryTag::Array: {
+                uint32_t count;
+                // Every value is at least 1 byte, which bounds the count before allocating
+                if (depth >= MAX_BINARY_DEPTH || !Read(count) || count > Remaining()) return false;
+                dst = picojson::value(picojson::array_type, false);
+                auto &arr = dst.get<picojson::array>();
+                arr.resize(count);
+                for (auto &item : arr) {
+                    if (!DecodeValue(item, depth + 1)) return false;
+                }
+                return true;
+            }
+            case BinaryTag::Object: {
+                uint32_t count;
+                if (depth >= MAX_BINARY_DEPTH || !Read(count) || count > Remaining()) return false;
+                dst = picojson::value(picojson::object_type, false);
+                auto &obj = dst.get<picojson::object>();
+                for (uint32_t i = 0; i < count; i++) {
+                    uint32_t keyIndex;
+                    if (!ReadString(keyIndex)) return false;
+                    // Keys were encoded in the object's sorted order, so each one is inserted at the end
+                    auto it = obj.emplace_hint(obj.end(), strings[keyIndex], picojson::value());
+                    if (!DecodeValue(it->second, depth + 1)) return false;
+                }
+                return true;
+            }
+            default:
+                return false;
+            }
+        }
+
+        std::span<const uint8_t> src;
+        size_t offset = 0;
+        std::vector<std::string> strings;
+    };
+
+    void EncodeBinary(const picojson::value &src, std::vector<uint8_t> &dst) {
+        ZoneScoped;
+        BinaryEncoder(dst).Encode(src);
+    }
+
+    bool DecodeBinary(std::span<const uint8_t> src, picojson::value &dst) {
+        ZoneScoped;
+        ZoneValue(src.size());
+        return BinaryDecoder(src).Decode(dst);
+    }
+} // namespace sp::json
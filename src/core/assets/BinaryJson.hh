@@ -0,0 +1,27 @@
+#pragma once
+
+#include "core/Common.hh"
+
+#include <span>
+#include <vector>
+
+namespace picojson {
+    class value;
+}
+
+namespace sp::json {
+    /**
+     * A compact binary encoding of a picojson document, used to cache JSON assets that are expensive to parse.
+     *
+     * Every string and object key is stored once in a string table at the start of the buffer, followed by the
+     * values as tagged nodes in document order. Decoding is a single pass over the buffer with no text parsing,
+     * number conversion, or escape handling. The encoding uses native byte order, so it is only meant for caches
+     * that can be regenerated from the original JSON.
+     */
+    static const uint32_t BINARY_JSON_VERSION = 1;
+
+    void EncodeBinary(const picojson::value &src, std::vector<uint8_t> &dst);
+
+    // Returns false if the buffer is truncated or corrupt, leaving dst in an unspecified state
+    bool DecodeBinary(std::span<const uint8_t> src, picojson::value &dst);
+} // namespace sp::json
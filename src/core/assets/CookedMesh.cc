@@ -0,0 +1,450 @@
+#include "CookedMesh.hh"
+
+#include "assets/Gltf.hh"
+#include "assets/GltfImpl.hh"
+#include "core/Logging.hh"
+#include "core/Tracing.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace sp {
+    static_assert(sizeof(CookedMesh::Vertex) == 32, "CookedMesh::Vertex must not contain padding");
+    static_assert(sizeof(CookedMesh::JointVertex) == 32, "CookedMesh::JointVertex must not contain padding");
+    static_assert(sizeof(CookedMesh::Primitive) == 64, "CookedMesh::Primitive must not contain padding");
+
+    CookedMeshView CookedMesh::View() const {
+        return CookedMeshView{primitives, indices, vertices, joints};
+    }
+
+    namespace cookedmesh {
+        const uint32_t cookedMeshMagic = 0x4853454d; // "MESH"
+
+        // Each array is aligned within the file so it can be read in place
+        const size_t cookedMeshAlignment = 16;
+
+#pragma pack(push, 1)
+        struct cookedMeshHeader {
+            uint32_t magicNumber = cookedMeshMagic;
+            uint32_t version = COOKED_MESH_VERSION;
+            Hash128 sourceHash;
+            uint32_t primitiveCount = 0;
+            uint32_t indexCount = 0;
+            uint32_t vertexCount = 0;
+            uint32_t jointsCount = 0;
+        };
+
+#pragma pack(pop)
+
+        static_assert(sizeof(cookedMeshHeader) == 40, "Cooked mesh header size changed unexpectedly");
+
+        // The cache size assumed when ordering triangles, larger than most hardware so it works well for all of them
+        const size_t vertexCacheSize = 32;
+
+        std::string CachePath(const std::string &modelName, size_t meshIndex) {
+            return "cache/meshes/" + modelName + "." + std::to_string(meshIndex) + ".bin";
+        }
+
+        CookedMesh Convert(const gltf::Mesh &mesh) {
+            ZoneScoped;
+            size_t indexCount = 0, vertexCount = 0, jointsCount = 0;
+            for (auto &prim : mesh.primitives) {
+                indexCount += prim.indexBuffer.Count();
+                vertexCount += prim.positionBuffer.Count();
+                jointsCount += std::min(prim.positionBuffer.Count(), prim.jointsBuffer.Count());
+            }
+            Assertf(indexCount <= UINT32_MAX && vertexCount <= UINT32_MAX,
+                "Mesh is too large: %u indices, %u vertices",
+                indexCount,
+                vertexCount);
+
+            CookedMesh result;
+            result.primitives.reserve(mesh.primitives.size());
+            result.indices.resize(indexCount);
+            result.vertices.resize(vertexCount);
+            result.joints.resize(jointsCount);
+
+            size_t indexOffset = 0, vertexOffset = 0, jointsOffset = 0;
+            for (auto &assetPrimitive : mesh.primitives) {
+                // TODO: this implementation assumes a lot about the model format,
+                // and asserts the assumptions. It would be better to support more
+                // kinds of inputs, and convert the data rather than just failing.
+                Assert(assetPrimitive.drawMode == gltf::Mesh::DrawMode::Triangles, "draw mode must be Triangles");
+
+                auto &prim = result.primitives.emplace_back();
+                prim.materialIndex = assetPrimitive.materialIndex;
+
+                prim.indexOffset = indexOffset;
+                prim.indexCount = assetPrimitive.indexBuffer.Count();
+                if (prim.indexCount > 0) {
+                    auto indices = std::span(result.indices).subspan(indexOffset, prim.indexCount);
+                    assetPrimitive.indexBuffer.ReadInto(indices);
+                }
+                indexOffset += prim.indexCount;
+
+                prim.vertexOffset = vertexOffset;
+                prim.vertexCount = assetPrimitive.positionBuffer.Count();
+                auto *vertices = result.vertices.data() + vertexOffset;
+                if (prim.vertexCount > 0) {
+                    // Each attribute is converted in bulk, directly into its field of the interleaved vertex
+                    assetPrimitive.positionBuffer.ReadInto(&vertices->position,
+                        sizeof(CookedMesh::Vertex),
+                        0,
+                        prim.vertexCount);
+                    auto normalCount = std::min<size_t>(prim.vertexCount, assetPrimitive.normalBuffer.Count());
+                    if (normalCount > 0) {
+                        assetPrimitive.normalBuffer.ReadInto(&vertices->normal,
+                            sizeof(CookedMesh::Vertex),
+                            0,
+                            normalCount);
+                    }
+                    auto uvCount = std::min<size_t>(prim.vertexCount, assetPrimitive.texcoordBuffer.Count());
+                    if (uvCount > 0) {
+                        assetPrimitive.texcoordBuffer.ReadInto(&vertices->uv, sizeof(CookedMesh::Vertex), 0, uvCount);
+                    }
+                }
+                vertexOffset += prim.vertexCount;
+
+                prim.jointsVertexOffset = jointsOffset;
+                prim.jointsVertexCount = std::min<size_t>(prim.vertexCount, assetPrimitive.jointsBuffer.Count());
+                if (prim.jointsVertexCount > 0) {
+                    Assert(prim.jointsVertexCount <= assetPrimitive.weightsBuffer.Count(),
+                        "must have one weight per joint index");
+                    auto *joints = result.joints.data() + jointsOffset;
+                    assetPrimitive.jointsBuffer.ReadInto(&joints->jointIndexes,
+                        sizeof(CookedMesh::JointVertex),
+                        0,
+                        prim.jointsVertexCount);
+                    assetPrimitive.weightsBuffer.ReadInto(&joints->jointWeights,
+                        sizeof(CookedMesh::JointVertex),
+                        0,
+                        prim.jointsVertexCount);
+                }
+                jointsOffset += prim.jointsVertexCount;
+
+                prim.center = glm::vec3(0);
+                prim.boundsMin = glm::vec3(0);
+                prim.boundsMax = glm::vec3(0);
+                if (prim.vertexCount > 0) {
+                    prim.boundsMin = glm::vec3(std::numeric_limits<float>::infinity());
+                    prim.boundsMax = glm::vec3(-std::numeric_limits<float>::infinity());
+                    for (size_t i = 0; i < prim.vertexCount; i++) {
+                        prim.center += vertices[i].position;
+                        prim.boundsMin = glm::min(prim.boundsMin, vertices[i].position);
+                        prim.boundsMax = glm::max(prim.boundsMax, vertices[i].position);
+                    }
+                    prim.center /= prim.vertexCount;
+                }
+            }
+            return result;
+        }
+
+        // Tracks a least recently used post-transform vertex cache
+        class cacheSimulator {
+        public:
+            cacheSimulator(size_t cacheSize) : cacheSize(cacheSize) {
+                entries.reserve(cacheSize + 1);
+            }
+
+            // Returns true if the vertex was already in the cache
+            bool Access(uint32_t vertex) {
+                auto it = std::find(entries.begin(), entries.end(), vertex);
+                bool hit = it != entries.end();
+                if (hit) entries.erase(it);
+                entries.insert(entries.begin(), vertex);
+                if (entries.size() > cacheSize) entries.pop_back();
+                return hit;
+            }
+
+        private:
+            size_t cacheSize;
+            std::vector<uint32_t> entries;
+        };
+
+        float AverageCacheMissRatio(std::span<const uint32_t> indices, size_t cacheSize) {
+            if (indices.size() < 3) return 0.0f;
+            cacheSimulator cache(cacheSize);
+            size_t misses = 0;
+            for (auto index : indices) {
+                if (!cache.Access(index)) misses++;
+            }
+            return (float)misses / (float)(indices.size() / 3);
+        }
+
+        static float vertexScore(int cachePosition, uint32_t remainingTriangles) {
+            if (remainingTriangles == 0) return -1.0f;
+
+            float score = 0.0f;
+            if (cachePosition >= 0) {
+                if (cachePosition < 3) {
+                    // Vertices of the last triangle are penalized, so strips don't keep reusing the same edge
+                    score = 0.75f;
+                } else {
+                    float scale = 1.0f - (float)(cachePosition - 3) / (float)(vertexCacheSize - 3);
+                    score = std::pow(scale, 1.5f);
+                }
+            }
+            // Vertices with few remaining triangles are boosted, so they can be finished and leave the cache
+            return score + 2.0f / std::sqrt((float)remainingTriangles);
+        }
+
+        // Tom Forsyth's linear-speed vertex cache optimization, greedily emitting the triangle with the best score
+        static void optimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount) {
+            ZoneScoped;
+            size_t triangleCount = indices.size() / 3;
+
+            std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+            for (auto index : indices) {
+                adjacencyOffsets[index + 1]++;
+            }
+            for (size_t v = 0; v < vertexCount; v++) {
+                adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+            }
+            std::vector<uint32_t> adjacency(indices.size());
+            {
+                std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+                for (size_t i = 0; i < indices.size(); i++) {
+                    adjacency[fill[indices[i]]++] = i / 3;
+                }
+            }
+
+            std::vector<uint32_t> remaining(vertexCount);
+            std::vector<int> cachePosition(vertexCount, -1);
+            std::vector<float> vertexScores(vertexCount);
+            for (size_t v = 0; v < vertexCount; v++) {
+                remaining[v] = adjacencyOffsets[v + 1] - adjacencyOffsets[v];
+                vertexScores[v] = vertexScore(-1, remaining[v]);
+            }
+
+            std::vector<float> triangleScores(triangleCount);
+            std::vector<bool> emitted(triangleCount);
+            size_t bestTriangle = 0;
+            for (size_t t = 0; t < triangleCount; t++) {
+                for (size_t i = 0; i < 3; i++) {
+                    triangleScores[t] += vertexScores[indices[t * 3 + i]];
+                }
+                if (triangleScores[t] > triangleScores[bestTriangle]) bestTriangle = t;
+            }
+
+            std::vector<uint32_t> output;
+            output.reserve(indices.size());
+            std::vector<uint32_t> cache, nextCache;
+            cache.reserve(vertexCacheSize + 3);
+            nextCache.reserve(vertexCacheSize + 3);
+            size_t nextUnemitted = 0;
+
+            while (output.size() < indices.size()) {
+                if (bestTriangle == triangleCount) {
+                    // Nothing in the cache is connected to a remaining triangle, start again from the input order
+                    while (emitted[nextUnemitted]) {
+                        nextUnemitted++;
+                    }
+                    bestTriangle = nextUnemitted;
+                }
+
+                emitted[bestTriangle] = true;
+                nextCache.clear();
+                for (size_t i = 0; i < 3; i++) {
+                    auto vertex = indices[bestTriangle * 3 + i];
+                    output.emplace_back(vertex);
+                    remaining[vertex]--;
+                    if (!sp::contains(nextCache, vertex)) nextCache.emplace_back(vertex);
+                }
+                for (auto vertex : cache) {
+                    if (!sp::contains(nextCache, vertex)) nextCache.emplace_back(vertex);
+                }
+
+                // Rescore every vertex whose cache position changed, including those pushed out of the cache
+                for (size_t i = 0; i < nextCache.size(); i++) {
+                    auto vertex = nextCache[i];
+                    cachePosition[vertex] = i < vertexCacheSize ? (int)i : -1;
+                    float score = vertexScore(cachePosition[vertex], remaining[vertex]);
+                    float delta = score - vertexScores[vertex];
+                    vertexScores[vertex] = score;
+                    for (auto a = adjacencyOffsets[vertex]; a < adjacencyOffsets[vertex + 1]; a++) {
+                        if (!emitted[adjacency[a]]) triangleScores[adjacency[a]] += delta;
+                    }
+                }
+                if (nextCache.size() > vertexCacheSize) nextCache.resize(vertexCacheSize);
+                std::swap(cache, nextCache);
+
+                // Only triangles using a cached vertex are candidates for the next triangle
+                bestTriangle = triangleCount;
+                float bestScore = -std::numeric_limits<float>::infinity();
+                for (auto vertex : cache) {
+                    for (auto a = adjacencyOffsets[vertex]; a < adjacencyOffsets[vertex + 1]; a++) {
+                        auto t = adjacency[a];
+                        if (!emitted[t] && triangleScores[t] > bestScore) {
+                            bestScore = triangleScores[t];
+                            bestTriangle = t;
+                        }
+                    }
+                }
+            }
+            std::copy(output.begin(), output.end(), indices.begin());
+        }
+
+        /**
+         * Splits the triangles into clusters wherever the vertex cache order has a hard boundary, and sorts the
+         * clusters so that those facing away from the center of the mesh are drawn first. Those are the surfaces most
+         * likely to be in front, so more of the later fragments fail the depth test. Based on Sander et al. 2007,
+         * "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw".
+         */
+        static void optimizeOverdraw(std::span<uint32_t> indices, std::span<const CookedMesh::Vertex> vertices) {
+            ZoneScoped;
+            size_t triangleCount = indices.size() / 3;
+
+            std::vector<size_t> clusterStarts;
+            cacheSimulator cache(vertexCacheSize);
+            for (size_t t = 0; t < triangleCount; t++) {
+                size_t misses = 0;
+                for (size_t i = 0; i < 3; i++) {
+                    if (!cache.Access(indices[t * 3 + i])) misses++;
+                }
+                if (misses == 3 || t == 0) clusterStarts.emplace_back(t);
+            }
+            clusterStarts.emplace_back(triangleCount);
+            if (clusterStarts.size() <= 2) return;
+
+            struct Cluster {
+                size_t start, end;
+                glm::vec3 centroid, normal;
+                float area;
+                float sortKey;
+            };
+            std::vector<Cluster> clusters(clusterStarts.size() - 1);
+            glm::vec3 meshCentroid(0);
+            float meshArea = 0.0f;
+            for (size_t c = 0; c < clusters.size(); c++) {
+                auto &cluster = clusters[c];
+                cluster.start = clusterStarts[c];
+                cluster.end = clusterStarts[c + 1];
+                cluster.centroid = glm::vec3(0);
+                cluster.normal = glm::vec3(0);
+                cluster.area = 0.0f;
+                for (size_t t = cluster.start; t < cluster.end; t++) {
+                    auto &p0 = vertices[indices[t * 3]].position;
+                    auto &p1 = vertices[indices[t * 3 + 1]].position;
+                    auto &p2 = vertices[indices[t * 3 + 2]].position;
+                    auto normal = glm::cross(p1 - p0, p2 - p0);
+                    float area = glm::length(normal);
+                    cluster.normal += normal;
+                    cluster.centroid += (p0 + p1 + p2) * (area / 3.0f);
+                    cluster.area += area;
+                }
+                meshCentroid += cluster.centroid;
+                meshArea += cluster.area;
+                if (cluster.area > 0.0f) cluster.centroid /= cluster.area;
+            }
+            if (meshArea > 0.0f) meshCentroid /= meshArea;
+
+            for (auto &cluster : clusters) {
+                float normalLength = glm::length(cluster.normal);
+                if (normalLength > 0.0f) {
+                    cluster.sortKey = glm::dot(cluster.centroid - meshCentroid, cluster.normal / normalLength);
+                } else {
+                    cluster.sortKey = 0.0f;
+                }
+            }
+            std::stable_sort(clusters.begin(), clusters.end(), [](auto &a, auto &b) {
+                return a.sortKey > b.sortKey;
+            });
+
+            std::vector<uint32_t> output;
+            output.reserve(indices.size());
+            for (auto &cluster : clusters) {
+                output.insert(output.end(), indices.begin() + cluster.start * 3, indices.begin() + cluster.end * 3);
+            }
+            std::copy(output.begin(), output.end(), indices.begin());
+        }
+
+        void OptimizeIndices(CookedMesh &mesh) {
+            ZoneScoped;
+            for (size_t p = 0; p < mesh.primitives.size(); p++) {
+                auto &prim = mesh.primitives[p];
+                if (prim.indexCount % 3 != 0) {
+                    Warnf("Skipping optimization of primitive %u, index count is not a multiple of 3", p);
+                    continue;
+                }
+                auto indices = std::span(mesh.indices).subspan(prim.indexOffset, prim.indexCount);
+                auto vertices = std::span(mesh.vertices).subspan(prim.vertexOffset, prim.vertexCount);
+                bool validIndices = std::all_of(indices.begin(), indices.end(), [&](auto index) {
+                    return index < prim.vertexCount;
+                });
+                if (!validIndices) {
+                    Warnf("Skipping optimization of primitive %u, indices are out of range", p);
+                    continue;
+                }
+
+                optimizeVertexCache(indices, prim.vertexCount);
+                optimizeOverdraw(indices, vertices);
+            }
+        }
+
+        static size_t alignOffset(size_t offset) {
+            return (offset + cookedMeshAlignment - 1) & ~(cookedMeshAlignment - 1);
+        }
+
+        void Serialize(const CookedMesh &mesh, const Hash128 &sourceHash, std::vector<uint8_t> &dst) {
+            ZoneScoped;
+            Assert(mesh.primitives.size() <= UINT32_MAX && mesh.indices.size() <= UINT32_MAX &&
+                       mesh.vertices.size() <= UINT32_MAX && mesh.joints.size() <= UINT32_MAX,
+                "Cooked mesh is too large to serialize");
+
+            cookedMeshHeader header = {};
+            header.sourceHash = sourceHash;
+            header.primitiveCount = mesh.primitives.size();
+            header.indexCount = mesh.indices.size();
+            header.vertexCount = mesh.vertices.size();
+            header.jointsCount = mesh.joints.size();
+
+            dst.clear();
+            auto append = [&dst](const void *data, size_t size) {
+                // Padding is zeroed so the output only depends on the mesh
+                dst.resize(alignOffset(dst.size()), 0);
+                auto *bytes = reinterpret_cast<const uint8_t *>(data);
+                dst.insert(dst.end(), bytes, bytes + size);
+            };
+            append(&header, sizeof(header));
+            append(mesh.primitives.data(), mesh.primitives.size() * sizeof(CookedMesh::Primitive));
+            append(mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+            append(mesh.vertices.data(), mesh.vertices.size() * sizeof(CookedMesh::Vertex));
+            append(mesh.joints.data(), mesh.joints.size() * sizeof(CookedMesh::JointVertex));
+        }
+
+        bool Deserialize(std::span<const uint8_t> src, const Hash128 &sourceHash, CookedMeshView &dst) {
+            ZoneScoped;
+            cookedMeshHeader header;
+            if (src.size() < sizeof(header)) return false;
+            std::memcpy(&header, src.data(), sizeof(header));
+            if (header.magicNumber != cookedMeshMagic || header.version != COOKED_MESH_VERSION) return false;
+            if (header.sourceHash != sourceHash) return false;
+
+            size_t offset = sizeof(header);
+            auto readArray = [&](auto &output, size_t count) {
+                using T = typename std::remove_reference_t<decltype(output)>::value_type;
+                offset = alignOffset(offset);
+                if (offset > src.size() || count > (src.size() - offset) / sizeof(T)) return false;
+                auto *data = src.data() + offset;
+                if (reinterpret_cast<uintptr_t>(data) % alignof(T) != 0) return false;
+                output = std::span(reinterpret_cast<const T *>(data), count);
+                offset += count * sizeof(T);
+                return true;
+            };
+            if (!readArray(dst.primitives, header.primitiveCount)) return false;
+            if (!readArray(dst.indices, header.indexCount)) return false;
+            if (!readArray(dst.vertices, header.vertexCount)) return false;
+            if (!readArray(dst.joints, header.jointsCount)) return false;
+            if (offset != src.size()) return false;
+
+            for (auto &prim : dst.primitives) {
+                if ((size_t)prim.indexOffset + prim.indexCount > dst.indices.size()) return false;
+                if ((size_t)prim.vertexOffset + prim.vertexCount > dst.vertices.size()) return false;
+                if ((size_t)prim.jointsVertexOffset + prim.jointsVertexCount > dst.joints.size()) return false;
+            }
+            return true;
+        }
+    } // namespace cookedmesh
+} // namespace sp
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "core/Common.hh"
+
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+namespace sp {
+    namespace gltf {
+        struct Mesh;
+    }
+
+    struct CookedMeshView;
+
+    /**
+     * A gltf mesh converted to the layout uploaded to the GPU: one interleaved vertex array, one joints array, and one
+     * index array for all primitives, with each primitive referencing its range of each array.
+     *
+     * Meshes are cooked offline by mesh_cooker into cache/meshes/, tagged with the hash of their source gltf so that
+     * a cooked mesh can be uploaded without parsing any vertex data. Meshes without a matching cache are converted
+     * from the gltf at load time instead.
+     */
+    struct CookedMesh {
+        // Matches the layout of vulkan::SceneVertex
+        struct Vertex {
+            glm::vec3 position;
+            glm::vec3 normal;
+            glm::vec2 uv;
+        };
+
+        // Matches the layout of vulkan::JointVertex
+        struct JointVertex {
+            glm::vec4 jointWeights;
+            glm::u16vec4 jointIndexes;
+            float _padding[2];
+        };
+
+        struct Primitive {
+            // Offsets are relative to the start of each of the mesh's arrays
+            uint32_t indexOffset, indexCount;
+            uint32_t vertexOffset, vertexCount;
+            uint32_t jointsVertexOffset, jointsVertexCount;
+            int32_t materialIndex;
+            glm::vec3 center;
+            glm::vec3 boundsMin, boundsMax;
+        };
+
+        std::vector<Primitive> primitives;
+        std::vector<uint32_t> indices;
+        std::vector<Vertex> vertices;
+        std::vector<JointVertex> joints;
+
+        CookedMeshView View() const;
+    };
+
+    struct CookedMeshView {
+        std::span<const CookedMesh::Primitive> primitives;
+        std::span<const uint32_t> indices;
+        std::span<const CookedMesh::Vertex> vertices;
+        std::span<const CookedMesh::JointVertex> joints;
+    };
+
+    namespace cookedmesh {
+        static const uint32_t COOKED_MESH_VERSION = 1;
+
+        std::string CachePath(const std::string &modelName, size_t meshIndex);
+
+        // Converts a gltf mesh to the GPU layout, keeping the source vertex and triangle order
+        CookedMesh Convert(const gltf::Mesh &mesh);
+
+        /**
+         * Reorders each primitive's triangles to reuse the post-transform vertex cache, then reorders clusters of
+         * triangles so that outward facing surfaces are drawn first, reducing overdraw. Triangles keep their winding.
+         */
+        void OptimizeIndices(CookedMesh &mesh);
+
+        // Returns the average number of vertices transformed per triangle, assuming a cache of the given size
+        float AverageCacheMissRatio(std::span<const uint32_t> indices, size_t cacheSize = 32);
+
+        // Serializes a cooked mesh, the output is byte for byte identical for identical inputs
+        void Serialize(const CookedMesh &mesh, const Hash128 &sourceHash, std::vector<uint8_t> &dst);
+
+        /**
+         * Reads a cooked mesh without copying, the returned view points into src.
+         * Returns false if the data is corrupt, misaligned, or was cooked from a different source.
+         */
+        bool Deserialize(std::span<const uint8_t> src, const Hash128 &sourceHash, CookedMeshView &dst);
+    } // namespace cookedmesh
+} // namespace sp
@@ -0,0 +1,922 @@
+#include "CookedTexture.hh"
+
+#include "assets/Gltf.hh"
+#include "assets/GltfImpl.hh"
+#include "core/Logging.hh"
+#include "core/Tracing.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+namespace sp {
+    glm::uvec2 CookedTextureInfo::LevelExtent(uint32_t level) const {
+        return glm::uvec2(std::max(1u, width >> level), std::max(1u, height >> level));
+    }
+
+    size_t CookedTextureInfo::LevelSize(uint32_t level) const {
+        auto extent = LevelExtent(level);
+        return cookedtexture::LevelSize(format, extent.x, extent.y);
+    }
+
+    size_t CookedTextureInfo::LevelOffset(uint32_t level) const {
+        size_t offset = 0;
+        for (uint32_t i = 0; i < level; i++) {
+            offset += LevelSize(i);
+        }
+        return offset;
+    }
+
+    CookedTextureView CookedTexture::View() const {
+        CookedTextureView view;
+        static_cast<CookedTextureInfo &>(view) = *this;
+        view.data = data;
+        return view;
+    }
+
+    namespace cookedtexture {
+        const uint32_t cookedTextureMagic = 0x52545854; // "TXTR"
+
+#pragma pack(push, 1)
+        struct cookedTextureHeader {
+            uint32_t magicNumber = cookedTextureMagic;
+            uint32_t version = COOKED_TEXTURE_VERSION;
+            Hash128 sourceHash;
+            uint32_t format = 0;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t levelCount = 0;
+            uint8_t srgb = 0;
+            uint8_t swizzle[4] = {};
+            uint8_t _padding[3] = {};
+        };
+
+#pragma pack(pop)
+        static_assert(sizeof(cookedTextureHeader) == 48, "Cooked texture header size changed unexpectedly");
+
+        // 4x4 pixels in row major order, 4 channels each
+        typedef std::array<std::array<uint8_t, 4>, 16> pixelBlock;
+
+        std::string CachePath(const std::string &textureName) {
+            return "cache/textures/" + textureName + ".bin";
+        }
+
+        size_t blockBytes(CookedTextureFormat format) {
+            switch (format) {
+            case CookedTextureFormat::BC1:
+                return 8;
+            case CookedTextureFormat::BC3:
+            case CookedTextureFormat::BC5:
+            case CookedTextureFormat::BC7:
+                return 16;
+            default:
+                return 0;
+            }
+        }
+
+        size_t LevelSize(CookedTextureFormat format, uint32_t width, uint32_t height) {
+            if (format == CookedTextureFormat::RGBA8) return (size_t)width * height * 4;
+            return (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes(format);
+        }
+
+        bool FindGltfTexture(const Gltf &source, int materialIndex, TextureType type, GltfTextureSource &dst) {
+            auto &gltfModel = *source.gltfModel;
+            if (materialIndex < 0 || (size_t)materialIndex >= gltfModel.materials.size()) return false;
+            auto &material = gltfModel.materials[materialIndex];
+
+            dst = {};
+            std::string typeName;
+
+            switch (type) {
+            case TextureType::BaseColor:
+                typeName = "BASE";
+                dst.textureIndex = material.pbrMetallicRoughness.baseColorTexture.index;
+                dst.factor = material.pbrMetallicRoughness.baseColorFactor;
+                dst.srgb = true;
+                break;
+
+            // gltf2.0 uses a combined texture for metallic roughness.
+            // Roughness = G channel, Metallic = B channel.
+            // R and A channels are not used / should be ignored.
+            // https://github.com/KhronosGroup/glTF/blob/e5519ce050/specification/2.0/schema/material.pbrMetallicRoughness.schema.json
+            case TextureType::MetallicRoughness: {
+                typeName = "METALLICROUGHNESS";
+                dst.textureIndex = material.pbrMetallicRoughness.metallicRoughnessTexture.index;
+                double rf = material.pbrMetallicRoughness.roughnessFactor,
+                       mf = material.pbrMetallicRoughness.metallicFactor;
+                if (rf != 1 || mf != 1) dst.factor = {0.0, rf, mf, 0.0};
+                break;
+            }
+            case TextureType::Height:
+                typeName = "HEIGHT";
+                dst.textureIndex = material.normalTexture.index;
+                // factor not supported for height textures
+                break;
+
+            case TextureType::Occlusion:
+                typeName = "OCCLUSION";
+                dst.textureIndex = material.occlusionTexture.index;
+                // factor not supported for occlusion textures
+                break;
+
+            case TextureType::Emissive:
+                typeName = "EMISSIVE";
+                dst.textureIndex = material.emissiveTexture.index;
+                dst.factor = material.emissiveFactor;
+                break;
+
+            default:
+                return false;
+            }
+
+            // Named by texture rather than material so materials sharing a texture and factor share one cooked copy
+            dst.name = source.name + "_" + std::to_string(dst.textureIndex) + "_" + typeName;
+            bool useFactor = false;
+            for (auto f : dst.factor) {
+                if (f != 1) useFactor = true;
+            }
+            if (useFactor) {
+                for (auto f : dst.factor) {
+                    char buf[32];
+                    std::snprintf(buf, sizeof(buf), "_%g", f);
+                    dst.name += buf;
+                }
+            }
+
+            if (dst.textureIndex < 0 || (size_t)dst.textureIndex >= gltfModel.textures.size()) {
+                dst.textureIndex = -1;
+                return true;
+            }
+
+            auto &texture = gltfModel.textures[dst.textureIndex];
+            if (texture.sampler < 0 || (size_t)texture.sampler >= gltfModel.samplers.size()) {
+                dst.genMipmap = true;
+            } else {
+                int minFilter = gltfModel.samplers[texture.sampler].minFilter;
+                dst.genMipmap = minFilter <= 0 || minFilter == TINYGLTF_TEXTURE_FILTER_NEAREST_MIPMAP_NEAREST ||
+                                minFilter == TINYGLTF_TEXTURE_FILTER_LINEAR_MIPMAP_NEAREST ||
+                                minFilter == TINYGLTF_TEXTURE_FILTER_NEAREST_MIPMAP_LINEAR ||
+                                minFilter == TINYGLTF_TEXTURE_FILTER_LINEAR_MIPMAP_LINEAR;
+            }
+            return true;
+        }
+
+        bool CookGltfTexture(const Gltf &source,
+            const GltfTextureSource &texture,
+            TextureType type,
+            const CookOptions &options,
+            CookedTexture &dst) {
+            ZoneScoped;
+            ZoneStr(texture.name);
+            auto &gltfModel = *source.gltfModel;
+            if (texture.textureIndex < 0 || (size_t)texture.textureIndex >= gltfModel.textures.size()) return false;
+            int imageIndex = gltfModel.textures[texture.textureIndex].source;
+            if (imageIndex < 0 || (size_t)imageIndex >= gltfModel.images.size()) return false;
+
+            auto &img = gltfModel.images[imageIndex];
+            if (img.bits != 8 || img.component < 1 || img.component > 4 || img.width <= 0 || img.height <= 0) {
+                return false;
+            }
+            size_t pixelCount = (size_t)img.width * img.height;
+            if (img.image.size() != pixelCount * img.component) return false;
+
+            // Expand to RGBA the same way the GPU does for formats with fewer channels
+            std::vector<uint8_t> rgba(pixelCount * 4);
+            for (size_t i = 0; i < pixelCount; i++) {
+                const uint8_t *src = &img.image[i * img.component];
+                uint8_t *pixel = &rgba[i * 4];
+                for (int c = 0; c < 4; c++) {
+                    pixel[c] = c < img.component ? src[c] : (c == 3 ? 255 : 0);
+                }
+            }
+
+            bool useFactor = false;
+            for (auto f : texture.factor) {
+                if (f != 1) useFactor = true;
+            }
+            if (useFactor) ApplyFactor(rgba, texture.factor, texture.srgb);
+
+            auto format = CookedTextureFormat::RGBA8;
+            std::array<uint8_t, 4> swizzle = {0, 1, 2, 3};
+            if (options.compress) {
+                if (type == TextureType::MetallicRoughness) {
+                    // Only roughness and metallic are read, so they are moved into the two BC5 channels
+                    for (size_t i = 0; i < pixelCount; i++) {
+                        rgba[i * 4] = rgba[i * 4 + 1];
+                        rgba[i * 4 + 1] = rgba[i * 4 + 2];
+                    }
+                    format = CookedTextureFormat::BC5;
+                    swizzle = {CHANNEL_ZERO, 0, 1, CHANNEL_ONE};
+                } else if (type == TextureType::Height) {
+                    // Normal maps keep X and Y in BC5, Z is restored as 1 and should be reconstructed when sampled
+                    format = CookedTextureFormat::BC5;
+                    swizzle = {0, 1, CHANNEL_ONE, CHANNEL_ONE};
+                } else if (options.highQuality) {
+                    format = CookedTextureFormat::BC7;
+                } else {
+                    bool hasAlpha = false;
+                    if (type == TextureType::BaseColor) {
+                        for (size_t i = 0; i < pixelCount && !hasAlpha; i++) {
+                            hasAlpha = rgba[i * 4 + 3] != 255;
+                        }
+                    }
+                    format = hasAlpha ? CookedTextureFormat::BC3 : CookedTextureFormat::BC1;
+                }
+            }
+
+            dst = Cook(rgba, img.width, img.height, format, texture.srgb, texture.genMipmap);
+            dst.swizzle = swizzle;
+            return true;
+        }
+
+        float srgbToLinear(float srgb) {
+            if (srgb <= 0.04045f) return srgb * (1.0f / 12.92f);
+            return std::pow(srgb * (1.0f / 1.055f) + 0.0521327f, 2.4f);
+        }
+
+        float linearToSrgb(float linear) {
+            if (linear < 0.00313067f) return linear * 12.92f;
+            return std::pow(linear, 1.0f / 2.4f) * 1.055f - 0.055f;
+        }
+
+        uint8_t unormToByte(float value) {
+            return (uint8_t)std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f);
+        }
+
+        const std::array<float, 256> &srgbToLinearTable() {
+            static const auto table = [] {
+                std::array<float, 256> values;
+                for (size_t i = 0; i < values.size(); i++) {
+                    values[i] = srgbToLinear(i / 255.0f);
+                }
+                return values;
+            }();
+            return table;
+        }
+
+        void ApplyFactor(std::span<uint8_t> rgba, std::span<const double> factor, bool srgb) {
+            float channelFactor[4];
+            for (size_t c = 0; c < 4; c++) {
+                channelFactor[c] = c < factor.size() ? (float)factor[c] : 0.0f;
+            }
+            auto &toLinear = srgbToLinearTable();
+            for (size_t i = 0; i + 3 < rgba.size(); i += 4) {
+                for (size_t c = 0; c < 4; c++) {
+                    if (srgb && c < 3) {
+                        rgba[i + c] = unormToByte(linearToSrgb(toLinear[rgba[i + c]] * channelFactor[c]));
+                    } else {
+                        rgba[i + c] = unormToByte(rgba[i + c] / 255.0f * channelFactor[c]);
+                    }
+                }
+            }
+        }
+
+        // Halves each dimension by averaging 2x2 pixels, the last row or column is dropped for odd sizes
+        std::vector<uint8_t> downsample(std::span<const uint8_t> src, uint32_t width, uint32_t height, bool srgb) {
+            uint32_t dstWidth = std::max(1u, width / 2), dstHeight = std::max(1u, height / 2);
+            std::vector<uint8_t> dst((size_t)dstWidth * dstHeight * 4);
+            auto &toLinear = srgbToLinearTable();
+
+            for (uint32_t y = 0; y < dstHeight; y++) {
+                uint32_t rows[2] = {std::min(y * 2, height - 1), std::min(y * 2 + 1, height - 1)};
+                for (uint32_t x = 0; x < dstWidth; x++) {
+                    uint32_t columns[2] = {std::min(x * 2, width - 1), std::min(x * 2 + 1, width - 1)};
+                    for (size_t c = 0; c < 4; c++) {
+                        bool linearize = srgb && c < 3;
+                        float sum = 0.0f;
+                        for (auto row : rows) {
+                            for (auto column : columns) {
+                                uint8_t value = src[((size_t)row * width + column) * 4 + c];
+                                sum += linearize ? toLinear[value] : value / 255.0f;
+                            }
+                        }
+                        float average = sum * 0.25f;
+                        dst[((size_t)y * dstWidth + x) * 4 + c] = unormToByte(linearize ? linearToSrgb(average)
+                                                                                        : average);
+                    }
+                }
+            }
+            return dst;
+        }
+
+        struct bitWriter {
+            uint8_t *dst;
+            size_t offset = 0;
+
+            void Write(uint32_t value, size_t bits) {
+                for (size_t i = 0; i < bits; i++, offset++) {
+                    if (value & (1u << i)) dst[offset / 8] |= 1 << (offset % 8);
+                }
+            }
+        };
+
+        struct bitReader {
+            const uint8_t *src;
+            size_t offset = 0;
+
+            uint32_t Read(size_t bits) {
+                uint32_t value = 0;
+                for (size_t i = 0; i < bits; i++, offset++) {
+                    value |= ((src[offset / 8] >> (offset % 8)) & 1) << i;
+                }
+                return value;
+            }
+        };
+
+        /**
+         * Finds the line through a set of points that best fits them, returning the two ends of the points' projection
+         * onto the line. The direction is the covariance matrix's principal eigenvector, found by power iteration.
+         */
+        template<size_t N>
+        void fitLine(const std::array<float, N> *points,
+            size_t count,
+            std::array<float, N> &min,
+            std::array<float, N> &max) {
+            std::array<float, N> mean = {};
+            for (size_t i = 0; i < count; i++) {
+                for (size_t c = 0; c < N; c++) {
+                    mean[c] += points[i][c] / count;
+                }
+            }
+
+            float covariance[N][N] = {};
+            for (size_t i = 0; i < count; i++) {
+                for (size_t a = 0; a < N; a++) {
+                    for (size_t b = 0; b < N; b++) {
+                        covariance[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+                    }
+                }
+            }
+
+            std::array<float, N> axis;
+            axis.fill(1.0f);
+            for (size_t iteration = 0; iteration < 8; iteration++) {
+                std::array<float, N> next = {};
+                float length = 0.0f;
+                for (size_t a = 0; a < N; a++) {
+                    for (size_t b = 0; b < N; b++) {
+                        next[a] += covariance[a][b] * axis[b];
+                    }
+                    length = std::max(length, std::abs(next[a]));
+                }
+                if (length < 1e-6f) break;
+                for (size_t a = 0; a < N; a++) {
+                    axis[a] = next[a] / length;
+                }
+            }
+            float axisLengthSqr = 0.0f;
+            for (size_t c = 0; c < N; c++) {
+                axisLengthSqr += axis[c] * axis[c];
+            }
+
+            float minT = 0.0f, maxT = 0.0f;
+            for (size_t i = 0; i < count; i++) {
+                float t = 0.0f;
+                for (size_t c = 0; c < N; c++) {
+                    t += (points[i][c] - mean[c]) * axis[c];
+                }
+                t /= axisLengthSqr;
+                minT = std::min(minT, t);
+                maxT = std::max(maxT, t);
+            }
+            for (size_t c = 0; c < N; c++) {
+                min[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+                max[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+            }
+        }
+
+        /**
+         * Refits a line's ends to minimize the squared error of points assigned to weights along it, where a weight of
+         * 0 is the first end and 1 is the second. Returns false if the weights don't span the line.
+         */
+        template<size_t N>
+        bool refitLine(const std::array<float, N> *points,
+            const float *weights,
+            size_t count,
+            std::array<float, N> &first,
+            std::array<float, N> &second) {
+            float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+            std::array<float, N> ax = {}, bx = {};
+            for (size_t i = 0; i < count; i++) {
+                float b = weights[i], a = 1.0f - b;
+                aa += a * a;
+                ab += a * b;
+                bb += b * b;
+                for (size_t c = 0; c < N; c++) {
+                    ax[c] += a * points[i][c];
+                    bx[c] += b * points[i][c];
+                }
+            }
+            float det = aa * bb - ab * ab;
+            if (std::abs(det) < 1e-6f) return false;
+            for (size_t c = 0; c < N; c++) {
+                first[c] = std::clamp((ax[c] * bb - bx[c] * ab) / det, 0.0f, 255.0f);
+                second[c] = std::clamp((bx[c] * aa - ax[c] * ab) / det, 0.0f, 255.0f);
+            }
+            return true;
+        }
+
+        uint16_t packColor565(const std::array<float, 3> &color) {
+            uint16_t r = std::lround(color[0] * 31.0f / 255.0f);
+            uint16_t g = std::lround(color[1] * 63.0f / 255.0f);
+            uint16_t b = std::lround(color[2] * 31.0f / 255.0f);
+            return (r << 11) | (g << 5) | b;
+        }
+
+        std::array<int, 3> unpackColor565(uint16_t color) {
+            int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+            return {(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)};
+        }
+
+        // Returns the 4 color palette used when the first endpoint is greater than the second
+        std::array<std::array<int, 3>, 4> colorPalette(uint16_t color0, uint16_t color1) {
+            std::array<std::array<int, 3>, 4> palette;
+            palette[0] = unpackColor565(color0);
+            palette[1] = unpackColor565(color1);
+            for (size_t c = 0; c < 3; c++) {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+            return palette;
+        }
+
+        // Picks the closest palette entry for each pixel, returning the total squared error
+        template<size_t N, size_t P>
+        float assignIndices(const std::array<float, N> *points,
+            const std::array<std::array<int, N>, P> &palette,
+            uint8_t *indices) {
+            float totalError = 0.0f;
+            for (size_t i = 0; i < 16; i++) {
+                float bestError = std::numeric_limits<float>::max();
+                for (size_t p = 0; p < P; p++) {
+                    float error = 0.0f;
+                    for (size_t c = 0; c < N; c++) {
+                        float delta = points[i][c] - palette[p][c];
+                        error += delta * delta;
+                    }
+                    if (error < bestError) {
+                        bestError = error;
+                        indices[i] = p;
+                    }
+                }
+                totalError += bestError;
+            }
+            return totalError;
+        }
+
+        // Writes a BC1 color block in 4 color mode, which BC3 also requires
+        void encodeColorBlock(const pixelBlock &block, uint8_t *dst) {
+            std::array<float, 3> points[16];
+            for (size_t i = 0; i < 16; i++) {
+                points[i] = {(float)block[i][0], (float)block[i][1], (float)block[i][2]};
+            }
+            std::array<float, 3> endpoint0, endpoint1;
+            fitLine(points, 16, endpoint1, endpoint0);
+
+            // Palette weights of the second endpoint for indices 0 to 3
+            const float weights[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+
+            uint16_t bestColors[2] = {0, 0};
+            uint8_t bestIndices[16] = {};
+            float bestError = std::numeric_limits<float>::max();
+            for (size_t iteration = 0; iteration < 3; iteration++) {
+                uint16_t color0 = packColor565(endpoint0), color1 = packColor565(endpoint1);
+                if (color0 < color1) {
+                    std::swap(color0, color1);
+                    std::swap(endpoint0, endpoint1);
+                }
+
+                uint8_t indices[16] = {};
+                float error;
+                if (color0 == color1) {
+                    auto color = unpackColor565(color0);
+                    std::array<std::array<int, 3>, 1> palette = {color};
+                    error = assignIndices(points, palette, indices);
+                } else {
+                    error = assignIndices(points, colorPalette(color0, color1), indices);
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    bestColors[0] = color0;
+                    bestColors[1] = color1;
+                    std::copy_n(indices, 16, bestIndices);
+                }
+                if (error == 0.0f || color0 == color1) break;
+
+                float pointWeights[16];
+                for (size_t i = 0; i < 16; i++) {
+                    pointWeights[i] = weights[indices[i]];
+                }
+                if (!refitLine(points, pointWeights, 16, endpoint0, endpoint1)) break;
+            }
+
+            std::memcpy(dst, bestColors, 4);
+            uint32_t packedIndices = 0;
+            for (size_t i = 0; i < 16; i++) {
+                packedIndices |= (uint32_t)bestIndices[i] << (i * 2);
+            }
+            std::memcpy(dst + 4, &packedIndices, 4);
+        }
+
+        // Returns the 8 value palette used when the first endpoint is greater than the second
+        std::array<std::array<int, 1>, 8> channelPalette(uint8_t value0, uint8_t value1) {
+            std::array<std::array<int, 1>, 8> palette;
+            palette[0][0] = value0;
+            palette[1][0] = value1;
+            for (int i = 2; i < 8; i++) {
+                palette[i][0] = ((8 - i) * value0 + (i - 1) * value1) / 7;
+            }
+            return palette;
+        }
+
+        // Writes a BC4 block, used for BC3 alpha and both BC5 channels
+        void encodeChannelBlock(const pixelBlock &block, size_t channel, uint8_t *dst) {
+            std::array<float, 1> points[16];
+            uint8_t min = 255, max = 0;
+            for (size_t i = 0; i < 16; i++) {
+                points[i][0] = block[i][channel];
+                min = std::min(min, block[i][channel]);
+                max = std::max(max, block[i][channel]);
+            }
+
+            uint8_t indices[16] = {};
+            if (min != max) assignIndices(points, channelPalette(max, min), indices);
+
+            dst[0] = max;
+            dst[1] = min;
+            uint64_t packedIndices = 0;
+            for (size_t i = 0; i < 16; i++) {
+                packedIndices |= (uint64_t)indices[i] << (i * 3);
+            }
+            for (size_t i = 0; i < 6; i++) {
+                dst[2 + i] = (packedIndices >> (i * 8)) & 0xff;
+            }
+        }
+
+        const int bc7Weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+        std::array<std::array<int, 4>, 16> bc7Palette(const std::array<int, 4> &endpoint0,
+            const std::array<int, 4> &endpoint1) {
+            std::array<std::array<int, 4>, 16> palette;
+            for (size_t i = 0; i < 16; i++) {
+                for (size_t c = 0; c < 4; c++) {
+                    palette[i][c] = ((64 - bc7Weights[i]) * endpoint0[c] + bc7Weights[i] * endpoint1[c] + 32) >> 6;
+                }
+            }
+            return palette;
+        }
+
+        // Rounds an endpoint to 7 bits per channel, picking the shared lowest bit with the smallest error
+        void quantizeBC7Endpoint(const std::array<float, 4> &endpoint, std::array<int, 4> &quantized, int &pBit) {
+            float bestError = std::numeric_limits<float>::max();
+            for (int p = 0; p < 2; p++) {
+                std::array<int, 4> candidate;
+                float error = 0.0f;
+                for (size_t c = 0; c < 4; c++) {
+                    int value = std::clamp((int)std::lround((endpoint[c] - p) / 2.0f), 0, 127);
+                    candidate[c] = value;
+                    float delta = (value * 2 + p) - endpoint[c];
+                    error += delta * delta;
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    quantized = candidate;
+                    pBit = p;
+                }
+            }
+        }
+
+        /**
+         * Writes a BC7 block using mode 6: a single subset with 7 bit RGBA endpoints, a shared lowest bit per endpoint,
+         * and 4 bit indices. It handles alpha and smooth gradients well, at the cost of blocks with several colors.
+         */
+        void encodeBC7Block(const pixelBlock &block, uint8_t *dst) {
+            std::array<float, 4> points[16];
+            for (size_t i = 0; i < 16; i++) {
+                for (size_t c = 0; c < 4; c++) {
+                    points[i][c] = block[i][c];
+                }
+            }
+            std::array<float, 4> endpoints[2];
+            fitLine(points, 16, endpoints[0], endpoints[1]);
+
+            std::array<int, 4> bestQuantized[2];
+            int bestPBits[2] = {0, 0};
+            uint8_t bestIndices[16] = {};
+            float bestError = std::numeric_limits<float>::max();
+            for (size_t iteration = 0; iteration < 3; iteration++) {
+                std::array<int, 4> quantized[2], expanded[2];
+                int pBits[2];
+                for (size_t e = 0; e < 2; e++) {
+                    quantizeBC7Endpoint(endpoints[e], quantized[e], pBits[e]);
+                    for (size_t c = 0; c < 4; c++) {
+                        expanded[e][c] = quantized[e][c] * 2 + pBits[e];
+                    }
+                }
+
+                uint8_t indices[16];
+                float error = assignIndices(points, bc7Palette(expanded[0], expanded[1]), indices);
+                if (error < bestError) {
+                    bestError = error;
+                    bestQuantized[0] = quantized[0];
+                    bestQuantized[1] = quantized[1];
+                    bestPBits[0] = pBits[0];
+                    bestPBits[1] = pBits[1];
+                    std::copy_n(indices, 16, bestIndices);
+                }
+                if (error == 0.0f) break;
+
+                float pointWeights[16];
+                for (size_t i = 0; i < 16; i++) {
+                    pointWeights[i] = bc7Weights[indices[i]] / 64.0f;
+                }
+                if (!refitLine(points, pointWeights, 16, endpoints[0], endpoints[1])) break;
+            }
+
+            // The first pixel's index is stored without its top bit, so it must be in the lower half of the palette
+            if (bestIndices[0] >= 8) {
+                std::swap(bestQuantized[0], bestQuantized[1]);
+                std::swap(bestPBits[0], bestPBits[1]);
+                for (auto &index : bestIndices) {
+                    index = 15 - index;
+                }
+            }
+
+            std::memset(dst, 0, 16);
+            bitWriter writer = {dst};
+            writer.Write(1 << 6, 7);
+            for (size_t c = 0; c < 4; c++) {
+                writer.Write(bestQuantized[0][c], 7);
+                writer.Write(bestQuantized[1][c], 7);
+            }
+            writer.Write(bestPBits[0], 1);
+            writer.Write(bestPBits[1], 1);
+            for (size_t i = 0; i < 16; i++) {
+                writer.Write(bestIndices[i], i == 0 ? 3 : 4);
+            }
+        }
+
+        void encodeLevel(std::span<const uint8_t> rgba,
+            uint32_t width,
+            uint32_t height,
+            CookedTextureFormat format,
+            uint8_t *dst) {
+            if (format == CookedTextureFormat::RGBA8) {
+                std::memcpy(dst, rgba.data(), rgba.size());
+                return;
+            }
+
+            size_t blockSize = blockBytes(format);
+            pixelBlock block;
+            for (uint32_t blockY = 0; blockY < height; blockY += 4) {
+                for (uint32_t blockX = 0; blockX < width; blockX += 4) {
+                    // Blocks past the edge of the texture repeat the last row and column
+                    for (uint32_t y = 0; y < 4; y++) {
+                        for (uint32_t x = 0; x < 4; x++) {
+                            size_t srcX = std::min(blockX + x, width - 1), srcY = std::min(blockY + y, height - 1);
+                            std::memcpy(block[y * 4 + x].data(), &rgba[(srcY * width + srcX) * 4], 4);
+                        }
+                    }
+
+                    switch (format) {
+                    case CookedTextureFormat::BC1:
+                        encodeColorBlock(block, dst);
+                        break;
+                    case CookedTextureFormat::BC3:
+                        encodeChannelBlock(block, 3, dst);
+                        encodeColorBlock(block, dst + 8);
+                        break;
+                    case CookedTextureFormat::BC5:
+                        encodeChannelBlock(block, 0, dst);
+                        encodeChannelBlock(block, 1, dst + 8);
+                        break;
+                    case CookedTextureFormat::BC7:
+                        encodeBC7Block(block, dst);
+                        break;
+                    default:
+                        Abortf("Unexpected cooked texture format: %u", (uint32_t)format);
+                    }
+                    dst += blockSize;
+                }
+            }
+        }
+
+        CookedTexture Cook(std::span<const uint8_t> rgba,
+            uint32_t width,
+            uint32_t height,
+            CookedTextureFormat format,
+            bool srgb,
+            bool genMipmap) {
+            ZoneScoped;
+            ZonePrintf("%ux%u", width, height);
+            Assertf(width > 0 && height > 0, "Can't cook texture with zero size: %ux%u", width, height);
+            Assertf(rgba.size() == (size_t)width * height * 4,
+                "Cooked texture data size mismatch: %u != %ux%ux4",
+                rgba.size(),
+                width,
+                height);
+
+            CookedTexture texture;
+            texture.format = format;
+            texture.width = width;
+            texture.height = height;
+            // BC5 has no sRGB variant, and only stores linear data
+            texture.srgb = srgb && format != CookedTextureFormat::BC5;
+            texture.levelCount = 1;
+            if (genMipmap) {
+                while ((std::max(width, height) >> texture.levelCount) > 0) {
+                    texture.levelCount++;
+                }
+            }
+            texture.data.resize(texture.LevelOffset(texture.levelCount));
+
+            std::vector<uint8_t> levelPixels;
+            std::span<const uint8_t> levelData = rgba;
+            for (uint32_t level = 0; level < texture.levelCount; level++) {
+                auto extent = texture.LevelExtent(level);
+                if (level > 0) {
+                    auto prevExtent = texture.LevelExtent(level - 1);
+                    levelPixels = downsample(levelData, prevExtent.x, prevExtent.y, texture.srgb);
+                    levelData = levelPixels;
+                }
+                encodeLevel(levelData, extent.x, extent.y, format, texture.data.data() + texture.LevelOffset(level));
+            }
+            return texture;
+        }
+
+        void decodeColorBlock(const uint8_t *src, bool fourColorMode, pixelBlock &dst) {
+            uint16_t colors[2];
+            uint32_t packedIndices;
+            std::memcpy(colors, src, 4);
+            std::memcpy(&packedIndices, src + 4, 4);
+
+            auto palette = colorPalette(colors[0], colors[1]);
+            bool transparentBlack = !fourColorMode && colors[0] <= colors[1];
+            if (transparentBlack) {
+                for (size_t c = 0; c < 3; c++) {
+                    palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                    palette[3][c] = 0;
+                }
+            }
+            for (size_t i = 0; i < 16; i++) {
+                uint32_t index = (packedIndices >> (i * 2)) & 3;
+                for (size_t c = 0; c < 3; c++) {
+                    dst[i][c] = palette[index][c];
+                }
+                dst[i][3] = (transparentBlack && index == 3) ? 0 : 255;
+            }
+        }
+
+        void decodeChannelBlock(const uint8_t *src, size_t channel, pixelBlock &dst) {
+            auto palette = channelPalette(src[0], src[1]);
+            if (src[0] <= src[1]) {
+                for (int i = 2; i < 6; i++) {
+                    palette[i][0] = ((6 - i) * src[0] + (i - 1) * src[1]) / 5;
+                }
+                palette[6][0] = 0;
+                palette[7][0] = 255;
+            }
+            uint64_t packedIndices = 0;
+            for (size_t i = 0; i < 6; i++) {
+                packedIndices |= (uint64_t)src[2 + i] << (i * 8);
+            }
+            for (size_t i = 0; i < 16; i++) {
+                dst[i][channel] = palette[(packedIndices >> (i * 3)) & 7][0];
+            }
+        }
+
+        void decodeBC7Block(const uint8_t *src, pixelBlock &dst) {
+            bitReader reader = {src};
+            Assertf(reader.Read(7) == (1 << 6), "Only BC7 mode 6 blocks can be decoded");
+
+            std::array<int, 4> endpoints[2];
+            for (size_t c = 0; c < 4; c++) {
+                endpoints[0][c] = reader.Read(7) << 1;
+                endpoints[1][c] = reader.Read(7) << 1;
+            }
+            for (auto &endpoint : endpoints) {
+                int pBit = reader.Read(1);
+                for (auto &value : endpoint) {
+                    value |= pBit;
+                }
+            }
+            auto palette = bc7Palette(endpoints[0], endpoints[1]);
+            for (size_t i = 0; i < 16; i++) {
+                auto &color = palette[reader.Read(i == 0 ? 3 : 4)];
+                for (size_t c = 0; c < 4; c++) {
+                    dst[i][c] = color[c];
+                }
+            }
+        }
+
+        std::vector<uint8_t> DecodeLevel(const CookedTextureView &texture, uint32_t level) {
+            ZoneScoped;
+            Assertf(level < texture.levelCount, "Cooked texture level out of range: %u", level);
+            Assertf(texture.data.size() >= texture.LevelOffset(texture.levelCount), "Cooked texture data is truncated");
+
+            auto extent = texture.LevelExtent(level);
+            auto src = texture.data.subspan(texture.LevelOffset(level), texture.LevelSize(level));
+            if (texture.format == CookedTextureFormat::RGBA8) return std::vector<uint8_t>(src.begin(), src.end());
+
+            std::vector<uint8_t> rgba((size_t)extent.x * extent.y * 4);
+            size_t blockSize = blockBytes(texture.format);
+            const uint8_t *block = src.data();
+            pixelBlock pixels;
+            for (uint32_t blockY = 0; blockY < extent.y; blockY += 4) {
+                for (uint32_t blockX = 0; blockX < extent.x; blockX += 4) {
+                    switch (texture.format) {
+                    case CookedTextureFormat::BC1:
+                        decodeColorBlock(block, false, pixels);
+                        break;
+                    case CookedTextureFormat::BC3:
+                        decodeColorBlock(block + 8, true, pixels);
+                        decodeChannelBlock(block, 3, pixels);
+                        break;
+                    case CookedTextureFormat::BC5:
+                        for (auto &pixel : pixels) {
+                            pixel = {0, 0, 0, 255};
+                        }
+                        decodeChannelBlock(block, 0, pixels);
+                        decodeChannelBlock(block + 8, 1, pixels);
+                        break;
+                    case CookedTextureFormat::BC7:
+                        decodeBC7Block(block, pixels);
+                        break;
+                    default:
+                        Abortf("Unexpected cooked texture format: %u", (uint32_t)texture.format);
+                    }
+                    block += blockSize;
+
+                    for (uint32_t y = 0; y < 4 && blockY + y < extent.y; y++) {
+                        for (uint32_t x = 0; x < 4 && blockX + x < extent.x; x++) {
+                            size_t offset = ((size_t)(blockY + y) * extent.x + blockX + x) * 4;
+                            std::memcpy(&rgba[offset], pixels[y * 4 + x].data(), 4);
+                        }
+                    }
+                }
+            }
+            return rgba;
+        }
+
+        double PSNR(std::span<const uint8_t> a, std::span<const uint8_t> b, size_t channelCount) {
+            Assertf(a.size() == b.size(), "Can't compare images of different sizes: %u != %u", a.size(), b.size());
+            double squaredError = 0.0;
+            size_t count = 0;
+            for (size_t i = 0; i + 3 < a.size(); i += 4) {
+                for (size_t c = 0; c < channelCount; c++) {
+                    double delta = (double)a[i + c] - b[i + c];
+                    squaredError += delta * delta;
+                    count++;
+                }
+            }
+            if (squaredError == 0.0) return std::numeric_limits<double>::infinity();
+            return 10.0 * std::log10(255.0 * 255.0 * count / squaredError);
+        }
+
+        void Serialize(const CookedTexture &texture, const Hash128 &sourceHash, std::vector<uint8_t> &dst) {
+            ZoneScoped;
+            Assertf(texture.data.size() == texture.LevelOffset(texture.levelCount),
+                "Cooked texture data size mismatch: %u",
+                texture.data.size());
+
+            cookedTextureHeader header = {};
+            header.sourceHash = sourceHash;
+            header.format = (uint32_t)texture.format;
+            header.width = texture.width;
+            header.height = texture.height;
+            header.levelCount = texture.levelCount;
+            header.srgb = texture.srgb;
+            std::copy(texture.swizzle.begin(), texture.swizzle.end(), header.swizzle);
+
+            dst.resize(sizeof(header) + texture.data.size());
+            std::memcpy(dst.data(), &header, sizeof(header));
+            std::copy(texture.data.begin(), texture.data.end(), dst.begin() + sizeof(header));
+        }
+
+        bool Deserialize(std::span<const uint8_t> src, const Hash128 &sourceHash, CookedTextureView &dst) {
+            ZoneScoped;
+            cookedTextureHeader header;
+            if (src.size() < sizeof(header)) return false;
+            std::memcpy(&header, src.data(), sizeof(header));
+            if (header.magicNumber != cookedTextureMagic || header.version != COOKED_TEXTURE_VERSION) return false;
+            if (header.sourceHash != sourceHash) return false;
+            if (header.format > (uint32_t)CookedTextureFormat::BC7) return false;
+            if (header.width == 0 || header.height == 0 || header.levelCount == 0) return false;
+            if ((std::max(header.width, header.height) >> (header.levelCount - 1)) == 0) return false;
+            for (auto channel : header.swizzle) {
+                if (channel > CHANNEL_ONE) return false;
+            }
+
+            dst.format = (CookedTextureFormat)header.format;
+            dst.width = header.width;
+            dst.height = header.height;
+            dst.levelCount = header.levelCount;
+            dst.srgb = header.srgb != 0;
+            std::copy_n(header.swizzle, 4, dst.swizzle.begin());
+            dst.data = src.subspan(sizeof(header));
+            return dst.data.size() == dst.LevelOffset(dst.levelCount);
+        }
+    } // namespace cookedtexture
+} // namespace sp
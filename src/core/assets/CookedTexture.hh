@@ -0,0 +1,118 @@
+#pragma once
+
+#include "assets/Gltf.hh"
+#include "core/Common.hh"
+
+#include <array>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+namespace sp {
+    enum class CookedTextureFormat : uint32_t {
+        RGBA8 = 0,
+        BC1, // RGB, 4 bits per pixel
+        BC3, // RGBA, BC1 color with a BC4 alpha channel, 8 bits per pixel
+        BC5, // RG, two BC4 channels, 8 bits per pixel
+        BC7, // RGBA, 8 bits per pixel
+    };
+
+    struct CookedTextureInfo {
+        CookedTextureFormat format = CookedTextureFormat::RGBA8;
+        uint32_t width = 0, height = 0;
+        uint32_t levelCount = 0;
+        bool srgb = false;
+
+        // The stored channel read by each of the r, g, b, a channels, or a cookedtexture::CHANNEL_ constant
+        std::array<uint8_t, 4> swizzle = {0, 1, 2, 3};
+
+        glm::uvec2 LevelExtent(uint32_t level) const;
+        size_t LevelSize(uint32_t level) const;
+        // Levels are stored largest first with no padding in between
+        size_t LevelOffset(uint32_t level) const;
+    };
+
+    struct CookedTextureView : public CookedTextureInfo {
+        std::span<const uint8_t> data;
+    };
+
+    /**
+     * A texture with its full mip chain precomputed and block compressed, in the layout uploaded to the GPU.
+     *
+     * Gltf material textures are cooked offline by texture_cooker into cache/textures/, tagged with the hash of their
+     * source gltf. Textures without a matching cache are uploaded from the decoded gltf image and have their factor
+     * and mipmaps generated on the GPU instead.
+     */
+    struct CookedTexture : public CookedTextureInfo {
+        std::vector<uint8_t> data;
+
+        CookedTextureView View() const;
+    };
+
+    // Identifies the texture a gltf material uses for a TextureType, shared by the runtime and texture_cooker
+    struct GltfTextureSource {
+        std::string name; // Unique per model, texture, texture type, and factor
+        int textureIndex = -1; // -1 if the material has no texture of this type
+        std::vector<double> factor; // Multiplied into each channel, channels past the end are zeroed
+        bool srgb = false;
+        bool genMipmap = false;
+    };
+
+    namespace cookedtexture {
+        static const uint32_t COOKED_TEXTURE_VERSION = 1;
+
+        static const uint8_t CHANNEL_ZERO = 4;
+        static const uint8_t CHANNEL_ONE = 5;
+
+        std::string CachePath(const std::string &textureName);
+
+        size_t LevelSize(CookedTextureFormat format, uint32_t width, uint32_t height);
+
+        // Returns false if the material doesn't exist or the texture type isn't supported
+        bool FindGltfTexture(const Gltf &source, int materialIndex, TextureType type, GltfTextureSource &dst);
+
+        struct CookOptions {
+            bool compress = true;
+            bool highQuality = false; // Use BC7 instead of BC1 and BC3 for color textures
+        };
+
+        /**
+         * Converts a gltf image to RGBA8, bakes in its factor, and cooks it in the format picked for its texture type.
+         * Returns false if the texture has no image, or the image isn't 8 bits per channel.
+         */
+        bool CookGltfTexture(const Gltf &source,
+            const GltfTextureSource &texture,
+            TextureType type,
+            const CookOptions &options,
+            CookedTexture &dst);
+
+        // Multiplies each RGBA8 pixel by the factor, matching the texture_factor compute shader
+        void ApplyFactor(std::span<uint8_t> rgba, std::span<const double> factor, bool srgb);
+
+        /**
+         * Cooks RGBA8 pixels into the given format. If genMipmap is set, each level down to 1x1 is box filtered from
+         * the one above it, in linear space for sRGB textures, before being compressed.
+         */
+        CookedTexture Cook(std::span<const uint8_t> rgba,
+            uint32_t width,
+            uint32_t height,
+            CookedTextureFormat format,
+            bool srgb,
+            bool genMipmap);
+
+        // Decodes a level back to RGBA8 without applying the swizzle. BC7 is limited to the mode written by Cook().
+        std::vector<uint8_t> DecodeLevel(const CookedTextureView &texture, uint32_t level);
+
+        // Peak signal to noise ratio in dB over the given channels of two RGBA8 images, infinite if they are equal
+        double PSNR(std::span<const uint8_t> a, std::span<const uint8_t> b, size_t channelCount = 4);
+
+        // Serializes a cooked texture, the output is byte for byte identical for identical inputs
+        void Serialize(const CookedTexture &texture, const Hash128 &sourceHash, std::vector<uint8_t> &dst);
+
+        /**
+         * Reads a cooked texture without copying, the returned view points into src.
+         * Returns false if the data is corrupt or was cooked from a different source.
+         */
+        bool Deserialize(std::span<const uint8_t> src, const Hash128 &sourceHash, CookedTextureView &dst);
+    } // namespace cookedtexture
+} // namespace sp
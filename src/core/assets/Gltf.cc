@@ -40,7 +40,7 @@ namespace sp {
             if (it != primitive.attributes.end()) normalBuffer = Accessor<glm::vec3>(model, it->second);
             it = primitive.attributes.find("TEXCOORD_0");
             if (it != primitive.attributes.end()) {
-                texcoordBuffer = Accessor<glm::vec2 /*, glm::u16vec2, glm::u8vec2, glm::i16vec2, glm::i8vec2*/>(model,
+                texcoordBuffer = Accessor<glm::vec2, glm::u16vec2, glm::u8vec2, glm::i16vec2, glm::i8vec2>(model,
                     it->second);
             }
             it = primitive.attributes.find("JOINTS_0");
@@ -49,7 +49,7 @@ namespace sp {
             }
             it = primitive.attributes.find("WEIGHTS_0");
             if (it != primitive.attributes.end()) {
-                weightsBuffer = Accessor<glm::vec4 /*, glm::u16vec4, glm::u8vec4*/>(model, it->second);
+                weightsBuffer = Accessor<glm::vec4, glm::u16vec4, glm::u8vec4>(model, it->second);
             }
         }
 
@@ -65,12 +65,10 @@ namespace sp {
             joints.resize(skin.joints.size());
             for (size_t i = 0; i < skin.joints.size(); i++) {
                 joints[i].jointNodeIndex = skin.joints[i];
-                if (i < inverseBindMatrices.Count()) {
-                    joints[i].inverseBindPose = inverseBindMatrices.Read(i);
-                } else {
-                    joints[i].inverseBindPose = glm::identity<glm::mat4>();
-                }
+                joints[i].inverseBindPose = glm::identity<glm::mat4>();
             }
+            size_t poseCount = std::min(joints.size(), inverseBindMatrices.Count());
+            if (poseCount > 0) inverseBindMatrices.ReadInto(&joints[0].inverseBindPose, sizeof(Joint), 0, poseCount);
             rootJoint = skin.skeleton;
         }
 
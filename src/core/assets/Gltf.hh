@@ -5,6 +5,7 @@
 
 #include <glm/glm.hpp>
 #include <optional>
+#include <span>
 #include <vector>
 
 namespace tinygltf {
@@ -45,9 +46,21 @@ namespace sp {
 
             ReadT Read(size_t i) const;
 
+            // Converts dst.size() elements starting at index first into dst
+            void ReadInto(std::span<ReadT> dst, size_t first = 0) const {
+                ReadInto(dst.data(), sizeof(ReadT), first, dst.size());
+            }
+
+            // Converts n elements starting at index first, writing them dstStride bytes apart.
+            // A stride larger than ReadT allows writing directly into a field of an interleaved vertex array.
+            void ReadInto(ReadT *dst, size_t dstStride, size_t first, size_t n) const;
+
+            std::vector<ReadT> ReadAll() const;
+
         private:
             const tinygltf::Buffer *buffer = nullptr;
             int typeIndex = -1;
+            bool normalized = false;
             size_t count = 0;
             size_t componentCount = 0;
             size_t byteOffset = 0;
@@ -73,9 +86,9 @@ namespace sp {
                 int materialIndex;
                 Accessor<glm::vec3> positionBuffer;
                 Accessor<glm::vec3> normalBuffer;
-                Accessor<glm::vec2 /*, glm::u16vec2, glm::u8vec2, glm::i16vec2, glm::i8vec2*/> texcoordBuffer;
+                Accessor<glm::vec2, glm::u16vec2, glm::u8vec2, glm::i16vec2, glm::i8vec2> texcoordBuffer;
                 Accessor<glm::u16vec4, glm::u8vec4> jointsBuffer;
-                Accessor<glm::vec4 /*, glm::u16vec4, glm::u8vec4*/> weightsBuffer;
+                Accessor<glm::vec4, glm::u16vec4, glm::u8vec4> weightsBuffer;
             };
 
             Mesh(const tinygltf::Model &model, const tinygltf::Mesh &mesh);
@@ -2,7 +2,9 @@
 
 #include "assets/Gltf.hh"
 
+#include <cstring>
 #include <glm/glm.hpp>
+#include <limits>
 #include <memory>
 #include <type_traits>
 
@@ -72,6 +74,60 @@ namespace sp::gltf {
                 return GltfTypeInfo<I + 1, Tn...>(type, componentType);
             }
         }
+
+        template<typename T>
+        struct scalarType {
+            using type = T;
+        };
+        template<glm::length_t L, typename T, glm::precision P>
+        struct scalarType<glm::vec<L, T, P>> {
+            using type = T;
+        };
+
+        // Calls fn with a std::type_identity of the I'th type, so conversion loops can be specialized per type
+        template<int I, typename T, typename... Tn>
+        static inline void VisitType(int typeIndex, auto &&fn) {
+            if (typeIndex == I) {
+                fn(std::type_identity<T>());
+            } else if constexpr (sizeof...(Tn) > 0) {
+                VisitType<I + 1, Tn...>(typeIndex, fn);
+            }
+        }
+
+        // Converts a stored value to ReadT, mapping normalized integers to [0, 1] or [-1, 1] as per the gltf spec
+        template<typename ReadT, typename SrcT, bool Normalized>
+        static inline ReadT ConvertElement(const uint8_t *data) {
+            SrcT src;
+            std::memcpy(&src, data, sizeof(SrcT));
+            if constexpr (std::is_same_v<ReadT, SrcT>) {
+                return src;
+            } else {
+                using SrcScalar = typename scalarType<SrcT>::type;
+                using ReadScalar = typename scalarType<ReadT>::type;
+                if constexpr (Normalized && std::is_integral_v<SrcScalar> && std::is_floating_point_v<ReadScalar>) {
+                    constexpr ReadScalar scale = ReadScalar(1) / ReadScalar(std::numeric_limits<SrcScalar>::max());
+                    if constexpr (std::is_signed_v<SrcScalar>) {
+                        return glm::max(ReadT(src) * scale, ReadT(-1));
+                    } else {
+                        return ReadT(src) * scale;
+                    }
+                } else {
+                    return static_cast<ReadT>(src);
+                }
+            }
+        }
+
+        template<typename ReadT, typename SrcT, bool Normalized>
+        static inline void ConvertRange(uint8_t *dst,
+            size_t dstStride,
+            const uint8_t *src,
+            size_t srcStride,
+            size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                *reinterpret_cast<ReadT *>(dst + i * dstStride) =
+                    ConvertElement<ReadT, SrcT, Normalized>(src + i * srcStride);
+            }
+        }
     }; // namespace detail
 
     template<typename ReadT, typename... Tn>
@@ -101,6 +157,7 @@ namespace sp::gltf {
             return;
         }
         typeIndex = index;
+        normalized = accessor.normalized;
 
         int stride = accessor.ByteStride(bufferView);
         if (stride <= 0) {
@@ -132,19 +189,45 @@ namespace sp::gltf {
 
     template<typename ReadT, typename... Tn>
     ReadT Accessor<ReadT, Tn...>::Read(size_t i) const {
+        ReadT result;
+        ReadInto(&result, sizeof(ReadT), i, 1);
+        return result;
+    }
+
+    template<typename ReadT, typename... Tn>
+    void Accessor<ReadT, Tn...>::ReadInto(ReadT *dst, size_t dstStride, size_t first, size_t n) const {
         Assertf(buffer && typeIndex >= 0 && (size_t)typeIndex <= sizeof...(Tn),
             "Trying to read invalid gltf::Accessor");
-        Assertf(i < count, "Trying to read invalid gltf::Accessor index: %u >= %u", i, count);
-
-        static const std::array<std::function<ReadT(const uint8_t &)>, 1 + sizeof...(Tn)> convertFuncs = {
-            [](const uint8_t &data) {
-                return reinterpret_cast<const ReadT &>(data);
-            },
-            [](const uint8_t &data) {
-                // TODO: Handle normalized int/uint -> float conversion
-                return static_cast<ReadT>(reinterpret_cast<const Tn &>(data));
-            }...};
-        const auto &data = buffer->data[byteOffset + (i * byteStride)];
-        return convertFuncs[typeIndex](data);
+        Assertf(first <= count && n <= count - first,
+            "Trying to read invalid gltf::Accessor range: %u + %u > %u",
+            first,
+            n,
+            count);
+        if (n == 0) return;
+
+        const uint8_t *src = buffer->data.data() + byteOffset + first * byteStride;
+        auto *out = reinterpret_cast<uint8_t *>(dst);
+        // Dispatch on the stored type once per range, rather than once per element
+        detail::VisitType<0, ReadT, Tn...>(typeIndex, [&](auto type) {
+            using SrcT = typename decltype(type)::type;
+            if constexpr (std::is_same_v<SrcT, ReadT>) {
+                if (byteStride == sizeof(ReadT) && dstStride == sizeof(ReadT)) {
+                    std::memcpy(out, src, n * sizeof(ReadT));
+                } else {
+                    detail::ConvertRange<ReadT, SrcT, false>(out, dstStride, src, byteStride, n);
+                }
+            } else if (normalized) {
+                detail::ConvertRange<ReadT, SrcT, true>(out, dstStride, src, byteStride, n);
+            } else {
+                detail::ConvertRange<ReadT, SrcT, false>(out, dstStride, src, byteStride, n);
+            }
+        });
+    }
+
+    template<typename ReadT, typename... Tn>
+    std::vector<ReadT> Accessor<ReadT, Tn...>::ReadAll() const {
+        std::vector<ReadT> result(Count());
+        if (!result.empty()) ReadInto(result);
+        return result;
     }
 } // namespace sp::gltf
@@ -179,8 +179,8 @@ namespace sp::json {
             return true;
         }
     }
-    template<typename T>
-    inline bool Load(robin_hood::unordered_flat_map<std::string, T> &dst, const picojson::value &src) {
+    template<typename K, typename T>
+    inline bool Load(robin_hood::unordered_flat_map<K, T> &dst, const picojson::value &src) {
         if (!src.is<picojson::object>()) return false;
         dst.clear();
         for (auto &p : src.get<picojson::object>()) {
@@ -190,8 +190,8 @@ namespace sp::json {
         }
         return true;
     }
-    template<typename T>
-    inline bool Load(robin_hood::unordered_node_map<std::string, T> &dst, const picojson::value &src) {
+    template<typename K, typename T>
+    inline bool Load(robin_hood::unordered_node_map<K, T> &dst, const picojson::value &src) {
         if (!src.is<picojson::object>()) return false;
         dst.clear();
         for (auto &p : src.get<picojson::object>()) {
@@ -310,23 +310,25 @@ namespace sp::json {
             dst = picojson::value(vec);
         }
     }
-    template<typename T>
+    template<typename K, typename T>
     inline void Save(const ecs::EntityScope &s,
         picojson::value &dst,
-        const robin_hood::unordered_flat_map<std::string, T> &src) {
+        const robin_hood::unordered_flat_map<K, T> &src) {
         picojson::object obj = {};
         for (auto &[key, value] : src) {
-            Save(s, obj[key], value);
+            const std::string &keyStr = key;
+            Save(s, obj[keyStr], value);
         }
         dst = picojson::value(obj);
     }
-    template<typename T>
+    template<typename K, typename T>
     inline void Save(const ecs::EntityScope &s,
         picojson::value &dst,
-        const robin_hood::unordered_node_map<std::string, T> &src) {
+        const robin_hood::unordered_node_map<K, T> &src) {
         picojson::object obj = {};
         for (auto &[key, value] : src) {
-            Save(s, obj[key], value);
+            const std::string &keyStr = key;
+            Save(s, obj[keyStr], value);
         }
         dst = picojson::value(obj);
     }
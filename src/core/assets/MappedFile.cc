@@ -0,0 +1,89 @@
+#include "MappedFile.hh"
+
+#include "core/Logging.hh"
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace sp {
+#ifdef _WIN32
+    std::shared_ptr<MappedFile> MappedFile::Open(const std::string &path) {
+        HANDLE file = CreateFileA(path.c_str(),
+            GENERIC_READ,
+            FILE_SHARE_READ | FILE_SHARE_DELETE,
+            nullptr,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL,
+            nullptr);
+        if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            return nullptr;
+        }
+
+        std::shared_ptr<MappedFile> mapped(new MappedFile());
+        mapped->fileHandle = file;
+        mapped->size = (size_t)fileSize.QuadPart;
+        // Empty files can't be mapped, but are still valid
+        if (mapped->size == 0) return mapped;
+
+        mapped->mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapped->mappingHandle) {
+            Warnf("Failed to create file mapping: %s", path);
+            return nullptr;
+        }
+        mapped->data = (const uint8_t *)MapViewOfFile(mapped->mappingHandle, FILE_MAP_READ, 0, 0, 0);
+        if (!mapped->data) {
+            Warnf("Failed to map file: %s", path);
+            return nullptr;
+        }
+        return mapped;
+    }
+
+    MappedFile::~MappedFile() {
+        if (data) UnmapViewOfFile(data);
+        if (mappingHandle) CloseHandle(mappingHandle);
+        if (fileHandle) CloseHandle(fileHandle);
+    }
+#else
+    std::shared_ptr<MappedFile> MappedFile::Open(const std::string &path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return nullptr;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            close(fd);
+            return nullptr;
+        }
+
+        std::shared_ptr<MappedFile> mapped(new MappedFile());
+        mapped->size = (size_t)st.st_size;
+        if (mapped->size > 0) {
+            void *ptr = mmap(nullptr, mapped->size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (ptr == MAP_FAILED) {
+                Warnf("Failed to map file: %s", path);
+                close(fd);
+                return nullptr;
+            }
+            mapped->data = (const uint8_t *)ptr;
+        }
+        // The mapping holds its own reference to the file
+        close(fd);
+        return mapped;
+    }
+
+    MappedFile::~MappedFile() {
+        if (data) munmap((void *)data, size);
+    }
+#endif
+} // namespace sp
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "core/Common.hh"
+
+#include <memory>
+#include <span>
+#include <string>
+
+namespace sp {
+    /**
+     * A read-only memory mapping of an entire file.
+     * The mapping stays valid until the MappedFile is destroyed, even if the file is unlinked or replaced.
+     * Truncating the file in place is not safe: reading past its new end raises SIGBUS on POSIX systems,
+     * so only files that are never modified while running (i.e. the packaged asset bundle) should be mapped.
+     */
+    class MappedFile : public NonCopyable {
+    public:
+        // Returns nullptr if the file could not be opened or mapped
+        static std::shared_ptr<MappedFile> Open(const std::string &path);
+
+        ~MappedFile();
+
+        std::span<const uint8_t> Data() const {
+            return {data, size};
+        }
+
+    private:
+        MappedFile() {}
+
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+
+#ifdef _WIN32
+        void *fileHandle = nullptr;
+        void *mappingHandle = nullptr;
+#endif
+    };
+} // namespace sp
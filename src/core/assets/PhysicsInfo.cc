@@ -20,7 +20,9 @@ namespace sp {
         ZonePrintf("%s from %s", modelName, asset->path.string());
 
         picojson::value root;
-        std::string err = picojson::parse(root, asset->String());
+        std::string err;
+        auto json = asset->StringView();
+        picojson::parse(root, json.begin(), json.end(), &err);
         if (!err.empty()) {
             Errorf("Failed to parse physics info (%s): %s", modelName, err);
             return;
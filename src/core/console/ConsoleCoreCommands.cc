@@ -1,3 +1,4 @@
+#include "assets/AssetManager.hh"
 #include "console/Console.hh"
 #include "core/Logging.hh"
 #include "core/RegisteredThread.hh"
@@ -69,6 +70,17 @@ void sp::ConsoleManager::RegisterCoreCommands() {
             }
         });
 
+    funcs.Register("assetstats", "Print asset queue wait and work times", []() {
+        auto stats = Assets().GetQueueStats();
+        auto toMs = [](chrono_clock::duration duration) {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        };
+        double count = std::max<size_t>(1, stats.processedCount);
+        Logf("Asset loads: %u processed, %u canceled", stats.processedCount, stats.skippedCount);
+        Logf("Queue wait: %.2fms avg, %.2fms max", toMs(stats.totalWait) / count, toMs(stats.maxWait));
+        Logf("Work time: %.2fms avg, %.2fms total", toMs(stats.totalWork) / count, toMs(stats.totalWork));
+    });
+
     funcs.Register("printfocus", "Print the current focus lock state", []() {
         auto lock = ecs::StartTransaction<ecs::Read<ecs::FocusLock>>();
 
@@ -0,0 +1,181 @@
+#include "Culling.hh"
+
+#include "core/Logging.hh"
+
+#include <limits>
+
+namespace sp {
+    glm::uvec2 DepthPyramid::LevelExtent(uint32 level) const {
+        return culling::DepthPyramidExtent(depthExtent, level);
+    }
+
+    float DepthPyramid::Texel(uint32 level, glm::uvec2 texel) const {
+        auto extent = LevelExtent(level);
+        Assertf(level < levels.size() && texel.x < extent.x && texel.y < extent.y,
+            "Depth pyramid texel out of range: %u (%u, %u)",
+            level,
+            texel.x,
+            texel.y);
+        return levels[level][texel.y * extent.x + texel.x];
+    }
+
+    namespace culling {
+        Frustum ExtractFrustum(const glm::mat4 &viewProj) {
+            // Rows of the matrix, glm matrices are column major
+            auto row = [&](int i) {
+                return glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+            };
+
+            Frustum frustum;
+            frustum.planes[0] = row(3) + row(0); // Left
+            frustum.planes[1] = row(3) - row(0); // Right
+            frustum.planes[2] = row(3) + row(1); // Bottom
+            frustum.planes[3] = row(3) - row(1); // Top
+            frustum.planes[4] = row(2); // Near, clip space depth starts at 0
+            frustum.planes[5] = row(3) - row(2); // Far
+            return frustum;
+        }
+
+        void TransformBounds(const glm::mat4 &transform, glm::vec3 &boundsMin, glm::vec3 &boundsMax) {
+            glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+            glm::vec3 extent = (boundsMax - boundsMin) * 0.5f;
+
+            glm::mat3 absRotation = glm::mat3(transform);
+            for (int i = 0; i < 3; i++) {
+                absRotation[i] = glm::abs(absRotation[i]);
+            }
+            center = glm::vec3(transform * glm::vec4(center, 1));
+            extent = absRotation * extent;
+
+            boundsMin = center - extent;
+            boundsMax = center + extent;
+        }
+
+        bool IntersectsFrustum(const Frustum &frustum, glm::vec3 boundsMin, glm::vec3 boundsMax) {
+            for (auto &plane : frustum.planes) {
+                // Test the corner farthest along the plane's normal
+                glm::vec3 normal(plane);
+                glm::vec3 corner = glm::mix(boundsMin, boundsMax, glm::greaterThanEqual(normal, glm::vec3(0)));
+                if (glm::dot(normal, corner) + plane.w < 0) return false;
+            }
+            return true;
+        }
+
+        uint32 DepthPyramidLevelCount(glm::uvec2 depthExtent) {
+            uint32 levelCount = 1;
+            while (glm::any(glm::greaterThan(DepthPyramidExtent(depthExtent, levelCount - 1), glm::uvec2(1)))) {
+                levelCount++;
+            }
+            return levelCount;
+        }
+
+        glm::uvec2 DepthPyramidExtent(glm::uvec2 depthExtent, uint32 level) {
+            // Rounding up at every level is the same as rounding up once
+            glm::uvec2 scale(2u << level);
+            return glm::max((depthExtent + scale - 1u) / scale, glm::uvec2(1));
+        }
+
+        DepthPyramid BuildDepthPyramid(std::span<const float> depth, glm::uvec2 depthExtent) {
+            Assertf(depth.size() == (size_t)depthExtent.x * depthExtent.y,
+                "Depth buffer size mismatch: %u != %ux%u",
+                depth.size(),
+                depthExtent.x,
+                depthExtent.y);
+
+            DepthPyramid pyramid;
+            pyramid.depthExtent = depthExtent;
+            pyramid.levels.resize(DepthPyramidLevelCount(depthExtent));
+
+            const glm::uvec2 offsets[] = {{0, 0}, {1, 0}, {0, 1}, {1, 1}};
+            std::span<const float> input = depth;
+            glm::uvec2 inputExtent = depthExtent;
+            for (uint32 level = 0; level < pyramid.levels.size(); level++) {
+                auto extent = pyramid.LevelExtent(level);
+                auto &output = pyramid.levels[level];
+                output.resize((size_t)extent.x * extent.y);
+
+                // Matches depth_pyramid.comp, the last row and column are clamped for odd sized inputs
+                for (uint32 y = 0; y < extent.y; y++) {
+                    for (uint32 x = 0; x < extent.x; x++) {
+                        float farthest = 0.0f;
+                        for (auto &offset : offsets) {
+                            glm::uvec2 in = glm::min(glm::uvec2(x, y) * 2u + offset, inputExtent - 1u);
+                            farthest = std::max(farthest, input[in.y * inputExtent.x + in.x]);
+                        }
+                        output[y * extent.x + x] = farthest;
+                    }
+                }
+                input = output;
+                inputExtent = extent;
+            }
+            return pyramid;
+        }
+
+        bool ProjectBounds(const glm::mat4 &viewProj,
+            glm::vec3 boundsMin,
+            glm::vec3 boundsMax,
+            glm::uvec2 depthExtent,
+            ScreenBounds &dst) {
+            glm::vec2 ndcMin(std::numeric_limits<float>::max());
+            glm::vec2 ndcMax(-std::numeric_limits<float>::max());
+            float nearestDepth = std::numeric_limits<float>::max();
+            for (int i = 0; i < 8; i++) {
+                glm::vec3 corner(i & 1 ? boundsMax.x : boundsMin.x,
+                    i & 2 ? boundsMax.y : boundsMin.y,
+                    i & 4 ? boundsMax.z : boundsMin.z);
+                glm::vec4 clip = viewProj * glm::vec4(corner, 1);
+                if (clip.w <= 0.0f) return false;
+
+                glm::vec3 ndc = glm::vec3(clip) / clip.w;
+                ndcMin = glm::min(ndcMin, glm::vec2(ndc));
+                ndcMax = glm::max(ndcMax, glm::vec2(ndc));
+                nearestDepth = std::min(nearestDepth, ndc.z);
+            }
+            if (nearestDepth < 0.0f) return false;
+            if (glm::any(glm::lessThan(ndcMin, glm::vec2(-1))) || glm::any(glm::greaterThan(ndcMax, glm::vec2(1)))) {
+                return false;
+            }
+
+            // The renderer draws with YDirection::Up, so NDC y = 1 is the first row of the depth buffer
+            glm::vec2 uvMin(ndcMin.x * 0.5f + 0.5f, 0.5f - ndcMax.y * 0.5f);
+            glm::vec2 uvMax(ndcMax.x * 0.5f + 0.5f, 0.5f - ndcMin.y * 0.5f);
+
+            glm::vec2 extent(depthExtent);
+            glm::uvec2 maxPixel = depthExtent - 1u;
+            dst.minPixel = glm::min(glm::uvec2(uvMin * extent), maxPixel);
+            dst.maxPixel = glm::min(glm::uvec2(uvMax * extent), maxPixel);
+            dst.nearestDepth = nearestDepth;
+            return true;
+        }
+
+        uint32 DepthPyramidTestLevel(const ScreenBounds &bounds) {
+            uint32 level = 0;
+            while (glm::any(glm::greaterThan((bounds.maxPixel >> (level + 1)) - (bounds.minPixel >> (level + 1)),
+                glm::uvec2(1)))) {
+                level++;
+            }
+            return level;
+        }
+
+        bool IsOccluded(const DepthPyramid &pyramid,
+            const glm::mat4 &viewProj,
+            glm::vec3 boundsMin,
+            glm::vec3 boundsMax) {
+            ScreenBounds bounds;
+            if (!ProjectBounds(viewProj, boundsMin, boundsMax, pyramid.depthExtent, bounds)) return false;
+
+            uint32 level = DepthPyramidTestLevel(bounds);
+            if (level >= pyramid.levels.size()) return false;
+
+            glm::uvec2 minTexel = bounds.minPixel >> (level + 1);
+            glm::uvec2 maxTexel = bounds.maxPixel >> (level + 1);
+            float farthest = 0.0f;
+            for (uint32 y = minTexel.y; y <= maxTexel.y; y++) {
+                for (uint32 x = minTexel.x; x <= maxTexel.x; x++) {
+                    farthest = std::max(farthest, pyramid.Texel(level, {x, y}));
+                }
+            }
+            return bounds.nearestDepth > farthest;
+        }
+    } // namespace culling
+} // namespace sp
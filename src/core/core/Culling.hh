@@ -0,0 +1,73 @@
+#pragma once
+
+#include "core/Common.hh"
+
+#include <array>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+namespace sp {
+    // Planes point inward, a point p is inside if dot(plane.xyz, p) + plane.w >= 0 for every plane
+    struct Frustum {
+        std::array<glm::vec4, 6> planes;
+    };
+
+    /**
+     * A max depth pyramid, each texel holds the farthest depth of the 2x2 texels below it.
+     * Level 0 is half the size of the depth buffer, rounded up, so each level covers the full depth buffer.
+     */
+    struct DepthPyramid {
+        glm::uvec2 depthExtent = {0, 0};
+        std::vector<std::vector<float>> levels;
+
+        glm::uvec2 LevelExtent(uint32 level) const;
+        float Texel(uint32 level, glm::uvec2 texel) const;
+    };
+
+    // The pixel rectangle and nearest depth covered by a bounding box, see culling::ProjectBounds()
+    struct ScreenBounds {
+        glm::uvec2 minPixel, maxPixel; // Inclusive
+        float nearestDepth;
+    };
+
+    /**
+     * CPU reference implementation of the draw culling in shaders/vulkan/lib/culling.glsl.
+     * Any change to the culling math needs to be made in both places.
+     *
+     * Depth follows the renderer's conventions: clip space depth is 0 to 1, and larger depths are farther away.
+     * Depth buffer rows go from NDC y = 1 at row 0 down to NDC y = -1, matching the flipped YDirection::Up viewport.
+     */
+    namespace culling {
+        Frustum ExtractFrustum(const glm::mat4 &viewProj);
+
+        // Returns the axis aligned bounds of the transformed box
+        void TransformBounds(const glm::mat4 &transform, glm::vec3 &boundsMin, glm::vec3 &boundsMax);
+
+        bool IntersectsFrustum(const Frustum &frustum, glm::vec3 boundsMin, glm::vec3 boundsMax);
+
+        uint32 DepthPyramidLevelCount(glm::uvec2 depthExtent);
+        glm::uvec2 DepthPyramidExtent(glm::uvec2 depthExtent, uint32 level);
+        DepthPyramid BuildDepthPyramid(std::span<const float> depth, glm::uvec2 depthExtent);
+
+        /**
+         * Projects world space bounds onto a depth buffer. Returns false if the bounds can't be tested for occlusion
+         * because they cross the near plane or aren't entirely on screen, since the depth buffer has no information
+         * about what is behind them.
+         */
+        bool ProjectBounds(const glm::mat4 &viewProj,
+            glm::vec3 boundsMin,
+            glm::vec3 boundsMax,
+            glm::uvec2 depthExtent,
+            ScreenBounds &dst);
+
+        // The smallest pyramid level where the bounds cover at most 2x2 texels
+        uint32 DepthPyramidTestLevel(const ScreenBounds &bounds);
+
+        // Returns true if the bounds are entirely behind the depth stored in the pyramid
+        bool IsOccluded(const DepthPyramid &pyramid,
+            const glm::mat4 &viewProj,
+            glm::vec3 boundsMin,
+            glm::vec3 boundsMax);
+    } // namespace culling
+} // namespace sp
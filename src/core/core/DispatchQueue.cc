@@ -1,72 +1,220 @@
 #include "DispatchQueue.hh"
 
+#include <algorithm>
+#include <array>
+
 namespace sp {
+    namespace detail {
+        static const size_t WORK_ITEM_SIZE_CLASS = 64;
+        static const size_t WORK_ITEM_SIZE_CLASS_COUNT = 16;
+        static const size_t WORK_ITEM_MAX_FREE_LIST_SIZE = 256;
+
+        static thread_local bool workItemFreeListsDestroyed = false;
+
+        struct WorkItemFreeLists {
+            std::array<std::vector<void *>, WORK_ITEM_SIZE_CLASS_COUNT> lists;
+
+            ~WorkItemFreeLists() {
+                workItemFreeListsDestroyed = true;
+                for (auto &list : lists) {
+                    for (auto *ptr : list) {
+                        ::operator delete(ptr);
+                    }
+                }
+            }
+        };
+        static thread_local WorkItemFreeLists workItemFreeLists;
+
+        void *AllocateWorkItem(size_t size) {
+            size_t sizeClass = (size + WORK_ITEM_SIZE_CLASS - 1) / WORK_ITEM_SIZE_CLASS;
+            if (sizeClass > WORK_ITEM_SIZE_CLASS_COUNT || workItemFreeListsDestroyed) return ::operator new(size);
+
+            auto &list = workItemFreeLists.lists[sizeClass - 1];
+            if (list.empty()) return ::operator new(sizeClass * WORK_ITEM_SIZE_CLASS);
+            void *ptr = list.back();
+            list.pop_back();
+            return ptr;
+        }
+
+        void FreeWorkItem(void *ptr, size_t size) {
+            size_t sizeClass = (size + WORK_ITEM_SIZE_CLASS - 1) / WORK_ITEM_SIZE_CLASS;
+            if (sizeClass > WORK_ITEM_SIZE_CLASS_COUNT || workItemFreeListsDestroyed) {
+                ::operator delete(ptr);
+                return;
+            }
+
+            auto &list = workItemFreeLists.lists[sizeClass - 1];
+            if (list.size() >= WORK_ITEM_MAX_FREE_LIST_SIZE) {
+                ::operator delete(ptr);
+            } else {
+                list.emplace_back(ptr);
+            }
+        }
+    } // namespace detail
+
+    DispatchQueue::DispatchQueue(std::string name, size_t threadCount, Workers workers)
+        : state(std::make_shared<State>()) {
+        state->name = std::move(name);
+        state->maxActive = threadCount;
+        if (threadCount == 0) return;
+        if (workers == Workers::Dedicated) {
+            dedicatedScheduler = std::make_unique<WorkScheduler>(threadCount, state->name);
+            state->scheduler = dedicatedScheduler.get();
+        } else {
+            // The shared scheduler is constructed first, so it outlives this queue
+            state->scheduler = &GetWorkScheduler();
+        }
+    }
+
     DispatchQueue::~DispatchQueue() {
-        dropPendingWork = true;
+        {
+            std::lock_guard lock(state->mutex);
+            state->dropPendingWork = true;
+        }
         Shutdown();
     }
 
     void DispatchQueue::Shutdown() {
         ZoneScoped;
-        std::unique_lock<std::mutex> lock(mutex);
-        exit = true;
-        workReady.notify_all();
-        lock.unlock();
-
-        for (auto &thread : threads) {
-            if (thread.joinable()) thread.join();
+        std::deque<std::shared_ptr<DispatchQueueWorkItemBase>> droppedWork;
+        {
+            std::unique_lock lock(state->mutex);
+            state->exit = true;
+            if (state->maxActive > 0) {
+                state->workChanged.wait(lock, [&] {
+                    if (state->activeCount > 0) return false;
+                    return state->dropPendingWork || (state->readyQueue.empty() && state->waitingCount == 0);
+                });
+            }
+            state->stopped = true;
+            droppedWork.swap(state->readyQueue);
+            state->controlledCount = 0;
+        }
+        for (auto &item : droppedWork) {
+            item->Skip();
         }
     }
 
     void DispatchQueue::Flush(bool blockUntilReady) {
         ZoneScoped;
-        std::unique_lock<std::mutex> lock(mutex);
-        FlushInternal(lock, workQueue.size(), blockUntilReady);
+        std::unique_lock lock(state->mutex);
+        if (state->maxActive > 0) {
+            // Work is run by the scheduler, wait for it instead of processing it on this thread
+            state->workChanged.wait(lock, [&] {
+                if (state->activeCount > 0 || !state->readyQueue.empty()) return false;
+                return !blockUntilReady || state->waitingCount == 0 || state->stopped;
+            });
+            return;
+        }
+
+        FlushInternal(lock, state->readyQueue.size());
+        while (blockUntilReady && state->waitingCount > 0 && !state->stopped) {
+            state->workChanged.wait(lock, [&] {
+                return !state->readyQueue.empty() || state->waitingCount == 0 || state->stopped;
+            });
+            FlushInternal(lock, state->readyQueue.size());
+        }
+    }
+
+    DispatchQueueStats DispatchQueue::GetStats() {
+        std::lock_guard lock(state->mutex);
+        return state->stats;
     }
 
-    void DispatchQueue::ThreadMain() {
-        tracy::SetThreadName(name.c_str());
-        std::unique_lock<std::mutex> lock(mutex);
+    size_t DispatchQueue::FlushInternal(std::unique_lock<std::mutex> &lock, size_t maxWorkItems) {
+        size_t flushCount = 0;
+        while (flushCount < maxWorkItems && !state->readyQueue.empty()) {
+            state->RunItem(lock, state->PopReady());
+            flushCount++;
+        }
+        return flushCount;
+    }
 
-        while (true) {
-            if (workQueue.empty()) {
-                if (exit) break;
-                workReady.wait(lock);
-            }
-            if (exit && dropPendingWork) break;
-            if (workQueue.empty()) continue;
-
-            {
-                ZoneScopedN("ThreadFlush");
-                size_t flushCount = workQueue.size();
-                ZoneValue(flushCount);
-                if (FlushInternal(lock, flushCount, false) == 0) {
-                    lock.unlock();
-                    std::this_thread::sleep_for(flushSleepInterval);
-                    lock.lock();
+    void DispatchQueue::State::PushReady(std::shared_ptr<DispatchQueueWorkItemBase> item) {
+        std::unique_lock lock(mutex);
+        waitingCount--;
+        if (stopped || (exit && dropPendingWork)) {
+            lock.unlock();
+            workChanged.notify_all();
+            item->Skip();
+            return;
+        }
+
+        item->readyTime = chrono_clock::now();
+        if (item->control) controlledCount++;
+        readyQueue.emplace_back(std::move(item));
+        if (maxActive > 0 && activeCount < maxActive) {
+            activeCount++;
+            // Scheduled while locked so Shutdown() can't return and free a dedicated scheduler during this call
+            scheduler->Schedule({&State::RunJob, this});
+        }
+        lock.unlock();
+        workChanged.notify_all();
+    }
+
+    std::shared_ptr<DispatchQueueWorkItemBase> DispatchQueue::State::PopReady() {
+        auto next = readyQueue.begin();
+        if (controlledCount > 0) {
+            // Find the first item with the highest priority, so equal priorities stay in order
+            int nextPriority = (*next)->control ? (*next)->control->Priority() : 0;
+            for (auto it = next + 1; it != readyQueue.end(); it++) {
+                int priority = (*it)->control ? (*it)->control->Priority() : 0;
+                if (priority > nextPriority) {
+                    next = it;
+                    nextPriority = priority;
                 }
             }
         }
+
+        auto item = std::move(*next);
+        readyQueue.erase(next);
+        if (item->control) controlledCount--;
+        return item;
     }
 
-    size_t DispatchQueue::FlushInternal(std::unique_lock<std::mutex> &lock, size_t maxWorkItems, bool blockUntilReady) {
-        size_t flushCount = 0;
-        while (maxWorkItems > 0 && !workQueue.empty()) {
-            auto item = std::move(workQueue.front());
-            workQueue.pop();
+    void DispatchQueue::State::RunItem(std::unique_lock<std::mutex> &lock,
+        std::shared_ptr<DispatchQueueWorkItemBase> item) {
+        auto startTime = chrono_clock::now();
+        auto wait = startTime - item->readyTime;
+        lock.unlock();
 
-            lock.unlock();
-            bool ready = blockUntilReady || item->Ready();
-            if (ready) {
-                item->Process();
-                std::this_thread::yield();
-                flushCount++;
-            }
-            lock.lock();
+        bool skipped = item->control && !item->control->TryStart();
+        if (skipped) {
+            item->Skip();
+        } else {
+            item->Process();
+        }
+        item.reset();
+        auto work = chrono_clock::now() - startTime;
 
-            if (!ready) workQueue.push(std::move(item));
-            maxWorkItems--;
+        lock.lock();
+        if (skipped) {
+            stats.skippedCount++;
+        } else {
+            stats.processedCount++;
+            stats.totalWait += wait;
+            stats.maxWait = std::max(stats.maxWait, wait);
+            stats.totalWork += work;
         }
-        return flushCount;
+    }
+
+    void DispatchQueue::State::RunJob(void *statePtr) {
+        auto &state = *static_cast<State *>(statePtr);
+        ZoneScopedN("DispatchQueue");
+        ZoneStr(state.name);
+
+        std::unique_lock lock(state.mutex);
+        if (!state.readyQueue.empty() && !(state.exit && state.dropPendingWork)) {
+            state.RunItem(lock, state.PopReady());
+        }
+
+        if (!state.readyQueue.empty() && !(state.exit && state.dropPendingWork)) {
+            // Reschedule instead of looping so work from other queues gets a chance to run
+            lock.unlock();
+            state.scheduler->Schedule({&State::RunJob, statePtr});
+            return;
+        }
+        state.activeCount--;
+        state.workChanged.notify_all();
     }
 } // namespace sp
@@ -3,16 +3,18 @@
 #include "assets/Async.hh"
 #include "core/Common.hh"
 #include "core/Tracing.hh"
+#include "core/WorkScheduler.hh"
 
+#include <atomic>
 #include <condition_variable>
 #include <cstdint>
 #include <cstdio>
+#include <deque>
 #include <functional>
 #include <future>
+#include <limits>
 #include <mutex>
-#include <queue>
 #include <string>
-#include <thread>
 #include <type_traits>
 #include <vector>
 
@@ -33,8 +35,9 @@ namespace sp {
 
             Future(std::future<T> &future) : future(std::move(future)) {}
 
-            bool Ready() const {
-                return future.wait_for(std::chrono::seconds(0)) != std::future_status::timeout;
+            // std::future has no way to register a callback, Get() will block the worker until it is ready.
+            void OnReady(std::function<void()> &&callback) {
+                callback();
             }
 
             ReturnType Get() {
@@ -52,8 +55,9 @@ namespace sp {
 
             Future(const std::shared_future<T> &future) : future(future) {}
 
-            bool Ready() const {
-                return future.wait_for(std::chrono::seconds(0)) != std::future_status::timeout;
+            // std::shared_future has no way to register a callback, Get() will block the worker until it is ready.
+            void OnReady(std::function<void()> &&callback) {
+                callback();
             }
 
             ReturnType Get() {
@@ -71,8 +75,12 @@ namespace sp {
 
             Future(const AsyncPtr<T> &future) : future(future) {}
 
-            bool Ready() const {
-                return !future || future->Ready();
+            void OnReady(std::function<void()> &&callback) {
+                if (future) {
+                    future->OnReady(std::move(callback));
+                } else {
+                    callback();
+                }
             }
 
             ReturnType Get() {
@@ -83,14 +91,115 @@ namespace sp {
         private:
             AsyncPtr<T> future;
         };
+
+        void *AllocateWorkItem(size_t size);
+        void FreeWorkItem(void *ptr, size_t size);
+
+        // Recycles work item and result storage through per-thread free lists grouped by size.
+        template<typename T>
+        struct WorkItemAllocator {
+            using value_type = T;
+
+            WorkItemAllocator() = default;
+            template<typename U>
+            WorkItemAllocator(const WorkItemAllocator<U> &) {}
+
+            T *allocate(size_t n) {
+                return static_cast<T *>(AllocateWorkItem(n * sizeof(T)));
+            }
+
+            void deallocate(T *ptr, size_t n) {
+                FreeWorkItem(ptr, n * sizeof(T));
+            }
+
+            template<typename U>
+            bool operator==(const WorkItemAllocator<U> &) const {
+                return true;
+            }
+        };
     } // namespace detail
 
+    /**
+     * Shared with work dispatched through DispatchQueue::DispatchControlled(), and used to reprioritize or cancel
+     * the work until it starts. Ready work with a higher priority runs first, and work with the same priority runs
+     * in the order it became ready. Work dispatched without a control has a priority of 0.
+     */
+    class DispatchControl {
+    public:
+        enum class State {
+            Queued = 0,
+            Canceled,
+            Started,
+            Skipped, // The work was canceled when it was dequeued, and its result was set to nullptr
+        };
+
+        DispatchControl(int priority = 0) : priority(priority) {}
+
+        int Priority() const {
+            return priority;
+        }
+
+        State GetState() {
+            std::lock_guard lock(mutex);
+            return state;
+        }
+
+        /**
+         * Raises the priority of the work to at least newPriority, and undoes any cancellation.
+         * Returns false if the work was already skipped.
+         */
+        bool Request(int newPriority) {
+            std::lock_guard lock(mutex);
+            if (newPriority > priority) priority = newPriority;
+            if (state == State::Canceled) state = State::Queued;
+            return state != State::Skipped;
+        }
+
+        // Cancels the work if it hasn't started and its priority is at most maxPriority
+        bool Cancel(int maxPriority = std::numeric_limits<int>::max()) {
+            std::lock_guard lock(mutex);
+            if (state == State::Queued && priority <= maxPriority) state = State::Canceled;
+            return state == State::Canceled;
+        }
+
+        // Called by the queue when the work is dequeued, returns false if the work should be skipped.
+        // Controls shared by multiple items follow the first item that was dequeued.
+        bool TryStart() {
+            std::lock_guard lock(mutex);
+            if (state == State::Queued) {
+                state = State::Started;
+            } else if (state == State::Canceled) {
+                state = State::Skipped;
+            }
+            return state == State::Started;
+        }
+
+    private:
+        std::mutex mutex;
+        std::atomic_int priority;
+        State state = State::Queued;
+    };
+
+    using DispatchControlPtr = std::shared_ptr<DispatchControl>;
+
+    struct DispatchQueueStats {
+        size_t processedCount = 0, skippedCount = 0;
+        // Time between work becoming ready and starting, and time spent running work
+        chrono_clock::duration totalWait = {}, maxWait = {}, totalWork = {};
+    };
+
     struct DispatchQueueWorkItemBase {
+        virtual ~DispatchQueueWorkItemBase() {}
         virtual void Process() = 0;
-        virtual bool Ready() = 0;
-    };
+        // Resolves the result to nullptr without running the work
+        virtual void Skip() = 0;
 
-    class DispatchQueue;
+        // Starts at the input count + 1, so the item can't be queued until all its callbacks are registered
+        std::atomic_size_t pendingInputs = 0;
+
+        DispatchControlPtr control;
+        chrono_clock::time_point readyTime;
+    };
 
     template<typename ReturnType, typename Fn, typename... Futures>
     struct DispatchQueueWorkItem final : public DispatchQueueWorkItemBase {
@@ -98,41 +207,45 @@ namespace sp {
         using ResultTuple = std::tuple<typename detail::Future<Futures>::ReturnType...>;
 
         template<typename... Args>
-        DispatchQueueWorkItem(DispatchQueue &queue, Fn &&func, Args &&...args)
-            : queue(queue), returnValue(std::make_shared<Async<ReturnType>>()), func(std::move(func)),
+        DispatchQueueWorkItem(Fn &&func, Args &&...args)
+            : returnValue(std::allocate_shared<Async<ReturnType>>(detail::WorkItemAllocator<Async<ReturnType>>())),
+              func(std::move(func)),
               waitForFutures(std::make_tuple(detail::Future<std::remove_cvref_t<Args>>(args)...)) {}
 
-        DispatchQueue &queue;
         AsyncPtr<ReturnType> returnValue;
         Fn func;
         FutureTuple waitForFutures;
 
         void Process();
-
-        bool Ready() {
-            return std::apply(
-                [](auto &&...future) {
-                    return (future.Ready() && ...);
-                },
-                waitForFutures);
+        void Skip() {
+            returnValue->Set(nullptr);
         }
     };
 
     class DispatchQueue : public NonCopyable {
     public:
-        DispatchQueue(std::string name,
-            size_t threadCount = 1,
-            chrono_clock::duration futuresPollInterval = std::chrono::milliseconds(5))
-            : name(std::move(name)), threads(threadCount), flushSleepInterval(futuresPollInterval) {
-            for (auto &thread : threads) {
-                thread = std::thread(&DispatchQueue::ThreadMain, this);
-            }
-        }
+        enum class Workers {
+            // The queue owns threadCount worker threads, its work may block on locks, IO, or other futures
+            Dedicated = 0,
+            // Work is run on the engine-wide WorkScheduler and must not block, e.g. splitting up a frame's work
+            Shared,
+        };
+
+        /**
+         * At most threadCount items from this queue run at once, on the workers selected by `workers`.
+         * A queue with a threadCount of 1 runs its work serially in dispatch order.
+         * If threadCount is 0, work is only run when Flush() is called by the owner of the queue.
+         *
+         * When the queue is destroyed, work that hasn't started is dropped and its result is set to nullptr.
+         */
+        DispatchQueue(std::string name, size_t threadCount = 1, Workers workers = Workers::Dedicated);
 
         ~DispatchQueue();
         void Shutdown();
         void Flush(bool blockUntilReady = false);
 
+        DispatchQueueStats GetStats();
+
         /**
          * Queues a function.
          * Returns a future that will be resolved with the return value of the function.
@@ -151,12 +264,31 @@ namespace sp {
         AsyncPtr<ReturnType> Dispatch(FuturesAndFn &&...args) {
             // if C++ adds support for parameters after a parameter pack, delete this function
             const size_t lastArg = sizeof...(FuturesAndFn) - 1;
-            auto tupl = std::make_tuple(std::move(args)...);
+            auto tupl = std::make_tuple(std::forward<FuturesAndFn>(args)...);
+            auto fn = std::move(std::get<lastArg>(tupl));
+            auto futures = detail::subtuple(std::move(tupl), std::make_index_sequence<lastArg>());
+            return std::apply(
+                [&](auto &&...futures) {
+                    return DispatchInternal<ReturnType>(nullptr, std::move(fn), std::move(futures)...);
+                },
+                futures);
+        }
+
+        /**
+         * Same as Dispatch(), but the work's priority and cancellation are controlled by `control`.
+         * Controls may be shared by multiple work items, e.g. to raise the priority of a chain of work.
+         *
+         * Usage: DispatchControlled<R>(control, FutureType<T>..., [](T...) { return std::make_shared<R>(); });
+         */
+        template<typename ReturnType, typename... FuturesAndFn>
+        AsyncPtr<ReturnType> DispatchControlled(const DispatchControlPtr &control, FuturesAndFn &&...args) {
+            const size_t lastArg = sizeof...(FuturesAndFn) - 1;
+            auto tupl = std::make_tuple(std::forward<FuturesAndFn>(args)...);
             auto fn = std::move(std::get<lastArg>(tupl));
             auto futures = detail::subtuple(std::move(tupl), std::make_index_sequence<lastArg>());
             return std::apply(
                 [&](auto &&...futures) {
-                    return DispatchInternal<ReturnType>(std::move(fn), std::move(futures)...);
+                    return DispatchInternal<ReturnType>(control, std::move(fn), std::move(futures)...);
                 },
                 futures);
         }
@@ -165,43 +297,76 @@ namespace sp {
          * When `from` is ready, its value will be set in `to`
          */
         template<typename FutT, typename T>
-        void ForwardAsync(FutT from, const AsyncPtr<T> &to) {
-            if (from->Ready()) {
+        static void ForwardAsync(FutT from, const AsyncPtr<T> &to) {
+            from->OnReady([from, to]() {
                 to->Set(from->Get());
-            } else {
-                Dispatch<void>(from, [to](auto &fromValue) {
-                    to->Set(fromValue);
-                });
-            }
+            });
         }
 
         template<typename ReturnType, typename Fn, typename... Futures>
-        AsyncPtr<ReturnType> DispatchInternal(Fn &&func, Futures &&...futures) {
-            Assert(!exit, "tried to dispatch to a shut down queue");
-            auto item = make_shared<DispatchQueueWorkItem<ReturnType, Fn, std::remove_cvref_t<Futures>...>>(*this,
+        AsyncPtr<ReturnType> DispatchInternal(const DispatchControlPtr &control, Fn &&func, Futures &&...futures) {
+            using WorkItem = DispatchQueueWorkItem<ReturnType, Fn, std::remove_cvref_t<Futures>...>;
+            Assert(!state->exit, "tried to dispatch to a shut down queue");
+            auto item = std::allocate_shared<WorkItem>(detail::WorkItemAllocator<WorkItem>(),
                 std::move(func),
                 std::move(futures)...);
+            item->control = control;
+            auto returnValue = item->returnValue;
 
-            std::unique_lock<std::mutex> lock(mutex);
-            workQueue.push(item);
-            workReady.notify_one();
-            return item->returnValue;
+            {
+                std::lock_guard lock(state->mutex);
+                state->waitingCount++;
+            }
+            item->pendingInputs = sizeof...(Futures) + 1;
+            std::apply(
+                [&](auto &...future) {
+                    (future.OnReady([state = state, item]() {
+                        if (--item->pendingInputs == 0) state->PushReady(item);
+                    }),
+                        ...);
+                },
+                item->waitForFutures);
+            if (--item->pendingInputs == 0) state->PushReady(std::move(item));
+            return returnValue;
         }
 
     private:
-        size_t FlushInternal(std::unique_lock<std::mutex> &lock, size_t maxWorkItems, bool blockUntilReady);
-        void ThreadMain();
+        struct State {
+            std::mutex mutex;
+            std::condition_variable workChanged;
+            std::string name;
+            size_t maxActive;
+            WorkScheduler *scheduler = nullptr;
+
+            // Items whose inputs are all ready, in the order they became ready
+            std::deque<std::shared_ptr<DispatchQueueWorkItemBase>> readyQueue;
+            // Number of items in readyQueue with a control, the queue is only searched by priority if non-zero
+            size_t controlledCount = 0;
+            size_t waitingCount = 0, activeCount = 0;
+            bool exit = false, dropPendingWork = false, stopped = false;
+
+            DispatchQueueStats stats;
+
+            void PushReady(std::shared_ptr<DispatchQueueWorkItemBase> item);
+            std::shared_ptr<DispatchQueueWorkItemBase> PopReady();
+            // Must be called with the mutex locked, which is released while the item runs
+            void RunItem(std::unique_lock<std::mutex> &lock, std::shared_ptr<DispatchQueueWorkItemBase> item);
+            static void RunJob(void *statePtr);
+        };
 
-        std::mutex mutex;
-        std::string name;
-        std::vector<std::thread> threads;
-        chrono_clock::duration flushSleepInterval;
+        size_t FlushInternal(std::unique_lock<std::mutex> &lock, size_t maxWorkItems);
 
-        std::queue<shared_ptr<DispatchQueueWorkItemBase>> workQueue;
-        std::condition_variable workReady;
-        bool exit = false, dropPendingWork = false;
+        std::shared_ptr<State> state;
+        // Declared after state so the worker threads are joined before the state is freed
+        std::unique_ptr<WorkScheduler> dedicatedScheduler;
     };
 
+    template<typename T>
+    template<typename ReturnType, typename Fn>
+    AsyncPtr<ReturnType> Async<T>::Then(DispatchQueue &queue, Fn &&fn) {
+        return queue.Dispatch<ReturnType>(this->shared_from_this(), std::forward<Fn>(fn));
+    }
+
     template<typename ReturnType, typename Fn, typename... Futures>
     void DispatchQueueWorkItem<ReturnType, Fn, Futures...>::Process() {
         ZoneScoped;
@@ -221,7 +386,7 @@ namespace sp {
         } else {
             auto result = std::apply(func, args);
             if constexpr (std::is_constructible<detail::Future<decltype(result)>, decltype(result)>()) {
-                queue.ForwardAsync(result, returnValue);
+                DispatchQueue::ForwardAsync(result, returnValue);
             } else {
                 returnValue->Set(result);
             }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/Common.hh"
+#include "core/StringAtom.hh"
 
 #include <cstring>
 #include <iomanip>
@@ -44,7 +45,7 @@ namespace sp::logging {
     auto convert(T &&t) {
         using BaseType = std::remove_cv_t<std::remove_reference_t<T>>;
 
-        if constexpr (std::is_same<BaseType, std::string>()) {
+        if constexpr (std::is_same<BaseType, std::string>() || std::is_same<BaseType, StringAtom>()) {
             return std::forward<T>(t).c_str();
         } else if constexpr (std::is_same<BaseType, std::string_view>()) {
             if (t.empty()) return "";
@@ -0,0 +1,46 @@
+#include "StringAtom.hh"
+
+#include "core/Logging.hh"
+
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace sp {
+    namespace detail {
+        template<typename Entry>
+        struct StringAtomTable {
+            std::shared_mutex mutex;
+            // Entries are stored in a deque so their addresses stay stable as the table grows
+            std::deque<Entry> entries;
+            std::unordered_map<std::string_view, const Entry *> lookup;
+
+            const Entry *Intern(std::string_view str) {
+                {
+                    std::shared_lock lock(mutex);
+                    auto it = lookup.find(str);
+                    if (it != lookup.end()) return it->second;
+                }
+
+                std::unique_lock lock(mutex);
+                auto it = lookup.find(str);
+                if (it != lookup.end()) return it->second;
+
+                Assert(entries.size() < std::numeric_limits<uint32_t>::max(), "Too many string atoms");
+                auto &entry = entries.emplace_back(Entry{std::string(str), (uint32_t)entries.size() + 1});
+                lookup.emplace(entry.str, &entry);
+                return &entry;
+            }
+        };
+    } // namespace detail
+
+    StringAtom::StringAtom(std::string_view str) {
+        if (str.empty()) return;
+
+        // Function-local so atoms can be safely constructed during static initialization
+        static detail::StringAtomTable<Entry> table;
+        entry = table.Intern(str);
+    }
+} // namespace sp
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace sp {
+    /**
+     * A string interned in an engine-wide table. Copying, comparing, and hashing an atom never touches the string.
+     *
+     * Interned strings are never freed, so String() references stay valid for the lifetime of the program.
+     * Each atom also has a compact Id(), with 0 reserved for the empty string.
+     */
+    class StringAtom {
+    public:
+        constexpr StringAtom() {}
+        StringAtom(std::string_view str);
+        StringAtom(const std::string &str) : StringAtom(std::string_view(str)) {}
+        StringAtom(const char *str) : StringAtom(std::string_view(str)) {}
+
+        const std::string &String() const {
+            static const std::string emptyString;
+            return entry ? entry->str : emptyString;
+        }
+
+        const char *c_str() const {
+            return String().c_str();
+        }
+
+        size_t size() const {
+            return String().size();
+        }
+
+        bool empty() const {
+            return entry == nullptr;
+        }
+
+        uint32_t Id() const {
+            return entry ? entry->id : 0;
+        }
+
+        operator const std::string &() const {
+            return String();
+        }
+
+        bool operator==(const StringAtom &other) const {
+            return entry == other.entry;
+        }
+        bool operator==(const std::string &other) const {
+            return String() == other;
+        }
+        bool operator==(std::string_view other) const {
+            return String() == other;
+        }
+        bool operator==(const char *other) const {
+            return String() == other;
+        }
+
+        // Atoms are ordered by their string value so sorted containers are deterministic
+        bool operator<(const StringAtom &other) const {
+            return entry != other.entry && String() < other.String();
+        }
+
+        friend std::ostream &operator<<(std::ostream &out, const StringAtom &atom) {
+            return out << atom.String();
+        }
+
+    private:
+        struct Entry {
+            std::string str;
+            uint32_t id;
+        };
+
+        const Entry *entry = nullptr;
+
+        friend struct std::hash<StringAtom>;
+    };
+} // namespace sp
+
+namespace std {
+    template<>
+    struct hash<sp::StringAtom> {
+        size_t operator()(const sp::StringAtom &atom) const {
+            return std::hash<const void *>()(atom.entry);
+        }
+    };
+} // namespace std
@@ -0,0 +1,137 @@
+#include "WorkScheduler.hh"
+
+#include "core/Logging.hh"
+#include "core/Tracing.hh"
+
+#include <algorithm>
+#include <string>
+
+namespace sp {
+    // Index of the worker owning the current thread, or SIZE_MAX for threads outside the pool
+    static thread_local size_t currentWorkerIndex = SIZE_MAX;
+    static thread_local WorkScheduler *currentScheduler = nullptr;
+
+    // Jobs each worker can hold before its ring has to grow
+    static const size_t INITIAL_JOB_CAPACITY = 1024;
+
+    WorkScheduler &GetWorkScheduler() {
+        // Only non-blocking work runs on the shared scheduler, so one worker per core is enough
+        static WorkScheduler scheduler(std::max<size_t>(1, std::thread::hardware_concurrency()));
+        return scheduler;
+    }
+
+    WorkScheduler::WorkScheduler(size_t threadCount, std::string threadName) : threadName(threadName) {
+        Assert(threadCount > 0, "WorkScheduler requires at least one thread");
+        workers.resize(threadCount);
+        for (auto &worker : workers) {
+            worker = std::make_unique<Worker>();
+            worker->jobs.resize(INITIAL_JOB_CAPACITY);
+        }
+        for (size_t i = 0; i < workers.size(); i++) {
+            workers[i]->thread = std::thread(&WorkScheduler::ThreadMain, this, i);
+        }
+    }
+
+    WorkScheduler::~WorkScheduler() {
+        {
+            std::lock_guard lock(sleepMutex);
+            exit = true;
+        }
+        workReady.notify_all();
+        for (auto &worker : workers) {
+            if (worker->thread.joinable()) worker->thread.join();
+        }
+    }
+
+    void WorkScheduler::Schedule(Job job) {
+        Assert(job.func, "WorkScheduler::Schedule called with null job");
+        size_t index;
+        if (currentScheduler == this) {
+            index = currentWorkerIndex;
+        } else {
+            index = nextWorker++ % workers.size();
+        }
+        // Workers register as sleeping before checking queuedJobs, and this checks sleepingWorkers after incrementing
+        // queuedJobs, so either the worker sees the job or this sees the sleeping worker.
+        queuedJobs++;
+        {
+            auto &worker = *workers[index];
+            std::lock_guard lock(worker.mutex);
+            worker.PushBack(job);
+        }
+        if (sleepingWorkers > 0) {
+            {
+                // Wait for a worker that is about to sleep to start waiting, so the wakeup can't be missed
+                std::lock_guard lock(sleepMutex);
+            }
+            workReady.notify_one();
+        }
+    }
+
+    void WorkScheduler::Worker::PushBack(Job job) {
+        if (count == jobs.size()) {
+            std::vector<Job> grown(jobs.size() * 2);
+            for (size_t i = 0; i < count; i++) {
+                grown[i] = jobs[(head + i) & (jobs.size() - 1)];
+            }
+            jobs = std::move(grown);
+            head = 0;
+        }
+        jobs[(head + count) & (jobs.size() - 1)] = job;
+        count++;
+    }
+
+    bool WorkScheduler::Worker::PopBack(Job &jobOut) {
+        if (count == 0) return false;
+        count--;
+        jobOut = jobs[(head + count) & (jobs.size() - 1)];
+        return true;
+    }
+
+    bool WorkScheduler::Worker::PopFront(Job &jobOut) {
+        if (count == 0) return false;
+        jobOut = jobs[head];
+        head = (head + 1) & (jobs.size() - 1);
+        count--;
+        return true;
+    }
+
+    bool WorkScheduler::PopJob(size_t workerIndex, Job &jobOut) {
+        {
+            auto &worker = *workers[workerIndex];
+            std::lock_guard lock(worker.mutex);
+            if (worker.PopBack(jobOut)) return true;
+        }
+        for (size_t i = 1; i < workers.size(); i++) {
+            auto &victim = *workers[(workerIndex + i) % workers.size()];
+            std::lock_guard lock(victim.mutex);
+            if (victim.PopFront(jobOut)) return true;
+        }
+        return false;
+    }
+
+    void WorkScheduler::ThreadMain(size_t workerIndex) {
+        std::string name = threadName + std::to_string(workerIndex);
+        tracy::SetThreadName(name.c_str());
+        currentWorkerIndex = workerIndex;
+        currentScheduler = this;
+
+        Job job;
+        while (true) {
+            if (PopJob(workerIndex, job)) {
+                queuedJobs--;
+                job.func(job.data);
+                continue;
+            }
+
+            // Queued jobs are always run before exiting, since queues may be waiting on them
+            std::unique_lock lock(sleepMutex);
+            sleepingWorkers++;
+            if (queuedJobs == 0) {
+                if (exit) break;
+                workReady.wait(lock);
+            }
+            sleepingWorkers--;
+        }
+    }
+} // namespace sp
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "core/Common.hh"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sp {
+    /**
+     * Pool of worker threads, each with its own deque of jobs.
+     * GetWorkScheduler() returns the engine-wide pool, and DispatchQueues with dedicated workers own their own pool.
+     *
+     * Jobs scheduled from a worker thread are pushed onto that worker's deque and run newest-first, keeping related
+     * work on the same thread. Jobs scheduled from any other thread are distributed round-robin across the workers.
+     * Idle workers steal the oldest job from another worker's deque before going to sleep.
+     *
+     * Jobs are a plain function pointer and argument, stored in a preallocated ring per worker. Scheduling only
+     * allocates if a worker's ring is full and needs to grow, and only takes the sleep mutex when a worker is asleep.
+     * Jobs on the engine-wide pool must not block, since they share threads with the rest of the engine.
+     */
+    class WorkScheduler : public NonCopyable {
+    public:
+        struct Job {
+            void (*func)(void *) = nullptr;
+            void *data = nullptr;
+        };
+
+        WorkScheduler(size_t threadCount, std::string threadName = "Worker");
+        ~WorkScheduler();
+
+        void Schedule(Job job);
+
+        size_t ThreadCount() const {
+            return workers.size();
+        }
+
+    private:
+        struct Worker {
+            std::mutex mutex;
+            std::thread thread;
+
+            // Ring buffer of jobs from oldest to newest, its capacity is always a power of 2
+            std::vector<Job> jobs;
+            size_t head = 0, count = 0;
+
+            void PushBack(Job job);
+            bool PopBack(Job &jobOut);
+            bool PopFront(Job &jobOut);
+        };
+
+        void ThreadMain(size_t workerIndex);
+        bool PopJob(size_t workerIndex, Job &jobOut);
+
+        std::string threadName;
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::atomic_size_t nextWorker = 0;
+        std::atomic_size_t queuedJobs = 0;
+        std::atomic_size_t sleepingWorkers = 0;
+
+        std::mutex sleepMutex;
+        std::condition_variable workReady;
+        bool exit = false;
+    };
+
+    WorkScheduler &GetWorkScheduler();
+} // namespace sp
@@ -5,10 +5,12 @@
 #include "ecs/components/Name.hh"
 #include "ecs/components/SceneInfo.hh"
 
+#include <concepts>
 #include <cstring>
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <span>
 #include <stdexcept>
 #include <typeindex>
 
@@ -32,6 +34,10 @@ namespace ecs {
         ComponentBase(const char *name, const StructMetadata &metadata) : name(name), metadata(metadata) {}
 
         virtual bool LoadEntity(FlatEntity &dst, const picojson::value &src) const = 0;
+        // Stores a component loaded by LoadEntity() as raw field values for the binary scene cache.
+        // Returns false if the component has custom loading or fields that can't be stored by value.
+        virtual bool SaveBinary(const FlatEntity &src, std::vector<uint8_t> &dst) const = 0;
+        virtual bool LoadBinary(FlatEntity &dst, std::span<const uint8_t> src) const = 0;
         virtual void SaveEntity(const Lock<ReadAll> &lock,
             const EntityScope &scope,
             picojson::value &dst,
@@ -123,6 +129,36 @@ namespace ecs {
             return false;
         }
 
+        bool SaveBinary(const FlatEntity &src, std::vector<uint8_t> &dst) const override {
+            if constexpr (has_custom_load<CompType>()) {
+                return false;
+            } else {
+                auto &comp = std::get<std::optional<CompType>>(src);
+                if (!comp) return false;
+                for (auto &field : metadata.fields) {
+                    if (!(field.actions & FieldAction::AutoLoad)) continue;
+                    if (!field.IsBinaryValue()) return false;
+                }
+                for (auto &field : metadata.fields) {
+                    if (!(field.actions & FieldAction::AutoLoad)) continue;
+                    field.SaveBinary(&*comp, dst);
+                }
+                return true;
+            }
+        }
+
+        bool LoadBinary(FlatEntity &dst, std::span<const uint8_t> src) const override {
+            // Fields are written directly into a copy of the default, the same starting point as LoadEntity()
+            CompType comp = defaultStagingComponent;
+            for (auto &field : metadata.fields) {
+                if (!(field.actions & FieldAction::AutoLoad)) continue;
+                if (!field.LoadBinary(&comp, src)) return false;
+            }
+            if (!src.empty()) return false;
+            std::get<std::optional<CompType>>(dst) = comp;
+            return true;
+        }
+
         void SaveEntity(const Lock<ReadAll> &lock,
             const EntityScope &scope,
             picojson::value &dst,
@@ -142,6 +178,18 @@ namespace ecs {
             }
         }
 
+        // Returns true if the components are equal, comparing field by field for types without an operator==
+        bool CompareComponent(const CompType &a, const CompType &b) const {
+            if constexpr (std::equality_comparable<CompType>) {
+                return a == b;
+            } else {
+                for (auto &field : metadata.fields) {
+                    if (!field.Compare(&a, &b)) return false;
+                }
+                return true;
+            }
+        }
+
         void ApplyComponent(CompType &dst, const CompType &src, bool liveTarget) const {
             const auto &defaultComponent = liveTarget ? defaultLiveComponent : defaultStagingComponent;
             // Merge existing component with a new one
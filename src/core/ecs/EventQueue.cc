@@ -4,6 +4,8 @@
 #include "core/Common.hh"
 #include "core/Logging.hh"
 
+#include <bit>
+#include <mutex>
 #include <optional>
 #include <picojson/picojson.h>
 #include <sstream>
@@ -39,77 +41,128 @@ namespace ecs {
         return out;
     }
 
-    bool EventQueue::Add(const AsyncEvent &event) {
-        State s, s2;
-        do {
-            s = state.load();
-            s2 = {s.head, (s.tail + 1) % (uint32_t)events.size()};
-            if (s2.tail == s2.head) {
-                Warnf("Event Queue full! Dropping event %s from %s", event.name, std::to_string(event.source));
-                return false;
+    EventQueue::Slot *EventQueue::ReserveSlot(uint64_t &positionOut) {
+        if (capacity == 0) return nullptr;
+
+        uint64_t position = writePosition.load(std::memory_order_relaxed);
+        while (true) {
+            auto &slot = slots[position & (capacity - 1)];
+            uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence == position) {
+                if (writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    positionOut = position;
+                    return &slot;
+                }
+            } else if (sequence < position) {
+                // The slot still holds an event from the previous lap, the queue is full
+                return nullptr;
+            } else {
+                position = writePosition.load(std::memory_order_relaxed);
             }
-        } while (!state.compare_exchange_weak(s, s2, std::memory_order_acquire, std::memory_order_relaxed));
-        events[s.tail] = event;
+        }
+    }
+
+    bool EventQueue::Add(const AsyncEvent &event) {
+        if (event.data && event.data->Ready()) {
+            auto data = event.data->Get();
+            // A null event means it was filtered out asynchronously, drop it
+            if (!data) return true;
+            return Add(Event(event.name, event.source, *data), event.transactionId);
+        }
+
+        uint64_t position;
+        Slot *slot = ReserveSlot(position);
+        if (!slot) {
+            Warnf("Event Queue full! Dropping event %s from %s", event.name, std::to_string(event.source));
+            return false;
+        }
+        slot->transactionId = event.transactionId;
+        slot->event.name = event.name;
+        slot->event.source = event.source;
+        slot->asyncData = event.data;
+        slot->sequence.store(position + 1, std::memory_order_release);
         return true;
     }
 
     bool EventQueue::Add(const Event &event, size_t transactionId) {
-        AsyncEvent asyncEvent(event.name, event.source, event.data);
-        asyncEvent.transactionId = transactionId;
-        return Add(asyncEvent);
+        uint64_t position;
+        Slot *slot = ReserveSlot(position);
+        if (!slot) {
+            Warnf("Event Queue full! Dropping event %s from %s", event.name, std::to_string(event.source));
+            return false;
+        }
+        slot->transactionId = transactionId;
+        slot->event = event;
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
     }
 
     bool EventQueue::Poll(Event &eventOut, size_t transactionId) {
+        std::lock_guard lock(readMutex);
+
         bool outputSet = false;
-        while (!outputSet) {
-            State s = state.load();
-            if (s.head == s.tail) break;
+        uint64_t position = readPosition.load(std::memory_order_relaxed);
+        while (!outputSet && capacity > 0) {
+            auto &slot = slots[position & (capacity - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != position + 1) break;
 
-            auto &async = events[s.head];
             // Check if this event should be visible to the current transaction.
             // Events are not visible to the transaction that emitted them.
-            if (async.transactionId >= transactionId && transactionId > 0) break;
-            if (!async.data || !async.data->Ready()) break;
-
-            auto data = async.data->Get();
-            if (data) {
-                eventOut = Event{
-                    async.name,
-                    async.source,
-                    *data,
-                };
-                outputSet = true;
+            if (slot.transactionId >= transactionId && transactionId > 0) break;
+
+            if (slot.asyncData) {
+                if (!slot.asyncData->Ready()) break;
+
+                auto data = slot.asyncData->Get();
+                if (data) {
+                    eventOut.name = slot.event.name;
+                    eventOut.source = slot.event.source;
+                    eventOut.data = *data;
+                    outputSet = true;
+                } else {
+                    // A null event means it was filtered out asynchronously, skip over it
+                }
+                slot.asyncData.reset();
             } else {
-                // A null event means it was filtered out asynchronously, skip over it
+                eventOut = std::move(slot.event);
+                outputSet = true;
             }
 
-            State s2;
-            do {
-                s = state.load();
-                s2 = {(s.head + 1) % (uint32_t)events.size(), s.tail};
-            } while (!state.compare_exchange_weak(s, s2, std::memory_order_release, std::memory_order_relaxed));
+            slot.sequence.store(position + capacity, std::memory_order_release);
+            readPosition.store(++position, std::memory_order_release);
         }
         if (!outputSet) eventOut = Event();
         return outputSet;
     }
 
     bool EventQueue::Empty() {
-        State s = state.load();
-        return s.head == s.tail;
+        return Size() == 0;
     }
 
     size_t EventQueue::Size() {
-        State s = state.load();
-        if (s.head > s.tail) {
-            return s.tail + events.size() - s.head;
-        } else {
-            return s.tail - s.head;
-        }
+        uint64_t read = readPosition.load(std::memory_order_acquire);
+        uint64_t write = writePosition.load(std::memory_order_acquire);
+        // Slots may be reserved but not yet published, so this is only an upper bound while events are being added
+        return write > read ? write - read : 0;
     }
 
     void EventQueue::Resize(uint32_t newSize) {
-        events.resize(newSize);
-        state.store({0, 0});
+        Assertf(newSize <= (1u << 31), "EventQueue size %u is too large", newSize);
+        capacity = newSize > 0 ? std::bit_ceil(newSize) : 0;
+        if (capacity > allocatedSlots) {
+            slots = std::make_unique<Slot[]>(capacity);
+            allocatedSlots = capacity;
+        }
+        // Keep the existing allocation when shrinking so recycled queues don't need to reallocate
+        for (size_t i = 0; i < allocatedSlots; i++) {
+            auto &slot = slots[i];
+            slot.sequence.store(i, std::memory_order_relaxed);
+            slot.transactionId = 0;
+            slot.event = Event();
+            slot.asyncData.reset();
+        }
+        readPosition.store(0, std::memory_order_relaxed);
+        writePosition.store(0, std::memory_order_relaxed);
     }
 
     EventQueueRef NewEventQueue(uint32_t maxQueueSize) {
@@ -2,6 +2,8 @@
 
 #include "assets/Async.hh"
 #include "core/InlineVector.hh"
+#include "core/LockFreeMutex.hh"
+#include "core/StringAtom.hh"
 #include "ecs/Ecs.hh"
 #include "ecs/EntityRef.hh"
 #include "ecs/components/Transform.h"
@@ -9,6 +11,7 @@
 #include <atomic>
 #include <glm/glm.hpp>
 #include <iostream>
+#include <memory>
 #include <queue>
 #include <string>
 #include <variant>
@@ -28,49 +31,53 @@ namespace ecs {
         std::string>;
 
     struct Event {
-        std::string name;
+        sp::StringAtom name;
         Entity source;
         EventData data;
 
         Event() {}
         template<typename T>
-        Event(const std::string &name, const Entity &source, const T &data) : name(name), source(source), data(data) {}
+        Event(const sp::StringAtom &name, const Entity &source, const T &data)
+            : name(name), source(source), data(data) {}
 
         std::string toString() const;
     };
 
     struct AsyncEvent {
-        std::string name;
+        sp::StringAtom name;
         Entity source;
         sp::AsyncPtr<EventData> data;
 
         size_t transactionId = 0;
 
         AsyncEvent() {}
-        AsyncEvent(const std::string &name, const Entity &source, const sp::AsyncPtr<EventData> &data)
+        AsyncEvent(const sp::StringAtom &name, const Entity &source, const sp::AsyncPtr<EventData> &data)
             : name(name), source(source), data(data) {}
 
         template<typename T>
-        AsyncEvent(const std::string &name, const Entity &source, T data)
+        AsyncEvent(const sp::StringAtom &name, const Entity &source, T data)
             : AsyncEvent(name, source, std::make_shared<sp::Async<EventData>>(std::make_shared<T>(data))) {}
     };
 
     std::ostream &operator<<(std::ostream &out, const EventData &v);
 
     /**
-     * A lock-free event queue that is thread-safe for a single reader and multiple writers.
+     * A bounded event queue that is thread-safe for multiple readers and multiple writers.
+     *
+     * Writers are lock-free, claiming a slot in the ring and publishing it by advancing the slot's sequence number.
+     * Readers are serialized with each other, but never block writers.
+     * Synchronous events are stored inline in the ring so adding them does not allocate. Only events whose data is
+     * still being computed asynchronously keep a reference to their Async value until they are ready.
      *
      * Event availability is synchronized with transactions by providing the current transaction's id.
      */
-    class EventQueue {
+    class EventQueue : public sp::NonCopyable {
     public:
-        static const size_t MAX_QUEUE_SIZE = 1000;
+        static const uint32_t DEFAULT_QUEUE_SIZE = 1024;
 
-        EventQueue(uint32_t maxQueueSize) : events(maxQueueSize), state({0, 0}) {
-            Assertf(maxQueueSize <= MAX_QUEUE_SIZE,
-                "EventQueue size %u exceeds max size %u",
-                maxQueueSize,
-                MAX_QUEUE_SIZE);
+        // The queue capacity is rounded up to the next power of 2
+        EventQueue(uint32_t maxQueueSize) {
+            Resize(maxQueueSize);
         }
 
         // Returns false if the queue is full
@@ -87,22 +94,33 @@ namespace ecs {
         // Not thread safe, drops all events in queue
         void Resize(uint32_t newSize);
         size_t Capacity() const {
-            return events.size();
+            return capacity;
         }
 
     private:
-        struct State {
-            // Workaround for Clang so that std::atomic<State> operations can be inlined as if uint64. See issue:
-            // https://stackoverflow.com/questions/60445848/clang-doesnt-inline-stdatomicload-for-loading-64-bit-structs
-            alignas(std::atomic_uint64_t) uint32_t head;
-            uint32_t tail;
+        struct Slot {
+            // Equal to the write position + 1 once the slot's event is published,
+            // and to the read position + capacity once the slot is free to be reused.
+            std::atomic_uint64_t sequence;
+
+            size_t transactionId = 0;
+            Event event;
+            // Only set for events whose data was not ready when they were added
+            sp::AsyncPtr<EventData> asyncData;
         };
 
-        sp::InlineVector<AsyncEvent, MAX_QUEUE_SIZE> events;
-        std::atomic<State> state;
+        Slot *ReserveSlot(uint64_t &positionOut);
+
+        std::unique_ptr<Slot[]> slots;
+        size_t allocatedSlots = 0;
+        size_t capacity = 0;
+
+        alignas(64) std::atomic_uint64_t writePosition = 0;
+        alignas(64) std::atomic_uint64_t readPosition = 0;
+        sp::LockFreeMutex readMutex;
     };
 
     using EventQueueRef = std::shared_ptr<EventQueue>;
 
-    EventQueueRef NewEventQueue(uint32_t maxQueueSize = EventQueue::MAX_QUEUE_SIZE);
+    EventQueueRef NewEventQueue(uint32_t maxQueueSize = EventQueue::DEFAULT_QUEUE_SIZE);
 } // namespace ecs
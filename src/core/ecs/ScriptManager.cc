@@ -4,12 +4,19 @@
 #include "core/Defer.hh"
 #include "ecs/EcsImpl.hh"
 
+#include <algorithm>
 #include <shared_mutex>
 
 namespace ecs {
     static sp::CVar<uint32_t> CVarMaxScriptQueueSize("s.MaxScriptQueueSize",
-        EventQueue::MAX_QUEUE_SIZE,
+        EventQueue::DEFAULT_QUEUE_SIZE,
         "Maximum number of event queue size for scripts");
+    static sp::CVar<uint32_t> CVarScriptWorkerThreads("s.ScriptWorkerThreads",
+        4,
+        "Maximum number of script groups to run in parallel (applied on first tick)");
+    static sp::CVar<uint32_t> CVarScriptChunkSize("s.ScriptChunkSize",
+        64,
+        "Maximum number of read-only scripts to run per parallel transaction");
 
     ScriptManager &GetScriptManager() {
         static ScriptManager scriptManager;
@@ -181,7 +188,7 @@ namespace ecs {
         ZoneScoped;
         std::shared_lock l(mutexes[ScriptCallbackIndex<OnTickFunc>()]);
         for (auto &[ent, state] : onTickScripts) {
-            if (!ent) continue;
+            if (!ent || state.definition.lockGroup) continue;
             auto &callback = std::get<OnTickFunc>(state.definition.callback);
             if (state.definition.filterOnEvent && state.eventQueue && state.eventQueue->Empty()) continue;
             // ZoneScopedN("OnTick");
@@ -190,6 +197,85 @@ namespace ecs {
         }
     }
 
+    void ScriptManager::RunOnTickParallel(const chrono_clock::duration &interval) {
+        ZoneScoped;
+        std::shared_lock l(mutexes[ScriptCallbackIndex<OnTickFunc>()]);
+
+        struct GroupScripts {
+            const ScriptLockGroupBase *lockGroup;
+            std::vector<std::pair<Entity, ScriptState *>> scripts;
+            size_t wave = 0;
+        };
+        std::vector<GroupScripts> groups;
+        for (auto &[ent, state] : onTickScripts) {
+            if (!ent || !state.definition.lockGroup) continue;
+            if (state.definition.filterOnEvent && state.eventQueue && state.eventQueue->Empty()) continue;
+            auto it = std::find_if(groups.begin(), groups.end(), [&](auto &group) {
+                return group.lockGroup == state.definition.lockGroup;
+            });
+            if (it == groups.end()) {
+                it = groups.insert(groups.end(), GroupScripts{state.definition.lockGroup, {}});
+            }
+            it->scripts.emplace_back(ent, &state);
+        }
+        if (groups.empty()) return;
+
+        // Each group runs after any earlier group it conflicts with, so conflicting scripts keep a consistent order
+        size_t waveCount = 0;
+        for (size_t i = 0; i < groups.size(); i++) {
+            for (size_t j = 0; j < i; j++) {
+                if (groups[i].lockGroup->Conflicts(*groups[j].lockGroup)) {
+                    groups[i].wave = std::max(groups[i].wave, groups[j].wave + 1);
+                }
+            }
+            waveCount = std::max(waveCount, groups[i].wave + 1);
+        }
+
+        size_t threadCount = CVarScriptWorkerThreads.Get();
+        if (!workQueue && threadCount > 0) {
+            workQueue = std::make_unique<sp::DispatchQueue>("ScriptWorker", threadCount);
+        }
+        size_t chunkSize = std::max(1u, CVarScriptChunkSize.Get());
+
+        std::vector<std::pair<const ScriptLockGroupBase *, std::span<std::pair<Entity, ScriptState *>>>> tasks;
+        std::vector<sp::AsyncPtr<void>> pending;
+        for (size_t wave = 0; wave < waveCount; wave++) {
+            ZoneScopedN("ScriptWave");
+            ZoneValue(wave);
+            tasks.clear();
+            for (auto &group : groups) {
+                if (group.wave != wave) continue;
+                std::span<std::pair<Entity, ScriptState *>> scripts = group.scripts;
+                if (group.lockGroup->CanSplit()) {
+                    // Read-only scripts that don't use events can't observe each other, so they can be split
+                    for (size_t offset = 0; offset < scripts.size(); offset += chunkSize) {
+                        tasks.emplace_back(group.lockGroup,
+                            scripts.subspan(offset, std::min(chunkSize, scripts.size() - offset)));
+                    }
+                } else {
+                    tasks.emplace_back(group.lockGroup, scripts);
+                }
+            }
+
+            // Run the last task on this thread while the workers process the rest
+            pending.clear();
+            for (size_t i = 0; i + 1 < tasks.size(); i++) {
+                auto &[lockGroup, scripts] = tasks[i];
+                if (workQueue) {
+                    pending.emplace_back(workQueue->Dispatch<void>([lockGroup, scripts, &interval]() {
+                        lockGroup->RunOnTick(scripts, interval);
+                    }));
+                } else {
+                    lockGroup->RunOnTick(scripts, interval);
+                }
+            }
+            tasks.back().first->RunOnTick(tasks.back().second, interval);
+            for (auto &result : pending) {
+                result->Get();
+            }
+        }
+    }
+
     void ScriptManager::RunOnPhysicsUpdate(const PhysicsUpdateLock &lock, const chrono_clock::duration &interval) {
         ZoneScoped;
         std::shared_lock l(mutexes[ScriptCallbackIndex<OnPhysicsUpdateFunc>()]);
@@ -3,15 +3,18 @@
 #include "core/Common.hh"
 #include "core/LockFreeMutex.hh"
 #include "core/Logging.hh"
+#include "core/StringAtom.hh"
 #include "ecs/Ecs.hh"
 #include "ecs/SignalRef.hh"
 
 #include <any>
+#include <bitset>
 #include <deque>
 #include <functional>
 #include <limits>
 #include <map>
 #include <memory>
+#include <span>
 #include <variant>
 
 namespace sp {
@@ -50,13 +53,80 @@ namespace ecs {
         virtual const void *Access(const ScriptState &state) const = 0;
     };
 
+    namespace detail {
+        template<typename, typename>
+        struct lock_permissions {};
+        template<typename LockType, typename... Tn>
+        struct lock_permissions<LockType, Tecs::ECS<Tn...>> {
+            static constexpr std::array<bool, sizeof...(Tn)> read = {Tecs::is_read_allowed<Tn, LockType>()...};
+            static constexpr std::array<bool, sizeof...(Tn)> write = {Tecs::is_write_allowed<Tn, LockType>()...};
+        };
+    } // namespace detail
+
+    /**
+     * OnTick scripts that declare a narrower lock than WriteAll are grouped by script type.
+     * Each group runs in its own transaction, and groups with non-conflicting permissions run in parallel.
+     */
+    struct ScriptLockGroupBase {
+        using ComponentSet = std::bitset<std::tuple_size_v<FlatEntity>>;
+
+        ComponentSet readPermissions, writePermissions;
+        bool addRemove = false;
+        // Set if the lock can send or poll events (Read<EventInput>).
+        // Event visibility is based on transaction order, so these groups must run in a single transaction,
+        // and are ordered with respect to each other to keep same-tick event delivery deterministic.
+        bool usesEvents = false;
+
+        bool IsReadOnly() const {
+            return !addRemove && writePermissions.none();
+        }
+
+        // Scripts in a group can only be split across transactions if they can't observe each other's changes
+        bool CanSplit() const {
+            return IsReadOnly() && !usesEvents;
+        }
+
+        bool Conflicts(const ScriptLockGroupBase &other) const {
+            if (addRemove || other.addRemove) return true;
+            if (usesEvents && other.usesEvents) return true;
+            return (writePermissions & (other.readPermissions | other.writePermissions)).any() ||
+                   (other.writePermissions & readPermissions).any();
+        }
+
+        // Starts a transaction with the group's permissions and runs each script in order
+        virtual void RunOnTick(std::span<std::pair<Entity, ScriptState *>> scripts,
+            const chrono_clock::duration &interval) const = 0;
+    };
+
+    template<typename LockType>
+    struct ScriptLockGroup {};
+
+    template<typename... Permissions>
+    struct ScriptLockGroup<Lock<Permissions...>> : public ScriptLockGroupBase {
+        ScriptLockGroup() {
+            using LockPermissions = detail::lock_permissions<Lock<Permissions...>, ECS>;
+            for (size_t i = 0; i < LockPermissions::read.size(); i++) {
+                readPermissions[i] = LockPermissions::read[i];
+                writePermissions[i] = LockPermissions::write[i];
+            }
+            addRemove = Tecs::is_add_remove_allowed<Lock<Permissions...>>();
+            usesEvents = Tecs::is_read_allowed<EventInput, Lock<Permissions...>>();
+        }
+
+        Lock<Permissions...> StartTransaction() const {
+            return World().StartTransaction<Permissions...>();
+        }
+    };
+
     struct ScriptDefinition {
         std::string name;
-        std::vector<std::string> events;
+        std::vector<sp::StringAtom> events;
         bool filterOnEvent = false;
         const InternalScriptBase *context = nullptr;
         std::optional<ScriptInitFunc> initFunc;
         ScriptCallback callback;
+        // If set, this OnTick script is run by RunOnTickParallel() instead of in the WriteAll transaction
+        const ScriptLockGroupBase *lockGroup = nullptr;
     };
 
     struct ScriptDefinitions {
@@ -157,6 +227,8 @@ namespace ecs {
         void RegisterEvents(const Lock<Read<Name, Scripts>, Write<EventInput>> &lock);
         void RegisterEvents(const Lock<Read<Name, Scripts>, Write<EventInput>> &lock, const Entity &ent);
         void RunOnTick(const Lock<WriteAll> &Lock, const chrono_clock::duration &interval);
+        // Runs OnTick scripts with a declared lock group, should be called after RunOnTick() outside of any transaction
+        void RunOnTickParallel(const chrono_clock::duration &interval);
         void RunOnPhysicsUpdate(const PhysicsUpdateLock &lock, const chrono_clock::duration &interval);
 
         // RunPrefabs should only be run from the SceneManager thread
@@ -167,6 +239,8 @@ namespace ecs {
             const Entity &ent,
             const ScriptState &state) const;
 
+        std::unique_ptr<sp::DispatchQueue> workQueue;
+
         std::deque<EventQueue> eventQueues;
         std::deque<std::pair<Entity, ScriptState>> onTickScripts;
         std::deque<std::pair<Entity, ScriptState>> onPhysicsUpdateScripts;
@@ -0,0 +1,264 @@
+#include "SignalBatch.hh"
+
+#include "core/Common.hh"
+#include "core/Hashing.hh"
+#include "core/Logging.hh"
+#include "core/Tracing.hh"
+#include "ecs/EcsImpl.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <optional>
+
+namespace ecs {
+    using Instruction = SignalExpression::Instruction;
+    using Opcode = Instruction::Opcode;
+
+    // Registers, jump targets and expression indexes are all stored in 16-bit instruction fields
+    static const size_t MAX_BATCH_INDEX = std::numeric_limits<uint16_t>::max();
+
+    struct instructionKey {
+        Opcode opcode = Opcode::Constant;
+        uint64_t payload = 0;
+        uint16_t inputA = 0;
+        uint16_t inputB = 0;
+
+        bool operator==(const instructionKey &) const = default;
+    };
+
+    struct instructionKeyHash {
+        size_t operator()(const instructionKey &key) const {
+            size_t hash = (size_t)key.opcode;
+            sp::hash_combine(hash, key.payload);
+            sp::hash_combine(hash, key.inputA);
+            sp::hash_combine(hash, key.inputB);
+            return hash;
+        }
+    };
+
+    template<typename T>
+    static uint64_t payloadBits(const T &value) {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &value, std::min(sizeof(value), sizeof(bits)));
+        return bits;
+    }
+
+    static bool hasBranches(const SignalExpression &expr) {
+        return std::any_of(expr.program.begin(), expr.program.end(), [](auto &inst) {
+            return inst.opcode == Opcode::JumpIfFalse || inst.opcode == Opcode::JumpIfUnfocused ||
+                   inst.opcode == Opcode::Jump;
+        });
+    }
+
+    // Merges expression programs into one, sharing instructions that compute the same value
+    struct batchBuilder {
+        std::vector<Instruction> &program;
+        size_t registerCount = 0;
+        robin_hood::unordered_flat_map<instructionKey, uint16_t, instructionKeyHash> sharedRegisters;
+        robin_hood::unordered_flat_map<SignalRef, uint16_t> signalRegisters;
+
+        batchBuilder(std::vector<Instruction> &program) : program(program) {}
+
+        // Returns the expression's result register, or nothing if the batch has run out of registers
+        std::optional<uint16_t> Append(const SignalExpression &expr, size_t exprIndex) {
+            if (expr.program.empty() || exprIndex > MAX_BATCH_INDEX) return {};
+            if (registerCount + expr.nodes.size() > MAX_BATCH_INDEX + 1) return {};
+            if (program.size() + expr.program.size() > MAX_BATCH_INDEX) return {};
+
+            if (hasBranches(expr)) return appendRelocated(expr, exprIndex);
+
+            // Maps the expression's registers to batch registers
+            std::vector<uint16_t> local(expr.nodes.size());
+            for (auto &inst : expr.program) {
+                instructionKey key;
+                key.opcode = inst.opcode;
+                switch (inst.opcode) {
+                case Opcode::Constant:
+                    key.payload = payloadBits(inst.value);
+                    break;
+                case Opcode::Load: {
+                    auto *signalNode = std::get_if<SignalExpression::SignalNode>(&expr.nodes[inst.inputA]);
+                    if (signalNode && signalNode->signal) {
+                        auto existing = signalRegisters.find(signalNode->signal);
+                        if (existing != signalRegisters.end()) {
+                            local[inst.dst] = existing->second;
+                        } else {
+                            local[inst.dst] = emitLoad(inst, exprIndex);
+                            signalRegisters.emplace(signalNode->signal, local[inst.dst]);
+                        }
+                    } else {
+                        // Component and event input reads aren't shared between expressions
+                        local[inst.dst] = emitLoad(inst, exprIndex);
+                    }
+                    continue;
+                }
+                case Opcode::Move:
+                    local[inst.dst] = local[inst.inputA];
+                    continue;
+                case Opcode::OneInput:
+                    key.payload = payloadBits(inst.evaluateOne);
+                    key.inputA = local[inst.inputA];
+                    break;
+                case Opcode::TwoInput:
+                    key.payload = payloadBits(inst.evaluateTwo);
+                    key.inputA = local[inst.inputA];
+                    key.inputB = local[inst.inputB];
+                    break;
+                default:
+                    Abortf("Unexpected branch instruction in signal expression: %s", expr.expr);
+                }
+
+                auto existing = sharedRegisters.find(key);
+                if (existing != sharedRegisters.end()) {
+                    local[inst.dst] = existing->second;
+                    continue;
+                }
+                auto &merged = program.emplace_back(inst);
+                merged.dst = (uint16_t)registerCount++;
+                merged.inputA = key.inputA;
+                merged.inputB = key.inputB;
+                local[inst.dst] = merged.dst;
+                sharedRegisters.emplace(key, merged.dst);
+            }
+            return local[expr.programResult];
+        }
+
+    private:
+        uint16_t emitLoad(const Instruction &inst, size_t exprIndex) {
+            auto &load = program.emplace_back(inst);
+            load.dst = (uint16_t)registerCount++;
+            load.inputB = (uint16_t)exprIndex;
+            return load.dst;
+        }
+
+        // Copies the program with its own registers, offsetting jump targets to its position in the batch
+        uint16_t appendRelocated(const SignalExpression &expr, size_t exprIndex) {
+            uint16_t base = (uint16_t)registerCount;
+            uint16_t start = (uint16_t)program.size();
+            registerCount += expr.nodes.size();
+
+            for (auto &inst : expr.program) {
+                auto &merged = program.emplace_back(inst);
+                merged.dst += base;
+                switch (inst.opcode) {
+                case Opcode::Load:
+                    merged.inputB = (uint16_t)exprIndex;
+                    break;
+                case Opcode::TwoInput:
+                    merged.inputA += base;
+                    merged.inputB += base;
+                    break;
+                case Opcode::Move:
+                case Opcode::OneInput:
+                    merged.inputA += base;
+                    break;
+                case Opcode::JumpIfFalse:
+                    merged.inputA += base;
+                    merged.target += start;
+                    break;
+                case Opcode::JumpIfUnfocused:
+                case Opcode::Jump:
+                    merged.target += start;
+                    break;
+                case Opcode::Constant:
+                    break;
+                }
+            }
+            return base + expr.programResult;
+        }
+    };
+
+    size_t SignalBatch::Add(const SignalExpression &expr) {
+        compiled = false;
+        expressions.emplace_back(expr);
+        return expressions.size() - 1;
+    }
+
+    void SignalBatch::Clear() {
+        expressions.clear();
+        program.clear();
+        outputRegisters.clear();
+        fallbackExpressions.clear();
+        registerCount = 0;
+        compiled = false;
+    }
+
+    void SignalBatch::Compile() {
+        ZoneScoped;
+        program.clear();
+        outputRegisters.assign(expressions.size(), 0);
+        fallbackExpressions.clear();
+
+        batchBuilder builder(program);
+        for (size_t i = 0; i < expressions.size(); i++) {
+            auto result = builder.Append(expressions[i], i);
+            if (result) {
+                outputRegisters[i] = *result;
+            } else {
+                fallbackExpressions.emplace_back(i);
+            }
+        }
+        registerCount = builder.registerCount;
+        compiled = true;
+    }
+
+    void SignalBatch::Evaluate(const DynamicLock<ReadSignalsLock> &lock, std::vector<double> &output) {
+        ZoneScoped;
+        if (!compiled) Compile();
+        output.resize(expressions.size());
+        registers.resize(registerCount);
+
+        static const EventData noInput = 0.0;
+        SignalExpression::Storage cache;
+        const Instruction *instructions = program.data();
+        const size_t programSize = program.size();
+        size_t pc = 0;
+        while (pc < programSize) {
+            auto &inst = instructions[pc++];
+            switch (inst.opcode) {
+            case Opcode::Constant:
+                registers[inst.dst] = inst.value;
+                break;
+            case Opcode::Load: {
+                auto &expr = expressions[inst.inputB];
+                SignalExpression::Context ctx(lock, expr, cache, noInput);
+                registers[inst.dst] = inst.load(ctx, expr.nodes[inst.inputA], 0);
+                break;
+            }
+            case Opcode::Move:
+                registers[inst.dst] = registers[inst.inputA];
+                break;
+            case Opcode::OneInput:
+                registers[inst.dst] = inst.evaluateOne(registers[inst.inputA]);
+                break;
+            case Opcode::TwoInput:
+                registers[inst.dst] = inst.evaluateTwo(registers[inst.inputA], registers[inst.inputB]);
+                break;
+            case Opcode::JumpIfFalse:
+                if (!(registers[inst.inputA] >= 0.5)) pc = inst.target;
+                break;
+            case Opcode::JumpIfUnfocused:
+                SignalExpression::untrackedReads++;
+                if (!lock.Has<FocusLock>() || !lock.Get<FocusLock>().HasPrimaryFocus(inst.focus)) {
+                    registers[inst.dst] = 0.0;
+                    pc = inst.target;
+                }
+                break;
+            case Opcode::Jump:
+                pc = inst.target;
+                break;
+            }
+        }
+
+        auto fallback = fallbackExpressions.begin();
+        for (size_t i = 0; i < expressions.size(); i++) {
+            if (fallback != fallbackExpressions.end() && *fallback == i) {
+                output[i] = expressions[i].Evaluate(lock);
+                fallback++;
+            } else {
+                output[i] = registers[outputRegisters[i]];
+            }
+        }
+    }
+} // namespace ecs
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "ecs/Ecs.hh"
+#include "ecs/SignalExpression.hh"
+#include "ecs/SignalRef.hh"
+
+#include <vector>
+
+namespace ecs {
+    /**
+     * Evaluates a set of independent signal expressions in one pass, writing results into a contiguous array.
+     *
+     * The compiled programs of every expression are merged into a single register program. Instructions are
+     * deduplicated across the whole batch, so a signal read by many expressions is only looked up once, and any
+     * sub-expression shared between them (e.g. "a + b" in both "a + b" and "(a + b) * 2") is only computed once.
+     *
+     * Expressions with branches (?: or if_focused) are appended with their own registers, since a value computed
+     * inside a branch may not exist for the rest of the batch. Their loads and operations are not shared.
+     */
+    class SignalBatch {
+    public:
+        SignalBatch() {}
+
+        // Returns the index of the expression's result in the Evaluate() output.
+        size_t Add(const SignalExpression &expr);
+        void Clear();
+
+        size_t Size() const {
+            return expressions.size();
+        }
+
+        const SignalExpression &Get(size_t index) const {
+            return expressions[index];
+        }
+
+        // Merges the expressions into a single program. Called automatically by Evaluate() after expressions change.
+        void Compile();
+
+        // The number of instructions run by Evaluate() for the merged expressions
+        size_t ProgramSize() const {
+            return program.size();
+        }
+
+        // Output is resized to Size(), and results are stored in the order expressions were added.
+        void Evaluate(const DynamicLock<ReadSignalsLock> &lock, std::vector<double> &output);
+
+    private:
+        std::vector<SignalExpression> expressions;
+        bool compiled = false;
+
+        // Merged program, Load instructions store the index of their expression in inputB
+        std::vector<SignalExpression::Instruction> program;
+        // Per expression: the register holding its result
+        std::vector<uint16_t> outputRegisters;
+        // Expressions that couldn't be merged are evaluated individually, in ascending order
+        std::vector<size_t> fallbackExpressions;
+        size_t registerCount = 0;
+
+        // Scratch storage reused between evaluations
+        std::vector<double> registers;
+    };
+} // namespace ecs
@@ -666,6 +666,8 @@ namespace ecs {
         this->rootIndex = nodes.size();
         this->nodes.emplace_back(SignalNode{signal}, 0, 0, this->rootIndex);
         this->nodeStrings.emplace_back(expr);
+        this->nodes[rootIndex].compile(*this, false);
+        compileProgram();
     }
 
     SignalExpression::SignalExpression(std::string_view expr, const Name &scope) : scope(scope), expr(expr) {
@@ -707,6 +709,7 @@ namespace ecs {
         // Parse the expression into a deduplicated tree of nodes
         nodes.clear();
         nodeStrings.clear();
+        program.clear();
         size_t tokenIndex = 0;
         rootIndex = parseNode(tokenIndex);
         if (rootIndex < 0) {
@@ -728,9 +731,181 @@ namespace ecs {
         // Compile the parsed expression tree into a lambda function
         nodes[rootIndex].compile(*this, false);
         Assertf(nodes[rootIndex].evaluate, "Failed to compile expression: %s", expr);
+
+        // Lower the tree into a flat register program for evaluation
+        compileProgram();
         return true;
     }
 
+    void SignalExpression::compileProgram() {
+        program.clear();
+        programResult = 0;
+        if (rootIndex < 0 || rootIndex >= nodes.size()) return;
+
+        // Node inputs always have a lower index than the node itself, so constants can be folded in a single pass
+        std::vector<std::optional<double>> constants(nodes.size());
+        for (size_t i = 0; i < nodes.size(); i++) {
+            constants[i] = std::visit(
+                [&](auto &node) -> std::optional<double> {
+                    using T = std::decay_t<decltype(node)>;
+                    if constexpr (std::is_same_v<T, SignalExpression::ConstantNode>) {
+                        return node.value;
+                    } else if constexpr (std::is_same_v<T, SignalExpression::OneInputOperation>) {
+                        auto &input = constants[node.inputIndex];
+                        if (input) return node.evaluate(*input);
+                    } else if constexpr (std::is_same_v<T, SignalExpression::TwoInputOperation>) {
+                        auto &inputA = constants[node.inputIndexA];
+                        auto &inputB = constants[node.inputIndexB];
+                        if (inputA && inputB) return node.evaluate(*inputA, *inputB);
+                    } else if constexpr (std::is_same_v<T, SignalExpression::DeciderOperation>) {
+                        auto &condition = constants[node.ifIndex];
+                        if (condition) return *condition >= 0.5 ? constants[node.trueIndex] : constants[node.falseIndex];
+                    }
+                    return {};
+                },
+                (const SignalExpression::NodeVariant &)nodes[i]);
+        }
+
+        std::vector<bool> emitted(nodes.size());
+        programResult = emitInstructions(rootIndex, emitted, constants);
+        if (program.size() > std::numeric_limits<uint16_t>::max()) {
+            Warnf("Signal expression program too large, falling back to tree evaluation: %s", expr);
+            program.clear();
+            programResult = 0;
+        }
+    }
+
+    uint16_t SignalExpression::emitInstructions(int index,
+        std::vector<bool> &emitted,
+        const std::vector<std::optional<double>> &constants) {
+        using Opcode = Instruction::Opcode;
+
+        uint16_t dst = (uint16_t)index;
+        if (emitted[index]) return dst;
+        emitted[index] = true;
+
+        if (constants[index]) {
+            auto &inst = program.emplace_back(Opcode::Constant, dst);
+            inst.value = *constants[index];
+            return dst;
+        }
+
+        std::visit(
+            [&](auto &node) {
+                using T = std::decay_t<decltype(node)>;
+                if constexpr (std::is_same_v<T, SignalExpression::IdentifierNode> ||
+                              std::is_same_v<T, SignalExpression::SignalNode> ||
+                              std::is_same_v<T, SignalExpression::ComponentNode>) {
+                    auto &inst = program.emplace_back(Opcode::Load, dst);
+                    inst.inputA = dst;
+                    inst.load = &T::Evaluate;
+                } else if constexpr (std::is_same_v<T, SignalExpression::FocusCondition>) {
+                    size_t testIndex = program.size();
+                    program.emplace_back(Opcode::JumpIfUnfocused, dst).focus = node.ifFocused;
+                    if (node.inputIndex < 0) {
+                        program.emplace_back(Opcode::Constant, dst).value = 1.0;
+                    } else {
+                        // Nodes emitted inside a branch can't be reused after it
+                        auto outerEmitted = emitted;
+                        uint16_t input = emitInstructions(node.inputIndex, emitted, constants);
+                        program.emplace_back(Opcode::Move, dst).inputA = input;
+                        emitted = outerEmitted;
+                    }
+                    program[testIndex].target = (uint16_t)program.size();
+                } else if constexpr (std::is_same_v<T, SignalExpression::OneInputOperation>) {
+                    uint16_t input = emitInstructions(node.inputIndex, emitted, constants);
+                    auto &inst = program.emplace_back(Opcode::OneInput, dst);
+                    inst.inputA = input;
+                    inst.evaluateOne = node.evaluate;
+                } else if constexpr (std::is_same_v<T, SignalExpression::TwoInputOperation>) {
+                    uint16_t inputA = emitInstructions(node.inputIndexA, emitted, constants);
+                    uint16_t inputB = emitInstructions(node.inputIndexB, emitted, constants);
+                    auto &inst = program.emplace_back(Opcode::TwoInput, dst);
+                    inst.inputA = inputA;
+                    inst.inputB = inputB;
+                    inst.evaluateTwo = node.evaluate;
+                } else if constexpr (std::is_same_v<T, SignalExpression::DeciderOperation>) {
+                    auto &condition = constants[node.ifIndex];
+                    if (condition) {
+                        // Only the taken branch of a constant condition is emitted
+                        int branchIndex = *condition >= 0.5 ? node.trueIndex : node.falseIndex;
+                        uint16_t input = emitInstructions(branchIndex, emitted, constants);
+                        program.emplace_back(Opcode::Move, dst).inputA = input;
+                        return;
+                    }
+
+                    uint16_t ifInput = emitInstructions(node.ifIndex, emitted, constants);
+                    size_t jumpFalseIndex = program.size();
+                    program.emplace_back(Opcode::JumpIfFalse, dst).inputA = ifInput;
+
+                    // Nodes emitted inside a branch can't be reused after it
+                    auto outerEmitted = emitted;
+                    uint16_t trueInput = emitInstructions(node.trueIndex, emitted, constants);
+                    program.emplace_back(Opcode::Move, dst).inputA = trueInput;
+                    emitted = outerEmitted;
+
+                    size_t jumpEndIndex = program.size();
+                    program.emplace_back(Opcode::Jump, dst);
+                    program[jumpFalseIndex].target = (uint16_t)program.size();
+
+                    uint16_t falseInput = emitInstructions(node.falseIndex, emitted, constants);
+                    program.emplace_back(Opcode::Move, dst).inputA = falseInput;
+                    emitted = outerEmitted;
+
+                    program[jumpEndIndex].target = (uint16_t)program.size();
+                } else {
+                    Abortf("Unexpected non-constant signal expression node: %s", typeid(T).name());
+                }
+            },
+            (SignalExpression::NodeVariant &)nodes[index]);
+        return dst;
+    }
+
+    double SignalExpression::evaluateProgram(const Context &ctx, size_t depth) const {
+        using Opcode = Instruction::Opcode;
+
+        auto &registers = ctx.cache;
+        const Instruction *instructions = program.data();
+        const size_t programSize = program.size();
+        size_t pc = 0;
+        while (pc < programSize) {
+            auto &inst = instructions[pc++];
+            switch (inst.opcode) {
+            case Opcode::Constant:
+                registers[inst.dst] = inst.value;
+                break;
+            case Opcode::Load:
+                registers[inst.dst] = inst.load(ctx, nodes[inst.inputA], depth);
+                break;
+            case Opcode::Move:
+                registers[inst.dst] = registers[inst.inputA];
+                break;
+            case Opcode::OneInput:
+                registers[inst.dst] = inst.evaluateOne(registers[inst.inputA]);
+                break;
+            case Opcode::TwoInput:
+                registers[inst.dst] = inst.evaluateTwo(registers[inst.inputA], registers[inst.inputB]);
+                break;
+            case Opcode::JumpIfFalse:
+                if (!(registers[inst.inputA] >= 0.5)) pc = inst.target;
+                break;
+            case Opcode::JumpIfUnfocused:
+                untrackedReads++;
+                if (!ctx.lock.Has<FocusLock>() || !ctx.lock.Get<FocusLock>().HasPrimaryFocus(inst.focus)) {
+                    registers[inst.dst] = 0.0;
+                    pc = inst.target;
+                }
+                break;
+            case Opcode::Jump:
+                pc = inst.target;
+                break;
+            }
+        }
+        return registers[programResult];
+    }
+
+    thread_local size_t SignalExpression::untrackedReads = 0;
+
     double cacheLookup(const SignalExpression::Context &ctx, const SignalExpression::Node &node, size_t depth) {
         return ctx.cache[node.index];
     }
@@ -780,6 +955,7 @@ namespace ecs {
     double SignalExpression::IdentifierNode::Evaluate(const Context &ctx, const Node &node, size_t depth) {
         // ZoneScoped;
         auto &identNode = std::get<SignalExpression::IdentifierNode>(node);
+        untrackedReads++;
         if (identNode.field.type != typeid(EventData)) {
             Warnf("SignalExpression can't convert %s from %s to EventData",
                 ctx.expr.nodeStrings[node.index],
@@ -794,6 +970,7 @@ namespace ecs {
         auto &signalNode = std::get<SignalExpression::SignalNode>(node);
         if (depth >= MAX_SIGNAL_BINDING_DEPTH) {
             Errorf("Max signal binding depth exceeded: %s -> %s", ctx.expr.expr, signalNode.signal.String());
+            untrackedReads++;
             return 0.0;
         }
         return signalNode.signal.GetSignal(ctx.lock, depth + 1);
@@ -803,6 +980,7 @@ namespace ecs {
         // ZoneScoped;
         auto &componentNode = std::get<SignalExpression::ComponentNode>(node);
         if (!componentNode.component) return 0.0;
+        untrackedReads++;
         Entity ent = componentNode.entity.Get(ctx.lock);
         if (!ent) return 0.0;
         return GetFieldType(componentNode.component->metadata.type, [&](auto *typePtr) {
@@ -831,6 +1009,7 @@ namespace ecs {
     double SignalExpression::FocusCondition::Evaluate(const Context &ctx, const Node &node, size_t depth) {
         // ZoneScoped;
         auto &focusNode = std::get<SignalExpression::FocusCondition>(node);
+        untrackedReads++;
         if (!ctx.lock.Has<FocusLock>() || !ctx.lock.Get<FocusLock>().HasPrimaryFocus(focusNode.ifFocused)) {
             return 0.0;
         } else if (focusNode.inputIndex < 0) {
@@ -915,6 +1094,15 @@ namespace ecs {
     double SignalExpression::Evaluate(const DynamicLock<ReadSignalsLock> &lock, size_t depth) const {
         // ZoneScoped;
         // ZoneStr(expr);
+        if (rootIndex < 0 || rootIndex >= nodes.size()) return 0.0;
+        Storage cache;
+        Context ctx(lock, *this, cache, 0.0);
+        if (!program.empty()) return evaluateProgram(ctx, depth);
+        auto &rootNode = nodes[rootIndex];
+        return rootNode.evaluate(ctx, rootNode, depth);
+    }
+
+    double SignalExpression::EvaluateTree(const DynamicLock<ReadSignalsLock> &lock, size_t depth) const {
         if (rootIndex < 0 || rootIndex >= nodes.size()) return 0.0;
         Storage cache;
         auto &rootNode = nodes[rootIndex];
@@ -927,8 +1115,9 @@ namespace ecs {
         // ZoneStr(expr);
         if (rootIndex < 0 || rootIndex >= nodes.size()) return 0.0;
         Storage cache;
-        auto &rootNode = nodes[rootIndex];
         Context ctx(lock, *this, cache, input);
+        if (!program.empty()) return evaluateProgram(ctx, 0);
+        auto &rootNode = nodes[rootIndex];
         return rootNode.evaluate(ctx, rootNode, 0);
     }
 
@@ -8,6 +8,7 @@
 
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <variant>
 
@@ -24,7 +25,7 @@ namespace ecs {
 
         SignalExpression(const SignalExpression &other)
             : scope(other.scope), expr(other.expr), nodes(other.nodes), nodeStrings(other.nodeStrings),
-              rootIndex(other.rootIndex) {}
+              rootIndex(other.rootIndex), program(other.program), programResult(other.programResult) {}
 
         struct Node;
         using Storage = std::array<double, MAX_SIGNAL_EXPRESSION_NODES>;
@@ -128,6 +129,37 @@ namespace ecs {
             CompiledFunc compile(SignalExpression &expr, bool noCacheWrite);
         };
 
+        // Flat register program lowered from the node tree by Compile() and evaluated in a single loop.
+        // Each node writes its result to the register matching its node index. Branches (?: and if_focused)
+        // become forward jumps so only the taken side is evaluated, and constant subtrees are folded.
+        struct Instruction {
+            enum class Opcode : uint8_t {
+                Constant, // dst = value
+                Load, // dst = load(nodes[inputA]) for nodes reading signals, components, or event input
+                Move, // dst = inputA
+                OneInput, // dst = evaluateOne(inputA)
+                TwoInput, // dst = evaluateTwo(inputA, inputB)
+                JumpIfFalse, // if !(inputA >= 0.5) jump to target
+                JumpIfUnfocused, // if focus layer is not active: dst = 0, jump to target
+                Jump, // jump to target
+            };
+
+            Opcode opcode = Opcode::Constant;
+            uint16_t dst = 0;
+            uint16_t inputA = 0;
+            uint16_t inputB = 0;
+            uint16_t target = 0;
+            union {
+                double value = 0.0;
+                CompiledFunc load;
+                double (*evaluateOne)(double);
+                double (*evaluateTwo)(double, double);
+                FocusLayer focus;
+            };
+
+            Instruction(Opcode opcode, uint16_t dst) : opcode(opcode), dst(dst) {}
+        };
+
         // Called automatically by constructor. Should be called when expression string is changed.
         bool Compile();
 
@@ -145,6 +177,10 @@ namespace ecs {
         double Evaluate(const DynamicLock<ReadSignalsLock> &lock, size_t depth = 0) const;
         double EvaluateEvent(const DynamicLock<ReadSignalsLock> &lock, const EventData &input) const;
 
+        // Evaluates the closure tree directly instead of the compiled program.
+        // Kept as a reference implementation for testing and benchmarking.
+        double EvaluateTree(const DynamicLock<ReadSignalsLock> &lock, size_t depth = 0) const;
+
         bool operator==(const SignalExpression &other) const {
             return expr == other.expr && scope == other.scope;
         }
@@ -163,17 +199,32 @@ namespace ecs {
 
         void SetScope(const EntityScope &scope);
 
+        // Incremented on the evaluating thread whenever a result depends on state outside the signal dependency
+        // graph (component fields, focus, event input, or a binding depth overflow).
+        // SignalRef::GetSignal() only memoizes a binding if this counter did not change during its evaluation.
+        static thread_local size_t untrackedReads;
+
         EntityScope scope;
         std::string expr;
         std::vector<Node> nodes;
         std::vector<std::string> nodeStrings;
         int rootIndex = -1;
 
+        // Empty if the program could not be generated, in which case the closure tree is evaluated instead.
+        std::vector<Instruction> program;
+        uint16_t programResult = 0;
+
     private:
         std::string joinTokens(size_t startToken, size_t endToken) const;
         int deduplicateNode(int index);
         int parseNode(size_t &tokenIndex, uint8_t precedence = '\x0');
 
+        void compileProgram();
+        uint16_t emitInstructions(int index,
+            std::vector<bool> &emitted,
+            const std::vector<std::optional<double>> &constants);
+        double evaluateProgram(const Context &ctx, size_t depth) const;
+
         bool canEvaluate(const DynamicLock<ReadSignalsLock> &lock, size_t depth) const;
 
         std::vector<std::string_view> tokens; // string_views into expr
@@ -3,6 +3,7 @@
 #include "ecs/EcsImpl.hh"
 #include "ecs/SignalRef.hh"
 
+#include <algorithm>
 #include <mutex>
 #include <shared_mutex>
 
@@ -27,7 +28,7 @@ namespace ecs {
         return ref;
     }
 
-    SignalRef SignalManager::GetRef(const EntityRef &entity, const std::string_view &signalName) {
+    SignalRef SignalManager::GetRef(const EntityRef &entity, const sp::StringAtom &signalName) {
         return GetRef(SignalKey{entity, signalName});
     }
 
@@ -37,11 +38,70 @@ namespace ecs {
 
     void SignalManager::ClearEntity(const Lock<Write<Signals>> &lock, const EntityRef &entity) {
         auto &signals = lock.Get<Signals>();
+        std::vector<SignalRef> clearedRefs;
         for (auto &signal : signals.signals) {
             if (signal.ref == entity) {
+                clearedRefs.emplace_back(signal.ref);
+                RemoveDependencies(lock, signal.ref, signal.expr);
                 signal = Signals::Signal();
             }
         }
+        for (auto &ref : clearedRefs) {
+            MarkDirty(lock, ref);
+        }
+    }
+
+    void SignalManager::AddDependencies(const Lock<Write<Signals>> &lock,
+        const SignalRef &ref,
+        const SignalExpression &expr) {
+        auto &signals = lock.Get<Signals>();
+        for (auto &node : expr.nodes) {
+            auto *signalNode = std::get_if<SignalExpression::SignalNode>(&node);
+            if (!signalNode || !signalNode->signal) continue;
+
+            auto &list = signals.subscribers[signalNode->signal];
+            if (std::find(list.begin(), list.end(), ref) == list.end()) list.emplace_back(ref);
+        }
+    }
+
+    void SignalManager::RemoveDependencies(const Lock<Write<Signals>> &lock,
+        const SignalRef &ref,
+        const SignalExpression &expr) {
+        auto &signals = lock.Get<Signals>();
+        for (auto &node : expr.nodes) {
+            auto *signalNode = std::get_if<SignalExpression::SignalNode>(&node);
+            if (!signalNode || !signalNode->signal) continue;
+
+            auto it = signals.subscribers.find(signalNode->signal);
+            if (it == signals.subscribers.end()) continue;
+            auto &list = it->second;
+            list.erase(std::remove(list.begin(), list.end(), ref), list.end());
+            if (list.empty()) signals.subscribers.erase(it);
+        }
+    }
+
+    void SignalManager::MarkDirty(const Lock<Write<Signals>> &lock, const SignalRef &ref) {
+        auto &signals = lock.Get<Signals>();
+        if (signals.subscribers.empty()) return;
+
+        // Walk the full graph instead of stopping at already dirty nodes, since memoized values are written by
+        // concurrent readers and may be observed in any order. The visited set guards against binding cycles.
+        robin_hood::unordered_flat_set<SignalRef> visited;
+        std::vector<SignalRef> pending = {ref};
+        while (!pending.empty()) {
+            SignalRef current = pending.back();
+            pending.pop_back();
+
+            auto it = signals.subscribers.find(current);
+            if (it == signals.subscribers.end()) continue;
+            for (auto &subscriber : it->second) {
+                if (!visited.emplace(subscriber).second) continue;
+
+                size_t index = subscriber.GetIndex(lock);
+                if (index < signals.signals.size()) signals.signals[index].cacheValid = false;
+                pending.emplace_back(subscriber);
+            }
+        }
     }
 
     std::set<SignalRef> SignalManager::GetSignals(const std::string &search) {
@@ -54,6 +114,15 @@ namespace ecs {
         return results;
     }
 
+    SignalBatch SignalManager::NewBatch(const std::vector<SignalExpression> &expressions) {
+        SignalBatch batch;
+        for (auto &expr : expressions) {
+            batch.Add(expr);
+        }
+        batch.Compile();
+        return batch;
+    }
+
     std::set<SignalRef> SignalManager::GetSignals(const EntityRef &entity) {
         std::set<SignalRef> results;
         signalRefs.ForEach([&](const SignalKey &signal, std::shared_ptr<SignalRef::Ref> &refPtr) {
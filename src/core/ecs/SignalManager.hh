@@ -5,6 +5,7 @@
 #include "core/PreservingMap.hh"
 #include "ecs/Ecs.hh"
 #include "ecs/EntityRef.hh"
+#include "ecs/SignalBatch.hh"
 #include "ecs/SignalRef.hh"
 #include "ecs/components/Name.hh"
 #include "ecs/components/Signals.hh"
@@ -18,9 +19,20 @@ namespace ecs {
         SignalManager() {}
 
         SignalRef GetRef(const SignalKey &signal);
-        SignalRef GetRef(const EntityRef &entity, const std::string_view &signalName);
+        SignalRef GetRef(const EntityRef &entity, const sp::StringAtom &signalName);
         SignalRef GetRef(const std::string_view &str, const EntityScope &scope = Name());
         void ClearEntity(const Lock<Write<Signals>> &lock, const EntityRef &entity);
+
+        // Signal dependency graph maintenance. Edges are derived from the SignalNodes of a binding expression.
+        void AddDependencies(const Lock<Write<Signals>> &lock, const SignalRef &ref, const SignalExpression &expr);
+        void RemoveDependencies(const Lock<Write<Signals>> &lock, const SignalRef &ref, const SignalExpression &expr);
+        // Invalidates memoized values of every binding that transitively depends on ref.
+        void MarkDirty(const Lock<Write<Signals>> &lock, const SignalRef &ref);
+
+        // Compiles expressions into a single batch program, see SignalBatch.hh. Signal reads and sub-expressions
+        // shared between the expressions are only evaluated once, and results are written to a contiguous array.
+        SignalBatch NewBatch(const std::vector<SignalExpression> &expressions);
+
         std::set<SignalRef> GetSignals(const std::string &search = "");
         std::set<SignalRef> GetSignals(const EntityRef &entity);
 
@@ -6,7 +6,7 @@
 #include <limits>
 
 namespace ecs {
-    SignalRef::SignalRef(const EntityRef &ent, const std::string_view &signalName) {
+    SignalRef::SignalRef(const EntityRef &ent, const sp::StringAtom &signalName) {
         if (!ent || signalName.empty()) return;
         ptr = GetSignalManager().GetRef(ent, signalName).ptr;
     }
@@ -43,7 +43,7 @@ namespace ecs {
 
     const std::string &SignalRef::GetSignalName() const {
         static const std::string empty = "";
-        return ptr ? ptr->signal.signalName : empty;
+        return ptr ? ptr->signal.signalName.String() : empty;
     }
 
     std::string SignalRef::String() const {
@@ -69,11 +69,15 @@ namespace ecs {
         size_t &index = GetIndex(lock);
         if (index < signals.signals.size()) {
             auto &signal = signals.signals[index];
-            signal.value = value;
             signal.ref = *this;
+            if (signal.value != value) {
+                signal.value = value;
+                GetSignalManager().MarkDirty(lock, *this);
+            }
             return signal.value;
         } else {
             index = signals.NewSignal(*this, value);
+            GetSignalManager().MarkDirty(lock, *this);
             return signals.signals[index].value;
         }
     }
@@ -85,8 +89,10 @@ namespace ecs {
         if (index >= signals.size()) return; // Noop
 
         auto &signal = signals[index];
+        bool changed = !std::isinf(signal.value);
         signal.value = -std::numeric_limits<double>::infinity();
         if (signal.expr.IsNull()) signal.ref = {};
+        if (changed) GetSignalManager().MarkDirty(lock, *this);
     }
 
     bool SignalRef::HasValue(const Lock<Read<Signals>> &lock) const {
@@ -108,24 +114,29 @@ namespace ecs {
         return signals[index].value;
     }
 
-    SignalExpression &SignalRef::SetBinding(const Lock<Write<Signals>> &lock, const SignalExpression &expr) const {
+    const SignalExpression &SignalRef::SetBinding(const Lock<Write<Signals>> &lock,
+        const SignalExpression &expr) const {
         Assertf(ptr, "SignalRef::SetBinding() called on null SignalRef");
         Assertf(!expr.IsNull(), "SignalRef::SetBinding() called with null SignalExpression");
+        auto &manager = GetSignalManager();
         auto &signals = lock.Get<Signals>();
         size_t &index = GetIndex(lock);
 
         if (index < signals.signals.size()) {
             auto &signal = signals.signals[index];
+            manager.RemoveDependencies(lock, *this, signal.expr);
             signal.expr = expr;
             signal.ref = *this;
-            return signal.expr;
+            signal.cacheValid = false;
         } else {
             index = signals.NewSignal(*this, expr);
-            return signals.signals[index].expr;
         }
+        manager.AddDependencies(lock, *this, expr);
+        manager.MarkDirty(lock, *this);
+        return signals.signals[index].expr;
     }
 
-    SignalExpression &SignalRef::SetBinding(const Lock<Write<Signals>> &lock,
+    const SignalExpression &SignalRef::SetBinding(const Lock<Write<Signals>> &lock,
         const std::string_view &expr,
         const EntityScope &scope) const {
         return SetBinding(lock, SignalExpression{expr, scope});
@@ -138,8 +149,13 @@ namespace ecs {
         if (index >= signals.size()) return; // Noop
 
         auto &signal = signals[index];
+        bool changed = !signal.expr.IsNull();
+        auto &manager = GetSignalManager();
+        manager.RemoveDependencies(lock, *this, signal.expr);
         signal.expr = SignalExpression();
+        signal.cacheValid = false;
         if (std::isinf(signal.value)) signal.ref = {};
+        if (changed) manager.MarkDirty(lock, *this);
     }
 
     bool SignalRef::HasBinding(const Lock<Read<Signals>> &lock) const {
@@ -170,7 +186,18 @@ namespace ecs {
 
         auto &signal = signals[index];
         if (!std::isinf(signal.value)) return signal.value;
-        return signal.expr.Evaluate(lock, depth);
+        if (signal.cacheValid.load(std::memory_order_acquire)) {
+            return signal.cachedValue.load(std::memory_order_relaxed);
+        }
+
+        // Only memoize results that depend purely on other signals, which are tracked by the dependency graph.
+        size_t untrackedReads = SignalExpression::untrackedReads;
+        double value = signal.expr.Evaluate(lock, depth);
+        if (untrackedReads == SignalExpression::untrackedReads) {
+            signal.cachedValue.store(value, std::memory_order_relaxed);
+            signal.cacheValid.store(true, std::memory_order_release);
+        }
+        return value;
     }
 
     bool SignalRef::operator==(const EntityRef &other) const {
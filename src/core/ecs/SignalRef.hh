@@ -1,5 +1,6 @@
 #pragma once
 
+#include "core/StringAtom.hh"
 #include "ecs/Ecs.hh"
 
 #include <memory>
@@ -17,7 +18,7 @@ namespace ecs {
 
     public:
         SignalRef() {}
-        SignalRef(const EntityRef &ent, const std::string_view &signalName);
+        SignalRef(const EntityRef &ent, const sp::StringAtom &signalName);
         SignalRef(const std::string_view &str, const EntityScope &scope = Name());
         SignalRef(const SignalRef &ref) : ptr(ref.ptr) {}
         SignalRef(const std::shared_ptr<Ref> &ptr) : ptr(ptr) {}
@@ -37,8 +38,8 @@ namespace ecs {
         void ClearValue(const Lock<Write<Signals>> &lock) const;
         bool HasValue(const Lock<Read<Signals>> &lock) const;
         const double &GetValue(const Lock<Read<Signals>> &lock) const;
-        SignalExpression &SetBinding(const Lock<Write<Signals>> &lock, const SignalExpression &signal) const;
-        SignalExpression &SetBinding(const Lock<Write<Signals>> &lock,
+        const SignalExpression &SetBinding(const Lock<Write<Signals>> &lock, const SignalExpression &signal) const;
+        const SignalExpression &SetBinding(const Lock<Write<Signals>> &lock,
             const std::string_view &expr,
             const EntityScope &scope = Name()) const;
         void ClearBinding(const Lock<Write<Signals>> &lock) const;
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "core/Common.hh"
+#include "core/StringAtom.hh"
+#include "ecs/Ecs.hh"
+#include "ecs/SignalRef.hh"
+
+#include <array>
+#include <vector>
+
+namespace ecs {
+    /**
+     * Caches resolved SignalRefs for a fixed list of signal names, indexed by entity.
+     *
+     * Constructing a SignalRef from an entity and a name requires an EntityRef lookup and a SignalManager lookup.
+     * Systems that access the same signals on the same entities every frame can own one of these instead, so that
+     * only the first access to each entity resolves its refs. Cached refs are tied to the exact entity id, so
+     * entities that are removed or recreated by a scene reload are resolved again on their next access.
+     *
+     * This cache is not thread-safe and should only be used by the system that owns it.
+     * References returned by Get() are only valid until the next call to Get().
+     *
+     * Example:
+     *   static SignalRefCache colorSignals("color_r", "color_g", "color_b");
+     *   auto &[r, g, b] = colorSignals.Get(ent);
+     */
+    template<size_t N>
+    class SignalRefCache : public sp::NonCopyable {
+    public:
+        using Refs = std::array<SignalRef, N>;
+
+        template<typename... Names>
+        SignalRefCache(const Names &...signalNames) : signalNames{sp::StringAtom(signalNames)...} {
+            static_assert(sizeof...(Names) == N, "SignalRefCache requires exactly N signal names");
+        }
+
+        const Refs &Get(const Entity &ent) {
+            if (!ent) {
+                static const Refs emptyRefs = {};
+                return emptyRefs;
+            }
+            if (ent.index >= entries.size()) entries.resize(ent.index + 1);
+
+            auto &entry = entries[ent.index];
+            if (entry.ent != ent) {
+                entry.ent = ent;
+                for (size_t i = 0; i < N; i++) {
+                    entry.refs[i] = SignalRef(ent, signalNames[i]);
+                }
+            }
+            return entry.refs;
+        }
+
+        const SignalRef &Get(const Entity &ent, size_t signalIndex) {
+            return Get(ent)[signalIndex];
+        }
+
+        void Clear() {
+            entries.clear();
+        }
+
+    private:
+        struct Entry {
+            Entity ent;
+            Refs refs;
+        };
+
+        std::array<sp::StringAtom, N> signalNames;
+        std::vector<Entry> entries;
+    };
+
+    template<typename... Names>
+    SignalRefCache(const Names &...) -> SignalRefCache<sizeof...(Names)>;
+} // namespace ecs
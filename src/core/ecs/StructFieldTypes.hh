@@ -72,7 +72,7 @@ namespace ecs {
         robin_hood::unordered_map<std::string, SignalExpression>,
         robin_hood::unordered_map<std::string, PhysicsJoint>,
         robin_hood::unordered_map<std::string, std::vector<SignalExpression>>,
-        robin_hood::unordered_map<std::string, std::vector<EventBinding>>,
+        robin_hood::unordered_map<sp::StringAtom, std::vector<EventBinding>>,
 
         // Enums
         FocusLayer,
@@ -52,6 +52,48 @@ namespace ecs {
         }
     }
 
+    // Fields that can be copied into a binary scene cache, they are read back without any conversion
+    template<typename T>
+    inline static constexpr bool isBinaryValue() {
+        if constexpr (!has_type<T, FieldTypes>()) {
+            // Component types used as fields may hold references to other data
+            return false;
+        } else if constexpr (std::is_same<T, std::string>() || std::is_same<T, EntityRef>()) {
+            // References are stored by name, the same way they are loaded from JSON
+            return true;
+        } else if constexpr (sp::is_vector<T>()) {
+            return std::is_trivially_copyable<typename T::value_type>();
+        } else {
+            return std::is_trivially_copyable<T>();
+        }
+    }
+
+    static void writeBinary(std::vector<uint8_t> &dst, const void *data, size_t size) {
+        auto *bytes = static_cast<const uint8_t *>(data);
+        dst.insert(dst.end(), bytes, bytes + size);
+    }
+
+    static bool readBinary(std::span<const uint8_t> &src, void *data, size_t size) {
+        if (src.size() < size) return false;
+        if (size > 0) std::memcpy(data, src.data(), size);
+        src = src.subspan(size);
+        return true;
+    }
+
+    static void writeBinaryString(std::vector<uint8_t> &dst, const std::string &str) {
+        uint32_t count = str.size();
+        writeBinary(dst, &count, sizeof(count));
+        writeBinary(dst, str.data(), count);
+    }
+
+    static bool readBinaryString(std::span<const uint8_t> &src, std::string &str) {
+        uint32_t count;
+        if (!readBinary(src, &count, sizeof(count)) || src.size() < count) return false;
+        str.assign(reinterpret_cast<const char *>(src.data()), count);
+        src = src.subspan(count);
+        return true;
+    }
+
     void StructField::InitUndefined(void *dstStruct, const void *defaultStruct) const {
         auto *field = static_cast<char *>(dstStruct) + offset;
         auto *defaultField = static_cast<const char *>(defaultStruct) + offset;
@@ -167,4 +209,62 @@ namespace ecs {
             }
         });
     }
+
+    bool StructField::IsBinaryValue() const {
+        return GetFieldType(type, [](auto *typePtr) {
+            using T = std::remove_pointer_t<decltype(typePtr)>;
+            return isBinaryValue<T>();
+        });
+    }
+
+    void StructField::SaveBinary(const void *srcStruct, std::vector<uint8_t> &dst) const {
+        auto *field = static_cast<const char *>(srcStruct) + offset;
+
+        GetFieldType(type, field, [&](auto &value) {
+            using T = std::decay_t<decltype(value)>;
+
+            if constexpr (!isBinaryValue<T>()) {
+                Abortf("StructField::SaveBinary called on unsupported type: %s", type.name());
+            } else if constexpr (std::is_same<T, std::string>()) {
+                writeBinaryString(dst, value);
+            } else if constexpr (std::is_same<T, EntityRef>()) {
+                auto name = value.Name();
+                writeBinaryString(dst, name.scene);
+                writeBinaryString(dst, name.entity);
+            } else if constexpr (sp::is_vector<T>()) {
+                uint32_t count = value.size();
+                writeBinary(dst, &count, sizeof(count));
+                writeBinary(dst, value.data(), count * sizeof(typename T::value_type));
+            } else {
+                writeBinary(dst, &value, sizeof(T));
+            }
+        });
+    }
+
+    bool StructField::LoadBinary(void *dstStruct, std::span<const uint8_t> &src) const {
+        auto *field = static_cast<char *>(dstStruct) + offset;
+
+        return GetFieldType(type, field, [&](auto &value) -> bool {
+            using T = std::decay_t<decltype(value)>;
+
+            if constexpr (!isBinaryValue<T>()) {
+                Abortf("StructField::LoadBinary called on unsupported type: %s", type.name());
+            } else if constexpr (std::is_same<T, std::string>()) {
+                return readBinaryString(src, value);
+            } else if constexpr (std::is_same<T, EntityRef>()) {
+                Name name;
+                if (!readBinaryString(src, name.scene) || !readBinaryString(src, name.entity)) return false;
+                value = EntityRef(name);
+                return true;
+            } else if constexpr (sp::is_vector<T>()) {
+                uint32_t count;
+                if (!readBinary(src, &count, sizeof(count))) return false;
+                if (src.size() / sizeof(typename T::value_type) < count) return false;
+                value.resize(count);
+                return readBinary(src, value.data(), count * sizeof(typename T::value_type));
+            } else {
+                return readBinary(src, &value, sizeof(T));
+            }
+        });
+    }
 } // namespace ecs
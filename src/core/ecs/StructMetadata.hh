@@ -9,6 +9,7 @@
 #include "ecs/components/Name.hh"
 
 #include <robin_hood.h>
+#include <span>
 #include <type_traits>
 #include <typeindex>
 #include <vector>
@@ -140,8 +141,22 @@ namespace ecs {
             const void *srcStruct,
             const void *defaultStruct) const;
         void Apply(void *dstStruct, const void *srcStruct, const void *defaultPtr) const;
+
+        // Returns true if the field's type can be stored by value in a binary scene cache (see game/SceneCache.hh)
+        bool IsBinaryValue() const;
+        // Appends the field's in-memory value to dst, the field must be a binary value type
+        void SaveBinary(const void *srcStruct, std::vector<uint8_t> &dst) const;
+        // Reads a value written by SaveBinary() from the front of src and advances it, returns false if src is too short
+        bool LoadBinary(void *dstStruct, std::span<const uint8_t> &src) const;
     };
 
+    /**
+     * Must be specialized to true for every component with a StructMetadata::Load<T>() specialization.
+     * The binary scene cache only stores field values, so components with custom loading are always read from JSON.
+     */
+    template<typename T>
+    struct has_custom_load : std::false_type {};
+
     class StructMetadata {
     public:
         template<typename... Fields>
@@ -227,15 +242,15 @@ namespace ecs {
             if (dst) SetScope(*dst, scope);
         }
 
-        template<typename T>
-        inline void SetScope(robin_hood::unordered_flat_map<std::string, T> &dst, const EntityScope &scope) {
+        template<typename K, typename T>
+        inline void SetScope(robin_hood::unordered_flat_map<K, T> &dst, const EntityScope &scope) {
             for (auto &item : dst) {
                 SetScope(item.second, scope);
             }
         }
 
-        template<typename T>
-        inline void SetScope(robin_hood::unordered_node_map<std::string, T> &dst, const EntityScope &scope) {
+        template<typename K, typename T>
+        inline void SetScope(robin_hood::unordered_node_map<K, T> &dst, const EntityScope &scope) {
             for (auto &item : dst) {
                 SetScope(item.second, scope);
             }
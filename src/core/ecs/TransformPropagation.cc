@@ -0,0 +1,184 @@
+#include "TransformPropagation.hh"
+
+#include "console/CVar.hh"
+#include "core/DispatchQueue.hh"
+#include "core/Logging.hh"
+#include "core/Tracing.hh"
+#include "ecs/EcsImpl.hh"
+
+#include <algorithm>
+
+namespace ecs {
+    static sp::CVar<uint32_t> CVarTransformChunkSize("x.TransformChunkSize",
+        1024,
+        "Number of entities per parallel transform propagation job (0 to propagate on a single thread)");
+
+    static sp::DispatchQueue &GetTransformWorkQueue() {
+        static sp::DispatchQueue workQueue("TransformWorker",
+            sp::GetWorkScheduler().ThreadCount(),
+            sp::DispatchQueue::Workers::Shared);
+        return workQueue;
+    }
+
+    const std::vector<Entity> &TransformPropagation::Update(UpdateLock lock) {
+        ZoneScoped;
+        if (!SyncNodes(lock)) Rebuild(lock);
+
+        {
+            ZoneScopedN("Propagate");
+            size_t chunkSize = CVarTransformChunkSize.Get();
+            std::vector<sp::AsyncPtr<void>> pending;
+            for (size_t level = 0; level < levels.size(); level++) {
+                size_t begin = levels[level];
+                size_t end = level + 1 < levels.size() ? levels[level + 1] : nodes.size();
+
+                // Nodes in the same level only read from their parents, so each level can be split across threads.
+                // The last chunk is run on this thread while the workers process the rest.
+                pending.clear();
+                if (chunkSize > 0) {
+                    for (; begin + chunkSize < end; begin += chunkSize) {
+                        pending.emplace_back(GetTransformWorkQueue().Dispatch<void>([this, begin, chunkSize]() {
+                            PropagateLevel(begin, begin + chunkSize);
+                        }));
+                    }
+                }
+                PropagateLevel(begin, end);
+                for (auto &result : pending) {
+                    result->Get();
+                }
+            }
+        }
+
+        ZoneScopedN("WriteSnapshots");
+        changed.clear();
+        for (auto &node : nodes) {
+            if (!node.dirty) continue;
+            node.dirty = false;
+            if (!node.ent.Has<TransformSnapshot>(lock)) continue;
+
+            node.ent.Get<TransformSnapshot>(lock) = node.global;
+            changed.emplace_back(node.ent);
+        }
+        return changed;
+    }
+
+    void TransformPropagation::Invalidate() {
+        nodes.clear();
+        levels.clear();
+    }
+
+    // Updates cached poses and dirty flags, returning false if the hierarchy needs to be rebuilt
+    bool TransformPropagation::SyncNodes(UpdateLock lock) {
+        ZoneScoped;
+        size_t seenCount = 0;
+        bool valid = true;
+        for (auto &ent : lock.EntitiesWith<TransformTree>()) {
+            if (!ent.Has<TransformTree>(lock)) continue;
+            seenCount++;
+
+            if (ent.index >= nodeIndex.size() || nodeIndex[ent.index] >= nodes.size()) {
+                valid = false;
+                continue;
+            }
+            auto &node = nodes[nodeIndex[ent.index]];
+            if (node.ent != ent) {
+                valid = false;
+                continue;
+            }
+
+            auto &tree = ent.Get<const TransformTree>(lock);
+            if (tree.parent.Get(lock) != node.parentEnt) {
+                valid = false;
+            } else if (tree.pose != node.pose) {
+                node.pose = tree.pose;
+                node.dirty = true;
+            }
+        }
+        return valid && seenCount == nodes.size();
+    }
+
+    void TransformPropagation::Rebuild(UpdateLock lock) {
+        ZoneScoped;
+        std::vector<Node> unsorted;
+        for (auto &ent : lock.EntitiesWith<TransformTree>()) {
+            if (!ent.Has<TransformTree>(lock)) continue;
+            auto &tree = ent.Get<const TransformTree>(lock);
+
+            if (ent.index >= nodeIndex.size()) nodeIndex.resize(ent.index + 1, NO_PARENT);
+            nodeIndex[ent.index] = unsorted.size();
+            unsorted.emplace_back(Node{ent, tree.parent.Get(lock), NO_PARENT, tree.pose});
+        }
+        for (auto &node : unsorted) {
+            // Parents without a TransformTree are treated as the world origin, matching GetGlobalTransform()
+            if (!node.parentEnt.Has<TransformTree>(lock)) continue;
+            node.parent = nodeIndex[node.parentEnt.index];
+        }
+
+        // Calculate the depth of each node, walking up the tree until a node with a known depth is found
+        const uint32_t unknownDepth = NO_PARENT, visiting = NO_PARENT - 1;
+        std::vector<uint32_t> depths(unsorted.size(), unknownDepth);
+        std::vector<uint32_t> stack;
+        uint32_t maxDepth = 0;
+        for (uint32_t i = 0; i < unsorted.size(); i++) {
+            uint32_t current = i;
+            while (depths[current] == unknownDepth) {
+                depths[current] = visiting;
+                stack.emplace_back(current);
+                if (unsorted[current].parent == NO_PARENT) break;
+                current = unsorted[current].parent;
+            }
+            if (depths[current] == visiting && unsorted[current].parent != NO_PARENT) {
+                // Break the loop by treating this entity as a root, then walk the tree again
+                Errorf("TransformTree has a parent loop at entity: %s", std::to_string(unsorted[current].ent));
+                unsorted[current].parent = NO_PARENT;
+                for (auto index : stack) {
+                    depths[index] = unknownDepth;
+                }
+                stack.clear();
+                i--;
+                continue;
+            }
+            for (auto it = stack.rbegin(); it != stack.rend(); it++) {
+                auto parent = unsorted[*it].parent;
+                depths[*it] = parent == NO_PARENT ? 0 : depths[parent] + 1;
+                maxDepth = std::max(maxDepth, depths[*it]);
+            }
+            stack.clear();
+        }
+
+        // Counting sort the nodes by depth
+        levels.assign(unsorted.empty() ? 0 : maxDepth + 1, 0);
+        for (auto depth : depths) {
+            if (depth < maxDepth) levels[depth + 1]++;
+        }
+        for (size_t level = 1; level < levels.size(); level++) {
+            levels[level] += levels[level - 1];
+        }
+        std::vector<size_t> offsets = levels;
+        std::vector<uint32_t> sortedIndex(unsorted.size());
+        for (uint32_t i = 0; i < unsorted.size(); i++) {
+            sortedIndex[i] = offsets[depths[i]]++;
+        }
+
+        nodes.resize(unsorted.size());
+        for (uint32_t i = 0; i < unsorted.size(); i++) {
+            auto &node = nodes[sortedIndex[i]];
+            node = unsorted[i];
+            if (node.parent != NO_PARENT) node.parent = sortedIndex[node.parent];
+            nodeIndex[node.ent.index] = sortedIndex[i];
+        }
+    }
+
+    void TransformPropagation::PropagateLevel(size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            auto &node = nodes[i];
+            if (node.parent == NO_PARENT) {
+                if (node.dirty) node.global = node.pose;
+            } else {
+                auto &parent = nodes[node.parent];
+                if (parent.dirty) node.dirty = true;
+                if (node.dirty) node.global = parent.global * node.pose;
+            }
+        }
+    }
+} // namespace ecs
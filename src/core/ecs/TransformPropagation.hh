@@ -0,0 +1,57 @@
+#pragma once
+
+#include "core/Common.hh"
+#include "ecs/Ecs.hh"
+#include "ecs/components/Transform.h"
+
+#include <limits>
+#include <vector>
+
+namespace ecs {
+    /**
+     * Computes TransformSnapshot for every entity with a TransformTree in a single linear pass.
+     *
+     * Entities are kept in an array sorted by their depth in the transform hierarchy, so every parent is processed
+     * before its children and each global transform is a single multiply with the parent's cached result.
+     * Entities whose pose or parent changed since the last Update() are marked dirty, and the dirty flag propagates
+     * down to their children. Each depth level is independent, so large levels are split into parallel chunks.
+     *
+     * The sorted array is only rebuilt when an entity is added, removed, or reparented.
+     * This class is not thread-safe and should only be used by the system that owns it.
+     */
+    class TransformPropagation : public sp::NonCopyable {
+    public:
+        using UpdateLock = Lock<Read<TransformTree>, Write<TransformSnapshot>>;
+
+        /**
+         * Updates the TransformSnapshot of each entity whose global transform changed since the last call.
+         * Entities without a TransformSnapshot component are tracked, but their snapshot is not added.
+         * Returns the list of entities whose snapshot was written, valid until the next call to Update().
+         */
+        const std::vector<Entity> &Update(UpdateLock lock);
+
+        // Forces every snapshot to be recalculated on the next Update()
+        void Invalidate();
+
+    private:
+        static constexpr uint32_t NO_PARENT = std::numeric_limits<uint32_t>::max();
+
+        struct Node {
+            Entity ent, parentEnt;
+            uint32_t parent = NO_PARENT; // Index into nodes
+            Transform pose, global;
+            bool dirty = true;
+        };
+
+        bool SyncNodes(UpdateLock lock);
+        void Rebuild(UpdateLock lock);
+        void PropagateLevel(size_t begin, size_t end);
+
+        // Sorted by depth, with levels[d] being the first node index of depth d
+        std::vector<Node> nodes;
+        std::vector<size_t> levels;
+        // Maps an entity index to its node index
+        std::vector<uint32_t> nodeIndex;
+        std::vector<Entity> changed;
+    };
+} // namespace ecs
@@ -33,13 +33,22 @@ namespace ecs {
     void Animation::UpdateTransform(Lock<ReadSignalsLock, Read<Animation>, Write<TransformTree>> lock, Entity ent) {
         if (!ent.Has<Animation, TransformTree>(lock)) return;
 
+        double currentState = SignalRef(ent, "animation_state").GetSignal(lock);
+        double targetState = SignalRef(ent, "animation_target").GetSignal(lock);
+        UpdateTransform(lock, ent, currentState, targetState);
+    }
+
+    void Animation::UpdateTransform(Lock<Read<Animation>, Write<TransformTree>> lock,
+        Entity ent,
+        double currentState,
+        double targetState) {
+        if (!ent.Has<Animation, TransformTree>(lock)) return;
+
         auto &animation = ent.Get<Animation>(lock);
         if (animation.states.empty()) return;
 
         auto &transform = ent.Get<TransformTree>(lock);
 
-        double currentState = SignalRef(ent, "animation_state").GetSignal(lock);
-        double targetState = SignalRef(ent, "animation_target").GetSignal(lock);
         currentState = std::clamp(currentState, 0.0, animation.states.size() - 1.0);
         targetState = std::clamp(targetState, 0.0, animation.states.size() - 1.0);
         auto state = animation.GetCurrNextState(currentState, targetState);
@@ -53,6 +53,10 @@ namespace ecs {
 
         CurrNextState GetCurrNextState(double currentState, double targetState) const;
         static void UpdateTransform(Lock<ReadSignalsLock, Read<Animation>, Write<TransformTree>> lock, Entity ent);
+        static void UpdateTransform(Lock<Read<Animation>, Write<TransformTree>> lock,
+            Entity ent,
+            double currentState,
+            double targetState);
     };
 
     static StructMetadata MetadataAnimation(typeid(Animation),
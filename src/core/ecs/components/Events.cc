@@ -30,9 +30,9 @@ namespace ecs {
         const EventDest &def) {
         sp::json::Save(scope, dst, src.target);
         if (dst.is<std::string>()) {
-            dst = picojson::value(dst.get<std::string>() + src.queueName);
+            dst = picojson::value(dst.get<std::string>() + src.queueName.String());
         } else {
-            Errorf("Failed to save EventDest: %s", src.target.Name().String() + src.queueName);
+            Errorf("Failed to save EventDest: %s", src.target.Name().String() + src.queueName.String());
         }
     }
 
@@ -194,7 +194,7 @@ namespace ecs {
         }
     }
 
-    void EventInput::Register(Lock<Write<EventInput>> lock, const EventQueueRef &queue, const std::string &binding) {
+    void EventInput::Register(Lock<Write<EventInput>> lock, const EventQueueRef &queue, const sp::StringAtom &binding) {
         Assertf(IsLive(lock), "Attempting to register event on non-live entity: %s", binding);
         Assertf(queue, "EventInput::Register called with null queue: %s", binding);
 
@@ -203,7 +203,7 @@ namespace ecs {
         queueList.emplace_back(queue);
     }
 
-    void EventInput::Unregister(const std::shared_ptr<EventQueue> &queue, const std::string &binding) {
+    void EventInput::Unregister(const std::shared_ptr<EventQueue> &queue, const sp::StringAtom &binding) {
         if (!queue) return;
 
         auto it = events.find(binding);
@@ -214,9 +214,14 @@ namespace ecs {
     }
 
     size_t EventInput::Add(const Event &event, size_t transactionId) const {
-        AsyncEvent asyncEvent(event.name, event.source, event.data);
-        asyncEvent.transactionId = transactionId;
-        return Add(asyncEvent);
+        size_t eventsSent = 0;
+        auto it = events.find(event.name);
+        if (it != events.end()) {
+            for (auto &queue : it->second) {
+                if (queue->Add(event, transactionId)) eventsSent++;
+            }
+        }
+        return eventsSent;
     }
 
     size_t EventInput::Add(const AsyncEvent &event) const {
@@ -235,7 +240,7 @@ namespace ecs {
         return queue->Poll(eventOut, lock.GetTransactionId());
     }
 
-    EventBinding &EventBindings::Bind(std::string source, const EventBinding &binding) {
+    EventBinding &EventBindings::Bind(const sp::StringAtom &source, const EventBinding &binding) {
         auto &list = sourceToDest.emplace(source, BindingList{}).first->second;
         auto it = std::find_if(list.begin(), list.end(), [&](auto &arg) {
             return arg.actions == binding.actions;
@@ -252,13 +257,13 @@ namespace ecs {
         }
     }
 
-    EventBinding &EventBindings::Bind(std::string source, EntityRef target, std::string dest) {
+    EventBinding &EventBindings::Bind(const sp::StringAtom &source, EntityRef target, const sp::StringAtom &dest) {
         EventBinding binding;
         binding.outputs = {EventDest{target, dest}};
         return Bind(source, binding);
     }
 
-    void EventBindings::Unbind(std::string source, EntityRef target, std::string dest) {
+    void EventBindings::Unbind(const sp::StringAtom &source, EntityRef target, const sp::StringAtom &dest) {
         auto list = sourceToDest.find(source);
         if (list != sourceToDest.end()) {
             EventDest searchDest = {target, dest};
@@ -278,7 +283,7 @@ namespace ecs {
         }
     }
 
-    void modifyEvent(const DynamicLock<ReadSignalsLock> &lock,
+    static void modifyEvent(const DynamicLock<ReadSignalsLock> &lock,
         EventData &output,
         const EventData &input,
         const EventBinding &binding) {
@@ -318,7 +323,7 @@ namespace ecs {
             output);
     }
 
-    bool filterAndModifyEvent(const DynamicLock<ReadSignalsLock> &lock,
+    static bool filterAndModifyEvent(const DynamicLock<ReadSignalsLock> &lock,
         sp::AsyncPtr<EventData> &asyncOutput,
         const sp::AsyncPtr<EventData> &asyncInput,
         const EventBinding &binding) {
@@ -382,18 +387,42 @@ namespace ecs {
         return true;
     }
 
-    size_t EventBindings::SendEvent(const DynamicLock<SendEventsLock> &lock,
-        const EntityRef &target,
-        const Event &event,
+    // Returns std::nullopt if the binding's actions can't be evaluated synchronously with the provided lock
+    static std::optional<bool> filterAndModifyEvent(const DynamicLock<ReadSignalsLock> &lock,
+        EventData &output,
+        const EventData &input,
+        const EventBinding &binding) {
+        auto &actions = binding.actions;
+        if (actions.filterExpr && !actions.filterExpr->CanEvaluate(lock)) return std::nullopt;
+        for (auto &expr : actions.modifyExprs) {
+            if (!expr.CanEvaluate(lock)) return std::nullopt;
+        }
+
+        if (actions.setValue) output = *actions.setValue;
+        if (actions.filterExpr && actions.filterExpr->EvaluateEvent(lock, input) < 0.5) return false;
+        if (!actions.modifyExprs.empty()) modifyEvent(lock, output, input, binding);
+        return true;
+    }
+
+    static size_t sendAsyncBinding(const DynamicLock<SendEventsLock> &lock,
+        const AsyncEvent &event,
+        const EventBinding &binding,
         size_t depth) {
-        AsyncEvent asyncEvent = AsyncEvent(event.name, event.source, event.data);
-        asyncEvent.transactionId = lock.GetTransactionId();
-        return SendEvent(lock, target, asyncEvent, depth);
+        // Execute event modifiers before submitting to the destination queue
+        AsyncEvent outputEvent = event;
+        if (!filterAndModifyEvent(lock, outputEvent.data, event.data, binding)) return 0;
+
+        size_t eventsSent = 0;
+        for (auto &dest : binding.outputs) {
+            outputEvent.name = dest.queueName;
+            eventsSent += EventBindings::SendEvent(lock, dest.target, outputEvent, depth + 1);
+        }
+        return eventsSent;
     }
 
     size_t EventBindings::SendEvent(const DynamicLock<SendEventsLock> &lock,
         const EntityRef &target,
-        const AsyncEvent &event,
+        const Event &event,
         size_t depth) {
         ZoneScoped;
         Entity ent = target.Get(lock);
@@ -405,7 +434,7 @@ namespace ecs {
         size_t eventsSent = 0;
         if (ent.Has<EventInput>(lock)) {
             auto &eventInput = ent.Get<const EventInput>(lock);
-            eventsSent += eventInput.Add(event);
+            eventsSent += eventInput.Add(event, lock.GetTransactionId());
         }
         if (ent.Has<EventBindings>(lock)) {
             auto &bindings = ent.Get<const EventBindings>(lock);
@@ -416,9 +445,17 @@ namespace ecs {
                     return eventsSent;
                 }
                 for (auto &binding : list->second) {
-                    // Execute event modifiers before submitting to the destination queue
-                    AsyncEvent outputEvent = event;
-                    if (!filterAndModifyEvent(lock, outputEvent.data, event.data, binding)) continue;
+                    Event outputEvent = event;
+                    auto result = filterAndModifyEvent(lock, outputEvent.data, event.data, binding);
+                    if (!result) {
+                        // The binding reads signals outside this lock, evaluate it asynchronously instead
+                        AsyncEvent asyncEvent(event.name, event.source, event.data);
+                        asyncEvent.transactionId = lock.GetTransactionId();
+                        eventsSent += sendAsyncBinding(lock, asyncEvent, binding, depth);
+                        continue;
+                    } else if (!*result) {
+                        continue;
+                    }
 
                     for (auto &dest : binding.outputs) {
                         outputEvent.name = dest.queueName;
@@ -429,4 +466,36 @@ namespace ecs {
         }
         return eventsSent;
     }
+
+    size_t EventBindings::SendEvent(const DynamicLock<SendEventsLock> &lock,
+        const EntityRef &target,
+        const AsyncEvent &event,
+        size_t depth) {
+        ZoneScoped;
+        Entity ent = target.Get(lock);
+        if (!ent.Exists(lock)) {
+            Errorf("Tried to send event to missing entity: %s", target.Name().String());
+            return 0;
+        }
+
+        size_t eventsSent = 0;
+        if (ent.Has<EventInput>(lock)) {
+            auto &eventInput = ent.Get<const EventInput>(lock);
+            eventsSent += eventInput.Add(event);
+        }
+        if (ent.Has<EventBindings>(lock)) {
+            auto &bindings = ent.Get<const EventBindings>(lock);
+            auto list = bindings.sourceToDest.find(event.name);
+            if (list != bindings.sourceToDest.end()) {
+                if (depth >= MAX_EVENT_BINDING_DEPTH) {
+                    Errorf("Max event binding depth exceeded: %s %s", target.Name().String(), event.name);
+                    return eventsSent;
+                }
+                for (auto &binding : list->second) {
+                    eventsSent += sendAsyncBinding(lock, event, binding, depth);
+                }
+            }
+        }
+        return eventsSent;
+    }
 } // namespace ecs
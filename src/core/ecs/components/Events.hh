@@ -2,6 +2,7 @@
 
 #include "core/Common.hh"
 #include "core/LockFreeMutex.hh"
+#include "core/StringAtom.hh"
 #include "ecs/Components.hh"
 #include "ecs/EntityRef.hh"
 #include "ecs/EventQueue.hh"
@@ -21,8 +22,8 @@ namespace ecs {
     struct EventInput {
         EventInput() {}
 
-        void Register(Lock<Write<EventInput>> lock, const EventQueueRef &queue, const std::string &binding);
-        void Unregister(const EventQueueRef &queue, const std::string &binding);
+        void Register(Lock<Write<EventInput>> lock, const EventQueueRef &queue, const sp::StringAtom &binding);
+        void Unregister(const EventQueueRef &queue, const sp::StringAtom &binding);
 
         /**
          * Adds an event to any matching event input queues.
@@ -34,7 +35,7 @@ namespace ecs {
         size_t Add(const AsyncEvent &event) const;
         static bool Poll(Lock<Read<EventInput>> lock, const EventQueueRef &queue, Event &eventOut);
 
-        robin_hood::unordered_map<std::string, std::vector<EventQueueRef>> events;
+        robin_hood::unordered_map<sp::StringAtom, std::vector<EventQueueRef>> events;
     };
 
     static StructMetadata MetadataEventInput(typeid(EventInput));
@@ -42,7 +43,7 @@ namespace ecs {
 
     struct EventDest {
         EntityRef target;
-        std::string queueName;
+        sp::StringAtom queueName;
 
         bool operator==(const EventDest &) const = default;
     };
@@ -100,9 +101,9 @@ namespace ecs {
     public:
         EventBindings() {}
 
-        EventBinding &Bind(std::string source, const EventBinding &binding);
-        EventBinding &Bind(std::string source, EntityRef target, std::string dest);
-        void Unbind(std::string source, EntityRef target, std::string dest);
+        EventBinding &Bind(const sp::StringAtom &source, const EventBinding &binding);
+        EventBinding &Bind(const sp::StringAtom &source, EntityRef target, const sp::StringAtom &dest);
+        void Unbind(const sp::StringAtom &source, EntityRef target, const sp::StringAtom &dest);
 
         static size_t SendEvent(const DynamicLock<SendEventsLock> &lock,
             const EntityRef &target,
@@ -114,11 +115,13 @@ namespace ecs {
             size_t depth = 0);
 
         using BindingList = typename std::vector<EventBinding>;
-        robin_hood::unordered_map<std::string, BindingList> sourceToDest;
+        robin_hood::unordered_map<sp::StringAtom, BindingList> sourceToDest;
     };
 
     static StructMetadata MetadataEventBindings(typeid(EventBindings),
         StructField::New(&EventBindings::sourceToDest, FieldAction::AutoSave));
+    template<>
+    struct has_custom_load<EventBindings> : std::true_type {};
     static Component<EventBindings> ComponentEventBindings("event_bindings", MetadataEventBindings);
     template<>
     bool StructMetadata::Load<EventBindings>(EventBindings &dst, const picojson::value &src);
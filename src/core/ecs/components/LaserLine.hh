@@ -12,10 +12,14 @@ namespace ecs {
         struct Line {
             std::vector<glm::vec3> points;
             sp::color_t color = glm::vec3(1); // HDR value
+
+            bool operator==(const Line &) const = default;
         };
         struct Segment {
             glm::vec3 start, end;
             sp::color_t color = glm::vec3(1); // HDR value
+
+            bool operator==(const Segment &) const = default;
         };
         using Segments = std::vector<Segment>;
         std::variant<Line, Segments> line = Line();
@@ -25,6 +29,8 @@ namespace ecs {
         bool on = true;
         bool relative = true; // multiply transform
         float radius = 0.003; // in world units
+
+        bool operator==(const LaserLine &) const = default;
     };
 
     static StructMetadata MetadataLaserLine(typeid(LaserLine),
@@ -33,6 +39,8 @@ namespace ecs {
         StructField::New("on", &LaserLine::on),
         StructField::New("relative", &LaserLine::relative),
         StructField::New("radius", &LaserLine::radius));
+    template<>
+    struct has_custom_load<LaserLine> : std::true_type {};
     static Component<LaserLine> ComponentLaserLine("laser_line", MetadataLaserLine);
 
     template<>
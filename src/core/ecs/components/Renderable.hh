@@ -46,6 +46,8 @@ namespace ecs {
         struct Joint {
             EntityRef entity;
             glm::mat4 inverseBindPose;
+
+            bool operator==(const Joint &) const = default;
         };
         vector<Joint> joints; // list of entities corresponding to the "joints" array of the skin
 
@@ -58,6 +60,8 @@ namespace ecs {
         bool IsVisible(VisibilityMask viewMask) const {
             return (visibility & viewMask) == viewMask;
         }
+
+        bool operator==(const Renderable &) const = default;
     };
 
     static StructMetadata MetadataRenderable(typeid(Renderable),
@@ -67,6 +71,8 @@ namespace ecs {
         StructField::New("emissive", &Renderable::emissiveScale),
         StructField::New("color_override", &Renderable::colorOverride),
         StructField::New("metallic_roughness_override", &Renderable::metallicRoughnessOverride));
+    template<>
+    struct has_custom_load<Renderable> : std::true_type {};
     static Component<Renderable> ComponentRenderable("renderable", MetadataRenderable);
 
     template<>
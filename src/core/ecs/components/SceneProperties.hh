@@ -25,6 +25,8 @@ namespace ecs {
         StructField::New("root_transform", &SceneProperties::rootTransform, FieldAction::AutoApply),
         StructField::New("gravity_transform", &SceneProperties::gravityTransform),
         StructField::New("gravity", &SceneProperties::fixedGravity));
+    template<>
+    struct has_custom_load<SceneProperties> : std::true_type {};
     static Component<SceneProperties> ComponentSceneProperties("scene_properties", MetadataSceneProperties);
 
     template<>
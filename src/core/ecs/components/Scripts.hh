@@ -97,9 +97,43 @@ namespace ecs {
     struct script_has_init_func<T, std::void_t<decltype(std::declval<T>().Init(std::declval<ScriptState &>()))>>
         : std::true_type {};
 
+    // Extracts the lock type from a script's OnTick(ScriptState &, LockType, Entity, duration) function
+    template<typename Fn>
+    struct script_ontick_lock {};
+    template<typename T, typename LockType>
+    struct script_ontick_lock<void (T::*)(ScriptState &, LockType, Entity, chrono_clock::duration)> {
+        using type = LockType;
+    };
+
     template<typename T>
     struct InternalScript final : public InternalScriptBase {
+        using LockType = typename script_ontick_lock<decltype(&T::OnTick)>::type;
+
+        // Scripts with an OnTick lock narrower than WriteAll are run in parallel by ScriptManager::RunOnTickParallel()
+        struct LockGroup final : public ScriptLockGroup<LockType> {
+            void RunOnTick(std::span<std::pair<Entity, ScriptState *>> scripts,
+                const chrono_clock::duration &interval) const override {
+                auto lock = this->StartTransaction();
+                for (auto &[ent, state] : scripts) {
+                    ZoneScopedN("OnTick");
+                    ZoneStr(state->definition.name);
+                    T *ptr = std::any_cast<T>(&state->userData);
+                    if (!ptr) ptr = &state->userData.emplace<T>();
+                    ptr->OnTick(*state, lock, ent, interval);
+                }
+            }
+        };
+
         const T defaultValue = {};
+        const LockGroup lockGroup = {};
+
+        const ScriptLockGroupBase *GetLockGroup() const {
+            if constexpr (std::is_same_v<LockType, Lock<WriteAll>>) {
+                return nullptr;
+            } else {
+                return &lockGroup;
+            }
+        }
 
         const void *GetDefault() const override {
             return &defaultValue;
@@ -129,14 +163,15 @@ namespace ecs {
         }
 
         InternalScript(const std::string &name, const StructMetadata &metadata) : InternalScriptBase(metadata) {
-            GetScriptDefinitions().RegisterScript({name, {}, false, this, ScriptInitFunc(&Init), OnTickFunc(&OnTick)});
+            GetScriptDefinitions().RegisterScript(
+                {name, {}, false, this, ScriptInitFunc(&Init), OnTickFunc(&OnTick), GetLockGroup()});
         }
 
         template<typename... Events>
         InternalScript(const std::string &name, const StructMetadata &metadata, bool filterOnEvent, Events... events)
             : InternalScriptBase(metadata) {
             GetScriptDefinitions().RegisterScript(
-                {name, {events...}, filterOnEvent, this, ScriptInitFunc(&Init), OnTickFunc(&OnTick)});
+                {name, {events...}, filterOnEvent, this, ScriptInitFunc(&Init), OnTickFunc(&OnTick), GetLockGroup()});
         }
     };
 
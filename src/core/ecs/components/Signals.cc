@@ -9,9 +9,9 @@
 #include <picojson/picojson.h>
 
 namespace ecs {
-    SignalKey::SignalKey(const EntityRef &entity, const std::string_view &signalName)
+    SignalKey::SignalKey(const EntityRef &entity, const sp::StringAtom &signalName)
         : entity(entity), signalName(signalName) {
-        Assertf(signalName.find_first_of(",():/# ") == std::string::npos,
+        Assertf(signalName.String().find_first_of(",():/# ") == std::string::npos,
             "Signal name has invalid character: '%s'",
             signalName);
     }
@@ -24,14 +24,14 @@ namespace ecs {
         size_t i = str.find('/');
         if (i == std::string::npos) {
             entity = {};
-            signalName.clear();
+            signalName = {};
             Errorf("Invalid signal has no entity/signal separator: %s", std::string(str));
             return false;
         }
         ecs::Name entityName(str.substr(0, i), scope);
         if (!entityName) {
             entity = {};
-            signalName.clear();
+            signalName = {};
             Errorf("Invalid signal has bad entity name: %s", std::string(str));
             return false;
         }
@@ -47,7 +47,7 @@ namespace ecs {
 
 namespace std {
     std::size_t hash<ecs::SignalKey>::operator()(const ecs::SignalKey &key) const {
-        auto val = hash<string>()(key.signalName);
+        auto val = hash<sp::StringAtom>()(key.signalName);
         sp::hash_combine(val, key.entity.Name());
         return val;
     }
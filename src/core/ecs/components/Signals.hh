@@ -6,6 +6,7 @@
 #include "ecs/SignalExpression.hh"
 #include "ecs/SignalRef.hh"
 
+#include <atomic>
 #include <limits>
 #include <robin_hood.h>
 #include <set>
@@ -20,6 +21,11 @@ namespace ecs {
             SignalExpression expr;
             SignalRef ref;
 
+            // Memoized result of expr, valid until the binding or one of its dependencies changes.
+            // Written by readers holding a shared lock, so both fields are atomic.
+            mutable std::atomic<double> cachedValue = 0.0;
+            mutable std::atomic_bool cacheValid = false;
+
             Signal() : value(-std::numeric_limits<double>::infinity()) {}
             Signal(double value, const SignalRef &ref) : value(value) {
                 if (!std::isinf(value)) this->ref = ref;
@@ -28,11 +34,27 @@ namespace ecs {
                 : value(-std::numeric_limits<double>::infinity()), expr(expr) {
                 if (expr) this->ref = ref;
             }
+            Signal(const Signal &other)
+                : value(other.value), expr(other.expr), ref(other.ref), cachedValue(other.cachedValue.load()),
+                  cacheValid(other.cacheValid.load()) {}
+
+            Signal &operator=(const Signal &other) {
+                value = other.value;
+                expr = other.expr;
+                ref = other.ref;
+                cachedValue = other.cachedValue.load();
+                cacheValid = other.cacheValid.load();
+                return *this;
+            }
         };
 
         std::vector<Signal> signals;
         std::set<size_t> freeIndexes;
 
+        // Reverse edges of the signal dependency graph: signal -> bindings that read it.
+        // Maintained by SignalManager whenever a binding is set or cleared.
+        robin_hood::unordered_map<SignalRef, std::vector<SignalRef>> subscribers;
+
         size_t NewSignal(const SignalRef &ref, double value);
         size_t NewSignal(const SignalRef &ref, const SignalExpression &expr);
         void FreeSignal(size_t index);
@@ -40,17 +62,17 @@ namespace ecs {
 
     struct SignalKey {
         EntityRef entity;
-        std::string signalName;
+        sp::StringAtom signalName;
 
         SignalKey() {}
-        SignalKey(const EntityRef &entity, const std::string_view &signalName);
+        SignalKey(const EntityRef &entity, const sp::StringAtom &signalName);
         SignalKey(const std::string_view &str, const EntityScope &scope = Name());
 
         bool Parse(const std::string_view &str, const EntityScope &scope);
 
         std::string String() const {
-            if (!entity) return signalName;
-            return entity.Name().String() + "/" + signalName;
+            if (!entity) return signalName.String();
+            return entity.Name().String() + "/" + signalName.String();
         }
 
         explicit operator bool() const {
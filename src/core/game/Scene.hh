@@ -34,6 +34,10 @@ namespace sp {
         std::unordered_map<ecs::Name, ecs::Entity> namedEntities;
         std::vector<ecs::EntityRef> references;
 
+        // Defined in game/game/Scene.cc, shared_ptr allows it to be destroyed where the type is incomplete
+        struct AppliedEntities;
+        std::shared_ptr<AppliedEntities> appliedEntities;
+
     public:
         // ==== Below functions are defined in game module: game/game/Scene.cc
 
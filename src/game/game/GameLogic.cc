@@ -26,5 +26,6 @@ namespace sp {
             auto lock = ecs::StartTransaction<ecs::WriteAll>();
             ecs::GetScriptManager().RunOnTick(lock, interval);
         }
+        ecs::GetScriptManager().RunOnTickParallel(interval);
     }
 } // namespace sp
@@ -7,7 +7,83 @@
 #include "game/SceneImpl.hh"
 #include "game/SceneManager.hh"
 
+#include <robin_hood.h>
+
 namespace sp {
+    using AppliedEntityMap = robin_hood::unordered_node_map<ecs::Entity, ecs::FlatEntity>;
+
+    // The flattened staging entity this scene last applied to each live entity, used to skip unchanged components.
+    // Should only be accessed from the SceneManager thread.
+    struct Scene::AppliedEntities : AppliedEntityMap {};
+
+    static void applyEntity(const ecs::Lock<ecs::AddRemove> &live,
+        const ecs::Entity &liveId,
+        ecs::FlatEntity &&flatEntity,
+        bool resetLive,
+        robin_hood::unordered_flat_set<ecs::Entity> &changedEntities,
+        AppliedEntityMap *appliedEntities) {
+        // Entities shared with other scenes may have been written by them since this scene last applied them,
+        // so they are always applied in full.
+        if (appliedEntities && liveId.Get<ecs::SceneInfo>(live).nextStagingId) {
+            appliedEntities->erase(liveId);
+            appliedEntities = nullptr;
+        }
+
+        const ecs::FlatEntity *previous = nullptr;
+        if (appliedEntities) {
+            auto it = appliedEntities->find(liveId);
+            if (it != appliedEntities->end()) previous = &it->second;
+        }
+        if (scene::ApplyFlatEntity(live, liveId, flatEntity, resetLive, previous)) {
+            changedEntities.emplace(liveId);
+        }
+        if (appliedEntities) (*appliedEntities)[liveId] = std::move(flatEntity);
+    }
+
+    // Updates the TransformSnapshot of each changed entity and all of its descendants
+    static void updateTransformSnapshots(const ecs::Lock<ecs::AddRemove> &live,
+        const robin_hood::unordered_flat_set<ecs::Entity> &changedEntities) {
+        ZoneScoped;
+        struct Node {
+            ecs::Transform global;
+            bool dirty;
+        };
+        robin_hood::unordered_flat_map<ecs::Entity, Node> nodes;
+        std::vector<ecs::Entity> chain;
+        for (auto &e : live.EntitiesWith<ecs::TransformTree>()) {
+            if (!e.Has<ecs::TransformTree>(live)) continue;
+
+            // Walk up the tree until a node that was already resolved is found
+            std::optional<Node> parent;
+            ecs::Entity current = e;
+            while (current.Has<ecs::TransformTree>(live)) {
+                auto it = nodes.find(current);
+                if (it != nodes.end()) {
+                    parent = it->second;
+                    break;
+                } else if (sp::contains(chain, current)) {
+                    // Treat parent loops as a root, matching TransformPropagation
+                    break;
+                }
+                chain.emplace_back(current);
+                current = current.Get<const ecs::TransformTree>(live).parent.Get(live);
+            }
+
+            for (auto it = chain.rbegin(); it != chain.rend(); it++) {
+                auto &tree = it->Get<const ecs::TransformTree>(live);
+                Node node;
+                node.global = parent ? parent->global * tree.pose : tree.pose;
+                node.dirty = (parent && parent->dirty) || changedEntities.contains(*it);
+                nodes.emplace(*it, node);
+                parent = node;
+            }
+            chain.clear();
+
+            auto &node = nodes[e];
+            if (node.dirty || !e.Has<ecs::TransformSnapshot>(live)) e.Set<ecs::TransformSnapshot>(live, node.global);
+        }
+    }
+
     std::shared_ptr<Scene> Scene::New(ecs::Lock<ecs::AddRemove> stagingLock,
         const std::string &name,
         SceneType type,
@@ -227,14 +303,22 @@ namespace sp {
         properties.fixedGravity = properties.rootTransform * glm::vec4(properties.fixedGravity, 0.0f);
         properties.gravityTransform = properties.rootTransform * properties.gravityTransform;
 
+        if (!appliedEntities) appliedEntities = std::make_shared<AppliedEntities>();
         for (auto e : live.EntitiesWith<ecs::SceneInfo>()) {
             if (!e.Has<ecs::SceneInfo>(live)) continue;
             auto &sceneInfo = e.Get<ecs::SceneInfo>(live);
             if (sceneInfo.scene != *this) continue;
             Assert(sceneInfo.liveId == e, "Expected live entity to match SceneInfo.liveId");
 
-            if (!sceneInfo.rootStagingId.Has<ecs::SceneInfo>(staging)) e.Destroy(live);
+            if (!sceneInfo.rootStagingId.Has<ecs::SceneInfo>(staging)) {
+                appliedEntities->erase(e);
+                e.Destroy(live);
+            }
         }
+
+        // Only components that changed since they were last applied are written, and only entities with changes
+        // have their animations, events, and transform snapshots updated.
+        robin_hood::unordered_flat_set<ecs::Entity> changedEntities;
         for (auto &[e, flatEntity] : entities) {
             auto &sceneInfo = e.Get<ecs::SceneInfo>(staging);
 
@@ -245,7 +329,12 @@ namespace sp {
                 sceneInfo.SetLiveId(staging, sceneInfo.liveId);
                 liveSceneInfo = sceneInfo.rootStagingId.Get<ecs::SceneInfo>(staging);
 
-                scene::ApplyFlatEntity(live, sceneInfo.liveId, flatEntity, resetLive);
+                applyEntity(live,
+                    sceneInfo.liveId,
+                    std::move(flatEntity),
+                    resetLive,
+                    changedEntities,
+                    appliedEntities.get());
                 continue;
             }
 
@@ -262,7 +351,12 @@ namespace sp {
 
                 // Rebuild the flat entity since the scene hierarchy has changed
                 flatEntity = scene::BuildEntity(ecs::Lock<ecs::ReadAll>(staging), liveSceneInfo.rootStagingId);
-                scene::ApplyFlatEntity(live, sceneInfo.liveId, flatEntity, resetLive);
+                applyEntity(live,
+                    sceneInfo.liveId,
+                    std::move(flatEntity),
+                    resetLive,
+                    changedEntities,
+                    appliedEntities.get());
             } else {
                 // No entity exists in the live scene
                 sceneInfo.liveId = live.NewEntity();
@@ -272,27 +366,32 @@ namespace sp {
                 ecs::GetEntityRefs().Set(entityName, e);
                 ecs::GetEntityRefs().Set(entityName, sceneInfo.liveId);
 
-                scene::ApplyFlatEntity(live, sceneInfo.liveId, flatEntity, resetLive);
+                // Entity ids may be reused, drop anything applied to a previous entity with this id
+                appliedEntities->erase(sceneInfo.liveId);
+                applyEntity(live,
+                    sceneInfo.liveId,
+                    std::move(flatEntity),
+                    resetLive,
+                    changedEntities,
+                    appliedEntities.get());
             }
         }
         {
             ZoneScopedN("AnimationUpdate");
-            for (auto &e : live.EntitiesWith<ecs::Animation>()) {
+            for (auto &e : changedEntities) {
                 if (!e.Has<ecs::Animation, ecs::TransformTree>(live)) continue;
 
                 ecs::Animation::UpdateTransform(live, e);
             }
         }
-        ecs::GetScriptManager().RegisterEvents(live);
         {
-            ZoneScopedN("TransformSnapshot");
-            for (auto &e : live.EntitiesWith<ecs::TransformTree>()) {
-                if (!e.Has<ecs::TransformTree>(live)) continue;
-
-                auto transform = e.Get<ecs::TransformTree>(live).GetGlobalTransform(live);
-                e.Set<ecs::TransformSnapshot>(live, transform);
+            ZoneScopedN("RegisterEvents");
+            auto &scriptManager = ecs::GetScriptManager();
+            for (auto &e : changedEntities) {
+                scriptManager.RegisterEvents(live, e);
             }
         }
+        if (!changedEntities.empty()) updateTransformSnapshots(live, changedEntities);
         active = true;
 
         if (callback) callback(staging, live);
@@ -302,6 +401,7 @@ namespace sp {
         ZoneScoped;
         ZoneStr(data->name);
         Debugf("Removing scene: %s", data->name);
+        robin_hood::unordered_flat_set<ecs::Entity> changedEntities;
         for (auto &e : staging.EntitiesWith<ecs::SceneInfo>()) {
             if (!e.Has<ecs::SceneInfo>(staging)) continue;
             auto &sceneInfo = e.Get<ecs::SceneInfo>(staging);
@@ -321,7 +421,8 @@ namespace sp {
                         remainingInfo.rootStagingId.Get<ecs::SceneInfo>(staging));
 
                     auto flatEntity = scene::BuildEntity(ecs::Lock<ecs::ReadAll>(staging), remainingInfo.rootStagingId);
-                    scene::ApplyFlatEntity(live, remainingInfo.liveId, flatEntity, false);
+                    // The remaining scenes haven't applied this flattening, so it is written in full
+                    applyEntity(live, remainingInfo.liveId, std::move(flatEntity), false, changedEntities, nullptr);
                 }
             }
             ecs::EntityRef ref = e;
@@ -342,6 +443,7 @@ namespace sp {
             // Remove non-staging entities that were created by a script after scene load.
             e.Destroy(live);
         }
+        appliedEntities.reset();
 
         auto liveSceneId = data->sceneEntity.Get(live);
         auto stagingSceneId = data->sceneEntity.Get(staging);
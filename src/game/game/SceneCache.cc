@@ -0,0 +1,317 @@
+#include "SceneCache.hh"
+
+#include "assets/Asset.hh"
+#include "assets/AssetManager.hh"
+#include "assets/BinaryJson.hh"
+#include "console/CVar.hh"
+#include "core/Hashing.hh"
+#include "core/Logging.hh"
+#include "core/Tracing.hh"
+#include "ecs/EcsImpl.hh"
+
+#include <cstring>
+#include <fstream>
+#include <picojson/picojson.h>
+#include <robin_hood.h>
+
+namespace sp::scenecache {
+    static CVar<bool> CVarSceneCache("s.SceneCache",
+        true,
+        "Load scenes from a binary cache, rebuilding it when the scene's JSON changes");
+
+    const uint32 sceneCacheMagic = 0x5c3e;
+    // Bump when the cache layout, or the in-memory layout of a cached field type changes
+    const uint32 sceneCacheVersion = 2;
+
+#pragma pack(push, 1)
+    /**
+     * The header is followed by the binary JSON of the scene with cached components removed, then the components:
+     *
+     * uint32 typeCount, typeCount * (uint32 nameLength, char name[nameLength])
+     * uint32 entityCount, entityCount * (uint32 componentCount, componentCount * (uint32 type, uint32 size, data))
+     *
+     * Entities are in the same order as the scene's "entities" list, and data is written by ComponentBase::SaveBinary()
+     */
+    struct sceneCacheHeader {
+        uint32_t magicNumber = sceneCacheMagic;
+        uint32_t version = sceneCacheVersion;
+        uint32_t jsonVersion = json::BINARY_JSON_VERSION;
+        uint32_t reserved = 0;
+        Hash128 sourceHash;
+        uint64_t layoutHash = 0;
+        uint64_t jsonSize = 0;
+        uint64_t componentsSize = 0;
+    };
+
+#pragma pack(pop)
+
+    static_assert(sizeof(sceneCacheHeader) == 56, "Scene cache header size changed unexpectedly");
+
+    static std::string cachePath(const std::string &sceneName) {
+        return "cache/scenes/" + sceneName + ".bin";
+    }
+
+    // Hashes the field table of every component, so caches written by a build with different fields are ignored
+    static uint64_t componentLayoutHash() {
+        static const uint64_t layoutHash = [] {
+            uint64_t hash = 0;
+            ecs::ForEachComponent([&](const std::string &name, const ecs::ComponentBase &comp) {
+                hash_combine(hash, name);
+                for (auto &field : comp.metadata.fields) {
+                    hash_combine(hash, field.name);
+                    hash_combine(hash, std::string(field.type.name()));
+                    hash_combine(hash, field.offset);
+                    hash_combine(hash, (uint32_t)field.actions);
+                }
+            });
+            return hash;
+        }();
+        return layoutHash;
+    }
+
+    static void writeUint32(std::vector<uint8_t> &dst, uint32_t value) {
+        auto *bytes = reinterpret_cast<const uint8_t *>(&value);
+        dst.insert(dst.end(), bytes, bytes + sizeof(value));
+    }
+
+    static bool readUint32(std::span<const uint8_t> &src, uint32_t &value) {
+        if (src.size() < sizeof(value)) return false;
+        std::memcpy(&value, src.data(), sizeof(value));
+        src = src.subspan(sizeof(value));
+        return true;
+    }
+
+    static picojson::array *entityList(picojson::value &root) {
+        if (!root.is<picojson::object>()) return nullptr;
+        auto &sceneObj = root.get<picojson::object>();
+        auto it = sceneObj.find("entities");
+        if (it == sceneObj.end() || !it->second.is<picojson::array>()) return nullptr;
+        return &it->second.get<picojson::array>();
+    }
+
+    static bool parseJson(const std::string &sceneName, const Asset &source, picojson::value &root) {
+        ZoneScoped;
+        string err;
+        auto json = source.StringView();
+        picojson::parse(root, json.begin(), json.end(), &err);
+        if (!err.empty()) {
+            Errorf("Failed to parse scene (%s): %s", sceneName, err);
+            return false;
+        }
+        return true;
+    }
+
+    static void loadJsonComponents(const std::string &sceneName,
+        picojson::value &root,
+        std::vector<ecs::FlatEntity> &entities) {
+        ZoneScoped;
+        auto *list = entityList(root);
+        if (!list) return;
+        entities.resize(list->size());
+
+        for (size_t i = 0; i < list->size(); i++) {
+            if (!(*list)[i].is<picojson::object>()) continue;
+            for (auto &comp : (*list)[i].get<picojson::object>()) {
+                if (comp.first.empty() || comp.first[0] == '_' || comp.first == "name") continue;
+
+                auto componentType = ecs::LookupComponent(comp.first);
+                if (componentType != nullptr) {
+                    if (!componentType->LoadEntity(entities[i], comp.second)) {
+                        Errorf("LoadScene(%s): Failed to load component, ignoring: %s", sceneName, comp.first);
+                    }
+                } else {
+                    Errorf("LoadScene(%s): Unknown component, ignoring: %s", sceneName, comp.first);
+                }
+            }
+        }
+    }
+
+    static bool loadCachedComponents(std::span<const uint8_t> src,
+        picojson::value &root,
+        std::vector<ecs::FlatEntity> &entities) {
+        ZoneScoped;
+        uint32_t typeCount, entityCount;
+        if (!readUint32(src, typeCount)) return false;
+        std::vector<const ecs::ComponentBase *> types;
+        for (uint32_t i = 0; i < typeCount; i++) {
+            uint32_t nameLength;
+            if (!readUint32(src, nameLength) || src.size() < nameLength) return false;
+            std::string name(reinterpret_cast<const char *>(src.data()), nameLength);
+            src = src.subspan(nameLength);
+
+            auto *comp = ecs::LookupComponent(name);
+            if (!comp) return false;
+            types.emplace_back(comp);
+        }
+
+        auto *list = entityList(root);
+        if (!readUint32(src, entityCount) || entityCount != (list ? list->size() : 0)) return false;
+        entities.resize(entityCount);
+        for (auto &entity : entities) {
+            uint32_t componentCount;
+            if (!readUint32(src, componentCount)) return false;
+            for (uint32_t i = 0; i < componentCount; i++) {
+                uint32_t type, size;
+                if (!readUint32(src, type) || !readUint32(src, size)) return false;
+                if (type >= types.size() || src.size() < size) return false;
+                if (!types[type]->LoadBinary(entity, src.first(size))) return false;
+                src = src.subspan(size);
+            }
+        }
+        return src.empty();
+    }
+
+    static bool loadCache(const std::string &sceneName,
+        const Asset &source,
+        picojson::value &root,
+        std::vector<ecs::FlatEntity> *entities) {
+        ZoneScoped;
+        auto asset = Assets().Load(cachePath(sceneName), AssetType::Bundled, true)->Get();
+        if (!asset) return false;
+
+        auto buf = asset->Buffer();
+        sceneCacheHeader header;
+        if (buf.size() < sizeof(header)) {
+            Errorf("Scene cache is corrupt: %s", sceneName);
+            return false;
+        }
+        std::memcpy(&header, buf.data(), sizeof(header));
+
+        if (header.magicNumber != sceneCacheMagic || header.version != sceneCacheVersion ||
+            header.jsonVersion != json::BINARY_JSON_VERSION || header.layoutHash != componentLayoutHash()) {
+            Logf("Ignoring outdated scene cache format for %s", sceneName);
+            return false;
+        } else if (header.sourceHash != source.Hash()) {
+            Logf("Ignoring outdated scene cache for %s", sceneName);
+            return false;
+        }
+        auto body = buf.subspan(sizeof(header));
+        if (body.size() < header.jsonSize || body.size() - header.jsonSize != header.componentsSize) {
+            Errorf("Scene cache is corrupt: %s", sceneName);
+            return false;
+        }
+
+        if (!json::DecodeBinary(body.first(header.jsonSize), root)) {
+            Errorf("Scene cache is corrupt: %s", sceneName);
+            return false;
+        }
+        if (entities && !loadCachedComponents(body.subspan(header.jsonSize), root, *entities)) {
+            Errorf("Scene cache is corrupt: %s", sceneName);
+            return false;
+        }
+        return true;
+    }
+
+    static bool saveCache(const std::string &sceneName,
+        const Asset &source,
+        const picojson::value &root,
+        const std::vector<ecs::FlatEntity> &entities) {
+        ZoneScoped;
+        ZoneStr(sceneName);
+        picojson::value residual = root;
+        std::vector<const ecs::ComponentBase *> types;
+        robin_hood::unordered_flat_map<const ecs::ComponentBase *, uint32_t> typeIndexes;
+        std::vector<uint8_t> entityData, componentData;
+
+        auto *list = entityList(residual);
+        size_t entityCount = list ? list->size() : 0;
+        Assertf(entities.size() == entityCount, "Scene cache saved with wrong entity count: %s", sceneName);
+        writeUint32(entityData, entityCount);
+        for (size_t i = 0; i < entityCount; i++) {
+            size_t countOffset = entityData.size();
+            uint32_t componentCount = 0;
+            writeUint32(entityData, componentCount);
+            if (!(*list)[i].is<picojson::object>()) continue;
+
+            auto &entSrc = (*list)[i].get<picojson::object>();
+            for (auto it = entSrc.begin(); it != entSrc.end();) {
+                auto componentType = ecs::LookupComponent(it->first);
+                componentData.clear();
+                if (it->first == "name" || !componentType || !componentType->SaveBinary(entities[i], componentData)) {
+                    it++;
+                    continue;
+                }
+
+                auto [typeIt, inserted] = typeIndexes.emplace(componentType, types.size());
+                if (inserted) types.emplace_back(componentType);
+                writeUint32(entityData, typeIt->second);
+                writeUint32(entityData, componentData.size());
+                entityData.insert(entityData.end(), componentData.begin(), componentData.end());
+                componentCount++;
+                it = entSrc.erase(it);
+            }
+            std::memcpy(entityData.data() + countOffset, &componentCount, sizeof(componentCount));
+        }
+
+        std::vector<uint8_t> components;
+        writeUint32(components, types.size());
+        for (auto *type : types) {
+            size_t nameLength = std::strlen(type->name);
+            writeUint32(components, nameLength);
+            components.insert(components.end(), type->name, type->name + nameLength);
+        }
+        components.insert(components.end(), entityData.begin(), entityData.end());
+
+        std::vector<uint8_t> jsonBuffer;
+        json::EncodeBinary(residual, jsonBuffer);
+
+        std::ofstream out;
+        if (!Assets().OutputStream(cachePath(sceneName), out)) {
+            Warnf("Failed to write scene cache: %s", sceneName);
+            return false;
+        }
+
+        sceneCacheHeader header = {};
+        header.sourceHash = source.Hash();
+        header.layoutHash = componentLayoutHash();
+        header.jsonSize = jsonBuffer.size();
+        header.componentsSize = components.size();
+
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(jsonBuffer.data()), jsonBuffer.size());
+        out.write(reinterpret_cast<const char *>(components.data()), components.size());
+        out.close();
+        return !out.fail();
+    }
+
+    bool LoadScene(const std::string &sceneName,
+        const Asset &source,
+        picojson::value &root,
+        std::vector<ecs::FlatEntity> &entities) {
+        ZoneScoped;
+        ZoneStr(sceneName);
+        bool useCache = CVarSceneCache.Get();
+        if (useCache) {
+            if (loadCache(sceneName, source, root, &entities)) {
+                loadJsonComponents(sceneName, root, entities);
+                return true;
+            }
+            root = picojson::value();
+            entities.clear();
+        }
+
+        if (!parseJson(sceneName, source, root)) return false;
+        loadJsonComponents(sceneName, root, entities);
+
+#ifndef SP_PACKAGE_RELEASE
+        // Packaged builds read scenes from the asset bundle, and don't write back to the assets directory
+        if (useCache) saveCache(sceneName, source, root, entities);
+#endif
+        return true;
+    }
+
+    bool ParseScene(const std::string &sceneName, const Asset &source, picojson::value &root) {
+        ZoneScoped;
+        ZoneStr(sceneName);
+        if (CVarSceneCache.Get() && loadCache(sceneName, source, root, nullptr)) return true;
+        return parseJson(sceneName, source, root);
+    }
+
+    bool SaveCache(const std::string &sceneName, const Asset &source) {
+        picojson::value root;
+        if (!parseJson(sceneName, source, root)) return false;
+        std::vector<ecs::FlatEntity> entities;
+        loadJsonComponents(sceneName, root, entities);
+        return saveCache(sceneName, source, root, entities);
+    }
+} // namespace sp::scenecache
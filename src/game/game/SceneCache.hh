@@ -0,0 +1,48 @@
+#pragma once
+
+#include "core/Common.hh"
+#include "ecs/Ecs.hh"
+
+namespace picojson {
+    class value;
+}
+
+namespace sp {
+    class Asset;
+
+    /**
+     * Scenes are authored as JSON. A binary copy of each loaded scene is stored in cache/scenes/, tagged with the hash
+     * of the JSON it was generated from. The JSON stays the source of truth: a cache that doesn't match the current
+     * file is ignored and rebuilt.
+     *
+     * Components whose fields are all plain values (numbers, vectors, enums, strings and entity references) are stored
+     * as their in-memory field values, and are read back by writing directly into each StructField's offset. The rest
+     * of the scene (names, components with custom StructMetadata::Load hooks or containers of structs) is kept as
+     * binary encoded JSON and loaded through StructMetadata as before.
+     *
+     * The cache is tagged with a hash of every component's field table, so adding, removing or reordering fields
+     * invalidates it. Changing the layout of a field's value type (e.g. ecs::Transform) requires bumping the version.
+     */
+    namespace scenecache {
+        /**
+         * Loads the components of each entry in the scene's "entities" list into the matching index of entities.
+         * root is set to the scene's JSON, minus any components that were read from the cache.
+         * Entity names are not loaded, they are left in root to be resolved by the caller.
+         *
+         * When the s.SceneCache CVar is enabled, a missing or outdated cache is written after loading from JSON.
+         */
+        bool LoadScene(const std::string &sceneName,
+            const Asset &source,
+            picojson::value &root,
+            std::vector<ecs::FlatEntity> &entities);
+
+        /**
+         * Parses the scene's JSON without loading any components. If the cache is used, components stored by value
+         * are missing from root, but everything else (e.g. model names) is present.
+         */
+        bool ParseScene(const std::string &sceneName, const Asset &source, picojson::value &root);
+
+        // Loads the scene from the source asset's JSON and writes its binary cache
+        bool SaveCache(const std::string &sceneName, const Asset &source);
+    } // namespace scenecache
+} // namespace sp
@@ -131,19 +131,33 @@ namespace sp::scene {
         return flatEntity;
     }
 
+    // Returns true if both flattened components are missing, or both exist and are equal
+    template<typename T>
+    bool CompareFlatComponent(const std::optional<T> &a, const std::optional<T> &b) {
+        if (!a || !b) return a.has_value() == b.has_value();
+        return LookupComponent<T>().CompareComponent(*a, *b);
+    }
+
+    // Apply flattened staging components to the live id, and remove any components that are no longer in staging.
+    // If previous is the flattening last applied to this live id, components that haven't changed in staging since
+    // then are left untouched, keeping their live state even when resetLive is set. Components that were not in the
+    // previous flattening either are assumed to have been added at runtime, and are not removed.
+    // Returns true if any live component was written or removed.
     template<typename... AllComponentTypes, template<typename...> typename ECSType>
-    void ApplyFlatEntity(const Tecs::Lock<ECSType<AllComponentTypes...>, AddRemove> &live,
+    bool ApplyFlatEntity(const Tecs::Lock<ECSType<AllComponentTypes...>, AddRemove> &live,
         const Entity &liveId,
         const FlatEntity &flatEntity,
-        bool resetLive) {
+        bool resetLive,
+        const FlatEntity *previous = nullptr) {
         ZoneScoped;
+        bool changed = false;
 
-        // Apply flattened staging components to the live id, and remove any components that are no longer in staging
         ( // For each component:
             [&] {
                 using T = AllComponentTypes;
                 if constexpr (std::is_same_v<T, Name>) {
                     auto &name = std::get<std::optional<Name>>(flatEntity);
+                    if (previous && std::get<std::optional<Name>>(*previous) == name) return;
                     if (name) liveId.Set<Name>(live, *name);
                 } else if constexpr (std::is_same_v<T, SceneInfo>) {
                     // Ignore, this should always be set
@@ -151,32 +165,45 @@ namespace sp::scene {
                     // Skip, this is handled bellow
                 } else if constexpr (std::is_same_v<T, SignalBindings>) {
                     // Skip, this is handled bellow
+                } else if constexpr (std::is_same_v<T, TransformSnapshot>) {
+                    // Snapshots are never staged, they exist alongside the TransformTree
+                    auto &transformOpt = std::get<std::optional<TransformTree>>(flatEntity);
+                    if (!transformOpt && liveId.Has<TransformSnapshot>(live)) {
+                        liveId.Unset<TransformSnapshot>(live);
+                        changed = true;
+                    }
                 } else if constexpr (!Tecs::is_global_component<T>()) {
                     auto &component = std::get<std::optional<T>>(flatEntity);
                     if (component) {
+                        if (previous && liveId.Has<T>(live) &&
+                            CompareFlatComponent(std::get<std::optional<T>>(*previous), component)) {
+                            return;
+                        }
                         if (resetLive) liveId.Unset<T>(live);
 
                         auto &dstComp = liveId.Get<T>(live);
                         LookupComponent<T>().ApplyComponent(dstComp, *component, true);
+                        changed = true;
                     } else if (liveId.Has<T>(live)) {
-                        if constexpr (std::is_same_v<T, TransformSnapshot>) {
-                            auto &transformOpt = std::get<std::optional<TransformTree>>(flatEntity);
-                            if (!transformOpt) {
-                                liveId.Unset<TransformSnapshot>(live);
-                            }
-                        } else {
-                            liveId.Unset<T>(live);
-                        }
+                        if (previous && !std::get<std::optional<T>>(*previous)) return;
+                        liveId.Unset<T>(live);
+                        changed = true;
                     }
                 }
             }(),
             ...);
 
+        auto &signalOutput = std::get<std::optional<SignalOutput>>(flatEntity);
+        auto &signalBindings = std::get<std::optional<SignalBindings>>(flatEntity);
+        if (previous && CompareFlatComponent(std::get<std::optional<SignalOutput>>(*previous), signalOutput) &&
+            CompareFlatComponent(std::get<std::optional<SignalBindings>>(*previous), signalBindings)) {
+            return changed;
+        }
+
         if (resetLive) {
             GetSignalManager().ClearEntity(live, liveId);
         }
 
-        auto &signalOutput = std::get<std::optional<SignalOutput>>(flatEntity);
         if (signalOutput) {
             for (auto &[signalName, value] : signalOutput.value().signals) {
                 if (!std::isfinite(value)) continue;
@@ -184,7 +211,6 @@ namespace sp::scene {
                 if (!ref.HasValue(live)) ref.SetValue(live, value);
             }
         }
-        auto &signalBindings = std::get<std::optional<SignalBindings>>(flatEntity);
         if (signalBindings) {
             for (auto &[signalName, binding] : signalBindings.value().bindings) {
                 if (!binding) continue;
@@ -192,5 +218,6 @@ namespace sp::scene {
                 if (!ref.HasBinding(live)) ref.SetBinding(live, binding);
             }
         }
+        return true;
     }
 } // namespace sp::scene
@@ -3,6 +3,7 @@
 #include "assets/Asset.hh"
 #include "assets/AssetManager.hh"
 #include "assets/JsonHelpers.hh"
+#include "console/CVar.hh"
 #include "console/Console.hh"
 #include "console/ConsoleBindingManager.hh"
 #include "core/Logging.hh"
@@ -13,10 +14,12 @@
 #include "ecs/SignalManager.hh"
 #include "game/GameEntities.hh"
 #include "game/Scene.hh"
+#include "game/SceneCache.hh"
 
 #include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <glm/glm.hpp>
 #include <picojson/picojson.h>
 #include <robin_hood.h>
@@ -35,6 +38,47 @@ namespace sp {
 
     static std::atomic<std::thread::id> activeSceneManagerThread;
 
+    static CVar<bool> CVarPrefetchScenes("s.PrefetchScenes",
+        true,
+        "Prefetch the models of scenes connected to the active scenes before they are loaded");
+
+    // Finds the models referenced by a scene's entities, split by whether they are rendered
+    static void FindSceneModels(const picojson::object &sceneObj,
+        robin_hood::unordered_flat_set<std::string> &visibleModels,
+        robin_hood::unordered_flat_set<std::string> &otherModels) {
+        auto entitiesIt = sceneObj.find("entities");
+        if (entitiesIt == sceneObj.end() || !entitiesIt->second.is<picojson::array>()) return;
+
+        std::function<void(const picojson::value &, robin_hood::unordered_flat_set<std::string> &)> findModels;
+        findModels = [&findModels](const picojson::value &value, robin_hood::unordered_flat_set<std::string> &models) {
+            if (value.is<picojson::object>()) {
+                for (auto &[key, field] : value.get<picojson::object>()) {
+                    if (key == "model" && field.is<std::string>()) {
+                        // Physics shapes reference meshes as "model.mesh"
+                        auto &modelName = field.get<std::string>();
+                        auto model = modelName.substr(0, modelName.find('.'));
+                        if (!model.empty()) models.emplace(model);
+                    } else {
+                        findModels(field, models);
+                    }
+                }
+            } else if (value.is<picojson::array>()) {
+                for (auto &item : value.get<picojson::array>()) {
+                    findModels(item, models);
+                }
+            }
+        };
+
+        for (auto &entity : entitiesIt->second.get<picojson::array>()) {
+            if (!entity.is<picojson::object>()) continue;
+            for (auto &[component, value] : entity.get<picojson::object>()) {
+                // Gltf prefab scripts render their model by default
+                bool visible = component == "renderable" || component == "script";
+                findModels(value, visible ? visibleModels : otherModels);
+            }
+        }
+    }
+
     std::shared_ptr<Scene> SceneRef::Lock() const {
         Assertf(std::this_thread::get_id() == activeSceneManagerThread,
             "SceneRef::Lock() must only be called in SceneManaager thread");
@@ -398,12 +442,14 @@ namespace sp {
     void SceneManager::UpdateSceneConnections() {
         ZoneScoped;
         robin_hood::unordered_set<std::string> requiredSceneList = {};
+        robin_hood::unordered_set<std::string> connectedSceneList = {};
         {
             auto lock = ecs::StartTransaction<ecs::ReadSignalsLock, ecs::Read<ecs::SceneConnection>>();
 
             for (auto &ent : lock.EntitiesWith<ecs::SceneConnection>()) {
                 auto &connection = ent.Get<ecs::SceneConnection>(lock);
                 for (auto &[sceneName, signals] : connection.scenes) {
+                    connectedSceneList.emplace(sceneName);
                     for (auto &expr : signals) {
                         if (expr.Evaluate(lock) >= 0.5) {
                             requiredSceneList.emplace(sceneName);
@@ -423,6 +469,50 @@ namespace sp {
                 AddScene(sceneName, SceneType::Async);
             }
         }
+
+        UpdateScenePrefetches(connectedSceneList, requiredSceneList);
+    }
+
+    void SceneManager::UpdateScenePrefetches(const robin_hood::unordered_set<std::string> &connectedScenes,
+        const robin_hood::unordered_set<std::string> &requiredScenes) {
+        ZoneScoped;
+        // Required scenes were loaded above, so their content has already been requested at a regular priority
+        bool enabled = CVarPrefetchScenes.Get();
+        for (auto it = scenePrefetches.begin(); it != scenePrefetches.end();) {
+            if (!enabled || !connectedScenes.contains(it->first) || requiredScenes.contains(it->first)) {
+                it = scenePrefetches.erase(it);
+            } else {
+                it++;
+            }
+        }
+        if (!enabled) return;
+
+        for (auto &sceneName : connectedScenes) {
+            if (requiredScenes.contains(sceneName) || stagedScenes.Contains(sceneName)) continue;
+
+            auto &prefetch = scenePrefetches[sceneName];
+            if (!prefetch.sceneAsset) {
+                prefetch.sceneAsset = Assets().Load("scenes/" + sceneName + ".json",
+                    AssetType::Bundled,
+                    false,
+                    AssetPriority::Prefetch);
+            }
+            if (prefetch.assets || !prefetch.sceneAsset->Ready()) continue;
+
+            std::vector<std::string> models;
+            auto asset = prefetch.sceneAsset->Get();
+            if (asset) {
+                picojson::value root;
+                if (scenecache::ParseScene(sceneName, *asset, root) && root.is<picojson::object>()) {
+                    robin_hood::unordered_flat_set<std::string> visibleModels, otherModels;
+                    FindSceneModels(root.get<picojson::object>(), visibleModels, otherModels);
+                    // Prefetches run in request order, so visible models are loaded first
+                    models.insert(models.end(), visibleModels.begin(), visibleModels.end());
+                    models.insert(models.end(), otherModels.begin(), otherModels.end());
+                }
+            }
+            prefetch.assets = Assets().Prefetch(models);
+        }
     }
 
     void SceneManager::Frame() {
@@ -601,17 +691,23 @@ namespace sp {
         }
 
         picojson::value root;
-        string err = picojson::parse(root, asset->String());
-        if (!err.empty()) {
-            Errorf("Failed to parse scene (%s): %s", sceneName, err);
-            return nullptr;
-        }
+        std::vector<ecs::FlatEntity> entities;
+        if (!scenecache::LoadScene(sceneName, *asset, root, entities)) return nullptr;
         if (!root.is<picojson::object>()) {
             Errorf("Failed to parse scene (%s): %s", sceneName, root.to_str());
             return nullptr;
         }
         auto &sceneObj = root.get<picojson::object>();
 
+        {
+            // Request rendered models before the entities are loaded, so visible content is ready first
+            robin_hood::unordered_flat_set<std::string> visibleModels, otherModels;
+            FindSceneModels(sceneObj, visibleModels, otherModels);
+            for (auto &modelName : visibleModels) {
+                Assets().LoadGltf(modelName, AssetPriority::High);
+            }
+        }
+
         ScenePriority priority = sceneType == SceneType::System ? ScenePriority::System : ScenePriority::Scene;
         ecs::EntityScope scope(sceneName, "");
         if (sceneObj.count("priority")) {
@@ -625,30 +721,17 @@ namespace sp {
             }
         }
 
-        std::vector<ecs::FlatEntity> entities;
         if (sceneObj.count("entities")) {
-            auto &entityList = sceneObj["entities"];
-            for (auto &value : entityList.get<picojson::array>()) {
-                auto &entSrc = value.get<picojson::object>();
-                auto &entDst = entities.emplace_back();
+            // Components are loaded by the scene cache, names are resolved here since they depend on the scope
+            auto &entityList = sceneObj["entities"].get<picojson::array>();
+            for (size_t i = 0; i < entities.size(); i++) {
+                auto &entSrc = entityList[i].get<picojson::object>();
+                auto &entDst = entities[i];
 
                 if (entSrc.count("name") && entSrc["name"].is<string>()) {
                     ecs::Name name(entSrc["name"].get<string>(), scope);
                     if (name) std::get<std::optional<ecs::Name>>(entDst) = name;
                 }
-
-                for (auto &comp : entSrc) {
-                    if (comp.first.empty() || comp.first[0] == '_' || comp.first == "name") continue;
-
-                    auto componentType = ecs::LookupComponent(comp.first);
-                    if (componentType != nullptr) {
-                        if (!componentType->LoadEntity(entDst, comp.second)) {
-                            Errorf("LoadScene(%s): Failed to load component, ignoring: %s", sceneName, comp.first);
-                        }
-                    } else {
-                        Errorf("LoadScene(%s): Unknown component, ignoring: %s", sceneName, comp.first);
-                    }
-                }
             }
         }
 
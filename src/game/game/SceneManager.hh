@@ -20,6 +20,8 @@
 #include <shared_mutex>
 
 namespace sp {
+    class Asset;
+    class AssetPrefetch;
     class Game;
 
     static const char *const InputBindingConfigPath = "input_bindings.json";
@@ -75,6 +77,8 @@ namespace sp {
     private:
         void RunSceneActions();
         void UpdateSceneConnections();
+        void UpdateScenePrefetches(const robin_hood::unordered_set<std::string> &connectedScenes,
+            const robin_hood::unordered_set<std::string> &requiredScenes);
         void RunPrefabs(ecs::Lock<ecs::AddRemove> lock, ecs::Entity ent);
 
         using OnApplySceneCallback = std::function<void(ecs::Lock<ecs::ReadAll, ecs::Write<ecs::SceneInfo>>,
@@ -127,6 +131,13 @@ namespace sp {
         LockFreeMutex activeSceneMutex;
         std::vector<SceneRef> activeSceneCache;
 
+        struct ScenePrefetch {
+            AsyncPtr<Asset> sceneAsset;
+            std::shared_ptr<AssetPrefetch> assets;
+        };
+        // Content of scenes connected to the active scenes that aren't required yet
+        robin_hood::unordered_flat_map<std::string, ScenePrefetch> scenePrefetches;
+
         PreservingMap<std::string, Scene, 1000> stagedScenes;
         using SceneList = std::vector<std::shared_ptr<Scene>>;
         EnumArray<SceneList, SceneType> scenes;
@@ -44,6 +44,13 @@ namespace sp::vulkan {
     static CVar<bool> CVarSortedDraw("r.SortedDraw", true, "Draw geometry in sorted depth-order");
     static CVar<bool> CVarDrawReverseOrder("r.DrawReverseOrder", false, "Flip the order for geometry depth sorting");
 
+    static CVar<bool> CVarFrustumCulling("r.FrustumCulling",
+        true,
+        "Cull primitives outside the view on the GPU, replaces sorted draws");
+    static CVar<bool> CVarOcclusionCulling("r.OcclusionCulling",
+        true,
+        "Cull primitives hidden behind previously drawn geometry on the GPU, replaces sorted draws");
+
     Renderer::Renderer(DeviceContext &device)
         : device(device), graph(device), scene(device), voxels(scene), lighting(scene, voxels), transparency(scene),
           guiRenderer(new GuiRenderer(device)) {
@@ -222,8 +229,13 @@ namespace sp::vulkan {
         if (!view) return {};
         view.UpdateViewMatrix(lock, windowEntity);
 
+        bool frustumCulling = CVarFrustumCulling.Get();
+        bool occlusionCulling = CVarOcclusionCulling.Get();
+
         GPUScene::DrawBufferIDs drawIDs;
-        if (CVarSortedDraw.Get()) {
+        if (frustumCulling || occlusionCulling) {
+            drawIDs = scene.GenerateCulledDrawsForView(graph, view, frustumCulling, occlusionCulling);
+        } else if (CVarSortedDraw.Get()) {
             glm::vec3 viewPos = view.invViewMat * glm::vec4(0, 0, 0, 1);
             drawIDs = scene.GenerateSortedDrawsForView(graph, viewPos, view.visibilityMask, CVarDrawReverseOrder.Get());
         } else {
@@ -268,6 +280,36 @@ namespace sp::vulkan {
                     resources.GetBuffer(drawIDs.drawCommandsBuffer),
                     resources.GetBuffer(drawIDs.drawParamsBuffer));
             });
+
+        if (occlusionCulling) {
+            // Primitives that were hidden last frame are retested against the depth drawn so far, which also becomes
+            // the next frame's depth pyramid.
+            scene.AddDepthPyramid(graph, view);
+            auto occludedDrawIDs = scene.GenerateOccludedDrawsForView(graph, view);
+
+            graph.AddPass("ForwardPassOccluded")
+                .Build([&](rg::PassBuilder &builder) {
+                    builder.SetColorAttachment(0, "GBuffer0", {LoadOp::Load, StoreOp::Store});
+                    builder.SetColorAttachment(1, "GBuffer1", {LoadOp::Load, StoreOp::Store});
+                    builder.SetColorAttachment(2, "GBuffer2", {LoadOp::Load, StoreOp::Store});
+                    builder.SetDepthAttachment("GBufferDepthStencil", {LoadOp::Load, StoreOp::Store});
+
+                    builder.Read("ViewState", Access::VertexShaderReadUniform);
+
+                    builder.Read("WarpedVertexBuffer", Access::VertexBuffer);
+                    builder.Read(occludedDrawIDs.drawCommandsBuffer, Access::IndirectBuffer);
+                    builder.Read(occludedDrawIDs.drawParamsBuffer, Access::VertexShaderReadStorage);
+                })
+                .Execute([this, occludedDrawIDs](rg::Resources &resources, CommandContext &cmd) {
+                    cmd.SetShaders("scene.vert", "generate_gbuffer.frag");
+                    cmd.SetUniformBuffer(0, 10, resources.GetBuffer("ViewState"));
+
+                    scene.DrawSceneIndirect(cmd,
+                        resources.GetBuffer("WarpedVertexBuffer"),
+                        resources.GetBuffer(occludedDrawIDs.drawCommandsBuffer),
+                        resources.GetBuffer(occludedDrawIDs.drawParamsBuffer));
+                });
+        }
         return view;
     }
 
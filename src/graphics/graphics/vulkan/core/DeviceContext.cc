@@ -339,6 +339,9 @@ namespace sp::vulkan {
         enabledDeviceFeatures.shaderInt16 = true;
         enabledDeviceFeatures.fragmentStoresAndAtomics = true;
         // enabledDeviceFeatures.wideLines = true;
+        // Block compressed textures are optional, cooked textures fall back to their source images without them
+        enabledDeviceFeatures.textureCompressionBC = availableDeviceFeatures.textureCompressionBC;
+        textureCompressionBC = availableDeviceFeatures.textureCompressionBC;
 
         vk::DeviceCreateInfo deviceInfo;
         deviceInfo.queueCreateInfoCount = queueInfos.size();
@@ -1040,7 +1043,13 @@ namespace sp::vulkan {
         vk::ImageUsageFlags declaredUsage = createInfo.usage;
         vk::Format factorFormat = createInfo.format;
 
-        if (!createInfo.mipLevels) createInfo.mipLevels = genMipmap ? CalculateMipmapLevels(createInfo.extent) : 1;
+        if (!createInfo.mipLevels) {
+            if (!createInfo.levelOffsets.empty()) {
+                createInfo.mipLevels = createInfo.levelOffsets.size();
+            } else {
+                createInfo.mipLevels = genMipmap ? CalculateMipmapLevels(createInfo.extent) : 1;
+            }
+        }
         if (!createInfo.arrayLayers) createInfo.arrayLayers = 1;
 
         if (!hasSrcData) {
@@ -1048,6 +1057,10 @@ namespace sp::vulkan {
         } else {
             Assert(createInfo.arrayLayers == 1, "can't load initial data into an image array");
             Assert(!genMipmap || createInfo.mipLevels > 1, "can't generate mipmap for a single level image");
+            if (!createInfo.levelOffsets.empty()) {
+                Assert(!genMipmap && !genFactor, "can't generate a mipmap or factor for precomputed mip levels");
+                Assert(createInfo.levelOffsets.size() == createInfo.mipLevels, "must pass an offset for each level");
+            }
 
             createInfo.usage |= vk::ImageUsageFlagBits::eTransferDst;
             if (genMipmap) createInfo.usage |= vk::ImageUsageFlagBits::eTransferSrc;
@@ -1092,19 +1105,24 @@ namespace sp::vulkan {
                 vk::PipelineStageFlagBits::eTransfer,
                 vk::AccessFlagBits::eTransferWrite);
 
-            vk::BufferImageCopy region;
-            region.bufferOffset = 0;
-            region.bufferRowLength = 0;
-            region.bufferImageHeight = 0;
-            region.imageSubresource.aspectMask = FormatToAspectFlags(createInfo.format);
-            region.imageSubresource.mipLevel = 0;
-            region.imageSubresource.baseArrayLayer = 0;
-            region.imageSubresource.layerCount = 1;
-            region.imageOffset = vk::Offset3D{0, 0, 0};
-            region.imageExtent = createInfo.extent;
+            std::vector<vk::BufferImageCopy> regions(std::max<size_t>(1, createInfo.levelOffsets.size()));
+            for (uint32 level = 0; level < regions.size(); level++) {
+                auto &region = regions[level];
+                region.bufferOffset = createInfo.levelOffsets.empty() ? 0 : createInfo.levelOffsets[level];
+                region.bufferRowLength = 0;
+                region.bufferImageHeight = 0;
+                region.imageSubresource.aspectMask = FormatToAspectFlags(createInfo.format);
+                region.imageSubresource.mipLevel = level;
+                region.imageSubresource.baseArrayLayer = 0;
+                region.imageSubresource.layerCount = 1;
+                region.imageOffset = vk::Offset3D{0, 0, 0};
+                region.imageExtent = vk::Extent3D{std::max(1u, createInfo.extent.width >> level),
+                    std::max(1u, createInfo.extent.height >> level),
+                    std::max(1u, createInfo.extent.depth >> level)};
+            }
 
             PushInFlightObject(stagingBuf, transferCmd->Fence());
-            transferCmd->Raw().copyBufferToImage(*stagingBuf, *image, vk::ImageLayout::eTransferDstOptimal, {region});
+            transferCmd->Raw().copyBufferToImage(*stagingBuf, *image, vk::ImageLayout::eTransferDstOptimal, regions);
 
             ImageBarrierInfo transferToGeneral;
             transferToGeneral.trackImageLayout = false;
@@ -1365,7 +1383,7 @@ namespace sp::vulkan {
         ZoneScoped;
         auto futImage = CreateImage(imageInfo, data);
 
-        return allocatorQueue.Dispatch<ImageView>(futImage, [=, this](ImagePtr image) {
+        return futImage->Then<ImageView>(allocatorQueue, [=, this](ImagePtr image) {
             auto viewI = viewInfo;
             viewI.image = image;
             return CreateImageView(viewI);
@@ -176,6 +176,10 @@ namespace sp::vulkan {
             return physicalDeviceDescriptorIndexingProperties;
         }
 
+        bool SupportsTextureCompressionBC() const {
+            return textureCompressionBC;
+        }
+
         vk::FormatProperties FormatProperties(vk::Format format) const;
 
         vk::Format SelectSupportedFormat(vk::FormatProperties requiredProps,
@@ -251,6 +255,7 @@ namespace sp::vulkan {
         vk::PhysicalDevice physicalDevice;
         vk::PhysicalDeviceProperties2 physicalDeviceProperties;
         vk::PhysicalDeviceDescriptorIndexingProperties physicalDeviceDescriptorIndexingProperties;
+        bool textureCompressionBC = false;
         vk::UniqueDevice device;
 
         unique_ptr<VmaAllocator_T, void (*)(VmaAllocator)> allocator;
@@ -23,7 +23,7 @@ namespace sp::vulkan {
         vk::ImageType imageType = vk::ImageType::e2D;
         vk::Format format = vk::Format::eUndefined;
         vk::Extent3D extent = {};
-        uint32 mipLevels = 0; // defaults to 1 if genMipmap is false, defaults to CalculateMipmapLevels otherwise
+        uint32 mipLevels = 0; // defaults to levelOffsets.size(), else CalculateMipmapLevels if genMipmap, else 1
         uint32 arrayLayers = 1;
         vk::SampleCountFlagBits samples = vk::SampleCountFlagBits::e1;
         vk::ImageTiling tiling = vk::ImageTiling::eOptimal;
@@ -32,6 +32,9 @@ namespace sp::vulkan {
 
         bool genMipmap = false;
         std::vector<double> factor;
+        // Byte offset of each mip level in the initial data, for uploading precomputed mipmaps.
+        // If empty, the initial data only contains the first level.
+        std::vector<vk::DeviceSize> levelOffsets;
         std::vector<vk::Format> formats; // fill only if using eMutableFormat flag
 
         vk::ImageCreateInfo GetVkCreateInfo() const {
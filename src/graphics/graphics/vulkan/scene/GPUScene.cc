@@ -1,13 +1,23 @@
 #include "GPUScene.hh"
 
+#include "assets/AssetManager.hh"
+#include "assets/CookedMesh.hh"
 #include "assets/GltfImpl.hh"
+#include "console/CVar.hh"
+#include "core/Culling.hh"
 #include "ecs/EcsImpl.hh"
 #include "graphics/vulkan/core/CommandContext.hh"
 #include "graphics/vulkan/core/DeviceContext.hh"
 #include "graphics/vulkan/scene/Mesh.hh"
 #include "graphics/vulkan/scene/VertexLayouts.hh"
 
+#include <numeric>
+
 namespace sp::vulkan {
+    static CVar<bool> CVarCookedMeshes("r.CookedMeshes",
+        true,
+        "Upload meshes from the mesh_cooker cache when it matches the source model");
+
     GPUScene::GPUScene(DeviceContext &device) : device(device), workQueue("", 0), textures(device, workQueue) {
         indexBuffer = device.AllocateBuffer({sizeof(uint32), 10 * 1024 * 1024},
             vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst,
@@ -44,51 +54,50 @@ namespace sp::vulkan {
     void GPUScene::LoadState(rg::RenderGraph &graph,
         ecs::Lock<ecs::Read<ecs::Renderable, ecs::OpticalElement, ecs::TransformSnapshot, ecs::Name>> lock) {
         ZoneScoped;
-        renderables.clear();
-        meshes.clear();
         opticEntities.clear();
         jointPoses.clear();
-        renderableCount = 0;
-        primitiveCount = 0;
-        vertexCount = 0;
+        stateFrame++;
 
         for (auto &ent : lock.EntitiesWith<ecs::Renderable>()) {
             if (!ent.Has<ecs::TransformSnapshot>(lock)) continue;
 
             auto &renderable = ent.Get<ecs::Renderable>(lock);
-            if (!renderable.model || !renderable.model->Ready()) continue;
+            if (!renderable.model) continue;
+
+            uint32 slotIndex = ent.index < entitySlots.size() ? entitySlots[ent.index] : ~0u;
+            if (slotIndex < renderableSlots.size() && renderableSlots[slotIndex].ent != ent) slotIndex = ~0u;
+            if (slotIndex < renderableSlots.size()) {
+                auto &slot = renderableSlots[slotIndex];
+                if (slot.model != renderable.model || slot.meshIndex != renderable.meshIndex) {
+                    RemoveRenderable(slotIndex);
+                    slotIndex = ~0u;
+                }
+            }
 
-            auto model = renderable.model->Get();
-            if (!model) continue;
+            if (slotIndex >= renderableSlots.size()) {
+                if (!renderable.model->Ready()) continue;
 
-            auto vkMesh = LoadMesh(model, renderable.meshIndex);
-            if (!vkMesh || !vkMesh->CheckReady()) continue;
+                auto model = renderable.model->Get();
+                if (!model) continue;
 
-            auto &transform = ent.Get<ecs::TransformSnapshot>(lock);
+                auto vkMesh = LoadMesh(model, renderable.meshIndex);
+                if (!vkMesh || !vkMesh->CheckReady()) continue;
 
-            GPURenderableEntity gpuRenderable;
-            gpuRenderable.modelToWorld = transform.GetMatrix();
-            gpuRenderable.visibilityMask = (uint32_t)renderable.visibility;
-            gpuRenderable.meshIndex = vkMesh->SceneIndex();
-            gpuRenderable.vertexOffset = vertexCount;
-            gpuRenderable.emissiveScale = renderable.emissiveScale;
-            if (glm::all(glm::greaterThanEqual(renderable.colorOverride.color, glm::vec4(0)))) {
-                gpuRenderable.baseColorOverrideID = textures.GetSinglePixelIndex(renderable.colorOverride);
-            }
-            if (glm::all(glm::greaterThanEqual(renderable.metallicRoughnessOverride, glm::vec2(0)))) {
-                gpuRenderable.metallicRoughnessOverrideID = textures.GetSinglePixelIndex(
-                    glm::vec4(renderable.metallicRoughnessOverride, 0, 1));
+                slotIndex = AddRenderable(ent, renderable, vkMesh);
             }
+
+            auto &slot = renderableSlots[slotIndex];
+            slot.lastSeenFrame = stateFrame;
+
+            uint32 opticID = 0;
             if (ent.Has<ecs::OpticalElement>(lock)) {
                 auto &optic = ent.Get<ecs::OpticalElement>(lock);
                 opticEntities.emplace_back(ent, optic);
-                gpuRenderable.opticID = opticEntities.size();
-                gpuRenderable.visibilityMask |= (uint32_t)ecs::VisibilityMask::Optics;
-            } else {
-                gpuRenderable.visibilityMask &= (uint32_t)~ecs::VisibilityMask::Optics;
+                opticID = opticEntities.size();
             }
 
-            if (!renderable.joints.empty()) gpuRenderable.jointPosesOffset = jointPoses.size();
+            uint32 jointPosesOffset = 0xffffffff;
+            if (!renderable.joints.empty()) jointPosesOffset = jointPoses.size();
 
             for (auto &joint : renderable.joints) {
                 auto jointEntity = joint.entity.Get(lock);
@@ -100,44 +109,221 @@ namespace sp::vulkan {
                 }
             }
 
-            renderables.push_back(gpuRenderable);
-            meshes.emplace_back(vkMesh);
+            auto &transform = ent.Get<ecs::TransformSnapshot>(lock);
+            RenderableState state = {transform,
+                renderable.visibility,
+                renderable.emissiveScale,
+                renderable.colorOverride.color,
+                renderable.metallicRoughnessOverride,
+                opticID,
+                jointPosesOffset};
+            if (slot.state == state) continue;
+            slot.state = state;
+
+            GPURenderableEntity &gpuRenderable = renderables[slotIndex];
+            gpuRenderable = {};
+            gpuRenderable.modelToWorld = transform.GetMatrix();
+            gpuRenderable.visibilityMask = (uint32_t)renderable.visibility;
+            gpuRenderable.meshIndex = slot.mesh->SceneIndex();
+            gpuRenderable.vertexOffset = slot.vertexOffset;
+            gpuRenderable.emissiveScale = renderable.emissiveScale;
+            if (glm::all(glm::greaterThanEqual(renderable.colorOverride.color, glm::vec4(0)))) {
+                gpuRenderable.baseColorOverrideID = textures.GetSinglePixelIndex(renderable.colorOverride);
+            }
+            if (glm::all(glm::greaterThanEqual(renderable.metallicRoughnessOverride, glm::vec2(0)))) {
+                gpuRenderable.metallicRoughnessOverrideID = textures.GetSinglePixelIndex(
+                    glm::vec4(renderable.metallicRoughnessOverride, 0, 1));
+            }
+            gpuRenderable.opticID = opticID;
+            if (opticID) {
+                gpuRenderable.visibilityMask |= (uint32_t)ecs::VisibilityMask::Optics;
+            } else {
+                gpuRenderable.visibilityMask &= (uint32_t)~ecs::VisibilityMask::Optics;
+            }
+            gpuRenderable.jointPosesOffset = jointPosesOffset;
+            dirtySlots.push_back(slotIndex);
+        }
 
-            renderableCount++;
-            primitiveCount += vkMesh->PrimitiveCount();
-            vertexCount += vkMesh->VertexCount();
+        // Swap removal only moves slots that were already seen this frame, so walk backwards
+        for (size_t i = renderableSlots.size(); i > 0; i--) {
+            if (renderableSlots[i - 1].lastSeenFrame != stateFrame) RemoveRenderable(i - 1);
         }
 
-        Assertf(renderables.size() == meshes.size(),
-            "Mismatched renderable and mesh counts: %u != %u",
+        Assertf(renderables.size() == renderableSlots.size(),
+            "Mismatched renderable and slot counts: %u != %u",
             renderables.size(),
-            meshes.size());
-
+            renderableSlots.size());
+        renderableCount = renderables.size();
         primitiveCountPowerOfTwo = std::max(1u, CeilToPowerOfTwo(primitiveCount));
 
         textures.Flush();
 
+        vector<vk::BufferCopy> uploadRegions;
+        rg::ResourceID previousID = rg::InvalidResource;
         graph.AddPass("SceneState")
             .Build([&](rg::PassBuilder &builder) {
+                // The next frame's buffer is built from this one, so this pass can't be skipped
+                builder.RequirePass();
+                previousID = builder.ReadPreviousFrame("RenderableEntities", Access::TransferRead);
+                if (previousID == rg::InvalidResource) {
+                    dirtySlots.resize(renderableCount);
+                    std::iota(dirtySlots.begin(), dirtySlots.end(), 0);
+                }
+
+                // Merge the dirty slots into contiguous ranges, packed back to back in the upload buffer
+                std::sort(dirtySlots.begin(), dirtySlots.end());
+                dirtySlots.erase(std::unique(dirtySlots.begin(), dirtySlots.end()), dirtySlots.end());
+                while (!dirtySlots.empty() && dirtySlots.back() >= renderableCount) {
+                    dirtySlots.pop_back();
+                }
+                const vk::DeviceSize stride = sizeof(GPURenderableEntity);
+                for (size_t i = 0; i < dirtySlots.size(); i++) {
+                    if (i > 0 && dirtySlots[i] == dirtySlots[i - 1] + 1) {
+                        uploadRegions.back().size += stride;
+                    } else {
+                        uploadRegions.emplace_back(i * stride, dirtySlots[i] * stride, stride);
+                    }
+                }
+                ZonePrintf("Uploading %u of %u renderables", dirtySlots.size(), renderableCount);
+
                 builder.CreateBuffer("RenderableEntities",
-                    {sizeof(renderables.front()), std::max(size_t(1), renderables.size())},
+                    {stride, std::max(1u, CeilToPowerOfTwo(renderableCount))},
+                    Residency::GPU_ONLY,
+                    Access::TransferWrite);
+                builder.CreateBuffer("RenderableEntityUploads",
+                    {stride, std::max(size_t(1), dirtySlots.size())},
                     Residency::CPU_TO_GPU,
-                    Access::HostWrite);
+                    Access::TransferRead);
 
                 Assertf(jointPoses.size() <= 100, "too many joints: %d", jointPoses.size());
                 builder.CreateUniform("JointPoses", sizeof(glm::mat4) * 100); // TODO: don't hardcode to 100 joints
             })
-            .Execute([this](rg::Resources &resources, DeviceContext &device) {
-                resources.GetBuffer("RenderableEntities")->CopyFrom(renderables.data(), renderables.size());
+            .Execute([this, uploadRegions, previousID](rg::Resources &resources, CommandContext &cmd) {
+                auto renderableBuffer = resources.GetBuffer("RenderableEntities");
+                if (previousID != rg::InvalidResource && renderableCount > 0) {
+                    auto previousBuffer = resources.GetBuffer(previousID);
+                    vk::BufferCopy region(0, 0, std::min(previousBuffer->ByteSize(), renderableBuffer->ByteSize()));
+                    cmd.Raw().copyBuffer(*previousBuffer, *renderableBuffer, {region});
+
+                    if (!uploadRegions.empty()) {
+                        // The uploads overwrite parts of the copy
+                        vk::MemoryBarrier barrier;
+                        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+                        barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+                        cmd.Raw().pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                            vk::PipelineStageFlagBits::eTransfer,
+                            {},
+                            {barrier},
+                            {},
+                            {});
+                    }
+                }
+
+                if (!uploadRegions.empty()) {
+                    const vk::DeviceSize stride = sizeof(GPURenderableEntity);
+                    auto uploadBuffer = resources.GetBuffer("RenderableEntityUploads");
+                    for (auto &region : uploadRegions) {
+                        uploadBuffer->CopyFrom(&renderables[region.dstOffset / stride],
+                            region.size / stride,
+                            region.srcOffset / stride);
+                    }
+                    cmd.Raw().copyBuffer(*uploadBuffer, *renderableBuffer, uploadRegions);
+                }
                 resources.GetBuffer("JointPoses")->CopyFrom(jointPoses.data(), jointPoses.size());
             });
+
+        dirtySlots.clear();
+    }
+
+    uint32 GPUScene::AddRenderable(ecs::Entity ent, const ecs::Renderable &renderable, shared_ptr<Mesh> mesh) {
+        uint32 slotIndex = renderableSlots.size();
+        auto &slot = renderableSlots.emplace_back();
+        slot.ent = ent;
+        slot.model = renderable.model;
+        slot.meshIndex = renderable.meshIndex;
+        slot.vertexOffset = AllocateVertices(mesh->VertexCount());
+        slot.mesh = std::move(mesh);
+        renderables.emplace_back();
+
+        if (ent.index >= entitySlots.size()) entitySlots.resize(ent.index + 1, ~0u);
+        entitySlots[ent.index] = slotIndex;
+        primitiveCount += slot.mesh->PrimitiveCount();
+        return slotIndex;
+    }
+
+    void GPUScene::RemoveRenderable(uint32 slotIndex) {
+        auto &slot = renderableSlots[slotIndex];
+        FreeVertices(slot.vertexOffset, slot.mesh->VertexCount());
+        primitiveCount -= slot.mesh->PrimitiveCount();
+        entitySlots[slot.ent.index] = ~0u;
+
+        uint32 lastIndex = renderableSlots.size() - 1;
+        if (slotIndex != lastIndex) {
+            slot = std::move(renderableSlots[lastIndex]);
+            renderables[slotIndex] = renderables[lastIndex];
+            entitySlots[slot.ent.index] = slotIndex;
+            dirtySlots.push_back(slotIndex);
+        }
+        renderableSlots.pop_back();
+        renderables.pop_back();
+    }
+
+    uint32 GPUScene::AllocateVertices(uint32 count) {
+        for (auto it = freeVertexRanges.begin(); it != freeVertexRanges.end(); it++) {
+            auto [offset, freeCount] = *it;
+            if (freeCount < count) continue;
+
+            freeVertexRanges.erase(it);
+            if (freeCount > count) freeVertexRanges.emplace(offset + count, freeCount - count);
+            return offset;
+        }
+        uint32 offset = vertexCount;
+        vertexCount += count;
+        return offset;
+    }
+
+    void GPUScene::FreeVertices(uint32 offset, uint32 count) {
+        if (count == 0) return;
+
+        // Merge with the neighboring free ranges
+        auto next = freeVertexRanges.lower_bound(offset);
+        if (next != freeVertexRanges.end() && offset + count == next->first) {
+            count += next->second;
+            next = freeVertexRanges.erase(next);
+        }
+        if (next != freeVertexRanges.begin()) {
+            auto prev = std::prev(next);
+            if (prev->first + prev->second == offset) {
+                offset = prev->first;
+                count += prev->second;
+                freeVertexRanges.erase(prev);
+            }
+        }
+
+        if (offset + count == vertexCount) {
+            vertexCount = offset;
+        } else {
+            freeVertexRanges.emplace(offset, count);
+        }
     }
 
     shared_ptr<Mesh> GPUScene::LoadMesh(const std::shared_ptr<const sp::Gltf> &model, size_t meshIndex) {
         if (meshIndex >= model->meshes.size()) return nullptr;
         auto vkMesh = activeMeshes.Load(MeshKeyView{model->name, meshIndex});
         if (!vkMesh) {
-            meshesToLoad.emplace_back(model, meshIndex);
+            auto pending = std::find_if(meshesToLoad.begin(), meshesToLoad.end(), [&](auto &pendingMesh) {
+                return pendingMesh.model == model && pendingMesh.meshIndex == meshIndex;
+            });
+            if (pending == meshesToLoad.end()) {
+                AsyncPtr<Asset> cooked;
+                if (CVarCookedMeshes.Get()) {
+                    cooked = Assets().Load(cookedmesh::CachePath(model->name, meshIndex),
+                        AssetType::Bundled,
+                        false,
+                        AssetPriority::High);
+                }
+                meshesToLoad.emplace_back(PendingMesh{model, meshIndex, cooked});
+            }
         }
         return vkMesh;
     }
@@ -145,15 +331,19 @@ namespace sp::vulkan {
     void GPUScene::FlushMeshes() {
         activeMeshes.Tick(std::chrono::milliseconds(33));
 
-        for (int i = (int)meshesToLoad.size() - 1; i >= 0; i--) {
-            auto &[model, meshIndex] = meshesToLoad[i];
-            if (activeMeshes.Contains(MeshKeyView{model->name, meshIndex})) {
-                meshesToLoad.pop_back();
-                continue;
-            }
+        for (auto it = meshesToLoad.begin(); it != meshesToLoad.end();) {
+            auto &[model, meshIndex, cooked] = *it;
+            if (!activeMeshes.Contains(MeshKeyView{model->name, meshIndex})) {
+                // Wait for the cooked mesh to finish loading, or fail to load, before falling back to the gltf
+                if (cooked && !cooked->Ready()) {
+                    it++;
+                    continue;
+                }
 
-            activeMeshes.Register(MeshKey{model->name, meshIndex}, make_shared<Mesh>(model, meshIndex, *this, device));
-            meshesToLoad.pop_back();
+                auto vkMesh = make_shared<Mesh>(model, meshIndex, cooked ? cooked->Get() : nullptr, *this, device);
+                activeMeshes.Register(MeshKey{model->name, meshIndex}, vkMesh);
+            }
+            it = meshesToLoad.erase(it);
         }
     }
 
@@ -245,8 +435,7 @@ namespace sp::vulkan {
                     auto &renderable = renderables[i];
                     if (((ecs::VisibilityMask)renderable.visibilityMask & viewMask) != viewMask) continue;
 
-                    auto mesh = meshes[i].lock();
-                    if (!mesh || !mesh->CheckReady()) continue;
+                    auto &mesh = renderableSlots[i].mesh;
 
                     for (auto &primitive : mesh->primitives) {
                         auto &drawCmd = drawCommands.emplace_back();
@@ -301,6 +490,236 @@ namespace sp::vulkan {
         return bufferIDs;
     }
 
+    GPUScene::DrawBufferIDs GPUScene::GenerateCulledDrawsForView(rg::RenderGraph &graph,
+        const ecs::View &view,
+        bool frustumCulling,
+        bool occlusionCulling,
+        uint32 instanceCount) {
+        DrawBufferIDs bufferIDs;
+        rg::ResourceID pyramidID = rg::InvalidResource;
+
+        GPUCullingView cullingView = {};
+        cullingView.viewProj = view.projMat * view.viewMat;
+        cullingView.frustumPlanes = culling::ExtractFrustum(cullingView.viewProj).planes;
+        cullingView.frustumCulling = frustumCulling;
+
+        graph.AddPass("GenerateCulledDrawsForView")
+            .Build([&](rg::PassBuilder &builder) {
+                const auto maxDraws = primitiveCountPowerOfTwo;
+
+                graph.AddPass("Clear")
+                    .Build([&](rg::PassBuilder &builder) {
+                        auto drawCmds = builder.CreateBuffer(
+                            {sizeof(uint32), sizeof(VkDrawIndexedIndirectCommand), maxDraws},
+                            Residency::GPU_ONLY,
+                            Access::TransferWrite);
+                        bufferIDs.drawCommandsBuffer = drawCmds.id;
+
+                        // A VkDispatchIndirectCommand followed by the number of occluded primitives
+                        builder.CreateBuffer("OccludedPrimitives",
+                            {sizeof(uint32) * 4, sizeof(glm::uvec2), maxDraws},
+                            Residency::GPU_ONLY,
+                            Access::TransferWrite);
+                    })
+                    .Execute([bufferIDs](rg::Resources &resources, CommandContext &cmd) {
+                        auto drawBuffer = resources.GetBuffer(bufferIDs.drawCommandsBuffer);
+                        cmd.Raw().fillBuffer(*drawBuffer, 0, sizeof(uint32), 0);
+
+                        auto occludedBuffer = resources.GetBuffer("OccludedPrimitives");
+                        cmd.Raw().fillBuffer(*occludedBuffer, 0, sizeof(uint32), 0);
+                        cmd.Raw().fillBuffer(*occludedBuffer, sizeof(uint32), sizeof(uint32) * 2, 1);
+                        cmd.Raw().fillBuffer(*occludedBuffer, sizeof(uint32) * 3, sizeof(uint32), 0);
+                    });
+
+                builder.Read("RenderableEntities", Access::ComputeShaderReadStorage);
+                builder.Read(bufferIDs.drawCommandsBuffer, Access::ComputeShaderReadStorage);
+                builder.Write(bufferIDs.drawCommandsBuffer, Access::ComputeShaderWrite);
+                builder.Read("OccludedPrimitives", Access::ComputeShaderReadStorage);
+                builder.Write("OccludedPrimitives", Access::ComputeShaderWrite);
+
+                auto drawParams = builder.CreateBuffer({sizeof(GPUDrawParams), maxDraws},
+                    Residency::GPU_ONLY,
+                    Access::ComputeShaderWrite);
+                bufferIDs.drawParamsBuffer = drawParams.id;
+
+                builder.CreateUniform("CullingView", sizeof(GPUCullingView));
+                builder.Read("CullingView", Access::ComputeShaderReadUniform);
+
+                if (occlusionCulling) {
+                    pyramidID = builder.ReadPreviousFrame("DepthPyramid", Access::ComputeShaderSampleImage);
+                    // The pyramid can only be reused if the view hasn't been resized
+                    if (depthPyramidExtent != glm::uvec2(view.extents)) pyramidID = rg::InvalidResource;
+                }
+                if (pyramidID != rg::InvalidResource) {
+                    cullingView.occlusionViewProj = depthPyramidViewProj;
+                    cullingView.depthExtent = depthPyramidExtent;
+                    cullingView.occlusionLevels = culling::DepthPyramidLevelCount(depthPyramidExtent);
+                }
+            })
+            .Execute([this, view, bufferIDs, pyramidID, cullingView, instanceCount](rg::Resources &resources,
+                         CommandContext &cmd) {
+                cmd.SetComputeShader("generate_culled_draws.comp");
+                cmd.SetStorageBuffer(0, 0, resources.GetBuffer("RenderableEntities"));
+                cmd.SetStorageBuffer(0, 1, models);
+                cmd.SetStorageBuffer(0, 2, primitiveLists);
+                cmd.SetStorageBuffer(0, 3, resources.GetBuffer(bufferIDs.drawCommandsBuffer));
+                cmd.SetStorageBuffer(0, 4, resources.GetBuffer(bufferIDs.drawParamsBuffer));
+                cmd.SetStorageBuffer(0, 5, resources.GetBuffer("OccludedPrimitives"));
+
+                auto cullingViewBuf = resources.GetBuffer("CullingView");
+                cullingViewBuf->CopyFrom(&cullingView);
+                cmd.SetUniformBuffer(0, 6, cullingViewBuf);
+
+                // The pyramid isn't sampled when occlusionLevels is 0, but the binding still needs an image
+                if (pyramidID != rg::InvalidResource) {
+                    cmd.SetImageView(0, 7, resources.GetImageView(pyramidID));
+                } else {
+                    cmd.SetImageView(0, 7, textures.GetSinglePixel(glm::vec4(1)));
+                }
+                cmd.SetSampler(0, 7, cmd.Device().GetSampler(SamplerType::NearestClampEdge));
+
+                struct {
+                    uint32 renderableCount;
+                    uint32 instanceCount;
+                    uint32 visibilityMask;
+                } constants;
+                constants.renderableCount = renderableCount;
+                constants.instanceCount = instanceCount;
+                constants.visibilityMask = (uint32_t)view.visibilityMask;
+                cmd.PushConstants(constants);
+
+                cmd.Dispatch((renderableCount + 127) / 128, 1, 1);
+            });
+        return bufferIDs;
+    }
+
+    void GPUScene::AddDepthPyramid(rg::RenderGraph &graph, const ecs::View &view) {
+        const glm::uvec2 depthExtent(view.extents);
+        const uint32 levelCount = culling::DepthPyramidLevelCount(depthExtent);
+        depthPyramidViewProj = view.projMat * view.viewMat;
+        depthPyramidExtent = depthExtent;
+
+        for (uint32 level = 0; level < levelCount; level++) {
+            graph.AddPass("DepthPyramid")
+                .Build([&](rg::PassBuilder &builder) {
+                    if (level == 0) {
+                        builder.Read("GBufferDepthStencil", Access::ComputeShaderSampleImage);
+
+                        auto extent = culling::DepthPyramidExtent(depthExtent, 0);
+                        rg::ImageDesc desc;
+                        desc.extent = vk::Extent3D(extent.x, extent.y, 1);
+                        desc.mipLevels = levelCount;
+                        desc.format = vk::Format::eR32Sfloat;
+                        desc.sampler = SamplerType::NearestClampEdge;
+                        builder.CreateImage("DepthPyramid", desc, Access::ComputeShaderWrite);
+                    } else {
+                        builder.Read("DepthPyramid", Access::ComputeShaderSampleImage);
+                        builder.Write("DepthPyramid", Access::ComputeShaderWrite);
+                    }
+                })
+                .Execute([depthExtent, level](rg::Resources &resources, CommandContext &cmd) {
+                    struct {
+                        glm::uvec2 inputExtent;
+                        glm::uvec2 outputExtent;
+                    } constants;
+                    constants.outputExtent = culling::DepthPyramidExtent(depthExtent, level);
+
+                    if (level == 0) {
+                        cmd.SetComputeShader("depth_pyramid_depth.comp");
+                        cmd.SetImageView(0, 0, resources.GetImageDepthView("GBufferDepthStencil"));
+                        constants.inputExtent = depthExtent;
+                    } else {
+                        cmd.SetComputeShader("depth_pyramid.comp");
+                        cmd.SetImageView(0, 0, resources.GetImageMipView("DepthPyramid", level - 1));
+                        constants.inputExtent = culling::DepthPyramidExtent(depthExtent, level - 1);
+                    }
+                    cmd.SetSampler(0, 0, cmd.Device().GetSampler(SamplerType::NearestClampEdge));
+                    cmd.SetImageView(0, 1, resources.GetImageMipView("DepthPyramid", level));
+                    cmd.PushConstants(constants);
+
+                    cmd.Dispatch((constants.outputExtent.x + 15) / 16, (constants.outputExtent.y + 15) / 16, 1);
+                });
+        }
+    }
+
+    GPUScene::DrawBufferIDs GPUScene::GenerateOccludedDrawsForView(rg::RenderGraph &graph,
+        const ecs::View &view,
+        uint32 instanceCount) {
+        DrawBufferIDs bufferIDs;
+
+        GPUCullingView cullingView = {};
+        cullingView.viewProj = view.projMat * view.viewMat;
+        cullingView.occlusionViewProj = cullingView.viewProj;
+        cullingView.depthExtent = glm::uvec2(view.extents);
+        cullingView.occlusionLevels = culling::DepthPyramidLevelCount(cullingView.depthExtent);
+
+        graph.AddPass("GenerateOccludedDrawsForView")
+            .Build([&](rg::PassBuilder &builder) {
+                const auto maxDraws = primitiveCountPowerOfTwo;
+
+                graph.AddPass("Clear")
+                    .Build([&](rg::PassBuilder &builder) {
+                        auto drawCmds = builder.CreateBuffer(
+                            {sizeof(uint32), sizeof(VkDrawIndexedIndirectCommand), maxDraws},
+                            Residency::GPU_ONLY,
+                            Access::TransferWrite);
+                        bufferIDs.drawCommandsBuffer = drawCmds.id;
+                    })
+                    .Execute([bufferIDs](rg::Resources &resources, CommandContext &cmd) {
+                        auto drawBuffer = resources.GetBuffer(bufferIDs.drawCommandsBuffer);
+                        cmd.Raw().fillBuffer(*drawBuffer, 0, sizeof(uint32), 0);
+                    });
+
+                builder.Read("RenderableEntities", Access::ComputeShaderReadStorage);
+                builder.Read("OccludedPrimitives", Access::IndirectBuffer);
+                builder.Read("OccludedPrimitives", Access::ComputeShaderReadStorage);
+                builder.Read("DepthPyramid", Access::ComputeShaderSampleImage);
+                builder.Read(bufferIDs.drawCommandsBuffer, Access::ComputeShaderReadStorage);
+                builder.Write(bufferIDs.drawCommandsBuffer, Access::ComputeShaderWrite);
+
+                auto drawParams = builder.CreateBuffer({sizeof(GPUDrawParams), maxDraws},
+                    Residency::GPU_ONLY,
+                    Access::ComputeShaderWrite);
+                bufferIDs.drawParamsBuffer = drawParams.id;
+
+                builder.CreateUniform("OccludedCullingView", sizeof(GPUCullingView));
+                builder.Read("OccludedCullingView", Access::ComputeShaderReadUniform);
+            })
+            .Execute([this, view, bufferIDs, cullingView, instanceCount](rg::Resources &resources,
+                         CommandContext &cmd) {
+                cmd.SetComputeShader("generate_occluded_draws.comp");
+                cmd.SetStorageBuffer(0, 0, resources.GetBuffer("RenderableEntities"));
+                cmd.SetStorageBuffer(0, 1, models);
+                cmd.SetStorageBuffer(0, 2, primitiveLists);
+                cmd.SetStorageBuffer(0, 3, resources.GetBuffer(bufferIDs.drawCommandsBuffer));
+                cmd.SetStorageBuffer(0, 4, resources.GetBuffer(bufferIDs.drawParamsBuffer));
+
+                auto occludedBuffer = resources.GetBuffer("OccludedPrimitives");
+                cmd.SetStorageBuffer(0, 5, occludedBuffer);
+
+                auto cullingViewBuf = resources.GetBuffer("OccludedCullingView");
+                cullingViewBuf->CopyFrom(&cullingView);
+                cmd.SetUniformBuffer(0, 6, cullingViewBuf);
+
+                cmd.SetImageView(0, 7, resources.GetImageView("DepthPyramid"));
+                cmd.SetSampler(0, 7, cmd.Device().GetSampler(SamplerType::NearestClampEdge));
+
+                struct {
+                    uint32 renderableCount;
+                    uint32 instanceCount;
+                    uint32 visibilityMask;
+                } constants;
+                constants.renderableCount = renderableCount;
+                constants.instanceCount = instanceCount;
+                constants.visibilityMask = (uint32_t)view.visibilityMask;
+                cmd.PushConstants(constants);
+
+                // The first phase counted the workgroups needed for the occluded primitives
+                cmd.DispatchIndirect(occludedBuffer, 0);
+            });
+        return bufferIDs;
+    }
+
     void GPUScene::DrawSceneIndirect(CommandContext &cmd,
         BufferPtr vertexBuffer,
         BufferPtr drawCommandsBuffer,
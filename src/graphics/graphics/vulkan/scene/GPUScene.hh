@@ -12,6 +12,10 @@
 #include "graphics/vulkan/render_graph/RenderGraph.hh"
 #include "graphics/vulkan/scene/TextureSet.hh"
 
+#include <array>
+#include <map>
+#include <optional>
+
 namespace sp::vulkan {
     class Mesh;
 
@@ -38,6 +42,7 @@ namespace sp::vulkan {
         uint32 firstIndex, vertexOffset;
         uint32 indexCount, vertexCount; // count of elements in the index/vertex buffers
         uint32 jointsVertexOffset;
+        glm::vec3 boundsMin, boundsMax; // Model space, stored as float[3] in std430
         uint16 baseColorTexID, metallicRoughnessTexID;
         // other material properties of the primitive can be stored here (or material ID)
     };
@@ -48,6 +53,7 @@ namespace sp::vulkan {
         uint32 primitiveCount;
         uint32 indexOffset;
         uint32 vertexOffset;
+        glm::vec3 boundsMin, boundsMax; // Union of the primitive bounds
     };
     static_assert(sizeof(GPUMeshModel) % sizeof(uint32) == 0, "std430 alignment");
 
@@ -72,6 +78,17 @@ namespace sp::vulkan {
     };
     static_assert(sizeof(GPUDrawParams) % sizeof(uint16_t) == 0, "std430 alignment");
 
+    // Matches CullingView in shaders/vulkan/lib/culling.glsl
+    struct GPUCullingView {
+        std::array<glm::vec4, 6> frustumPlanes;
+        glm::mat4 viewProj;
+        glm::mat4 occlusionViewProj;
+        glm::uvec2 depthExtent;
+        uint32 occlusionLevels = 0;
+        uint32 frustumCulling = 0;
+    };
+    static_assert(sizeof(GPUCullingView) % 16 == 0, "std140 alignment");
+
     class GPUScene {
     private:
         DeviceContext &device;
@@ -100,6 +117,25 @@ namespace sp::vulkan {
             bool reverseSort = false,
             uint32 instanceCount = 1);
 
+        /**
+         * Frustum and occlusion culled draws, the first phase of two phase culling. Primitives hidden behind the
+         * previous frame's "DepthPyramid" are added to the "OccludedPrimitives" list instead of being drawn.
+         * Skinned renderables are never culled, since they can move outside of their bounds.
+         */
+        DrawBufferIDs GenerateCulledDrawsForView(rg::RenderGraph &graph,
+            const ecs::View &view,
+            bool frustumCulling,
+            bool occlusionCulling,
+            uint32 instanceCount = 1);
+
+        // Builds the "DepthPyramid" image from the view's "GBufferDepthStencil", for occlusion culling
+        void AddDepthPyramid(rg::RenderGraph &graph, const ecs::View &view);
+
+        // The second phase of two phase culling, draws "OccludedPrimitives" not hidden behind this frame's depth
+        DrawBufferIDs GenerateOccludedDrawsForView(rg::RenderGraph &graph,
+            const ecs::View &view,
+            uint32 instanceCount = 1);
+
         void DrawSceneIndirect(CommandContext &cmd,
             BufferPtr vertexBuffer,
             BufferPtr drawCommandsBuffer,
@@ -127,7 +163,7 @@ namespace sp::vulkan {
         std::vector<OpticInstance> opticEntities;
         std::vector<glm::mat4> jointPoses;
 
-        uint32 vertexCount = 0;
+        uint32 vertexCount = 0; // Size of the warped vertex buffer, including ranges freed by removed renderables
         uint32 primitiveCount = 0;
         uint32 primitiveCountPowerOfTwo = 1; // Always at least 1. Used to size draw command buffers.
 
@@ -135,6 +171,34 @@ namespace sp::vulkan {
 
     private:
         void FlushMeshes();
+
+        uint32 AddRenderable(ecs::Entity ent, const ecs::Renderable &renderable, shared_ptr<Mesh> mesh);
+        void RemoveRenderable(uint32 slot);
+        uint32 AllocateVertices(uint32 count);
+        void FreeVertices(uint32 offset, uint32 count);
+
+        // The inputs a renderable's slot was last written from, compared each frame to find entities that changed
+        struct RenderableState {
+            ecs::Transform transform;
+            ecs::VisibilityMask visibility;
+            float emissiveScale;
+            glm::vec4 colorOverride;
+            glm::vec2 metallicRoughnessOverride;
+            uint32 opticID;
+            uint32 jointPosesOffset;
+
+            bool operator==(const RenderableState &) const = default;
+        };
+
+        struct RenderableSlot {
+            ecs::Entity ent;
+            AsyncPtr<Gltf> model;
+            size_t meshIndex;
+            shared_ptr<Mesh> mesh;
+            uint32 vertexOffset;
+            uint32 lastSeenFrame = 0;
+            std::optional<RenderableState> state;
+        };
         struct MeshKey {
             std::string modelName;
             size_t meshIndex;
@@ -173,8 +237,29 @@ namespace sp::vulkan {
         };
 
         PreservingMap<MeshKey, Mesh, 10000, MeshKeyHash, MeshKeyEqual> activeMeshes;
-        vector<std::pair<std::shared_ptr<const sp::Gltf>, size_t>> meshesToLoad;
+        struct PendingMesh {
+            std::shared_ptr<const sp::Gltf> model;
+            size_t meshIndex;
+            AsyncPtr<Asset> cooked;
+        };
+        vector<PendingMesh> meshesToLoad;
+
+        /**
+         * Renderables are stored in slots that persist across frames, so only entities that changed since the last
+         * frame are uploaded. Removed entities are swapped with the last slot, keeping the slots tightly packed.
+         * renderables mirrors the RenderableEntities buffer, which the GPU carries over from the previous frame.
+         */
         vector<GPURenderableEntity> renderables;
-        vector<std::weak_ptr<Mesh>> meshes;
+        vector<RenderableSlot> renderableSlots;
+        vector<uint32> entitySlots; // Indexed by ecs::Entity::index
+        vector<uint32> dirtySlots; // May contain duplicates and slots that were removed
+        uint32 stateFrame = 0;
+
+        // Offset -> count of unused ranges in the warped vertex buffer
+        std::map<uint32, uint32> freeVertexRanges;
+
+        // The view the last depth pyramid was built from, the next frame tests occlusion against it
+        glm::mat4 depthPyramidViewProj;
+        glm::uvec2 depthPyramidExtent = {0, 0};
     };
 } // namespace sp::vulkan
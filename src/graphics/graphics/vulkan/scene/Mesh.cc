@@ -1,5 +1,7 @@
 #include "Mesh.hh"
 
+#include "assets/Asset.hh"
+#include "assets/CookedMesh.hh"
 #include "assets/Gltf.hh"
 #include "assets/GltfImpl.hh"
 #include "core/Logging.hh"
@@ -10,7 +12,21 @@
 #include "graphics/vulkan/scene/VertexLayouts.hh"
 
 namespace sp::vulkan {
-    Mesh::Mesh(std::shared_ptr<const sp::Gltf> source, size_t meshIndex, GPUScene &scene, DeviceContext &device)
+    static_assert(sizeof(SceneVertex) == sizeof(CookedMesh::Vertex) &&
+                      offsetof(SceneVertex, position) == offsetof(CookedMesh::Vertex, position) &&
+                      offsetof(SceneVertex, normal) == offsetof(CookedMesh::Vertex, normal) &&
+                      offsetof(SceneVertex, uv) == offsetof(CookedMesh::Vertex, uv),
+        "SceneVertex layout must match CookedMesh::Vertex");
+    static_assert(sizeof(JointVertex) == sizeof(CookedMesh::JointVertex) &&
+                      offsetof(JointVertex, jointWeights) == offsetof(CookedMesh::JointVertex, jointWeights) &&
+                      offsetof(JointVertex, jointIndexes) == offsetof(CookedMesh::JointVertex, jointIndexes),
+        "JointVertex layout must match CookedMesh::JointVertex");
+
+    Mesh::Mesh(std::shared_ptr<const sp::Gltf> source,
+        size_t meshIndex,
+        std::shared_ptr<const Asset> cooked,
+        GPUScene &scene,
+        DeviceContext &device)
         : modelName(source->name), asset(source) {
         ZoneScoped;
         ZonePrintf("%s.%u", modelName, meshIndex);
@@ -18,31 +34,37 @@ namespace sp::vulkan {
         Assertf(meshIndex < source->meshes.size(), "Mesh index is out of range: %s.%u", modelName, meshIndex);
         auto &mesh = source->meshes[meshIndex];
         Assertf(mesh, "Mesh is undefined: %s.%u", modelName, meshIndex);
-        for (auto &assetPrimitive : mesh->primitives) {
-            indexCount += assetPrimitive.indexBuffer.Count();
-            vertexCount += assetPrimitive.positionBuffer.Count();
-            jointsCount += assetPrimitive.jointsBuffer.Count();
+
+        // Cooked meshes are copied straight from the cache file, otherwise the gltf is converted here
+        CookedMesh converted;
+        CookedMeshView meshData;
+        if (!cooked || !cookedmesh::Deserialize(cooked->Buffer(), source->asset->Hash(), meshData)) {
+            if (cooked) Logf("Ignoring outdated cooked mesh: %s.%u", modelName, meshIndex);
+            converted = cookedmesh::Convert(*mesh);
+            meshData = converted.View();
         }
+        Assertf(meshData.primitives.size() == mesh->primitives.size(),
+            "Cooked mesh primitive count mismatch: %s.%u",
+            modelName,
+            meshIndex);
+
+        indexCount = meshData.indices.size();
+        vertexCount = meshData.vertices.size();
+        jointsCount = meshData.joints.size();
 
         indexBuffer = scene.indexBuffer->ArrayAllocate(indexCount);
         staging.indexBuffer = device.AllocateBuffer({sizeof(uint32), indexCount},
             vk::BufferUsageFlagBits::eTransferSrc,
             VMA_MEMORY_USAGE_CPU_ONLY);
         Assertf(indexBuffer->ByteSize() == staging.indexBuffer->ByteSize(), "index staging buffer size mismatch");
-
-        auto indexData = (uint32 *)staging.indexBuffer->Mapped();
-        auto indexDataStart = indexData;
+        std::memcpy(staging.indexBuffer->Mapped(), meshData.indices.data(), meshData.indices.size_bytes());
 
         vertexBuffer = scene.vertexBuffer->ArrayAllocate(vertexCount);
         staging.vertexBuffer = device.AllocateBuffer({sizeof(SceneVertex), vertexCount},
             vk::BufferUsageFlagBits::eTransferSrc,
             VMA_MEMORY_USAGE_CPU_ONLY);
         Assertf(vertexBuffer->ByteSize() == staging.vertexBuffer->ByteSize(), "vertex staging buffer size mismatch");
-
-        auto vertexData = (SceneVertex *)staging.vertexBuffer->Mapped();
-        auto vertexDataStart = vertexData;
-
-        JointVertex *jointsData = nullptr, *jointsDataStart = nullptr;
+        std::memcpy(staging.vertexBuffer->Mapped(), meshData.vertices.data(), meshData.vertices.size_bytes());
 
         if (jointsCount > 0) {
             jointsBuffer = scene.jointsBuffer->ArrayAllocate(jointsCount);
@@ -51,61 +73,39 @@ namespace sp::vulkan {
                 VMA_MEMORY_USAGE_CPU_ONLY);
             Assertf(jointsBuffer->ByteSize() == staging.jointsBuffer->ByteSize(),
                 "joints staging buffer size mismatch");
-
-            jointsData = (JointVertex *)staging.jointsBuffer->Mapped();
-            jointsDataStart = jointsData;
+            std::memcpy(staging.jointsBuffer->Mapped(), meshData.joints.data(), meshData.joints.size_bytes());
         }
 
-        for (auto &assetPrimitive : mesh->primitives) {
+        for (auto &cookedPrimitive : meshData.primitives) {
             ZoneScopedN("CreatePrimitive");
-            // TODO: this implementation assumes a lot about the model format,
-            // and asserts the assumptions. It would be better to support more
-            // kinds of inputs, and convert the data rather than just failing.
-            Assert(assetPrimitive.drawMode == sp::gltf::Mesh::DrawMode::Triangles, "draw mode must be Triangles");
-
             auto &vkPrimitive = primitives.emplace_back();
-
-            vkPrimitive.indexCount = assetPrimitive.indexBuffer.Count();
-            vkPrimitive.indexOffset = indexData - indexDataStart;
-
-            for (size_t i = 0; i < vkPrimitive.indexCount; i++) {
-                *indexData++ = assetPrimitive.indexBuffer.Read(i);
-            }
-
-            vkPrimitive.vertexCount = assetPrimitive.positionBuffer.Count();
-            vkPrimitive.vertexOffset = vertexData - vertexDataStart;
-
-            vkPrimitive.jointsVertexCount = assetPrimitive.jointsBuffer.Count();
-            vkPrimitive.jointsVertexOffset = jointsData - jointsDataStart;
-
-            vkPrimitive.center = glm::vec3(0);
-            for (size_t i = 0; i < vkPrimitive.vertexCount; i++) {
-                SceneVertex &vertex = *vertexData++;
-
-                vertex.position = assetPrimitive.positionBuffer.Read(i);
-                if (i < assetPrimitive.normalBuffer.Count()) vertex.normal = assetPrimitive.normalBuffer.Read(i);
-                if (i < assetPrimitive.texcoordBuffer.Count()) vertex.uv = assetPrimitive.texcoordBuffer.Read(i);
-
-                if (jointsData && i < assetPrimitive.jointsBuffer.Count()) {
-                    Assert(i < assetPrimitive.weightsBuffer.Count(), "must have one weight per joint index");
-                    JointVertex &joints = *jointsData++;
-                    joints.jointIndexes = assetPrimitive.jointsBuffer.Read(i);
-                    joints.jointWeights = assetPrimitive.weightsBuffer.Read(i);
-                }
-
-                vkPrimitive.center += vertex.position;
-            }
-            vkPrimitive.center /= vkPrimitive.vertexCount;
+            vkPrimitive.indexOffset = cookedPrimitive.indexOffset;
+            vkPrimitive.indexCount = cookedPrimitive.indexCount;
+            vkPrimitive.vertexOffset = cookedPrimitive.vertexOffset;
+            vkPrimitive.vertexCount = cookedPrimitive.vertexCount;
+            vkPrimitive.jointsVertexOffset = cookedPrimitive.jointsVertexOffset;
+            vkPrimitive.jointsVertexCount = cookedPrimitive.jointsVertexCount;
+            vkPrimitive.center = cookedPrimitive.center;
+            vkPrimitive.boundsMin = cookedPrimitive.boundsMin;
+            vkPrimitive.boundsMax = cookedPrimitive.boundsMax;
 
             vkPrimitive.baseColor = scene.textures.LoadGltfMaterial(source,
-                assetPrimitive.materialIndex,
+                cookedPrimitive.materialIndex,
                 TextureType::BaseColor);
 
             vkPrimitive.metallicRoughness = scene.textures.LoadGltfMaterial(source,
-                assetPrimitive.materialIndex,
+                cookedPrimitive.materialIndex,
                 TextureType::MetallicRoughness);
         }
 
+        bool hasBounds = false;
+        for (auto &p : primitives) {
+            if (p.vertexCount == 0) continue;
+            boundsMin = hasBounds ? glm::min(boundsMin, p.boundsMin) : p.boundsMin;
+            boundsMax = hasBounds ? glm::max(boundsMax, p.boundsMax) : p.boundsMax;
+            hasBounds = true;
+        }
+
         primitiveList = scene.primitiveLists->ArrayAllocate(primitives.size());
         staging.primitiveList = device.AllocateBuffer({sizeof(GPUMeshPrimitive), primitives.size()},
             vk::BufferUsageFlagBits::eTransferSrc,
@@ -134,12 +134,16 @@ namespace sp::vulkan {
                                                   : 0xffffffff;
                 gpuPrim->baseColorTexID = p.baseColor.index;
                 gpuPrim->metallicRoughnessTexID = p.metallicRoughness.index;
+                gpuPrim->boundsMin = p.boundsMin;
+                gpuPrim->boundsMax = p.boundsMax;
                 gpuPrim++;
             }
             meshModel->primitiveCount = primitives.size();
             meshModel->primitiveOffset = primitiveList->ArrayOffset();
             meshModel->indexOffset = indexBuffer->ArrayOffset();
             meshModel->vertexOffset = vertexBuffer->ArrayOffset();
+            meshModel->boundsMin = boundsMin;
+            meshModel->boundsMax = boundsMax;
         }
 
         InlineVector<DeviceContext::BufferTransfer, 5> transfer;
@@ -27,9 +27,15 @@ namespace sp::vulkan {
             size_t jointsVertexOffset, jointsVertexCount;
             TextureHandle baseColor, metallicRoughness;
             glm::vec3 center;
+            glm::vec3 boundsMin, boundsMax; // Model space, before skinning
         };
 
-        Mesh(shared_ptr<const sp::Gltf> source, size_t meshIndex, GPUScene &scene, DeviceContext &device);
+        // If cooked is a cooked mesh matching the source gltf, it is uploaded instead of converting the gltf's data
+        Mesh(shared_ptr<const sp::Gltf> source,
+            size_t meshIndex,
+            shared_ptr<const Asset> cooked,
+            GPUScene &scene,
+            DeviceContext &device);
         ~Mesh();
 
         uint32 SceneIndex() const;
@@ -62,6 +68,7 @@ namespace sp::vulkan {
         shared_ptr<const sp::Gltf> asset;
 
         vector<Primitive> primitives;
+        glm::vec3 boundsMin = glm::vec3(0), boundsMax = glm::vec3(0); // Union of the primitive bounds
 
         uint32 vertexCount = 0, indexCount = 0, jointsCount = 0;
         struct {
@@ -1,10 +1,17 @@
 #include "TextureSet.hh"
 
+#include "assets/Asset.hh"
 #include "assets/AssetManager.hh"
+#include "assets/CookedTexture.hh"
 #include "assets/GltfImpl.hh"
+#include "console/CVar.hh"
 #include "graphics/vulkan/core/DeviceContext.hh"
 
 namespace sp::vulkan {
+    static CVar<bool> CVarCookedTextures("r.CookedTextures",
+        true,
+        "Upload textures from the texture_cooker cache when it matches the source model");
+
     TextureSet::TextureSet(DeviceContext &device, DispatchQueue &workQueue) : device(device), workQueue(workQueue) {
         textureDescriptorSet = device.CreateBindlessDescriptorSet();
         AllocateTextureIndex(); // reserve first index for blank pixel / error texture
@@ -34,7 +41,7 @@ namespace sp::vulkan {
         if (asyncPtr->Ready()) return Add(asyncPtr->Get());
 
         auto i = AllocateTextureIndex();
-        return {i, workQueue.Dispatch<void>(asyncPtr, [this, i](ImageViewPtr view) {
+        return {i, asyncPtr->Then<void>(workQueue, [this, i](ImageViewPtr view) {
                     DebugAssertf(view, "TextureSet::Add missing image view");
                     textures[i] = view;
                     texturesToFlush.push_back(i);
@@ -65,7 +72,7 @@ namespace sp::vulkan {
         if (it != textureCache.end()) return it->second;
 
         auto imageFut = Assets().LoadImage(name);
-        auto imageView = workQueue.Dispatch<ImageView>(imageFut, [=, this](shared_ptr<sp::Image> image) {
+        auto imageView = imageFut->Then<ImageView>(workQueue, [=, this](shared_ptr<sp::Image> image) {
             if (!image) {
                 Warnf("Missing asset image: %s", name);
                 return make_shared<Async<ImageView>>(GetSinglePixel(glm::vec4(1, 0, 1, 1)));
@@ -83,60 +90,18 @@ namespace sp::vulkan {
 
         ZoneScoped;
         auto &gltfModel = *source->gltfModel;
-        if (materialIndex < 0 || (size_t)materialIndex >= gltfModel.materials.size()) return {};
-        auto &material = gltfModel.materials[materialIndex];
-
-        string name = source->name + "_" + std::to_string(materialIndex) + "_";
-        int textureIndex = -1;
-        std::vector<double> factor;
-        bool srgb = false;
-
-        switch (type) {
-        case TextureType::BaseColor:
-            name += std::to_string(material.pbrMetallicRoughness.baseColorTexture.index) + "_BASE";
-            textureIndex = material.pbrMetallicRoughness.baseColorTexture.index;
-            factor = material.pbrMetallicRoughness.baseColorFactor;
-            srgb = true;
-            break;
-
-        // gltf2.0 uses a combined texture for metallic roughness.
-        // Roughness = G channel, Metallic = B channel.
-        // R and A channels are not used / should be ignored.
-        // https://github.com/KhronosGroup/glTF/blob/e5519ce050/specification/2.0/schema/material.pbrMetallicRoughness.schema.json
-        case TextureType::MetallicRoughness: {
-            name += std::to_string(material.pbrMetallicRoughness.metallicRoughnessTexture.index) + "_METALLICROUGHNESS";
-            textureIndex = material.pbrMetallicRoughness.metallicRoughnessTexture.index;
-            double rf = material.pbrMetallicRoughness.roughnessFactor,
-                   mf = material.pbrMetallicRoughness.metallicFactor;
-            if (rf != 1 || mf != 1) factor = {0.0, rf, mf, 0.0};
-            break;
-        }
-        case TextureType::Height:
-            name += std::to_string(material.normalTexture.index) + "_HEIGHT";
-            textureIndex = material.normalTexture.index;
-            // factor not supported for height textures
-            break;
-
-        case TextureType::Occlusion:
-            name += std::to_string(material.occlusionTexture.index) + "_OCCLUSION";
-            textureIndex = material.occlusionTexture.index;
-            // factor not supported for occlusion textures
-            break;
-
-        case TextureType::Emissive:
-            name += std::to_string(material.occlusionTexture.index) + "_EMISSIVE";
-            textureIndex = material.emissiveTexture.index;
-            factor = material.emissiveFactor;
-            break;
+        GltfTextureSource textureSource;
+        if (!cookedtexture::FindGltfTexture(*source, materialIndex, type, textureSource)) return {};
 
-        default:
-            return {};
-        }
+        auto &name = textureSource.name;
+        int textureIndex = textureSource.textureIndex;
+        auto &factor = textureSource.factor;
+        bool srgb = textureSource.srgb;
 
         auto cacheEntry = textureCache.find(name);
         if (cacheEntry != textureCache.end()) return cacheEntry->second;
 
-        if (textureIndex < 0 || (size_t)textureIndex >= gltfModel.textures.size()) {
+        if (textureIndex < 0) {
             if (factor.size() == 0) factor.push_back(1); // default texture is a single white pixel
 
             auto data = make_shared<std::array<uint8, 4>>();
@@ -204,11 +169,74 @@ namespace sp::vulkan {
             imageInfo.genMipmap = (samplerInfo.maxLod > 0);
         }
 
-        auto pending = Add(imageInfo, viewInfo, {img.image.data(), img.image.size(), source});
+        InitialData sourceData = {img.image.data(), img.image.size(), source};
+        if (!CVarCookedTextures.Get() || !device.SupportsTextureCompressionBC()) {
+            auto pending = Add(imageInfo, viewInfo, sourceData);
+            textureCache[name] = pending;
+            return pending;
+        }
+
+        // Asset::Hash() caches its result without locking, so it is read here instead of from the work queue
+        auto sourceHash = source->asset->Hash();
+        auto cooked = Assets().Load(cookedtexture::CachePath(name), AssetType::Bundled, false, AssetPriority::High);
+        auto imageView = cooked->Then<ImageView>(workQueue, [=, this](shared_ptr<const Asset> asset) {
+            CookedTextureView cookedView;
+            if (asset && cookedtexture::Deserialize(asset->Buffer(), sourceHash, cookedView)) {
+                return LoadCookedTexture(cookedView, viewInfo, asset);
+            }
+            return device.CreateImageAndView(imageInfo, viewInfo, sourceData);
+        });
+        auto pending = Add(imageView);
         textureCache[name] = pending;
         return pending;
     }
 
+    AsyncPtr<ImageView> TextureSet::LoadCookedTexture(const CookedTextureView &texture,
+        ImageViewCreateInfo viewInfo,
+        const shared_ptr<const void> &dataOwner) {
+        ImageCreateInfo imageInfo;
+        imageInfo.imageType = vk::ImageType::e2D;
+        imageInfo.usage = vk::ImageUsageFlagBits::eSampled;
+        imageInfo.extent = vk::Extent3D(texture.width, texture.height, 1);
+        for (uint32 level = 0; level < texture.levelCount; level++) {
+            imageInfo.levelOffsets.push_back(texture.LevelOffset(level));
+        }
+
+        switch (texture.format) {
+        case CookedTextureFormat::RGBA8:
+            imageInfo.format = texture.srgb ? vk::Format::eR8G8B8A8Srgb : vk::Format::eR8G8B8A8Unorm;
+            break;
+        case CookedTextureFormat::BC1:
+            imageInfo.format = texture.srgb ? vk::Format::eBc1RgbaSrgbBlock : vk::Format::eBc1RgbaUnormBlock;
+            break;
+        case CookedTextureFormat::BC3:
+            imageInfo.format = texture.srgb ? vk::Format::eBc3SrgbBlock : vk::Format::eBc3UnormBlock;
+            break;
+        case CookedTextureFormat::BC5:
+            imageInfo.format = vk::Format::eBc5UnormBlock;
+            break;
+        case CookedTextureFormat::BC7:
+            imageInfo.format = texture.srgb ? vk::Format::eBc7SrgbBlock : vk::Format::eBc7UnormBlock;
+            break;
+        }
+
+        vk::ComponentSwizzle *components[4] = {&viewInfo.mapping.r,
+            &viewInfo.mapping.g,
+            &viewInfo.mapping.b,
+            &viewInfo.mapping.a};
+        for (size_t i = 0; i < 4; i++) {
+            auto channel = texture.swizzle[i];
+            if (channel == cookedtexture::CHANNEL_ZERO) {
+                *components[i] = vk::ComponentSwizzle::eZero;
+            } else if (channel == cookedtexture::CHANNEL_ONE) {
+                *components[i] = vk::ComponentSwizzle::eOne;
+            } else {
+                *components[i] = (vk::ComponentSwizzle)((int)vk::ComponentSwizzle::eR + channel);
+            }
+        }
+        return device.CreateImageAndView(imageInfo, viewInfo, {texture.data.data(), texture.data.size(), dataOwner});
+    }
+
     void TextureSet::Flush() {
         texturesPendingDelete.clear();
 
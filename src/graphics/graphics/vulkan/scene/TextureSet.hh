@@ -1,6 +1,7 @@
 #pragma once
 
 #include "assets/Async.hh"
+#include "assets/CookedTexture.hh"
 #include "assets/Gltf.hh"
 #include "core/DispatchQueue.hh"
 #include "core/Hashing.hh"
@@ -53,6 +54,9 @@ namespace sp::vulkan {
 
     private:
         ImageViewPtr CreateSinglePixel(glm::u8vec4 value);
+        AsyncPtr<ImageView> LoadCookedTexture(const CookedTextureView &texture,
+            ImageViewCreateInfo viewInfo,
+            const shared_ptr<const void> &dataOwner);
         void ReleaseTexture(TextureIndex i);
         TextureIndex AllocateTextureIndex();
 
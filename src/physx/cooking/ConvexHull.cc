@@ -9,8 +9,11 @@
 #include "core/Logging.hh"
 
 #include <PxPhysicsAPI.h>
+#include <climits>
+#include <cstdio>
 #include <cstdlib>
 #include <fstream>
+#include <murmurhash/MurmurHash3.h>
 #include <unordered_set>
 
 #define ENABLE_VHACD_IMPLEMENTATION 1
@@ -69,15 +72,8 @@ namespace sp {
         const HullSettings &settings) {
         ZoneScoped;
         Assert(prim.drawMode == gltf::Mesh::DrawMode::Triangles, "primitive draw mode must be triangles");
-        std::vector<glm::vec3> points(prim.positionBuffer.Count());
-        std::vector<uint32_t> indices(prim.indexBuffer.Count());
-
-        for (size_t i = 0; i < prim.positionBuffer.Count(); i++) {
-            points[i] = prim.positionBuffer.Read(i);
-        }
-        for (size_t i = 0; i < prim.indexBuffer.Count(); i++) {
-            indices[i] = prim.indexBuffer.Read(i);
-        }
+        std::vector<glm::vec3> points = prim.positionBuffer.ReadAll();
+        std::vector<uint32_t> indices = prim.indexBuffer.ReadAll();
 
         static VHACDCallback vhacdCallback;
 
@@ -124,11 +120,11 @@ namespace sp {
         std::vector<VHACD::Vertex> points;
         points.reserve(prim.positionBuffer.Count());
 
-        for (size_t i = 0; i < prim.indexBuffer.Count(); i++) {
-            uint32_t index = prim.indexBuffer.Read(i);
-            if (visitedIndexes.count(index) || index >= prim.positionBuffer.Count()) continue;
+        auto positions = prim.positionBuffer.ReadAll();
+        for (auto index : prim.indexBuffer.ReadAll()) {
+            if (visitedIndexes.count(index) || index >= positions.size()) continue;
 
-            auto value = prim.positionBuffer.Read(index);
+            auto &value = positions[index];
             points.emplace_back(value.x, value.y, value.z);
             visitedIndexes.insert(index);
         }
@@ -185,12 +181,12 @@ namespace sp {
     }
 
     // Increment if the Collision Cache format ever changes
-    const uint32 hullCacheMagic = 0xc044;
+    const uint32 hullCacheMagic = 0xc045;
 
 #pragma pack(push, 1)
     struct hullCacheHeader {
         uint32_t magicNumber = hullCacheMagic;
-        Hash128 modelHash;
+        Hash128 meshHash;
         Hash128 settingsHash;
         uint32_t bufferSize = 0;
     };
@@ -199,6 +195,55 @@ namespace sp {
 
     static_assert(sizeof(hullCacheHeader) == 40, "Hull cache header size changed unexpectedly");
 
+    std::string hullgen::CollisionCacheKey::String() const {
+        char str[65];
+        std::snprintf(str,
+            sizeof(str),
+            "%016llx%016llx%016llx%016llx",
+            (unsigned long long)meshHash[0],
+            (unsigned long long)meshHash[1],
+            (unsigned long long)settingsHash[0],
+            (unsigned long long)settingsHash[1]);
+        return str;
+    }
+
+    std::optional<hullgen::CollisionCacheKey> hullgen::GetCollisionCacheKey(const Gltf &model,
+        const HullSettings &settings) {
+        ZoneScoped;
+        if (settings.hull.meshIndex >= model.meshes.size()) return {};
+        auto &mesh = model.meshes[settings.hull.meshIndex];
+        if (!mesh) return {};
+
+        // Only the data read by BuildConvexHulls is hashed, so edits to other parts of the model don't invalidate hulls
+        std::vector<uint8_t> meshData;
+        auto append = [&meshData](const auto &value) {
+            auto *bytes = reinterpret_cast<const uint8_t *>(&value);
+            meshData.insert(meshData.end(), bytes, bytes + sizeof(value));
+        };
+        for (auto &prim : mesh->primitives) {
+            append(prim.drawMode);
+            append((uint64_t)prim.positionBuffer.Count());
+            for (auto &position : prim.positionBuffer.ReadAll()) {
+                append(position);
+            }
+            append((uint64_t)prim.indexBuffer.Count());
+            for (auto index : prim.indexBuffer.ReadAll()) {
+                append(index);
+            }
+        }
+        Assertf(meshData.size() <= INT_MAX, "Mesh data size overflows int: %s", settings.name);
+
+        CollisionCacheKey key;
+        MurmurHash3_x86_128(meshData.data(), (int)meshData.size(), hullCacheMagic, key.meshHash.data());
+
+        // The mesh index only selects which mesh is hashed above
+        HashKey<HullSettings::Fields> settingsHash;
+        settingsHash.input = settings.hull;
+        settingsHash.input.meshIndex = 0;
+        key.settingsHash = settingsHash.Hash_128();
+        return key;
+    }
+
     std::shared_ptr<ConvexHullSet> hullgen::LoadCollisionCache(physx::PxSerializationRegistry &registry,
         const AsyncPtr<Gltf> &modelPtr,
         const AsyncPtr<HullSettings> &settingsPtr) {
@@ -235,14 +280,8 @@ namespace sp {
             return nullptr;
         }
 
-        if (!model->asset || header->modelHash != model->asset->Hash()) {
-            Logf("Ignoring outdated collision cache for %s", settings->name);
-            return nullptr;
-        }
-
-        HashKey<HullSettings::Fields> settingsHash;
-        settingsHash.input = settings->hull;
-        if (header->settingsHash != settingsHash.Hash_128()) {
+        auto key = GetCollisionCacheKey(*model, *settings);
+        if (!key || header->meshHash != key->meshHash || header->settingsHash != key->settingsHash) {
             Logf("Ignoring outdated collision cache for %s", settings->name);
             return nullptr;
         }
@@ -322,13 +361,14 @@ namespace sp {
             return;
         }
 
+        auto key = GetCollisionCacheKey(*model, *settings);
+        Assertf(key, "SaveCollisionCache failed to hash mesh: %s", settings->name);
+
         std::ofstream out;
         if (Assets().OutputStream("cache/collision/" + settings->name, out)) {
             hullCacheHeader header = {};
-            header.modelHash = model->asset->Hash();
-            HashKey<HullSettings::Fields> settingsHash = {};
-            settingsHash.input = settings->hull;
-            header.settingsHash = settingsHash.Hash_128();
+            header.meshHash = key->meshHash;
+            header.settingsHash = key->settingsHash;
             header.bufferSize = buf.getSize();
 
             out.write(reinterpret_cast<const char *>(&header), sizeof(header));
@@ -6,7 +6,9 @@
 #include <atomic>
 #include <glm/glm.hpp>
 #include <memory>
+#include <optional>
 #include <robin_hood.h>
+#include <string>
 #include <vector>
 
 namespace physx {
@@ -40,6 +42,22 @@ namespace sp {
     };
 
     namespace hullgen {
+        /**
+         * Identifies a cooked hull set by the mesh data and hull settings it was built from.
+         * The key doesn't depend on the model or mesh name, so identical meshes share cache entries.
+         */
+        struct CollisionCacheKey {
+            Hash128 meshHash = {0, 0};
+            Hash128 settingsHash = {0, 0};
+
+            bool operator==(const CollisionCacheKey &other) const = default;
+
+            // Returns the key as a hex string, usable as a file name
+            std::string String() const;
+        };
+
+        std::optional<CollisionCacheKey> GetCollisionCacheKey(const Gltf &model, const HullSettings &settings);
+
         // Builds convex hull set for a model without caching
         std::shared_ptr<ConvexHullSet> BuildConvexHulls(physx::PxCooking &cooking,
             physx::PxPhysics &physics,
@@ -17,9 +17,9 @@ namespace sp {
             auto &animation = ent.Get<ecs::Animation>(lock);
             if (animation.states.empty()) continue;
 
-            ecs::SignalRef stateRef(ent, "animation_state");
+            auto &[stateRef, targetRef] = animationSignals.Get(ent);
             double currentState = stateRef.GetSignal(lock);
-            double targetState = ecs::SignalRef(ent, "animation_target").GetSignal(lock);
+            double targetState = targetRef.GetSignal(lock);
             double originalState = currentState;
             currentState = std::clamp(currentState, 0.0, animation.states.size() - 1.0);
             targetState = std::clamp(targetState, 0.0, animation.states.size() - 1.0);
@@ -35,7 +35,7 @@ namespace sp {
                 }
             }
 
-            ecs::Animation::UpdateTransform(lock, ent);
+            ecs::Animation::UpdateTransform(lock, ent, originalState, targetState);
 
             if (originalState != currentState) {
                 stateRef.SetValue(lock, currentState);
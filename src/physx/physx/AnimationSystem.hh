@@ -2,6 +2,7 @@
 
 #include "ecs/Ecs.hh"
 #include "ecs/SignalExpression.hh"
+#include "ecs/SignalRefCache.hh"
 
 namespace sp {
     class PhysxManager;
@@ -17,5 +18,6 @@ namespace sp {
 
     private:
         const double frameInterval;
+        ecs::SignalRefCache<2> animationSignals{"animation_state", "animation_target"};
     };
 } // namespace sp
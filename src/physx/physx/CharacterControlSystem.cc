@@ -45,7 +45,12 @@ namespace sp {
         8.0,
         "Character controller minimum gravity required to orient (m/s^2)");
 
-    CharacterControlSystem::CharacterControlSystem(PhysxManager &manager) : manager(manager) {
+    CharacterControlSystem::CharacterControlSystem(PhysxManager &manager)
+        : manager(manager), movementSignals(INPUT_SIGNAL_MOVE_RELATIVE_X,
+                                INPUT_SIGNAL_MOVE_RELATIVE_Y,
+                                INPUT_SIGNAL_MOVE_RELATIVE_Z,
+                                INPUT_SIGNAL_MOVE_SPRINT,
+                                INPUT_SIGNAL_MOVE_NOCLIP) {
         GetSceneManager().QueueActionAndBlock(SceneAction::ApplySystemScene,
             "character",
             [](ecs::Lock<ecs::AddRemove> lock, std::shared_ptr<Scene> scene) {
@@ -286,7 +291,8 @@ namespace sp {
             }
             // Logf("Start headRelativePlayer pos: %s", glm::to_string(headRelativePlayer.GetPosition()));
 
-            bool noclip = ecs::SignalRef(entity, INPUT_SIGNAL_MOVE_NOCLIP).GetSignal(lock) >= 0.5;
+            auto &[moveX, moveY, moveZ, moveSprint, moveNoclip] = movementSignals.Get(entity);
+            bool noclip = moveNoclip.GetSignal(lock) >= 0.5;
             if (userData->noclipping != noclip) {
                 manager.SetCollisionGroup(actor, noclip ? ecs::PhysicsGroup::NoClip : ecs::PhysicsGroup::Player);
                 userData->noclipping = noclip;
@@ -407,10 +413,10 @@ namespace sp {
 
             // Read character movement inputs
             glm::vec3 movementInput = glm::vec3(0);
-            movementInput.x = ecs::SignalRef(entity, INPUT_SIGNAL_MOVE_RELATIVE_X).GetSignal(lock);
-            movementInput.y = ecs::SignalRef(entity, INPUT_SIGNAL_MOVE_RELATIVE_Y).GetSignal(lock);
-            movementInput.z = ecs::SignalRef(entity, INPUT_SIGNAL_MOVE_RELATIVE_Z).GetSignal(lock);
-            bool sprint = ecs::SignalRef(entity, INPUT_SIGNAL_MOVE_SPRINT).GetSignal(lock) >= 0.5;
+            movementInput.x = moveX.GetSignal(lock);
+            movementInput.y = moveY.GetSignal(lock);
+            movementInput.z = moveZ.GetSignal(lock);
+            bool sprint = moveSprint.GetSignal(lock) >= 0.5;
 
             bool jump = false;
             ecs::Event event;
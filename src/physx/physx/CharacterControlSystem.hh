@@ -2,6 +2,7 @@
 
 #include "ecs/Ecs.hh"
 #include "ecs/SignalExpression.hh"
+#include "ecs/SignalRefCache.hh"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
@@ -23,5 +24,6 @@ namespace sp {
     private:
         PhysxManager &manager;
         ecs::ComponentObserver<ecs::CharacterController> characterControllerObserver;
+        ecs::SignalRefCache<5> movementSignals;
     };
 } // namespace sp
@@ -1,5 +1,6 @@
 #include "LaserSystem.hh"
 
+#include "console/CVar.hh"
 #include "core/Common.hh"
 #include "core/Tracing.hh"
 #include "ecs/Ecs.hh"
@@ -9,28 +10,41 @@
 #include "physx/PhysxUtils.hh"
 
 #include <PxQueryReport.h>
+#include <algorithm>
+#include <array>
+#include <extensions/PxShapeExt.h>
 
 namespace sp {
     using namespace physx;
 
     CVar<int> CVarLaserRecursion("x.LaserRecursion", 10, "maximum number of laser bounces");
     CVar<float> CVarLaserBounceOffset("x.LaserBounceOffset", 0.001f, "Distance to offset laser bounces");
+    static CVar<uint32_t> CVarLaserWorkerThreads("x.LaserWorkerThreads",
+        4,
+        "Number of threads used to trace laser paths (0 to trace on the physics thread)");
 
     LaserSystem::LaserSystem(PhysxManager &manager) : manager(manager) {}
 
+    template<typename OpticMap>
     struct OpticFilterCallback : PxQueryFilterCallback {
-        OpticFilterCallback(ecs::Lock<ecs::Read<ecs::OpticalElement>> lock) : lock(lock) {}
+        OpticFilterCallback(const OpticMap &optics,
+            std::vector<ecs::Entity> &seenOwners,
+            std::vector<const PxRigidActor *> &seenActors)
+            : optics(optics), seenOwners(seenOwners), seenActors(seenActors) {}
 
         virtual PxQueryHitType::Enum preFilter(const PxFilterData &filterData,
             const PxShape *shape,
             const PxRigidActor *actor,
             PxHitFlags &queryFlags) {
             if (!actor) return PxQueryHitType::eNONE;
+            seenActors.emplace_back(actor);
             auto userData = (ShapeUserData *)shape->userData;
             if (!userData) return PxQueryHitType::eNONE;
+            seenOwners.emplace_back(userData->owner);
 
-            if (userData->owner.Has<ecs::OpticalElement>(lock)) {
-                auto &optic = userData->owner.Get<ecs::OpticalElement>(lock);
+            auto it = optics.find(userData->owner);
+            if (it != optics.end()) {
+                auto &optic = it->second.optic;
                 if (optic.passTint == glm::vec3(1)) {
                     if (color * optic.reflectTint == glm::vec3(0)) {
                         return PxQueryHitType::eNONE;
@@ -54,33 +68,54 @@ namespace sp {
             return PxQueryHitType::eNONE;
         }
 
-        ecs::Lock<ecs::Read<ecs::OpticalElement>> lock;
+        const OpticMap &optics;
+        std::vector<ecs::Entity> &seenOwners;
+        std::vector<const PxRigidActor *> &seenActors;
         color_t color;
     };
 
+    static bool SegmentIntersectsBounds(const ecs::LaserLine::Segment &segment, const PxBounds3 &bounds) {
+        // Slab test, clipping the segment to each axis of the bounds in turn
+        glm::vec3 boundsMin = PxVec3ToGlmVec3(bounds.minimum);
+        glm::vec3 boundsMax = PxVec3ToGlmVec3(bounds.maximum);
+        glm::vec3 delta = segment.end - segment.start;
+        float tMin = 0.0f, tMax = 1.0f;
+        for (int axis = 0; axis < 3; axis++) {
+            if (std::abs(delta[axis]) < 1e-8f) {
+                if (segment.start[axis] < boundsMin[axis] || segment.start[axis] > boundsMax[axis]) return false;
+                continue;
+            }
+            float t0 = (boundsMin[axis] - segment.start[axis]) / delta[axis];
+            float t1 = (boundsMax[axis] - segment.start[axis]) / delta[axis];
+            if (t0 > t1) std::swap(t0, t1);
+            tMin = std::max(tMin, t0);
+            tMax = std::min(tMax, t1);
+            if (tMin > tMax) return false;
+        }
+        return true;
+    }
+
     void LaserSystem::Frame(ecs::Lock<ecs::ReadSignalsLock,
         ecs::Read<ecs::TransformSnapshot, ecs::LaserEmitter, ecs::OpticalElement>,
         ecs::Write<ecs::LaserLine, ecs::LaserSensor, ecs::Signals>> lock) {
         ZoneScoped;
-
-        struct LaserStart {
-            glm::vec3 rayStart, rayDir;
-            color_t color;
-            int depth = 0;
-        };
-
-        static std::vector<LaserStart> emitterQueue;
-
-        for (auto &entity : lock.EntitiesWith<ecs::LaserSensor>()) {
-            auto &sensor = entity.Get<ecs::LaserSensor>(lock);
-            sensor.illuminance = glm::vec3(0);
+        frameCount++;
+        if (maxReflections != CVarLaserRecursion.Get() || bounceOffset != CVarLaserBounceOffset.Get()) {
+            maxReflections = CVarLaserRecursion.Get();
+            bounceOffset = CVarLaserBounceOffset.Get();
+            invalidateAll = true;
         }
+        UpdateOptics(lock);
+        UpdateActors();
+
+        tracing.clear();
         for (auto &entity : lock.EntitiesWith<ecs::LaserEmitter>()) {
             if (!entity.Has<ecs::TransformSnapshot, ecs::LaserLine>(lock)) continue;
 
             auto &emitter = entity.Get<ecs::LaserEmitter>(lock);
             auto &lines = entity.Get<ecs::LaserLine>(lock);
             lines.on = emitter.on;
+            // Paths of emitters that are off are dropped, since changes to the scene aren't tracked for them
             if (!emitter.on) continue;
 
             auto &transform = entity.Get<ecs::TransformSnapshot>(lock);
@@ -88,145 +123,332 @@ namespace sp {
             lines.intensity = emitter.intensity;
             lines.relative = false;
 
-            if (!std::holds_alternative<ecs::LaserLine::Segments>(lines.line)) lines.line = ecs::LaserLine::Segments();
-            auto &segments = std::get<ecs::LaserLine::Segments>(lines.line);
-            segments.clear();
-
+            auto &[colorR, colorG, colorB] = emitterSignals.Get(entity);
             color_t signalColor = glm::vec3{
-                ecs::SignalRef(entity, "laser_color_r").GetSignal(lock),
-                ecs::SignalRef(entity, "laser_color_g").GetSignal(lock),
-                ecs::SignalRef(entity, "laser_color_b").GetSignal(lock),
+                colorR.GetSignal(lock),
+                colorG.GetSignal(lock),
+                colorB.GetSignal(lock),
             };
+            color_t color = emitter.color + signalColor;
+
+            auto &path = paths[entity];
+            path.lastSeenFrame = frameCount;
+            bool inputsChanged = path.transform != transform || !(path.color == color) ||
+                                 path.startDistance != emitter.startDistance;
+            if (invalidateAll || inputsChanged || !IsPathValid(path)) {
+                path.valid = false;
+                path.transform = transform;
+                path.color = color;
+                path.startDistance = emitter.startDistance;
+                tracing.emplace_back(&path);
+            }
+        }
+        for (auto it = paths.begin(); it != paths.end();) {
+            if (it->second.lastSeenFrame != frameCount) {
+                it = paths.erase(it);
+            } else {
+                it++;
+            }
+        }
+        invalidateAll = false;
+
+        {
+            ZoneScopedN("TracePaths");
+            ZoneValue(tracing.size());
+            size_t threadCount = CVarLaserWorkerThreads.Get();
+            if (!workQueue && threadCount > 0) {
+                workQueue = std::make_unique<DispatchQueue>("LaserTrace", threadCount, DispatchQueue::Workers::Shared);
+            }
 
-            std::array<physx::PxRaycastHit, 128> hitBuffer;
-
-            PxRaycastBuffer hit;
-            hit.touches = hitBuffer.data();
-            hit.maxNbTouches = hitBuffer.size();
-            PxFilterData filterData;
-            filterData.word0 = (uint32_t)(ecs::PHYSICS_GROUP_WORLD | ecs::PHYSICS_GROUP_INTERACTIVE |
-                                          ecs::PHYSICS_GROUP_HELD_OBJECT | ecs::PHYSICS_GROUP_PLAYER_LEFT_HAND |
-                                          ecs::PHYSICS_GROUP_PLAYER_RIGHT_HAND);
-
-            OpticFilterCallback filterCallback(lock);
-
-            const float maxDistance = 1000.0f;
-            int maxReflections = CVarLaserRecursion.Get();
-            float bounceOffset = CVarLaserBounceOffset.Get();
-            bool status = true;
-
-            emitterQueue.clear();
-            emitterQueue.emplace_back(LaserStart{
-                transform.GetPosition() + transform.GetForward() * emitter.startDistance * transform.GetScale(),
-                transform.GetForward(),
-                emitter.color + signalColor,
-            });
-
-            while (!emitterQueue.empty()) {
-                auto laserStart = emitterQueue.back();
-                emitterQueue.pop_back();
-                laserStart.depth++;
-                if (laserStart.depth > maxReflections) continue;
-
-                filterCallback.color = laserStart.color;
-                status = manager.scene->raycast(GlmVec3ToPxVec3(laserStart.rayStart),
-                    GlmVec3ToPxVec3(laserStart.rayDir),
-                    maxDistance,
-                    hit,
-                    PxHitFlag::eNORMAL,
-                    PxQueryFilterData(filterData,
-                        PxQueryFlag::eSTATIC | PxQueryFlag::eDYNAMIC | PxQueryFlag::ePREFILTER),
-                    &filterCallback);
-
-                if (!status) {
-                    auto &segment = segments.emplace_back();
-                    segment.start = laserStart.rayStart;
-                    segment.end = laserStart.rayStart + laserStart.rayDir * maxDistance;
-                    segment.color = laserStart.color;
+            // Tracing only reads from the scene and the cached optics, so paths can be traced concurrently.
+            // The last path is traced on this thread while the workers process the rest.
+            std::vector<AsyncPtr<void>> results;
+            for (size_t i = 0; i < tracing.size(); i++) {
+                auto *path = tracing[i];
+                if (workQueue && threadCount > 0 && i + 1 < tracing.size()) {
+                    results.emplace_back(workQueue->Dispatch<void>([this, path]() {
+                        TracePath(*path);
+                    }));
                 } else {
-                    std::sort(hit.touches, hit.touches + hit.nbTouches, [](auto a, auto b) {
-                        return a.distance < b.distance;
-                    });
-
-                    float startDistance = 0;
-                    for (size_t i = 0; i < hit.nbTouches; i++) {
-                        auto &touch = hit.touches[i];
-                        if (!touch.actor) continue;
-                        auto userData = (ShapeUserData *)touch.shape->userData;
-                        if (!userData) continue;
-                        if (!userData->owner.Has<ecs::OpticalElement, ecs::TransformSnapshot>(lock)) continue;
-                        auto &optic = userData->owner.Get<ecs::OpticalElement>(lock);
-                        auto &opticTransform = userData->owner.Get<ecs::TransformSnapshot>(lock);
-                        if (optic.singleDirection && glm::dot(opticTransform.GetForward(), laserStart.rayDir) > 0) {
-                            continue;
-                        }
+                    TracePath(*path);
+                }
+            }
+            for (auto &result : results) {
+                result->Get();
+            }
+        }
 
-                        auto segmentEnd = laserStart.rayStart + laserStart.rayDir * (touch.distance - startDistance);
+        for (auto &entity : lock.EntitiesWith<ecs::LaserSensor>()) {
+            auto &sensor = entity.Get<ecs::LaserSensor>(lock);
+            sensor.illuminance = glm::vec3(0);
+        }
+        for (auto &entity : lock.EntitiesWith<ecs::LaserEmitter>()) {
+            if (!entity.Has<ecs::TransformSnapshot, ecs::LaserLine>(lock)) continue;
+            auto &emitter = entity.Get<ecs::LaserEmitter>(lock);
+            if (!emitter.on) continue;
+            auto it = paths.find(entity);
+            if (it == paths.end()) continue;
+            auto &path = it->second;
 
-                        if (laserStart.color * optic.reflectTint != glm::vec3(0)) {
-                            auto &reflectionStart = emitterQueue.emplace_back();
-                            reflectionStart.rayDir = glm::normalize(
-                                glm::reflect(laserStart.rayDir, PxVec3ToGlmVec3(touch.normal)));
-                            // offset to prevent hitting the same object again
-                            reflectionStart.rayStart = segmentEnd + reflectionStart.rayDir * bounceOffset;
-                            reflectionStart.color = laserStart.color * optic.reflectTint;
-                            reflectionStart.depth = laserStart.depth;
-                        }
-                        if (laserStart.color * optic.passTint != glm::vec3(0)) {
-                            auto &segment = segments.emplace_back();
-                            segment.start = laserStart.rayStart;
-                            segment.end = segmentEnd;
-                            segment.color = laserStart.color;
-
-                            laserStart.color *= optic.passTint;
-                            laserStart.rayStart = segmentEnd;
-                            startDistance = touch.distance;
-                        } else {
-                            hit.hasBlock = true;
-                            hit.block = touch;
-                            break;
-                        }
+            // Static paths keep their existing segments instead of being copied every frame
+            auto &lines = entity.Get<ecs::LaserLine>(lock);
+            auto *segments = std::get_if<ecs::LaserLine::Segments>(&lines.line);
+            if (!segments || path.lastTracedFrame == frameCount || segments->size() != path.segments.size()) {
+                lines.line = path.segments;
+            }
+
+            for (auto &[hitEntity, hitColor] : path.blockers) {
+                if (!hitEntity.Has<ecs::LaserSensor>(lock)) continue;
+                auto &sensor = hitEntity.Get<ecs::LaserSensor>(lock);
+                sensor.illuminance += glm::vec3(hitColor * emitter.intensity);
+            }
+        }
+        for (auto &entity : lock.EntitiesWith<ecs::LaserSensor>()) {
+            auto &sensor = entity.Get<ecs::LaserSensor>(lock);
+            auto &[valueR, valueG, valueB, value] = sensorSignals.Get(entity);
+            valueR.SetValue(lock, sensor.illuminance.r);
+            valueG.SetValue(lock, sensor.illuminance.g);
+            valueB.SetValue(lock, sensor.illuminance.b);
+            value.SetValue(lock, glm::all(glm::greaterThanEqual(sensor.illuminance, sensor.threshold)));
+        }
+    }
+
+    void LaserSystem::UpdateOptics(ecs::Lock<ecs::Read<ecs::TransformSnapshot, ecs::OpticalElement>> lock) {
+        ZoneScoped;
+        changedOptics.clear();
+        for (auto &entity : lock.EntitiesWith<ecs::OpticalElement>()) {
+            if (!entity.Has<ecs::OpticalElement>(lock)) continue;
+
+            auto &optic = entity.Get<ecs::OpticalElement>(lock);
+            bool hasTransform = entity.Has<ecs::TransformSnapshot>(lock);
+
+            auto [it, inserted] = optics.try_emplace(entity);
+            auto &state = it->second;
+            state.lastSeenFrame = frameCount;
+            bool changed = inserted || state.hasTransform != hasTransform;
+            changed |= !(state.optic.passTint == optic.passTint) || !(state.optic.reflectTint == optic.reflectTint);
+            changed |= state.optic.singleDirection != optic.singleDirection;
+            if (hasTransform) {
+                auto &transform = entity.Get<ecs::TransformSnapshot>(lock);
+                changed |= state.transform != transform;
+                state.transform = transform;
+            }
+            if (changed) {
+                state.optic = optic;
+                state.hasTransform = hasTransform;
+                changedOptics.emplace(entity);
+            }
+        }
+        for (auto it = optics.begin(); it != optics.end();) {
+            if (it->second.lastSeenFrame != frameCount) {
+                changedOptics.emplace(it->first);
+                it = optics.erase(it);
+            } else {
+                it++;
+            }
+        }
+    }
+
+    // Finds actors that were added, moved, or had their shapes changed since the last frame
+    void LaserSystem::UpdateActors() {
+        ZoneScoped;
+        movedActors.clear();
+        movedBounds.clear();
+
+        auto actorFlags = PxActorTypeFlag::eRIGID_STATIC | PxActorTypeFlag::eRIGID_DYNAMIC;
+        actorBuffer.resize(manager.scene->getNbActors(actorFlags));
+        manager.scene->getActors(actorFlags, actorBuffer.data(), actorBuffer.size());
+        for (auto *pxActor : actorBuffer) {
+            auto actor = pxActor->is<PxRigidActor>();
+            if (!actor) continue;
+
+            auto pose = actor->getGlobalPose();
+            auto userData = (ActorUserData *)actor->userData;
+            uint32_t shapesVersion = userData ? userData->shapesVersion : 0;
+
+            auto [it, inserted] = actorStates.try_emplace(actor);
+            auto &state = it->second;
+            state.lastSeenFrame = frameCount;
+            if (!inserted && state.pose == pose && state.shapesVersion == shapesVersion) continue;
+            state.pose = pose;
+            state.shapesVersion = shapesVersion;
+
+            movedActors.emplace(actor);
+            auto &bounds = movedBounds.emplace_back(PxBounds3::empty());
+            for (uint32_t i = 0; i < actor->getNbShapes(); i++) {
+                PxShape *shape = nullptr;
+                actor->getShapes(&shape, 1, i);
+                if (shape) bounds.include(PxShapeExt::getWorldBounds(*shape, *actor));
+            }
+        }
+        for (auto it = actorStates.begin(); it != actorStates.end();) {
+            if (it->second.lastSeenFrame != frameCount) {
+                // Removed actors may be referenced by any path, and their pointers may be reused
+                invalidateAll = true;
+                it = actorStates.erase(it);
+            } else {
+                it++;
+            }
+        }
+    }
+
+    bool LaserSystem::IsPathValid(const EmitterPath &path) const {
+        if (!path.valid) return false;
+        for (auto &owner : path.seenOwners) {
+            if (changedOptics.contains(owner)) return false;
+        }
+        for (auto *actor : path.seenActors) {
+            if (movedActors.contains(actor)) return false;
+        }
+        // Actors that weren't touched by the path may have moved into it
+        for (auto &bounds : movedBounds) {
+            for (auto &segment : path.segments) {
+                if (SegmentIntersectsBounds(segment, bounds)) return false;
+            }
+        }
+        return true;
+    }
+
+    void LaserSystem::TracePath(EmitterPath &path) const {
+        ZoneScoped;
+        struct LaserStart {
+            glm::vec3 rayStart, rayDir;
+            color_t color;
+            int depth = 0;
+        };
+
+        path.segments.clear();
+        path.blockers.clear();
+        path.seenOwners.clear();
+        path.seenActors.clear();
+        auto &segments = path.segments;
+        auto &transform = path.transform;
+
+        std::array<physx::PxRaycastHit, 128> hitBuffer;
+
+        PxRaycastBuffer hit;
+        hit.touches = hitBuffer.data();
+        hit.maxNbTouches = hitBuffer.size();
+        PxFilterData filterData;
+        filterData.word0 = (uint32_t)(ecs::PHYSICS_GROUP_WORLD | ecs::PHYSICS_GROUP_INTERACTIVE |
+                                      ecs::PHYSICS_GROUP_HELD_OBJECT | ecs::PHYSICS_GROUP_PLAYER_LEFT_HAND |
+                                      ecs::PHYSICS_GROUP_PLAYER_RIGHT_HAND);
+
+        OpticFilterCallback filterCallback(optics, path.seenOwners, path.seenActors);
+
+        const float maxDistance = 1000.0f;
+        bool status = true;
+
+        std::vector<LaserStart> emitterQueue;
+        emitterQueue.emplace_back(LaserStart{
+            transform.GetPosition() + transform.GetForward() * path.startDistance * transform.GetScale(),
+            transform.GetForward(),
+            path.color,
+        });
+
+        while (!emitterQueue.empty()) {
+            auto laserStart = emitterQueue.back();
+            emitterQueue.pop_back();
+            laserStart.depth++;
+            if (laserStart.depth > maxReflections) continue;
+
+            filterCallback.color = laserStart.color;
+            status = manager.scene->raycast(GlmVec3ToPxVec3(laserStart.rayStart),
+                GlmVec3ToPxVec3(laserStart.rayDir),
+                maxDistance,
+                hit,
+                PxHitFlag::eNORMAL,
+                PxQueryFilterData(filterData, PxQueryFlag::eSTATIC | PxQueryFlag::eDYNAMIC | PxQueryFlag::ePREFILTER),
+                &filterCallback);
+
+            if (!status) {
+                auto &segment = segments.emplace_back();
+                segment.start = laserStart.rayStart;
+                segment.end = laserStart.rayStart + laserStart.rayDir * maxDistance;
+                segment.color = laserStart.color;
+            } else {
+                std::sort(hit.touches, hit.touches + hit.nbTouches, [](auto a, auto b) {
+                    return a.distance < b.distance;
+                });
+
+                float startDistance = 0;
+                for (size_t i = 0; i < hit.nbTouches; i++) {
+                    auto &touch = hit.touches[i];
+                    if (!touch.actor) continue;
+                    auto userData = (ShapeUserData *)touch.shape->userData;
+                    if (!userData) continue;
+                    auto opticIt = optics.find(userData->owner);
+                    if (opticIt == optics.end() || !opticIt->second.hasTransform) continue;
+                    auto &optic = opticIt->second.optic;
+                    auto &opticTransform = opticIt->second.transform;
+                    if (optic.singleDirection && glm::dot(opticTransform.GetForward(), laserStart.rayDir) > 0) {
+                        continue;
                     }
 
-                    auto &segment = segments.emplace_back();
-                    segment.start = laserStart.rayStart;
-                    segment.end = laserStart.rayStart +
-                                  laserStart.rayDir *
-                                      ((hit.hasBlock ? hit.block.distance : maxDistance) - startDistance);
-                    segment.color = laserStart.color;
-
-                    physx::PxShape *hitShape = hit.block.shape;
-                    if (hitShape) {
-                        auto userData = (ShapeUserData *)hitShape->userData;
-                        if (userData) {
-                            auto hitEntity = userData->owner;
-                            if (hitEntity.Has<ecs::LaserSensor>(lock)) {
-                                auto &sensor = hitEntity.Get<ecs::LaserSensor>(lock);
-                                sensor.illuminance += glm::vec3(laserStart.color * emitter.intensity);
-                            }
-                            if (hitEntity.Has<ecs::OpticalElement>(lock)) {
-                                auto &optic = hitEntity.Get<ecs::OpticalElement>(lock);
-                                if (laserStart.color * optic.reflectTint != glm::vec3(0)) {
-                                    laserStart.color *= optic.reflectTint;
-                                    laserStart.rayDir = glm::normalize(
-                                        glm::reflect(laserStart.rayDir, PxVec3ToGlmVec3(hit.block.normal)));
-                                    // offset to prevent hitting the same object again
-                                    laserStart.rayStart = segment.end + laserStart.rayDir * bounceOffset;
-                                    emitterQueue.emplace_back(laserStart);
-                                }
+                    auto segmentEnd = laserStart.rayStart + laserStart.rayDir * (touch.distance - startDistance);
+
+                    if (laserStart.color * optic.reflectTint != glm::vec3(0)) {
+                        auto &reflectionStart = emitterQueue.emplace_back();
+                        reflectionStart.rayDir = glm::normalize(
+                            glm::reflect(laserStart.rayDir, PxVec3ToGlmVec3(touch.normal)));
+                        // offset to prevent hitting the same object again
+                        reflectionStart.rayStart = segmentEnd + reflectionStart.rayDir * bounceOffset;
+                        reflectionStart.color = laserStart.color * optic.reflectTint;
+                        reflectionStart.depth = laserStart.depth;
+                    }
+                    if (laserStart.color * optic.passTint != glm::vec3(0)) {
+                        auto &segment = segments.emplace_back();
+                        segment.start = laserStart.rayStart;
+                        segment.end = segmentEnd;
+                        segment.color = laserStart.color;
+
+                        laserStart.color *= optic.passTint;
+                        laserStart.rayStart = segmentEnd;
+                        startDistance = touch.distance;
+                    } else {
+                        hit.hasBlock = true;
+                        hit.block = touch;
+                        break;
+                    }
+                }
+
+                auto &segment = segments.emplace_back();
+                segment.start = laserStart.rayStart;
+                segment.end = laserStart.rayStart +
+                              laserStart.rayDir * ((hit.hasBlock ? hit.block.distance : maxDistance) - startDistance);
+                segment.color = laserStart.color;
+
+                physx::PxShape *hitShape = hit.block.shape;
+                if (hitShape) {
+                    auto userData = (ShapeUserData *)hitShape->userData;
+                    if (userData) {
+                        auto hitEntity = userData->owner;
+                        path.blockers.emplace_back(hitEntity, laserStart.color);
+
+                        auto opticIt = optics.find(hitEntity);
+                        if (opticIt != optics.end()) {
+                            auto &optic = opticIt->second.optic;
+                            if (laserStart.color * optic.reflectTint != glm::vec3(0)) {
+                                laserStart.color *= optic.reflectTint;
+                                laserStart.rayDir = glm::normalize(
+                                    glm::reflect(laserStart.rayDir, PxVec3ToGlmVec3(hit.block.normal)));
+                                // offset to prevent hitting the same object again
+                                laserStart.rayStart = segment.end + laserStart.rayDir * bounceOffset;
+                                emitterQueue.emplace_back(laserStart);
                             }
                         }
                     }
                 }
             }
         }
-        for (auto &entity : lock.EntitiesWith<ecs::LaserSensor>()) {
-            auto &sensor = entity.Get<ecs::LaserSensor>(lock);
-            ecs::SignalRef(entity, "light_value_r").SetValue(lock, sensor.illuminance.r);
-            ecs::SignalRef(entity, "light_value_g").SetValue(lock, sensor.illuminance.g);
-            ecs::SignalRef(entity, "light_value_b").SetValue(lock, sensor.illuminance.b);
-            ecs::SignalRef(entity, "value")
-                .SetValue(lock, glm::all(glm::greaterThanEqual(sensor.illuminance, sensor.threshold)));
-        }
+
+        std::sort(path.seenOwners.begin(), path.seenOwners.end(), [](auto &a, auto &b) {
+            return a.index < b.index;
+        });
+        path.seenOwners.erase(std::unique(path.seenOwners.begin(), path.seenOwners.end()), path.seenOwners.end());
+        std::sort(path.seenActors.begin(), path.seenActors.end());
+        path.seenActors.erase(std::unique(path.seenActors.begin(), path.seenActors.end()), path.seenActors.end());
+        path.valid = true;
+        path.lastTracedFrame = frameCount;
     }
 } // namespace sp
@@ -1,11 +1,27 @@
 #pragma once
 
+#include "core/Common.hh"
+#include "core/DispatchQueue.hh"
 #include "ecs/Ecs.hh"
 #include "ecs/SignalExpression.hh"
+#include "ecs/SignalRefCache.hh"
+#include "ecs/components/LaserLine.hh"
+#include "ecs/components/OpticalElement.hh"
+#include "ecs/components/Transform.h"
+
+#include <PxPhysicsAPI.h>
+#include <memory>
+#include <robin_hood.h>
+#include <vector>
 
 namespace sp {
     class PhysxManager;
 
+    /**
+     * Laser paths are cached per emitter and only traced again when something that could affect them changed:
+     * the emitter itself, an optic or actor the path's raycasts touched, or any actor moving into the path.
+     * Paths that need to be traced are processed in parallel, and the results are written back afterwards.
+     */
     class LaserSystem {
     public:
         LaserSystem(PhysxManager &manager);
@@ -16,6 +32,62 @@ namespace sp {
             ecs::Write<ecs::LaserLine, ecs::LaserSensor, ecs::Signals>> lock);
 
     private:
+        struct OpticState {
+            ecs::OpticalElement optic;
+            ecs::Transform transform;
+            bool hasTransform = false;
+            uint64_t lastSeenFrame = 0;
+        };
+
+        struct ActorState {
+            physx::PxTransform pose;
+            uint32_t shapesVersion = 0;
+            uint64_t lastSeenFrame = 0;
+        };
+
+        struct EmitterPath {
+            bool valid = false;
+            uint64_t lastSeenFrame = 0, lastTracedFrame = 0;
+
+            // Inputs the path was traced with
+            ecs::Transform transform;
+            color_t color;
+            float startDistance = 0.0f;
+
+            ecs::LaserLine::Segments segments;
+            // Entities that blocked the laser, with the color that reached them
+            std::vector<std::pair<ecs::Entity, color_t>> blockers;
+            // Every shape owner and actor considered by the path's raycasts
+            std::vector<ecs::Entity> seenOwners;
+            std::vector<const physx::PxRigidActor *> seenActors;
+        };
+
+        void UpdateOptics(ecs::Lock<ecs::Read<ecs::TransformSnapshot, ecs::OpticalElement>> lock);
+        void UpdateActors();
+        bool IsPathValid(const EmitterPath &path) const;
+        void TracePath(EmitterPath &path) const;
+
         PhysxManager &manager;
+        std::unique_ptr<DispatchQueue> workQueue;
+
+        uint64_t frameCount = 0;
+        int maxReflections = 0;
+        float bounceOffset = 0.0f;
+
+        robin_hood::unordered_flat_map<ecs::Entity, OpticState> optics;
+        robin_hood::unordered_flat_map<const physx::PxRigidActor *, ActorState> actorStates;
+        robin_hood::unordered_node_map<ecs::Entity, EmitterPath> paths;
+
+        // Changes since the previous frame, used to invalidate cached paths
+        bool invalidateAll = true;
+        robin_hood::unordered_flat_set<ecs::Entity> changedOptics;
+        robin_hood::unordered_flat_set<const physx::PxRigidActor *> movedActors;
+        std::vector<physx::PxBounds3> movedBounds;
+
+        std::vector<physx::PxActor *> actorBuffer;
+        std::vector<EmitterPath *> tracing;
+
+        ecs::SignalRefCache<3> emitterSignals{"laser_color_r", "laser_color_g", "laser_color_b"};
+        ecs::SignalRefCache<4> sensorSignals{"light_value_r", "light_value_g", "light_value_b", "value"};
     };
 } // namespace sp
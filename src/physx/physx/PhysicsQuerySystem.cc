@@ -1,177 +1,301 @@
 #include "PhysicsQuerySystem.hh"
 
+#include "console/CVar.hh"
+#include "core/Tracing.hh"
 #include "ecs/Ecs.hh"
 #include "ecs/EcsImpl.hh"
 #include "physx/PhysxManager.hh"
 #include "physx/PhysxUtils.hh"
 
 #include <PxQueryReport.h>
+#include <algorithm>
+#include <array>
+#include <span>
 
 namespace sp {
     using namespace physx;
 
+    static CVar<uint32_t> CVarQueryWorkerThreads("x.QueryWorkerThreads",
+        4,
+        "Number of threads used to run batched physics queries (0 to run them on the physics thread)");
+    static CVar<uint32_t> CVarQueryChunkSize("x.QueryChunkSize", 64, "Number of physics queries per worker job");
+    static CVar<bool> CVarQueryReuseResults("x.QueryReuseResults",
+        false,
+        "Reuse last frame's result for physics queries whose inputs and transform did not change "
+        "(results will not reflect other objects moving)");
+
+    static uint64_t QueryKey(const ecs::Entity &entity, size_t queryIndex) {
+        return ((uint64_t)entity.index << 32) | (uint32_t)queryIndex;
+    }
+
     PhysicsQuerySystem::PhysicsQuerySystem(PhysxManager &manager) : manager(manager) {}
 
     void PhysicsQuerySystem::Frame(ecs::Lock<ecs::Read<ecs::TransformSnapshot>, ecs::Write<ecs::PhysicsQuery>> lock) {
         ZoneScoped;
-        for (auto &entity : lock.EntitiesWith<ecs::PhysicsQuery>()) {
-            auto &query = entity.Get<ecs::PhysicsQuery>(lock);
-            for (auto &subQuery : query.queries) {
+        std::swap(batch, previousBatch);
+        batch.clear();
+        pending.clear();
+
+        bool reuseResults = CVarQueryReuseResults.Get();
+        previousIndex.clear();
+        if (reuseResults) {
+            for (size_t i = 0; i < previousBatch.size(); i++) {
+                previousIndex[QueryKey(previousBatch[i].entity, previousBatch[i].queryIndex)] = i;
+            }
+        }
+
+        {
+            ZoneScopedN("CollectQueries");
+            for (auto &entity : lock.EntitiesWith<ecs::PhysicsQuery>()) {
+                auto &query = entity.Get<ecs::PhysicsQuery>(lock);
+                bool hasTransform = entity.Has<ecs::TransformSnapshot>(lock);
+                ecs::Transform transform;
+                if (hasTransform) transform = entity.Get<ecs::TransformSnapshot>(lock);
+
+                for (size_t i = 0; i < query.queries.size(); i++) {
+                    auto &subQuery = query.queries[i];
+                    std::visit(
+                        [](auto &&arg) {
+                            using T = std::decay_t<decltype(arg)>;
+                            if constexpr (!std::is_same<T, std::monostate>()) arg.result.reset();
+                        },
+                        subQuery);
+                    if (std::holds_alternative<std::monostate>(subQuery)) continue;
+
+                    auto *mass = std::get_if<ecs::PhysicsQuery::Mass>(&subQuery);
+                    if (mass) {
+                        UpdateMass(lock, *mass);
+                        continue;
+                    }
+
+                    auto &item = batch.emplace_back(BatchedQuery{entity, i, hasTransform, transform, subQuery});
+                    if (reuseResults) {
+                        auto it = previousIndex.find(QueryKey(entity, i));
+                        if (it != previousIndex.end()) {
+                            auto &previous = previousBatch[it->second];
+                            if (previous.entity == entity && previous.hasTransform == hasTransform &&
+                                previous.transform == transform && previous.query == subQuery) {
+                                item.query = previous.query;
+                                continue;
+                            }
+                        }
+                    }
+                    if (Prepare(item)) pending.emplace_back(batch.size() - 1);
+                }
+            }
+        }
+
+        {
+            ZoneScopedN("ExecuteQueries");
+            ZoneValue(pending.size());
+            // Group queries by type and filter so consecutive queries walk the same parts of the scene
+            std::sort(pending.begin(), pending.end(), [this](size_t a, size_t b) {
+                auto &itemA = batch[a];
+                auto &itemB = batch[b];
+                if (itemA.query.index() != itemB.query.index()) return itemA.query.index() < itemB.query.index();
+                if (itemA.filterData.word0 != itemB.filterData.word0) {
+                    return itemA.filterData.word0 < itemB.filterData.word0;
+                }
+                return a < b;
+            });
+
+            size_t threadCount = CVarQueryWorkerThreads.Get();
+            if (!workQueue && threadCount > 0) {
+                workQueue = std::make_unique<DispatchQueue>("PhysicsQuery",
+                    threadCount,
+                    DispatchQueue::Workers::Shared);
+            }
+            size_t chunkSize = std::max(1u, CVarQueryChunkSize.Get());
+
+            // The scene is only read by queries, so chunks can run concurrently.
+            // The last chunk is run on this thread while the workers process the rest.
+            std::span<size_t> remaining = pending;
+            std::vector<AsyncPtr<void>> results;
+            while (workQueue && threadCount > 0 && remaining.size() > chunkSize) {
+                auto chunk = remaining.first(chunkSize);
+                remaining = remaining.subspan(chunkSize);
+                results.emplace_back(workQueue->Dispatch<void>([this, chunk]() {
+                    ZoneScopedN("PhysicsQueryChunk");
+                    for (auto index : chunk) {
+                        Execute(batch[index]);
+                    }
+                }));
+            }
+            for (auto index : remaining) {
+                Execute(batch[index]);
+            }
+            for (auto &result : results) {
+                result->Get();
+            }
+        }
+
+        {
+            ZoneScopedN("WriteResults");
+            for (auto &item : batch) {
+                auto &query = item.entity.Get<ecs::PhysicsQuery>(lock);
                 std::visit(
                     [&](auto &&arg) {
                         using T = std::decay_t<decltype(arg)>;
-                        if constexpr (!std::is_same<T, std::monostate>()) arg.result.reset();
-
-                        if constexpr (std::is_same<T, ecs::PhysicsQuery::Raycast>()) {
-                            if (arg.maxDistance > 0.0f && arg.maxHits > 0) {
-                                glm::vec3 rayStart = arg.position;
-                                glm::vec3 rayDir = arg.direction;
-
-                                if ((arg.relativePosition || arg.relativeDirection) &&
-                                    entity.Has<ecs::TransformSnapshot>(lock)) {
-                                    const auto &transform = entity.Get<ecs::TransformSnapshot>(lock);
-                                    if (arg.relativePosition) rayStart = transform * glm::vec4(rayStart, 1);
-                                    if (arg.relativeDirection) rayDir = transform * glm::vec4(rayDir, 0);
-                                }
-
-                                rayDir = glm::normalize(rayDir);
-
-                                PxFilterData filterData;
-                                filterData.word0 = (uint32_t)arg.filterGroup;
-
-                                std::array<PxRaycastHit, 16> touches;
-
-                                PxRaycastBuffer hit;
-                                hit.touches = touches.data();
-
-                                auto queryFlags = PxQueryFlag::eSTATIC | PxQueryFlag::eDYNAMIC;
-
-                                if (arg.maxHits == 1) {
-                                    hit.maxNbTouches = 0;
-                                } else {
-                                    hit.maxNbTouches = std::min((uint32)touches.size(), arg.maxHits);
-                                }
-
-                                manager.scene->raycast(GlmVec3ToPxVec3(rayStart),
-                                    GlmVec3ToPxVec3(rayDir),
-                                    arg.maxDistance,
-                                    hit,
-                                    PxHitFlag::eDEFAULT,
-                                    PxQueryFilterData(filterData, queryFlags));
-
-                                auto &result = arg.result.emplace();
-                                result.hits = hit.getNbAnyHits();
-                                result.position = PxVec3ToGlmVec3(hit.block.position);
-                                result.normal = PxVec3ToGlmVec3(hit.block.normal);
-                                result.distance = hit.block.distance;
-
-                                physx::PxRigidActor *hitActor = nullptr;
-                                physx::PxShape *hitShape = nullptr;
-                                if (arg.maxHits == 1) {
-                                    hitActor = hit.block.actor;
-                                    hitShape = hit.block.shape;
-                                } else if (result.hits > 0) {
-                                    hitActor = hit.getTouch(0).actor;
-                                    hitShape = hit.getTouch(0).shape;
-                                }
-                                if (hitShape) {
-                                    auto userData = (ShapeUserData *)hitShape->userData;
-                                    if (userData) {
-                                        result.target = userData->parent;
-                                        result.subTarget = userData->owner;
-                                    }
-                                } else if (hitActor) {
-                                    auto userData = (ActorUserData *)hitActor->userData;
-                                    if (userData) {
-                                        result.target = userData->entity;
-                                        result.subTarget = userData->entity;
-                                    }
-                                }
-                            }
-                        } else if constexpr (std::is_same<T, ecs::PhysicsQuery::Sweep>()) {
-                            if (arg.maxDistance > 0.0f && entity.Has<ecs::TransformSnapshot>(lock)) {
-                                auto &transform = entity.Get<ecs::TransformSnapshot>(lock);
-
-                                PxFilterData filterData;
-                                filterData.word0 = (uint32_t)arg.filterGroup;
-
-                                auto shapeTransform = transform * arg.shape.transform;
-                                PxTransform pxTransform(GlmVec3ToPxVec3(shapeTransform.GetPosition()),
-                                    GlmQuatToPxQuat(shapeTransform.GetRotation()));
-                                glm::vec3 sweepDir = transform * glm::vec4(arg.sweepDirection, 0.0f);
-
-                                PxSweepBuffer hit;
-                                manager.scene->sweep(manager.GeometryFromShape(arg.shape).any(),
-                                    pxTransform,
-                                    GlmVec3ToPxVec3(sweepDir),
-                                    arg.maxDistance,
-                                    hit,
-                                    PxHitFlag::ePOSITION,
-                                    PxQueryFilterData(filterData, PxQueryFlag::eSTATIC | PxQueryFlag::eDYNAMIC));
-
-                                auto &result = arg.result.emplace();
-
-                                physx::PxRigidActor *hitActor = hit.block.actor;
-                                if (hitActor) {
-                                    auto userData = (ActorUserData *)hitActor->userData;
-                                    if (userData) {
-                                        result.target = userData->entity;
-                                        result.position = PxVec3ToGlmVec3(hit.block.position);
-                                        result.distance = hit.block.distance;
-                                    }
-                                }
-                            }
-                        } else if constexpr (std::is_same<T, ecs::PhysicsQuery::Overlap>()) {
-                            if (entity.Has<ecs::TransformSnapshot>(lock)) {
-                                auto &transform = entity.Get<ecs::TransformSnapshot>(lock);
-
-                                PxFilterData filterData;
-                                filterData.word0 = (uint32_t)arg.filterGroup;
-
-                                auto shapeTransform = transform * arg.shape.transform;
-                                PxTransform pxTransform(GlmVec3ToPxVec3(shapeTransform.GetPosition()),
-                                    GlmQuatToPxQuat(shapeTransform.GetRotation()));
-
-                                PxOverlapHit touch;
-                                PxOverlapBuffer hit;
-                                hit.touches = &touch;
-                                hit.maxNbTouches = 1;
-
-                                manager.scene->overlap(manager.GeometryFromShape(arg.shape).any(),
-                                    pxTransform,
-                                    hit,
-                                    PxQueryFilterData(filterData, PxQueryFlag::eSTATIC | PxQueryFlag::eDYNAMIC));
-
-                                auto &result = arg.result.emplace();
-
-                                physx::PxRigidActor *hitActor = touch.actor;
-                                if (hitActor) {
-                                    auto userData = (ActorUserData *)hitActor->userData;
-                                    if (userData) {
-                                        result = userData->entity;
-                                    }
-                                }
-                            }
-                        } else if constexpr (std::is_same<T, ecs::PhysicsQuery::Mass>()) {
-                            auto target = arg.targetActor.Get(lock);
-                            if (target) {
-                                if (manager.actors.count(target) > 0) {
-                                    auto &result = arg.result.emplace();
-
-                                    const physx::PxRigidActor *actor = manager.actors[target];
-                                    auto dynamic = actor->is<PxRigidDynamic>();
-                                    if (dynamic) {
-                                        result.weight = dynamic->getMass();
-                                        result.centerOfMass = PxVec3ToGlmVec3(dynamic->getCMassLocalPose().p);
-                                    }
-                                }
-                            }
-                        } else {
-                            Errorf("Unknown PhysicsQuery type: %s", typeid(T).name());
+                        if constexpr (!std::is_same<T, std::monostate>()) {
+                            arg.result = std::get<T>(item.query).result;
                         }
                     },
-                    subQuery);
+                    query.queries[item.queryIndex]);
             }
         }
     }
+
+    // Resolves the world space inputs of a query, returning false if the query should be left without a result
+    bool PhysicsQuerySystem::Prepare(BatchedQuery &item) const {
+        return std::visit(
+            [&](auto &&arg) {
+                using T = std::decay_t<decltype(arg)>;
+                if constexpr (std::is_same<T, ecs::PhysicsQuery::Raycast>()) {
+                    if (arg.maxDistance <= 0.0f || arg.maxHits == 0) return false;
+
+                    glm::vec3 rayStart = arg.position;
+                    glm::vec3 rayDir = arg.direction;
+                    if ((arg.relativePosition || arg.relativeDirection) && item.hasTransform) {
+                        if (arg.relativePosition) rayStart = item.transform * glm::vec4(rayStart, 1);
+                        if (arg.relativeDirection) rayDir = item.transform * glm::vec4(rayDir, 0);
+                    }
+
+                    item.filterData.word0 = (uint32_t)arg.filterGroup;
+                    item.pose = PxTransform(GlmVec3ToPxVec3(rayStart));
+                    item.direction = GlmVec3ToPxVec3(glm::normalize(rayDir));
+                    return true;
+                } else if constexpr (std::is_same<T, ecs::PhysicsQuery::Sweep>() ||
+                                     std::is_same<T, ecs::PhysicsQuery::Overlap>()) {
+                    if (!item.hasTransform) return false;
+                    if constexpr (std::is_same<T, ecs::PhysicsQuery::Sweep>()) {
+                        if (arg.maxDistance <= 0.0f) return false;
+                        glm::vec3 sweepDir = item.transform * glm::vec4(arg.sweepDirection, 0.0f);
+                        item.direction = GlmVec3ToPxVec3(sweepDir);
+                    }
+
+                    item.filterData.word0 = (uint32_t)arg.filterGroup;
+                    auto shapeTransform = item.transform * arg.shape.transform;
+                    item.pose = PxTransform(GlmVec3ToPxVec3(shapeTransform.GetPosition()),
+                        GlmQuatToPxQuat(shapeTransform.GetRotation()));
+                    item.geometry = manager.GeometryFromShape(arg.shape);
+                    return true;
+                } else {
+                    Errorf("Unknown PhysicsQuery type: %s", typeid(T).name());
+                    return false;
+                }
+            },
+            item.query);
+    }
+
+    void PhysicsQuerySystem::Execute(BatchedQuery &item) const {
+        std::visit(
+            [&](auto &&arg) {
+                using T = std::decay_t<decltype(arg)>;
+                if constexpr (std::is_same<T, ecs::PhysicsQuery::Raycast>()) {
+                    std::array<PxRaycastHit, 16> touches;
+
+                    PxRaycastBuffer hit;
+                    hit.touches = touches.data();
+
+                    auto queryFlags = PxQueryFlag::eSTATIC | PxQueryFlag::eDYNAMIC;
+
+                    if (arg.maxHits == 1) {
+                        hit.maxNbTouches = 0;
+                    } else {
+                        hit.maxNbTouches = std::min((uint32)touches.size(), arg.maxHits);
+                    }
+
+                    manager.scene->raycast(item.pose.p,
+                        item.direction,
+                        arg.maxDistance,
+                        hit,
+                        PxHitFlag::eDEFAULT,
+                        PxQueryFilterData(item.filterData, queryFlags));
+
+                    auto &result = arg.result.emplace();
+                    result.hits = hit.getNbAnyHits();
+                    result.position = PxVec3ToGlmVec3(hit.block.position);
+                    result.normal = PxVec3ToGlmVec3(hit.block.normal);
+                    result.distance = hit.block.distance;
+
+                    physx::PxRigidActor *hitActor = nullptr;
+                    physx::PxShape *hitShape = nullptr;
+                    if (arg.maxHits == 1) {
+                        hitActor = hit.block.actor;
+                        hitShape = hit.block.shape;
+                    } else if (result.hits > 0) {
+                        hitActor = hit.getTouch(0).actor;
+                        hitShape = hit.getTouch(0).shape;
+                    }
+                    if (hitShape) {
+                        auto userData = (ShapeUserData *)hitShape->userData;
+                        if (userData) {
+                            result.target = userData->parent;
+                            result.subTarget = userData->owner;
+                        }
+                    } else if (hitActor) {
+                        auto userData = (ActorUserData *)hitActor->userData;
+                        if (userData) {
+                            result.target = userData->entity;
+                            result.subTarget = userData->entity;
+                        }
+                    }
+                } else if constexpr (std::is_same<T, ecs::PhysicsQuery::Sweep>()) {
+                    PxSweepBuffer hit;
+                    manager.scene->sweep(item.geometry.any(),
+                        item.pose,
+                        item.direction,
+                        arg.maxDistance,
+                        hit,
+                        PxHitFlag::ePOSITION,
+                        PxQueryFilterData(item.filterData, PxQueryFlag::eSTATIC | PxQueryFlag::eDYNAMIC));
+
+                    auto &result = arg.result.emplace();
+
+                    physx::PxRigidActor *hitActor = hit.block.actor;
+                    if (hitActor) {
+                        auto userData = (ActorUserData *)hitActor->userData;
+                        if (userData) {
+                            result.target = userData->entity;
+                            result.position = PxVec3ToGlmVec3(hit.block.position);
+                            result.distance = hit.block.distance;
+                        }
+                    }
+                } else if constexpr (std::is_same<T, ecs::PhysicsQuery::Overlap>()) {
+                    PxOverlapHit touch;
+                    PxOverlapBuffer hit;
+                    hit.touches = &touch;
+                    hit.maxNbTouches = 1;
+
+                    manager.scene->overlap(item.geometry.any(),
+                        item.pose,
+                        hit,
+                        PxQueryFilterData(item.filterData, PxQueryFlag::eSTATIC | PxQueryFlag::eDYNAMIC));
+
+                    auto &result = arg.result.emplace();
+
+                    physx::PxRigidActor *hitActor = touch.actor;
+                    if (hitActor) {
+                        auto userData = (ActorUserData *)hitActor->userData;
+                        if (userData) {
+                            result = userData->entity;
+                        }
+                    }
+                }
+            },
+            item.query);
+    }
+
+    void PhysicsQuerySystem::UpdateMass(ecs::Lock<> lock, ecs::PhysicsQuery::Mass &query) {
+        auto target = query.targetActor.Get(lock);
+        if (!target || manager.actors.count(target) == 0) return;
+
+        auto &result = query.result.emplace();
+        const physx::PxRigidActor *actor = manager.actors[target];
+        auto dynamic = actor->is<PxRigidDynamic>();
+        if (dynamic) {
+            result.weight = dynamic->getMass();
+            result.centerOfMass = PxVec3ToGlmVec3(dynamic->getCMassLocalPose().p);
+        }
+    }
 } // namespace sp
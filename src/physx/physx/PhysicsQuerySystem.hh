@@ -1,10 +1,22 @@
 #pragma once
 
+#include "core/DispatchQueue.hh"
 #include "ecs/Ecs.hh"
+#include "ecs/components/PhysicsQuery.hh"
+#include "ecs/components/Transform.h"
+
+#include <PxPhysicsAPI.h>
+#include <memory>
+#include <robin_hood.h>
+#include <vector>
 
 namespace sp {
     class PhysxManager;
 
+    /**
+     * Queries are collected into a batch each frame, executed in parallel against the scene, and then written back.
+     * Mass queries read actor state directly and are resolved while the batch is collected.
+     */
     class PhysicsQuerySystem {
     public:
         PhysicsQuerySystem(PhysxManager &manager);
@@ -13,6 +25,33 @@ namespace sp {
         void Frame(ecs::Lock<ecs::Read<ecs::TransformSnapshot>, ecs::Write<ecs::PhysicsQuery>> lock);
 
     private:
+        using QueryVariant = decltype(ecs::PhysicsQuery::queries)::value_type;
+
+        struct BatchedQuery {
+            ecs::Entity entity;
+            size_t queryIndex;
+            bool hasTransform;
+            ecs::Transform transform;
+            // A copy of the query whose result is filled in by Execute()
+            QueryVariant query;
+
+            // World space inputs resolved by Prepare()
+            physx::PxFilterData filterData;
+            physx::PxTransform pose;
+            physx::PxVec3 direction;
+            physx::PxGeometryHolder geometry;
+        };
+
+        bool Prepare(BatchedQuery &item) const;
+        void Execute(BatchedQuery &item) const;
+        void UpdateMass(ecs::Lock<> lock, ecs::PhysicsQuery::Mass &query);
+
         PhysxManager &manager;
+        std::unique_ptr<DispatchQueue> workQueue;
+
+        std::vector<BatchedQuery> batch, previousBatch;
+        // Maps an entity index and query index to the matching query in previousBatch
+        robin_hood::unordered_flat_map<uint64_t, size_t> previousIndex;
+        std::vector<size_t> pending;
     };
 } // namespace sp
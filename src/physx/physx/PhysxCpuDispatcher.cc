@@ -0,0 +1,29 @@
+#include "PhysxCpuDispatcher.hh"
+
+#include "core/Tracing.hh"
+
+namespace sp {
+    PhysxCpuDispatcher::PhysxCpuDispatcher(size_t threadCount) {
+        if (threadCount > 0) scheduler = std::make_unique<WorkScheduler>(threadCount, "PhysxWorker");
+    }
+
+    void PhysxCpuDispatcher::submitTask(physx::PxBaseTask &task) {
+        if (scheduler) {
+            scheduler->Schedule(WorkScheduler::Job{&RunTask, &task});
+        } else {
+            RunTask(&task);
+        }
+    }
+
+    uint32_t PhysxCpuDispatcher::getWorkerCount() const {
+        return scheduler ? scheduler->ThreadCount() : 0;
+    }
+
+    void PhysxCpuDispatcher::RunTask(void *taskPtr) {
+        auto task = static_cast<physx::PxBaseTask *>(taskPtr);
+        ZoneScopedN("PhysxTask");
+        ZoneStr(task->getName());
+        task->run();
+        task->release();
+    }
+} // namespace sp
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "core/Common.hh"
+#include "core/WorkScheduler.hh"
+
+#include <PxPhysicsAPI.h>
+#include <memory>
+
+namespace sp {
+    /**
+     * Runs PhysX simulation tasks on a dedicated WorkScheduler pool, so broadphase, narrowphase, and solver islands
+     * can be processed in parallel during simulate().
+     * With a thread count of 0, tasks are run immediately on the thread that submits them.
+     */
+    class PhysxCpuDispatcher : public physx::PxCpuDispatcher, public NonCopyable {
+    public:
+        PhysxCpuDispatcher(size_t threadCount);
+
+        void submitTask(physx::PxBaseTask &task) override;
+        uint32_t getWorkerCount() const override;
+
+    private:
+        static void RunTask(void *taskPtr);
+
+        std::unique_ptr<WorkScheduler> scheduler;
+    };
+} // namespace sp
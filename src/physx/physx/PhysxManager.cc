@@ -28,11 +28,17 @@ namespace sp {
 
     CVar<bool> CVarPhysxDebugCollision("x.DebugColliders", false, "Show physx colliders");
     CVar<bool> CVarPhysxDebugJoints("x.DebugJoints", false, "Show physx joints");
+    CVar<uint32_t> CVarPhysxWorkerThreads("x.PhysxWorkerThreads",
+        4,
+        "Number of threads used to simulate physx scenes (0 to simulate on the physics thread, requires reload)");
+    CVar<bool> CVarPhysxPipelined("x.Pipelined",
+        false,
+        "Simulate each physics step while the next frame's ECS sync runs");
 
     PhysxManager::PhysxManager(bool stepMode)
-        : RegisteredThread("PhysX", 120.0, true), scenes(GetSceneManager()), characterControlSystem(*this),
-          constraintSystem(*this), physicsQuerySystem(*this), laserSystem(*this), animationSystem(*this),
-          workQueue("PhysXHullLoading") {
+        : RegisteredThread("PhysX", 120.0, true), stepMode(stepMode), scenes(GetSceneManager()),
+          characterControlSystem(*this), constraintSystem(*this), physicsQuerySystem(*this), laserSystem(*this),
+          animationSystem(*this), workQueue("PhysXHullLoading") {
         Logf("PhysX %d.%d.%d starting up",
             PX_PHYSICS_VERSION_MAJOR,
             PX_PHYSICS_VERSION_MINOR,
@@ -87,6 +93,7 @@ namespace sp {
 
     PhysxManager::~PhysxManager() {
         StopThread();
+        if (simulating) FinishSimulation();
 
         workQueue.Shutdown();
 
@@ -106,10 +113,7 @@ namespace sp {
         scene.reset();
         cache.DropAll();
 
-        if (dispatcher) {
-            dispatcher->release();
-            dispatcher = nullptr;
-        }
+        dispatcher.reset();
 
         if (pxSerialization) {
             pxSerialization->release();
@@ -167,6 +171,9 @@ namespace sp {
 
     void PhysxManager::Frame() {
         ZoneScoped;
+        // In pipelined mode, the previous step was simulated during the last frame's ECS sync
+        if (simulating) FinishSimulation();
+
         if (CVarPhysxDebugCollision.Changed() || CVarPhysxDebugJoints.Changed()) {
             bool collision = CVarPhysxDebugCollision.Get(true);
             bool joints = CVarPhysxDebugJoints.Get(true);
@@ -178,6 +185,11 @@ namespace sp {
 
         characterControlSystem.RegisterEvents();
 
+        // Pipelined steps are always fetched at the start of the next frame, so the ECS sees each step's results
+        // exactly one frame later than in blocking mode. Results don't depend on thread timing, even in step mode.
+        bool pipelined = CVarPhysxPipelined.Get();
+        if (pipelined) StartSimulation();
+
         { // Sync ECS state to physx
             ZoneScopedN("Sync ECS");
             auto lock = ecs::StartTransaction<ecs::ReadSignalsLock,
@@ -231,36 +243,9 @@ namespace sp {
 
             {
                 ZoneScopedN("UpdateSnapshots(NonDynamic)");
-                for (auto &ent : lock.EntitiesWith<ecs::TransformTree>()) {
-                    if (!ent.Has<ecs::TransformTree, ecs::TransformSnapshot>(lock)) continue;
-
-                    // Only recalculate the transform snapshot for entities that moved.
-                    auto treeEnt = ent;
-                    bool dirty = false;
-                    while (treeEnt.Has<ecs::TransformTree>(lock)) {
-                        auto &tree = treeEnt.Get<const ecs::TransformTree>(lock);
-                        auto &cache = transformCache[treeEnt];
-                        treeEnt = tree.parent.Get(lock);
-
-                        if (cache.dirty < 0) {
-                            dirty = tree.pose != cache.pose || treeEnt != cache.parent;
-                            if (dirty) {
-                                cache.pose = tree.pose;
-                                cache.parent = treeEnt;
-                                cache.dirty = 1;
-                                break;
-                            } else {
-                                cache.dirty = 0;
-                            }
-                        } else if (cache.dirty > 0) {
-                            dirty = true;
-                            break;
-                        }
-                    }
-                    if (!dirty) continue;
-
-                    auto transform = ent.Get<const ecs::TransformTree>(lock).GetGlobalTransform(lock);
-                    ent.Set<ecs::TransformSnapshot>(lock, transform);
+                // Only entities that moved, or whose parents moved, have their snapshot recalculated.
+                for (auto &ent : transformPropagation.Update(lock)) {
+                    auto &transform = ent.Get<const ecs::TransformSnapshot>(lock);
 
                     if (ent.Has<ecs::Physics>(lock)) {
                         auto &ph = ent.Get<ecs::Physics>(lock);
@@ -337,23 +322,57 @@ namespace sp {
             ecs::GetScriptManager().RunOnPhysicsUpdate(lock, interval);
         }
 
-        { // Simulate 1 physics frame (blocking)
-            ZoneScopedN("Simulate");
-            scene->simulate(PxReal(std::chrono::nanoseconds(this->interval).count() / 1e9),
-                nullptr,
-                scratchBlock.data(),
-                scratchBlock.size());
-            scene->fetchResults(true);
+        if (!pipelined) {
+            // Simulate 1 physics frame (blocking)
+            StartSimulation();
+            FinishSimulation();
         }
 
         cache.Tick(interval);
+    }
 
-        {
-            ZoneScopedN("TransformCache Reset");
-            // Reset dirty flags in transform cache outside of the transaction
-            for (auto &[generation, cache] : transformCache) {
-                if (generation != 0) cache.dirty = -1;
-            }
+    void PhysxManager::StartSimulation() {
+        ZoneScoped;
+        scene->simulate(PxReal(std::chrono::nanoseconds(this->interval).count() / 1e9),
+            nullptr,
+            scratchBlock.data(),
+            scratchBlock.size());
+        simulating = true;
+    }
+
+    void PhysxManager::FinishSimulation() {
+        ZoneScoped;
+        scene->fetchResults(true);
+        simulating = false;
+
+        // The render buffer can't be read while a simulation is running, so copy it for UpdateDebugLines()
+        debugLineSegments.clear();
+        if (!CVarPhysxDebugCollision.Get() && !CVarPhysxDebugJoints.Get()) return;
+
+        auto &rb = scene->getRenderBuffer();
+        for (size_t i = 0; i < rb.getNbLines(); i++) {
+            auto &line = rb.getLines()[i];
+            ecs::LaserLine::Segment segment;
+            segment.start = PxVec3ToGlmVec3(line.pos0);
+            segment.end = PxVec3ToGlmVec3(line.pos1);
+            segment.color = PxColorToGlmVec3(line.color0);
+            debugLineSegments.push_back(segment);
+        }
+        for (size_t i = 0; i < rb.getNbTriangles(); i++) {
+            auto &triangle = rb.getTriangles()[i];
+            ecs::LaserLine::Segment segment;
+            segment.start = PxVec3ToGlmVec3(triangle.pos0);
+            segment.end = PxVec3ToGlmVec3(triangle.pos1);
+            segment.color = PxColorToGlmVec3(triangle.color0);
+            debugLineSegments.push_back(segment);
+            segment.start = PxVec3ToGlmVec3(triangle.pos1);
+            segment.end = PxVec3ToGlmVec3(triangle.pos2);
+            segment.color = PxColorToGlmVec3(triangle.color1);
+            debugLineSegments.push_back(segment);
+            segment.start = PxVec3ToGlmVec3(triangle.pos2);
+            segment.end = PxVec3ToGlmVec3(triangle.pos0);
+            segment.color = PxColorToGlmVec3(triangle.color2);
+            debugLineSegments.push_back(segment);
         }
     }
 
@@ -388,8 +407,8 @@ namespace sp {
         PxSetGroupCollisionFlag((uint16_t)Group::NoClip, (uint16_t)Group::PlayerRightHand, false);
         PxSetGroupCollisionFlag((uint16_t)Group::NoClip, (uint16_t)Group::UserInterface, false);
 
-        dispatcher = PxDefaultCpuDispatcherCreate(1);
-        sceneDesc.cpuDispatcher = dispatcher;
+        dispatcher = make_unique<PhysxCpuDispatcher>(CVarPhysxWorkerThreads.Get());
+        sceneDesc.cpuDispatcher = dispatcher.get();
 
         auto pxScene = pxPhysics->createScene(sceneDesc);
         Assert(pxScene, "Failed to create PhysX scene");
@@ -638,6 +657,9 @@ namespace sp {
             }
         }
 
+        auto actorUserData = (ActorUserData *)actor->userData;
+        if (actorUserData && shapesChanged) actorUserData->shapesVersion++;
+
         auto dynamic = actor->is<PxRigidDynamic>();
         if (dynamic && shapesChanged) {
             Tracef("Updating actor inertia: %s", ecs::ToString(lock, actorEnt));
@@ -925,35 +947,7 @@ namespace sp {
             if (!std::holds_alternative<ecs::LaserLine::Segments>(laser.line)) {
                 laser.line = ecs::LaserLine::Segments();
             }
-            auto &segments = std::get<ecs::LaserLine::Segments>(laser.line);
-            segments.clear();
-            if (CVarPhysxDebugCollision.Get() || CVarPhysxDebugJoints.Get()) {
-                auto &rb = scene->getRenderBuffer();
-                for (size_t i = 0; i < rb.getNbLines(); i++) {
-                    auto &line = rb.getLines()[i];
-                    ecs::LaserLine::Segment segment;
-                    segment.start = PxVec3ToGlmVec3(line.pos0);
-                    segment.end = PxVec3ToGlmVec3(line.pos1);
-                    segment.color = PxColorToGlmVec3(line.color0);
-                    segments.push_back(segment);
-                }
-                for (size_t i = 0; i < rb.getNbTriangles(); i++) {
-                    auto &triangle = rb.getTriangles()[i];
-                    ecs::LaserLine::Segment segment;
-                    segment.start = PxVec3ToGlmVec3(triangle.pos0);
-                    segment.end = PxVec3ToGlmVec3(triangle.pos1);
-                    segment.color = PxColorToGlmVec3(triangle.color0);
-                    segments.push_back(segment);
-                    segment.start = PxVec3ToGlmVec3(triangle.pos1);
-                    segment.end = PxVec3ToGlmVec3(triangle.pos2);
-                    segment.color = PxColorToGlmVec3(triangle.color1);
-                    segments.push_back(segment);
-                    segment.start = PxVec3ToGlmVec3(triangle.pos2);
-                    segment.end = PxVec3ToGlmVec3(triangle.pos0);
-                    segment.color = PxColorToGlmVec3(triangle.color2);
-                    segments.push_back(segment);
-                }
-            }
+            std::get<ecs::LaserLine::Segments>(laser.line) = debugLineSegments;
         }
     }
 } // namespace sp
@@ -11,6 +11,8 @@
 #include "core/RegisteredThread.hh"
 #include "ecs/Ecs.hh"
 #include "ecs/EntityRef.hh"
+#include "ecs/TransformPropagation.hh"
+#include "ecs/components/LaserLine.hh"
 #include "ecs/components/Physics.hh"
 #include "ecs/components/PhysicsJoints.hh"
 #include "ecs/components/Transform.h"
@@ -18,6 +20,7 @@
 #include "physx/CharacterControlSystem.hh"
 #include "physx/ConstraintSystem.hh"
 #include "physx/LaserSystem.hh"
+#include "physx/PhysxCpuDispatcher.hh"
 #include "physx/PhysicsQuerySystem.hh"
 #include "physx/SimulationCallbackHandler.hh"
 #include "physx/TriggerSystem.hh"
@@ -70,6 +73,8 @@ namespace sp {
         float linearDamping = 0.0f;
         float contactReportThreshold = -1.0f;
         ecs::PhysicsGroup physicsGroup = ecs::PhysicsGroup::NoClip;
+        // Incremented whenever shapes are added, removed, or modified
+        uint32_t shapesVersion = 0;
 
         ActorUserData() {}
         ActorUserData(ecs::Entity ent, ecs::PhysicsGroup group) : entity(ent), physicsGroup(group) {}
@@ -123,6 +128,8 @@ namespace sp {
         void CreatePhysxScene();
         void DestroyPhysxScene();
         void UpdateDebugLines(ecs::Lock<ecs::Write<ecs::LaserLine>> lock) const;
+        void StartSimulation();
+        void FinishSimulation();
         void RegisterDebugCommands();
 
         AsyncPtr<ConvexHullSet> LoadConvexHullSet(AsyncPtr<Gltf> model, AsyncPtr<HullSettings> settings);
@@ -132,6 +139,11 @@ namespace sp {
 
         std::atomic_bool simulate = false;
         std::atomic_bool exiting = false;
+        const bool stepMode;
+
+        // True between simulate() and fetchResults(). PhysX buffers API writes made during this time and applies them
+        // once the simulation completes. Reads and scene queries see the state from before simulate() was called.
+        bool simulating = false;
         std::vector<uint8_t> scratchBlock;
 
         SceneManager &scenes;
@@ -143,7 +155,7 @@ namespace sp {
 
         physx::PxFoundation *pxFoundation = nullptr;
         physx::PxPhysics *pxPhysics = nullptr;
-        physx::PxDefaultCpuDispatcher *dispatcher = nullptr;
+        unique_ptr<PhysxCpuDispatcher> dispatcher;
         physx::PxDefaultErrorCallback defaultErrorCallback;
         physx::PxDefaultAllocator defaultAllocatorCallback;
         physx::PxCooking *pxCooking = nullptr;
@@ -173,12 +185,8 @@ namespace sp {
         PreservingMap<string, Async<ConvexHullSet>> cache;
         DispatchQueue workQueue;
 
-        struct TransformCacheEntry {
-            ecs::Entity parent;
-            ecs::Transform pose;
-            int dirty = -1;
-        };
-        EntityMap<TransformCacheEntry> transformCache;
+        ecs::TransformPropagation transformPropagation;
+        ecs::LaserLine::Segments debugLineSegments;
 
         friend class CharacterControlSystem;
         friend class ConstraintSystem;
@@ -1,14 +1,20 @@
 #include "TriggerSystem.hh"
 
+#include "console/CVar.hh"
 #include "console/Console.hh"
 #include "core/Common.hh"
 #include "core/Logging.hh"
 #include "core/Tracing.hh"
 #include "ecs/EcsImpl.hh"
 
+#include <algorithm>
 #include <glm/gtx/norm.hpp>
 
 namespace sp {
+    static CVar<float> CVarTriggerCellSize("x.TriggerCellSize",
+        4.0f,
+        "Size of the spatial hash cells used to find entities near trigger areas");
+
     TriggerSystem::TriggerSystem() {
         auto lock = ecs::StartTransaction<ecs::AddRemove>();
         triggerGroupObserver = lock.Watch<ecs::ComponentEvent<ecs::TriggerGroup>>();
@@ -19,10 +25,80 @@ namespace sp {
         triggerGroupObserver.Stop(lock);
     }
 
+    glm::ivec3 TriggerSystem::GetCell(const glm::vec3 &position) const {
+        return glm::ivec3(glm::floor(position / cellSize));
+    }
+
+    TriggerSystem::CellKey TriggerSystem::GetCellKey(const glm::ivec3 &cell) {
+        // Pack each coordinate into 21 bits, wrapping positions that are millions of cells from the origin
+        auto mask = (1ull << 21) - 1;
+        return ((CellKey)cell.x & mask) | (((CellKey)cell.y & mask) << 21) | (((CellKey)cell.z & mask) << 42);
+    }
+
+    void TriggerSystem::RemoveFromCell(CellKey key, const ecs::Entity &ent) {
+        auto it = cells.find(key);
+        if (it == cells.end()) return;
+        auto &cellEntities = it->second;
+        auto entIt = std::find(cellEntities.begin(), cellEntities.end(), ent);
+        if (entIt != cellEntities.end()) {
+            *entIt = cellEntities.back();
+            cellEntities.pop_back();
+        }
+        if (cellEntities.empty()) cells.erase(it);
+    }
+
+    void TriggerSystem::UpdateIndex(
+        ecs::Lock<ecs::Read<ecs::TriggerGroup, ecs::TransformSnapshot>, ecs::Write<ecs::TriggerArea>> lock) {
+        ZoneScoped;
+        ecs::ComponentEvent<ecs::TriggerGroup> triggerEvent;
+        while (triggerGroupObserver.Poll(lock, triggerEvent)) {
+            if (triggerEvent.type != Tecs::EventType::REMOVED) continue;
+
+            auto &removed = triggerEvent.entity;
+            if (removed.index < indexEntries.size() && indexEntries[removed.index].ent == removed) {
+                RemoveFromCell(indexEntries[removed.index].cell, removed);
+                indexEntries[removed.index].ent = {};
+            }
+            for (auto &entity : lock.EntitiesWith<ecs::TriggerArea>()) {
+                if (!entity.Has<ecs::TriggerArea>(lock)) continue;
+                for (auto &containedEntities : entity.Get<ecs::TriggerArea>(lock).containedEntities) {
+                    containedEntities.erase(removed);
+                }
+            }
+        }
+
+        if (cellSize == 0.0f || CVarTriggerCellSize.Changed()) {
+            cellSize = std::max(0.01f, CVarTriggerCellSize.Get(true));
+            indexEntries.clear();
+            cells.clear();
+        }
+
+        for (auto &ent : lock.EntitiesWith<ecs::TriggerGroup>()) {
+            if (!ent.Has<ecs::TriggerGroup, ecs::TransformSnapshot>(lock)) continue;
+            auto &position = ent.Get<ecs::TransformSnapshot>(lock).GetPosition();
+
+            if (ent.index >= indexEntries.size()) indexEntries.resize(ent.index + 1);
+            auto &entry = indexEntries[ent.index];
+            if (entry.ent == ent && entry.position == position) continue;
+
+            auto key = GetCellKey(GetCell(position));
+            if (entry.ent != ent) {
+                // The entity index may have been reused by a new entity
+                if (entry.ent) RemoveFromCell(entry.cell, entry.ent);
+                cells[key].emplace_back(ent);
+            } else if (entry.cell != key) {
+                RemoveFromCell(entry.cell, ent);
+                cells[key].emplace_back(ent);
+            }
+            entry = {ent, position, key};
+        }
+    }
+
     void TriggerSystem::Frame(ecs::Lock<ecs::Read<ecs::Name, ecs::TriggerGroup, ecs::TransformSnapshot>,
         ecs::Write<ecs::TriggerArea, ecs::Signals>,
         ecs::SendEventsLock> lock) {
         ZoneScoped;
+        UpdateIndex(lock);
 
         for (auto &entity : lock.EntitiesWith<ecs::TriggerArea>()) {
             if (!entity.Has<ecs::TriggerArea, ecs::TransformSnapshot>(lock)) continue;
@@ -32,16 +108,42 @@ namespace sp {
             auto boundingRadiusSquared = glm::length2(areaTransform * glm::vec4(glm::vec3(0.5f), 0.0f));
             auto invAreaTransform = areaTransform.GetInverse();
 
-            ecs::ComponentEvent<ecs::TriggerGroup> triggerEvent;
-            while (triggerGroupObserver.Poll(lock, triggerEvent)) {
-                if (triggerEvent.type == Tecs::EventType::REMOVED) {
-                    for (auto &containedEntities : area.containedEntities) {
-                        containedEntities.erase(triggerEvent.entity);
+            // Both shapes fit inside the unit cube, so its world space bounds are used to search the spatial hash
+            glm::vec3 halfExtents = 0.5f * (glm::abs(areaTransform * glm::vec4(1, 0, 0, 0)) +
+                                               glm::abs(areaTransform * glm::vec4(0, 1, 0, 0)) +
+                                               glm::abs(areaTransform * glm::vec4(0, 0, 1, 0)));
+            auto minCell = GetCell(areaCenter - halfExtents);
+            auto maxCell = GetCell(areaCenter + halfExtents);
+            auto cellRange = glm::dvec3(maxCell - minCell + 1);
+
+            candidates.clear();
+            if (cellRange.x * cellRange.y * cellRange.z > cells.size()) {
+                // Areas covering more cells than are occupied are faster to test against every indexed entity
+                for (auto &[key, cellEntities] : cells) {
+                    candidates.insert(candidates.end(), cellEntities.begin(), cellEntities.end());
+                }
+            } else {
+                for (int x = minCell.x; x <= maxCell.x; x++) {
+                    for (int y = minCell.y; y <= maxCell.y; y++) {
+                        for (int z = minCell.z; z <= maxCell.z; z++) {
+                            auto it = cells.find(GetCellKey(glm::ivec3(x, y, z)));
+                            if (it == cells.end()) continue;
+                            candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+                        }
                     }
                 }
             }
+            // Entities that were inside the area last frame need to be tested so they can leave
+            for (auto &containedEntities : area.containedEntities) {
+                candidates.insert(candidates.end(), containedEntities.begin(), containedEntities.end());
+            }
+            // Keep events in entity order, independent of the hash layout
+            std::sort(candidates.begin(), candidates.end(), [](auto &a, auto &b) {
+                return a.index < b.index;
+            });
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
 
-            for (auto &triggerEnt : lock.EntitiesWith<ecs::TriggerGroup>()) {
+            for (auto &triggerEnt : candidates) {
                 if (!triggerEnt.Has<ecs::TriggerGroup, ecs::TransformSnapshot>(lock)) continue;
                 auto &transform = triggerEnt.Get<ecs::TransformSnapshot>(lock);
                 auto entityPos = transform.GetPosition();
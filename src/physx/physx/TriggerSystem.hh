@@ -2,6 +2,10 @@
 
 #include "ecs/Ecs.hh"
 
+#include <glm/glm.hpp>
+#include <robin_hood.h>
+#include <vector>
+
 namespace sp {
     class PhysxManager;
 
@@ -15,5 +19,27 @@ namespace sp {
             ecs::SendEventsLock> lock);
 
         ecs::ComponentObserver<ecs::TriggerGroup> triggerGroupObserver;
+
+    private:
+        using CellKey = uint64_t;
+
+        void UpdateIndex(
+            ecs::Lock<ecs::Read<ecs::TriggerGroup, ecs::TransformSnapshot>, ecs::Write<ecs::TriggerArea>> lock);
+        glm::ivec3 GetCell(const glm::vec3 &position) const;
+        static CellKey GetCellKey(const glm::ivec3 &cell);
+        void RemoveFromCell(CellKey key, const ecs::Entity &ent);
+
+        struct IndexEntry {
+            ecs::Entity ent;
+            glm::vec3 position;
+            CellKey cell;
+        };
+
+        // Spatial hash of trigger group entity positions, only updated for entities that moved
+        float cellSize = 0.0f;
+        std::vector<IndexEntry> indexEntries; // Indexed by entity index
+        robin_hood::unordered_flat_map<CellKey, std::vector<ecs::Entity>> cells;
+
+        std::vector<ecs::Entity> candidates;
     };
 } // namespace sp
@@ -4,12 +4,30 @@
 #include "ecs/EcsImpl.hh"
 #include "game/Scene.hh"
 
+#include <array>
 #include <cmath>
 #include <glm/glm.hpp>
 
 namespace sp::scripts {
     using namespace ecs;
 
+    static const StringAtom LIFE_SIGNAL_ALIVE = "alive";
+    static const StringAtom LIFE_SIGNAL_TILE_X = "tile.x";
+    static const StringAtom LIFE_SIGNAL_TILE_Y = "tile.y";
+    static const StringAtom LIFE_EVENT_NOTIFY_NEIGHBORS = "/life/notify_neighbors";
+    static const StringAtom LIFE_EVENT_NEIGHBOR_ALIVE = "/life/neighbor_alive";
+
+    // Signal names for each neighbor offset, indexed by [dx + 1][dy + 1]
+    static const std::array<std::array<StringAtom, 3>, 3> LIFE_SIGNAL_NEIGHBORS = [] {
+        std::array<std::array<StringAtom, 3>, 3> names;
+        for (int dx = -1; dx <= 1; dx++) {
+            for (int dy = -1; dy <= 1; dy++) {
+                names[dx + 1][dy + 1] = "neighbor[" + std::to_string(dx) + "][" + std::to_string(dy) + "]";
+            }
+        }
+        return names;
+    }();
+
     struct LifeCellPrefab {
         glm::uvec2 boardSize = glm::uvec2(32, 32);
 
@@ -26,8 +44,8 @@ namespace sp::scripts {
             auto &eventBindings = ent.Get<EventBindings>(lock);
 
             auto prefix = Name(name.scene, name.entity.substr(0, name.entity.find_last_of('.')));
-            glm::uvec2 pos = glm::uvec2(SignalRef(ent, "tile.x").GetSignal(lock),
-                SignalRef(ent, "tile.y").GetSignal(lock));
+            glm::uvec2 pos = glm::uvec2(SignalRef(ent, LIFE_SIGNAL_TILE_X).GetSignal(lock),
+                SignalRef(ent, LIFE_SIGNAL_TILE_Y).GetSignal(lock));
 
             for (int dx = -1; dx <= 1; dx++) {
                 for (int dy = -1; dy <= 1; dy++) {
@@ -36,10 +54,10 @@ namespace sp::scripts {
                     glm::uvec2 wrapped = (pos + glm::uvec2(boardSize.x + dx, boardSize.y + dy)) % boardSize;
                     EntityRef neighbor = Name(std::to_string(wrapped.x) + "_" + std::to_string(wrapped.y), prefix);
 
-                    std::string bindingName = "neighbor[" + std::to_string(dx) + "][" + std::to_string(dy) + "]";
-                    SignalRef(ent, bindingName).SetBinding(lock, SignalRef(neighbor, "alive"));
+                    auto &bindingName = LIFE_SIGNAL_NEIGHBORS[dx + 1][dy + 1];
+                    SignalRef(ent, bindingName).SetBinding(lock, SignalRef(neighbor, LIFE_SIGNAL_ALIVE));
 
-                    eventBindings.Bind("/life/notify_neighbors", neighbor, "/life/neighbor_alive");
+                    eventBindings.Bind(LIFE_EVENT_NOTIFY_NEIGHBORS, neighbor, LIFE_EVENT_NEIGHBOR_ALIVE);
                 }
             }
         }
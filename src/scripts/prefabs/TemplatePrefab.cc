@@ -46,7 +46,9 @@ namespace ecs {
             }
 
             picojson::value rootValue;
-            string err = picojson::parse(rootValue, asset->String());
+            string err;
+            auto json = asset->StringView();
+            picojson::parse(rootValue, json.begin(), json.end(), &err);
             if (!err.empty()) {
                 Errorf("Failed to parse template (%s): %s", sourceName, err);
                 return false;
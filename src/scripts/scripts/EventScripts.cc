@@ -123,7 +123,7 @@ namespace sp::scripts {
                     },
                     event.data);
 
-                auto eventName = std::string_view(event.name).substr("/signal/"s.size());
+                auto eventName = std::string_view(event.name.String()).substr("/signal/"s.size());
                 auto delimiter = eventName.find('/');
                 Assertf(delimiter != std::string_view::npos, "Event name should be /signal/<action>/<signal>");
                 auto action = eventName.substr(0, delimiter);
@@ -207,7 +207,7 @@ namespace sp::scripts {
                     continue;
                 }
 
-                auto fieldPath = std::string_view(event.name).substr("/set/"s.size());
+                auto fieldPath = std::string_view(event.name.String()).substr("/set/"s.size());
                 size_t delimiter = fieldPath.find('.');
                 if (delimiter == std::string_view::npos) {
                     Errorf("Unexpected event received by component_from_event: %s", event.name);
@@ -15,6 +15,9 @@ namespace sp::scripts {
         false,
         "Toggle to use a fixed joint instead of force limited joint");
 
+    using InteractiveObjectLock = Lock<Read<Name, EventInput, TransformSnapshot, TransformTree>,
+        Write<Physics, PhysicsJoints, PhysicsQuery, Renderable>>;
+
     struct InteractiveObject {
         bool disabled = false;
         std::vector<std::pair<Entity, Entity>> grabEntities;
@@ -22,7 +25,7 @@ namespace sp::scripts {
         bool renderOutline = false;
         PhysicsQuery::Handle<PhysicsQuery::Mass> massQuery;
 
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state, InteractiveObjectLock lock, Entity ent, chrono_clock::duration interval) {
             if (!ent.Has<TransformSnapshot, Physics, PhysicsJoints>(lock)) return;
 
             auto &ph = ent.Get<Physics>(lock);
@@ -71,7 +74,7 @@ namespace sp::scripts {
                         if (!enableInteraction) continue;
 
                         auto &parentTransform = std::get<Transform>(event.data);
-                        auto &transform = ent.Get<TransformSnapshot>(lock);
+                        auto &transform = ent.Get<const TransformSnapshot>(lock);
                         auto invParentRotate = glm::inverse(parentTransform.GetRotation());
 
                         Entity secondary;
@@ -160,7 +163,7 @@ namespace sp::scripts {
                             }
                             break;
                         }
-                        child = child.Get<TransformTree>(lock).parent.Get(lock);
+                        child = child.Get<const TransformTree>(lock).parent.Get(lock);
                     }
                 }
                 renderOutline = newRenderOutline;
@@ -176,6 +179,10 @@ namespace sp::scripts {
         INTERACT_EVENT_INTERACT_GRAB,
         INTERACT_EVENT_INTERACT_ROTATE);
 
+    using InteractHandlerLock = Lock<
+        Read<Name, FocusLock, EventBindings, EventInput, Signals, SignalBindings, SignalOutput, TransformSnapshot>,
+        Write<PhysicsJoints, PhysicsQuery>>;
+
     struct InteractHandler {
         float grabDistance = 2.0f;
         EntityRef noclipEntity;
@@ -204,10 +211,10 @@ namespace sp::scripts {
             }
         }
 
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state, InteractHandlerLock lock, Entity ent, chrono_clock::duration interval) {
             if (ent.Has<TransformSnapshot, PhysicsQuery>(lock)) {
                 auto &query = ent.Get<PhysicsQuery>(lock);
-                auto &transform = ent.Get<TransformSnapshot>(lock);
+                auto &transform = ent.Get<const TransformSnapshot>(lock);
 
                 PhysicsQuery::Raycast::Result raycastResult;
                 if (raycastQuery) {
@@ -10,14 +10,18 @@
 namespace sp::scripts {
     using namespace ecs;
 
+    static const StringAtom LIFE_EVENT_NOTIFY_NEIGHBORS = "/life/notify_neighbors";
+    static const StringAtom LIFE_EVENT_NEIGHBOR_ALIVE = "/life/neighbor_alive";
+    static const StringAtom LIFE_EVENT_TOGGLE_ALIVE = "/life/toggle_alive";
+
     struct LifeCell {
         int neighborCount = 0;
         bool alive = false;
         bool initialized = false;
 
-        void OnTick(ScriptState &state, Lock<WriteAll> lock, Entity ent, chrono_clock::duration interval) {
+        void OnTick(ScriptState &state, SendEventsLock lock, Entity ent, chrono_clock::duration interval) {
             if (!initialized) {
-                if (alive) EventBindings::SendEvent(lock, ent, Event{"/life/notify_neighbors", ent, alive});
+                if (alive) EventBindings::SendEvent(lock, ent, Event{LIFE_EVENT_NOTIFY_NEIGHBORS, ent, alive});
                 initialized = true;
                 return;
             }
@@ -25,11 +29,11 @@ namespace sp::scripts {
             bool forceToggle = false;
             Event event;
             while (EventInput::Poll(lock, state.eventQueue, event)) {
-                if (event.name == "/life/neighbor_alive") {
+                if (event.name == LIFE_EVENT_NEIGHBOR_ALIVE) {
                     auto *neighborAlive = std::get_if<bool>(&event.data);
                     if (neighborAlive == nullptr) continue;
                     neighborCount += *neighborAlive ? 1 : -1;
-                } else if (event.name == "/life/toggle_alive") {
+                } else if (event.name == LIFE_EVENT_TOGGLE_ALIVE) {
                     forceToggle = true;
                 }
             }
@@ -37,7 +41,7 @@ namespace sp::scripts {
             bool nextAlive = neighborCount == 3 || (neighborCount == 2 && alive);
             if (forceToggle || nextAlive != alive) {
                 alive = !alive;
-                EventBindings::SendEvent(lock, ent, Event{"/life/notify_neighbors", ent, alive});
+                EventBindings::SendEvent(lock, ent, Event{LIFE_EVENT_NOTIFY_NEIGHBORS, ent, alive});
             }
         }
     };
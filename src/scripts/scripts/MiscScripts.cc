@@ -376,7 +376,7 @@ namespace sp::scripts {
                     continue;
                 }
 
-                auto timerName = event.name.substr("/reset_timer/"s.size());
+                auto timerName = event.name.String().substr("/reset_timer/"s.size());
                 if (timerName.empty() || !sp::contains(names, timerName)) {
                     Errorf("Unexpected event received by timer: %s", event.name);
                     continue;
@@ -0,0 +1,90 @@
+#include "core/Logging.hh"
+#include "ecs/EcsImpl.hh"
+#include "physx/PhysxManager.hh"
+
+#include <cmath>
+#include <tests.hh>
+
+namespace LaserSystemTests {
+    using namespace testing;
+
+    // Enough steps for entity changes to reach PhysX and the laser to be traced again
+    const unsigned int SETTLE_STEPS = 3;
+
+    float LaserLength(ecs::Entity emitter) {
+        auto lock = ecs::StartTransaction<ecs::Read<ecs::LaserLine>>();
+        auto &lines = emitter.Get<ecs::LaserLine>(lock);
+        auto *segments = std::get_if<ecs::LaserLine::Segments>(&lines.line);
+        AssertTrue(segments && !segments->empty(), "Expected the emitter to have a traced laser path");
+        return glm::length(segments->back().end);
+    }
+
+    void MoveWall(ecs::Entity wall, float distance) {
+        auto lock = ecs::StartTransaction<ecs::Write<ecs::TransformTree, ecs::TransformSnapshot>>();
+        wall.Set<ecs::TransformTree>(lock, glm::vec3(0, 0, -distance));
+        wall.Set<ecs::TransformSnapshot>(lock, glm::vec3(0, 0, -distance));
+    }
+
+    void TestCachedPathInvalidation() {
+        ecs::Entity emitter, wall;
+        {
+            Timer t("Create a laser emitter facing a wall");
+            auto lock = ecs::StartTransaction<ecs::AddRemove>();
+
+            emitter = lock.NewEntity();
+            emitter.Set<ecs::Name>(lock, "", "emitter");
+            emitter.Set<ecs::TransformSnapshot>(lock, glm::vec3(0));
+            auto &laser = emitter.Set<ecs::LaserEmitter>(lock);
+            laser.color = glm::vec3(1, 0, 0);
+            emitter.Set<ecs::LaserLine>(lock);
+
+            wall = lock.NewEntity();
+            wall.Set<ecs::Name>(lock, "", "wall");
+            wall.Set<ecs::TransformTree>(lock, glm::vec3(0, 0, -5));
+            wall.Set<ecs::TransformSnapshot>(lock, glm::vec3(0, 0, -5));
+            wall.Set<ecs::Physics>(lock,
+                ecs::PhysicsShape::Box(glm::vec3(1)),
+                ecs::PhysicsGroup::World,
+                ecs::PhysicsActorType::Static);
+        }
+
+        sp::PhysxManager physics(true);
+        float blockedLength;
+        {
+            Timer t("Trace the initial path");
+            physics.Step(SETTLE_STEPS);
+            blockedLength = LaserLength(emitter);
+            AssertTrue(blockedLength < 5.0f, "Expected the wall to block the laser");
+        }
+        {
+            Timer t("Move the wall the path ends on");
+            MoveWall(wall, 10);
+            physics.Step(SETTLE_STEPS);
+            AssertTrue(std::abs(LaserLength(emitter) - blockedLength - 5.0f) < 1e-3f,
+                "Expected the path to follow the moved wall");
+        }
+        {
+            Timer t("Make the wall a transparent optic");
+            {
+                auto lock = ecs::StartTransaction<ecs::AddRemove>();
+                auto &optic = wall.Set<ecs::OpticalElement>(lock);
+                optic.passTint = glm::vec3(1);
+                optic.reflectTint = glm::vec3(0);
+            }
+            physics.Step(SETTLE_STEPS);
+            AssertTrue(LaserLength(emitter) > 100.0f, "Expected the laser to pass through the optic");
+        }
+        {
+            Timer t("Make the optic opaque without moving it");
+            {
+                auto lock = ecs::StartTransaction<ecs::Write<ecs::OpticalElement>>();
+                wall.Get<ecs::OpticalElement>(lock).passTint = glm::vec3(0);
+            }
+            physics.Step(SETTLE_STEPS);
+            AssertTrue(std::abs(LaserLength(emitter) - blockedLength - 5.0f) < 1e-3f,
+                "Expected the opaque optic to block the laser");
+        }
+    }
+
+    Test test(&TestCachedPathInvalidation);
+} // namespace LaserSystemTests
@@ -0,0 +1,66 @@
+#include "console/Console.hh"
+#include "core/Logging.hh"
+#include "ecs/EcsImpl.hh"
+#include "physx/PhysxManager.hh"
+
+#include <tests.hh>
+
+namespace PhysxPipelinedTests {
+    using namespace testing;
+
+    const size_t STEP_COUNT = 8;
+
+    // Drops a box under default gravity, returning its height as seen by the ECS after each physics step
+    std::vector<float> SimulateFallingBox(bool pipelined) {
+        sp::GetConsoleManager().GetCVar<bool>("x.Pipelined").Set(pipelined);
+
+        ecs::Entity box;
+        {
+            auto lock = ecs::StartTransaction<ecs::AddRemove>();
+            box = lock.NewEntity();
+            box.Set<ecs::Name>(lock, "", "box");
+            box.Set<ecs::TransformTree>(lock, glm::vec3(0, 10, 0));
+            box.Set<ecs::TransformSnapshot>(lock, glm::vec3(0, 10, 0));
+            box.Set<ecs::Physics>(lock, ecs::PhysicsShape::Box(glm::vec3(1)));
+        }
+
+        std::vector<float> heights;
+        {
+            sp::PhysxManager physics(true);
+            for (size_t i = 0; i < STEP_COUNT; i++) {
+                physics.Step();
+                auto lock = ecs::StartTransaction<ecs::Read<ecs::TransformSnapshot>>();
+                heights.emplace_back(box.Get<ecs::TransformSnapshot>(lock).GetPosition().y);
+            }
+        }
+        {
+            auto lock = ecs::StartTransaction<ecs::AddRemove>();
+            box.Destroy(lock);
+        }
+        return heights;
+    }
+
+    void TestPipelinedStepResults() {
+        std::vector<float> blocking, pipelined;
+        {
+            Timer t("Step a falling box with blocking physics");
+            blocking = SimulateFallingBox(false);
+        }
+        {
+            Timer t("Step a falling box with pipelined physics");
+            pipelined = SimulateFallingBox(true);
+        }
+        sp::GetConsoleManager().GetCVar<bool>("x.Pipelined").Set(false);
+
+        AssertTrue(blocking.back() < 10.0f, "Expected the box to fall in blocking mode");
+        AssertEqual(pipelined.front(), 10.0f, "Expected no pipelined results in the first frame");
+        // The step simulated during frame N is only written back to the ECS in frame N + 1
+        for (size_t i = 0; i + 1 < STEP_COUNT; i++) {
+            AssertEqual(pipelined[i + 1],
+                blocking[i],
+                "Expected pipelined frame " + std::to_string(i + 1) + " to match blocking frame " + std::to_string(i));
+        }
+    }
+
+    Test test(&TestPipelinedStepResults);
+} // namespace PhysxPipelinedTests
@@ -0,0 +1,83 @@
+#include "assets/Asset.hh"
+#include "assets/AssetManager.hh"
+#include "console/Console.hh"
+#include "core/Logging.hh"
+#include "ecs/EcsImpl.hh"
+#include "game/SceneCache.hh"
+
+#include <picojson/picojson.h>
+#include <tests.hh>
+
+namespace SceneCacheTests {
+    using namespace testing;
+
+    const size_t LOAD_COUNT = 100;
+
+    size_t CountJsonComponents(const picojson::value &root) {
+        size_t count = 0;
+        for (auto &entity : root.get("entities").get<picojson::array>()) {
+            for (auto &comp : entity.get<picojson::object>()) {
+                if (comp.first != "name" && comp.first[0] != '_') count++;
+            }
+        }
+        return count;
+    }
+
+    void AssertEntitiesEqual(const std::vector<ecs::FlatEntity> &a, const std::vector<ecs::FlatEntity> &b) {
+        AssertEqual(a.size(), b.size(), "Expected the same number of entities");
+        for (size_t i = 0; i < a.size(); i++) {
+            ecs::ForEachComponent([&](const std::string &name, const ecs::ComponentBase &comp) {
+                std::vector<uint8_t> bufferA, bufferB;
+                bool savedA = comp.SaveBinary(a[i], bufferA);
+                bool savedB = comp.SaveBinary(b[i], bufferB);
+                Assertf(savedA == savedB && bufferA == bufferB,
+                    "Expected cached component to match JSON: %s on entity %s",
+                    name,
+                    std::to_string(i));
+            });
+        }
+    }
+
+    void BenchmarkScene(const std::string &sceneName) {
+        auto asset = sp::Assets().Load("scenes/" + sceneName + ".json", sp::AssetType::Bundled, true)->Get();
+        Assertf(asset, "Expected scene to exist: %s", sceneName);
+        auto &cvar = sp::GetConsoleManager().GetCVar<bool>("s.SceneCache");
+
+        picojson::value jsonRoot, cachedRoot;
+        std::vector<ecs::FlatEntity> jsonEntities, cachedEntities;
+        {
+            cvar.Set(false);
+            MultiTimer timer("Load " + sceneName + " from JSON");
+            for (size_t i = 0; i < LOAD_COUNT; i++) {
+                Timer t(timer);
+                jsonRoot = picojson::value();
+                jsonEntities.clear();
+                AssertTrue(sp::scenecache::LoadScene(sceneName, *asset, jsonRoot, jsonEntities),
+                    "Expected scene to load from JSON");
+            }
+        }
+        AssertTrue(sp::scenecache::SaveCache(sceneName, *asset), "Expected scene cache to be written");
+        {
+            cvar.Set(true);
+            MultiTimer timer("Load " + sceneName + " from cache");
+            for (size_t i = 0; i < LOAD_COUNT; i++) {
+                Timer t(timer);
+                cachedRoot = picojson::value();
+                cachedEntities.clear();
+                AssertTrue(sp::scenecache::LoadScene(sceneName, *asset, cachedRoot, cachedEntities),
+                    "Expected scene to load from cache");
+            }
+        }
+
+        AssertTrue(CountJsonComponents(cachedRoot) < CountJsonComponents(jsonRoot),
+            "Expected some components to be read from the cache");
+        AssertEntitiesEqual(jsonEntities, cachedEntities);
+    }
+
+    void TestSceneCacheLoadTime() {
+        BenchmarkScene("station-center");
+        BenchmarkScene("sponza");
+    }
+
+    Test test(&TestSceneCacheLoadTime);
+} // namespace SceneCacheTests
@@ -1,6 +1,7 @@
 #include "core/Logging.hh"
 #include "ecs/EcsImpl.hh"
 #include "game/Scene.hh"
+#include "game/SceneImpl.hh"
 #include "game/SceneManager.hh"
 
 #include <tests.hh>
@@ -187,5 +188,41 @@ namespace SceneManagerTests {
         }
     }
 
+    void TestReapplyFlatEntity() {
+        Timer t("Reapply flattened entities over runtime changes");
+        auto lock = ecs::StartTransaction<ecs::AddRemove>();
+        auto ent = lock.NewEntity();
+
+        ecs::FlatEntity flatEntity;
+        std::get<std::optional<ecs::Name>>(flatEntity) = ecs::Name("scene", "flat");
+        std::get<std::optional<ecs::TransformTree>>(flatEntity) = ecs::TransformTree(glm::vec3(1, 2, 3));
+        std::get<std::optional<ecs::LaserEmitter>>(flatEntity).emplace().color = glm::vec3(1, 0, 0);
+        AssertTrue(sp::scene::ApplyFlatEntity(lock, ent, flatEntity, true), "Expected the first apply to write");
+
+        // Runtime changes that resetting the components would discard
+        ent.Get<ecs::TransformTree>(lock).pose.SetPosition(glm::vec3(4, 5, 6));
+        ent.Get<ecs::LaserEmitter>(lock).intensity = 5.0f;
+
+        AssertTrue(!sp::scene::ApplyFlatEntity(lock, ent, flatEntity, true, &flatEntity),
+            "Expected an unchanged entity to write nothing");
+        AssertEqual(ent.Get<ecs::TransformTree>(lock).pose.GetPosition(),
+            glm::vec3(4, 5, 6),
+            "Expected the unchanged transform to keep its runtime state");
+        AssertEqual(ent.Get<ecs::LaserEmitter>(lock).intensity,
+            5.0f,
+            "Expected the unchanged laser emitter to keep its runtime state");
+
+        auto changedEntity = flatEntity;
+        std::get<std::optional<ecs::LaserEmitter>>(changedEntity)->color = glm::vec3(0, 1, 0);
+        AssertTrue(sp::scene::ApplyFlatEntity(lock, ent, changedEntity, true, &flatEntity),
+            "Expected the changed component to be written");
+        AssertEqual(ent.Get<ecs::LaserEmitter>(lock).color, glm::vec3(0, 1, 0), "Expected the new laser color");
+        AssertEqual(ent.Get<ecs::LaserEmitter>(lock).intensity, 1.0f, "Expected the changed component to be reset");
+        AssertEqual(ent.Get<ecs::TransformTree>(lock).pose.GetPosition(),
+            glm::vec3(4, 5, 6),
+            "Expected the unchanged transform to keep its runtime state");
+    }
+
     Test test(&TestBasicLoadAddRemove);
+    Test test2(&TestReapplyFlatEntity);
 } // namespace SceneManagerTests
@@ -0,0 +1,107 @@
+#include "console/Console.hh"
+#include "core/Logging.hh"
+#include "ecs/EcsImpl.hh"
+#include "ecs/ScriptManager.hh"
+
+#include <array>
+#include <tests.hh>
+
+namespace ScriptManagerTests {
+    using namespace testing;
+
+    const int BOARD_SIZE = 5;
+    const size_t GENERATION_COUNT = 6;
+
+    using Board = std::array<std::array<ecs::Entity, BOARD_SIZE>, BOARD_SIZE>;
+    using Pattern = std::array<std::array<bool, BOARD_SIZE>, BOARD_SIZE>;
+
+    // Runs a logic frame the same way as GameLogic::Frame()
+    void Tick() {
+        auto interval = std::chrono::milliseconds(8);
+        {
+            auto lock = ecs::StartTransaction<ecs::WriteAll>();
+            ecs::GetScriptManager().RunOnTick(lock, interval);
+        }
+        ecs::GetScriptManager().RunOnTickParallel(interval);
+    }
+
+    Pattern ReadPattern(const Board &board) {
+        auto lock = ecs::StartTransaction<ecs::Read<ecs::Scripts>>();
+        Pattern pattern;
+        for (int x = 0; x < BOARD_SIZE; x++) {
+            for (int y = 0; y < BOARD_SIZE; y++) {
+                auto &state = *board[x][y].Get<ecs::Scripts>(lock).scripts.front().state;
+                pattern[x][y] = state.GetParam<bool>("alive");
+            }
+        }
+        return pattern;
+    }
+
+    void TestLifeBlinker() {
+        // Run every life_cell in its own transaction if the script manager allows splitting the group
+        sp::GetConsoleManager().GetCVar<uint32_t>("s.ScriptChunkSize").Set(1);
+
+        Pattern horizontal = {}, vertical = {};
+        for (int i = 1; i <= 3; i++) {
+            horizontal[i][2] = true;
+            vertical[2][i] = true;
+        }
+
+        Board board;
+        {
+            Timer t("Create a board of life_cell scripts with a blinker");
+            auto lock = ecs::StartTransaction<ecs::AddRemove>();
+
+            for (int x = 0; x < BOARD_SIZE; x++) {
+                for (int y = 0; y < BOARD_SIZE; y++) {
+                    ecs::Name name("life", std::to_string(x) + "_" + std::to_string(y));
+                    auto ent = lock.NewEntity();
+                    ecs::EntityRef ref(name, ent);
+                    ent.Set<ecs::Name>(lock, name);
+                    ent.Set<ecs::EventInput>(lock);
+                    ent.Set<ecs::EventBindings>(lock);
+                    auto &state = ent.Set<ecs::Scripts>(lock).AddOnTick(name, "life_cell");
+                    state.SetParam<bool>("alive", horizontal[x][y]);
+                    board[x][y] = ent;
+                }
+            }
+            for (int x = 0; x < BOARD_SIZE; x++) {
+                for (int y = 0; y < BOARD_SIZE; y++) {
+                    auto &bindings = board[x][y].Get<ecs::EventBindings>(lock);
+                    for (int dx = -1; dx <= 1; dx++) {
+                        for (int dy = -1; dy <= 1; dy++) {
+                            if (dx == 0 && dy == 0) continue;
+                            int nx = (x + BOARD_SIZE + dx) % BOARD_SIZE;
+                            int ny = (y + BOARD_SIZE + dy) % BOARD_SIZE;
+                            bindings.Bind("/life/notify_neighbors", board[nx][ny], "/life/neighbor_alive");
+                        }
+                    }
+                }
+            }
+            ecs::GetScriptManager().RegisterEvents(lock);
+        }
+        {
+            Timer t("Step the blinker");
+            // The first tick only notifies neighbors of the initial pattern
+            Tick();
+            AssertTrue(ReadPattern(board) == horizontal, "Expected the initial tick to keep the pattern");
+            for (size_t generation = 1; generation <= GENERATION_COUNT; generation++) {
+                Tick();
+                auto &expected = generation % 2 ? vertical : horizontal;
+                AssertTrue(ReadPattern(board) == expected,
+                    "Unexpected blinker pattern in generation " + std::to_string(generation));
+            }
+        }
+        {
+            auto lock = ecs::StartTransaction<ecs::AddRemove>();
+            for (auto &column : board) {
+                for (auto &ent : column) {
+                    ent.Destroy(lock);
+                }
+            }
+        }
+        sp::GetConsoleManager().GetCVar<uint32_t>("s.ScriptChunkSize").Set(64);
+    }
+
+    Test test(&TestLifeBlinker);
+} // namespace ScriptManagerTests
@@ -0,0 +1,63 @@
+#include "assets/BinaryJson.hh"
+#include "core/Common.hh"
+
+#include <algorithm>
+#include <picojson/picojson.h>
+#include <tests.hh>
+#include <vector>
+
+namespace BinaryJsonTests {
+    using namespace testing;
+
+    const std::string sceneJson = R"({
+        "priority": "Scene",
+        "entities": [
+            {
+                "name": "box",
+                "transform": {"translate": [1, -2.5, 1e-3], "scale": 0.5},
+                "renderable": {"model": "box", "visibility": "DirectCamera|DirectEye"},
+                "physics": {"shapes": {"model": "box"}, "type": "Dynamic"}
+            },
+            {
+                "name": "light",
+                "light": {"intensity": 30, "illuminance": 0, "on": true, "shadow_map": null},
+                "signal_output": {"box": 1},
+                "script": [],
+                "_comment": "Unicode é and escapes \" \\ \n"
+            }
+        ]
+    })";
+
+    void TestBinaryJsonRoundTrip() {
+        Timer t("Test binary json round trip");
+        picojson::value src;
+        std::string err = picojson::parse(src, sceneJson);
+        AssertTrue(err.empty(), "Failed to parse test json: " + err);
+
+        std::vector<uint8_t> buffer;
+        sp::json::EncodeBinary(src, buffer);
+
+        picojson::value dst;
+        AssertTrue(sp::json::DecodeBinary(buffer, dst), "Failed to decode binary json");
+        AssertEqual(dst.serialize(), src.serialize(), "Decoded json doesn't match the source");
+        AssertTrue(dst == src, "Decoded json doesn't match the source");
+
+        for (size_t size = 0; size < buffer.size(); size++) {
+            picojson::value truncated;
+            bool success = sp::json::DecodeBinary(std::span(buffer.data(), size), truncated);
+            AssertTrue(!success, "Expected truncated binary json to fail decoding at size " + std::to_string(size));
+        }
+
+        auto trailing = buffer;
+        trailing.push_back(0);
+        picojson::value trailingDst;
+        AssertTrue(!sp::json::DecodeBinary(trailing, trailingDst), "Expected trailing data to fail decoding");
+
+        auto corrupt = buffer;
+        std::fill(corrupt.begin(), corrupt.begin() + sizeof(uint32_t), 0xff);
+        picojson::value corruptDst;
+        AssertTrue(!sp::json::DecodeBinary(corrupt, corruptDst), "Expected corrupt string table to fail decoding");
+    }
+
+    Test test(&TestBinaryJsonRoundTrip);
+} // namespace BinaryJsonTests
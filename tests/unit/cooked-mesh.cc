@@ -0,0 +1,136 @@
+#include "assets/CookedMesh.hh"
+#include "assets/GltfImpl.hh"
+#include "core/Common.hh"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <random>
+#include <tests.hh>
+
+namespace CookedMeshTests {
+    using namespace testing;
+
+    template<typename T>
+    int addAccessor(tinygltf::Model &model, int type, int componentType, const std::vector<T> &data) {
+        auto &buffer = model.buffers[0].data;
+        auto &view = model.bufferViews.emplace_back();
+        view.buffer = 0;
+        view.byteOffset = buffer.size();
+        view.byteLength = data.size() * sizeof(T);
+        auto *bytes = reinterpret_cast<const uint8_t *>(data.data());
+        buffer.insert(buffer.end(), bytes, bytes + view.byteLength);
+
+        auto &accessor = model.accessors.emplace_back();
+        accessor.bufferView = model.bufferViews.size() - 1;
+        accessor.type = type;
+        accessor.componentType = componentType;
+        accessor.count = data.size();
+        return model.accessors.size() - 1;
+    }
+
+    // A grid of quads with its triangles shuffled, so the cooker has something to optimize
+    tinygltf::Model makeGridModel(int size) {
+        tinygltf::Model model;
+        model.buffers.emplace_back();
+
+        std::vector<glm::vec3> positions, normals;
+        std::vector<glm::vec2> uvs;
+        for (int y = 0; y <= size; y++) {
+            for (int x = 0; x <= size; x++) {
+                positions.emplace_back(x, y, (x * y) % 3);
+                normals.emplace_back(0, 0, 1);
+                uvs.emplace_back((float)x / size, (float)y / size);
+            }
+        }
+
+        std::vector<std::array<uint16_t, 3>> triangles;
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                uint16_t a = y * (size + 1) + x, b = a + 1, c = a + size + 1, d = c + 1;
+                triangles.push_back({a, b, c});
+                triangles.push_back({b, d, c});
+            }
+        }
+        std::shuffle(triangles.begin(), triangles.end(), std::mt19937(42));
+        std::vector<uint16_t> indices;
+        for (auto &tri : triangles) {
+            indices.insert(indices.end(), tri.begin(), tri.end());
+        }
+
+        auto &primitive = model.meshes.emplace_back().primitives.emplace_back();
+        primitive.mode = TINYGLTF_MODE_TRIANGLES;
+        primitive.indices = addAccessor(model, TINYGLTF_TYPE_SCALAR, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT, indices);
+        primitive.attributes["POSITION"] = addAccessor(model,
+            TINYGLTF_TYPE_VEC3,
+            TINYGLTF_COMPONENT_TYPE_FLOAT,
+            positions);
+        primitive.attributes["NORMAL"] = addAccessor(model,
+            TINYGLTF_TYPE_VEC3,
+            TINYGLTF_COMPONENT_TYPE_FLOAT,
+            normals);
+        primitive.attributes["TEXCOORD_0"] = addAccessor(model,
+            TINYGLTF_TYPE_VEC2,
+            TINYGLTF_COMPONENT_TYPE_FLOAT,
+            uvs);
+        return model;
+    }
+
+    std::vector<std::array<uint32_t, 3>> sortedTriangles(std::span<const uint32_t> indices) {
+        std::vector<std::array<uint32_t, 3>> triangles;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            triangles.push_back({indices[i], indices[i + 1], indices[i + 2]});
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    void TestCookedMeshMatchesRuntime() {
+        Timer t("Test cooked mesh matches runtime conversion");
+        auto model = makeGridModel(40);
+        sp::gltf::Mesh mesh(model, model.meshes[0]);
+        const sp::Hash128 sourceHash = {0x1234, 0x5678};
+
+        // The runtime path converts the gltf without reordering anything
+        auto runtime = sp::cookedmesh::Convert(mesh);
+        AssertEqual(runtime.primitives.size(), 1u, "Expected a single primitive");
+        AssertEqual(runtime.vertices.size(), 41u * 41u, "Unexpected vertex count");
+        AssertEqual(runtime.indices.size(), 40u * 40u * 6u, "Unexpected index count");
+        AssertEqual(runtime.primitives[0].boundsMax, glm::vec3(40, 40, 2), "Unexpected primitive bounds");
+
+        auto cooked = sp::cookedmesh::Convert(mesh);
+        sp::cookedmesh::OptimizeIndices(cooked);
+        std::vector<uint8_t> data;
+        sp::cookedmesh::Serialize(cooked, sourceHash, data);
+
+        std::vector<uint8_t> dataAgain;
+        auto cookedAgain = sp::cookedmesh::Convert(mesh);
+        sp::cookedmesh::OptimizeIndices(cookedAgain);
+        sp::cookedmesh::Serialize(cookedAgain, sourceHash, dataAgain);
+        AssertTrue(data == dataAgain, "Expected cooking to be deterministic");
+
+        sp::CookedMeshView view;
+        AssertTrue(sp::cookedmesh::Deserialize(data, sourceHash, view), "Failed to read cooked mesh");
+        AssertEqual(view.primitives.size(), runtime.primitives.size(), "Primitive count mismatch");
+        AssertTrue(std::memcmp(view.primitives.data(), runtime.primitives.data(), view.primitives.size_bytes()) == 0,
+            "Expected cooked primitives to match the runtime conversion");
+        AssertEqual(view.vertices.size(), runtime.vertices.size(), "Vertex count mismatch");
+        AssertTrue(std::memcmp(view.vertices.data(), runtime.vertices.data(), view.vertices.size_bytes()) == 0,
+            "Expected cooked vertices to match the runtime conversion");
+        AssertTrue(sortedTriangles(view.indices) == sortedTriangles(runtime.indices),
+            "Expected cooked triangles to match the runtime conversion");
+
+        float runtimeRatio = sp::cookedmesh::AverageCacheMissRatio(runtime.indices);
+        float cookedRatio = sp::cookedmesh::AverageCacheMissRatio(view.indices);
+        AssertTrue(cookedRatio < runtimeRatio * 0.5f,
+            "Expected cooked indices to reuse the vertex cache: " + std::to_string(cookedRatio) + " vs " +
+                std::to_string(runtimeRatio));
+
+        const sp::Hash128 otherHash = {0x1234, 0x5679};
+        AssertTrue(!sp::cookedmesh::Deserialize(data, otherHash, view), "Expected source hash mismatch to fail");
+        auto truncated = std::span(data).subspan(0, data.size() - 1);
+        AssertTrue(!sp::cookedmesh::Deserialize(truncated, sourceHash, view), "Expected truncated mesh to fail");
+    }
+
+    Test test(&TestCookedMeshMatchesRuntime);
+} // namespace CookedMeshTests
@@ -0,0 +1,121 @@
+#include "assets/CookedTexture.hh"
+#include "core/Common.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <tests.hh>
+
+namespace CookedTextureTests {
+    using namespace testing;
+
+    // Smooth gradients with mild noise, sized so the edge blocks are partially outside the texture
+    std::vector<uint8_t> makeTestImage(uint32_t width, uint32_t height) {
+        std::vector<uint8_t> rgba((size_t)width * height * 4);
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> noise(-4, 4);
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+                uint8_t *pixel = &rgba[((size_t)y * width + x) * 4];
+                int values[4] = {
+                    (int)(x * 255 / width),
+                    (int)(y * 255 / height),
+                    (int)(128 + 100 * std::sin(x * 0.2f + y * 0.1f)),
+                    (int)(255 - (x + y) * 2),
+                };
+                for (size_t c = 0; c < 4; c++) {
+                    pixel[c] = std::clamp(values[c] + noise(rng), 0, 255);
+                }
+            }
+        }
+        return rgba;
+    }
+
+    void TestCookedTextureQuality() {
+        Timer t("Test cooked texture compression quality");
+        const uint32_t width = 67, height = 45;
+        auto rgba = makeTestImage(width, height);
+
+        struct {
+            sp::CookedTextureFormat format;
+            size_t channels;
+            double minPSNR;
+        } cases[] = {
+            {sp::CookedTextureFormat::RGBA8, 4, std::numeric_limits<double>::infinity()},
+            {sp::CookedTextureFormat::BC1, 3, 32.0},
+            {sp::CookedTextureFormat::BC3, 4, 33.0},
+            {sp::CookedTextureFormat::BC5, 2, 45.0},
+            {sp::CookedTextureFormat::BC7, 4, 34.0},
+        };
+        for (auto &testCase : cases) {
+            auto formatName = std::to_string((uint32_t)testCase.format);
+            auto cooked = sp::cookedtexture::Cook(rgba, width, height, testCase.format, true, true);
+            AssertEqual(cooked.levelCount, 7u, "Expected a full mip chain for format " + formatName);
+            AssertEqual(cooked.LevelExtent(6).x, 1u, "Expected the last level to be 1x1");
+            AssertEqual(cooked.LevelExtent(6).y, 1u, "Expected the last level to be 1x1");
+            AssertEqual(cooked.data.size(), cooked.LevelOffset(7), "Unexpected cooked data size");
+
+            auto decoded = sp::cookedtexture::DecodeLevel(cooked.View(), 0);
+            double psnr = sp::cookedtexture::PSNR(rgba, decoded, testCase.channels);
+            AssertTrue(psnr >= testCase.minPSNR,
+                "Expected format " + formatName + " to preserve the source: " + std::to_string(psnr) + " dB");
+        }
+    }
+
+    void TestCookedTextureMipmaps() {
+        Timer t("Test cooked texture mipmaps");
+        // Black and white average to a linear 0.5 for sRGB textures, and to 128 for linear ones
+        std::vector<uint8_t> checker = {
+            0, 0, 0, 0, //
+            255, 255, 255, 255, //
+            255, 255, 255, 255, //
+            0, 0, 0, 0, //
+        };
+        auto srgb = sp::cookedtexture::Cook(checker, 2, 2, sp::CookedTextureFormat::RGBA8, true, true);
+        AssertEqual(srgb.levelCount, 2u, "Expected 2 levels for a 2x2 texture");
+        auto srgbLevel = sp::cookedtexture::DecodeLevel(srgb.View(), 1);
+        AssertTrue(srgbLevel == std::vector<uint8_t>{188, 188, 188, 128},
+            "Expected sRGB colors to be averaged in linear space");
+
+        auto linear = sp::cookedtexture::Cook(checker, 2, 2, sp::CookedTextureFormat::RGBA8, false, true);
+        auto linearLevel = sp::cookedtexture::DecodeLevel(linear.View(), 1);
+        AssertTrue(linearLevel == std::vector<uint8_t>{128, 128, 128, 128}, "Expected linear colors to be averaged");
+
+        auto single = sp::cookedtexture::Cook(checker, 2, 2, sp::CookedTextureFormat::BC1, true, false);
+        AssertEqual(single.levelCount, 1u, "Expected no mipmaps when they aren't requested");
+    }
+
+    void TestCookedTextureSerialization() {
+        Timer t("Test cooked texture serialization");
+        const sp::Hash128 sourceHash = {0x1234, 0x5678};
+        auto rgba = makeTestImage(32, 16);
+        auto cooked = sp::cookedtexture::Cook(rgba, 32, 16, sp::CookedTextureFormat::BC5, false, true);
+        cooked.swizzle = {sp::cookedtexture::CHANNEL_ZERO, 0, 1, sp::cookedtexture::CHANNEL_ONE};
+        auto cookedAgain = sp::cookedtexture::Cook(rgba, 32, 16, sp::CookedTextureFormat::BC5, false, true);
+        cookedAgain.swizzle = cooked.swizzle;
+
+        std::vector<uint8_t> data, dataAgain;
+        sp::cookedtexture::Serialize(cooked, sourceHash, data);
+        sp::cookedtexture::Serialize(cookedAgain, sourceHash, dataAgain);
+        AssertTrue(data == dataAgain, "Expected cooking to be deterministic");
+
+        sp::CookedTextureView view;
+        AssertTrue(sp::cookedtexture::Deserialize(data, sourceHash, view), "Failed to read cooked texture");
+        AssertEqual(view.width, 32u, "Unexpected cooked texture width");
+        AssertEqual(view.height, 16u, "Unexpected cooked texture height");
+        AssertEqual(view.levelCount, cooked.levelCount, "Unexpected cooked texture level count");
+        AssertTrue(view.swizzle == cooked.swizzle, "Unexpected cooked texture swizzle");
+        AssertTrue(std::equal(view.data.begin(), view.data.end(), cooked.data.begin(), cooked.data.end()),
+            "Expected cooked texture data to round trip");
+
+        const sp::Hash128 otherHash = {0x1234, 0x5679};
+        AssertTrue(!sp::cookedtexture::Deserialize(data, otherHash, view), "Expected source hash mismatch to fail");
+        auto truncated = std::span(data).subspan(0, data.size() - 1);
+        AssertTrue(!sp::cookedtexture::Deserialize(truncated, sourceHash, view), "Expected truncated texture to fail");
+    }
+
+    Test test1(&TestCookedTextureQuality);
+    Test test2(&TestCookedTextureMipmaps);
+    Test test3(&TestCookedTextureSerialization);
+} // namespace CookedTextureTests
@@ -0,0 +1,141 @@
+#include "core/Common.hh"
+#include "core/Culling.hh"
+
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <tests.hh>
+
+namespace CullingTests {
+    using namespace testing;
+
+    // A camera at the origin looking down -Z, which sees x and y from -10 to 10 at a distance of 10
+    glm::mat4 makeViewProj() {
+        return glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+    }
+
+    void TestFrustumCulling() {
+        Timer t("Test frustum culling of bounding boxes");
+        auto frustum = sp::culling::ExtractFrustum(makeViewProj());
+
+        AssertTrue(sp::culling::IntersectsFrustum(frustum, glm::vec3(-1, -1, -11), glm::vec3(1, 1, -9)),
+            "Expected a box in front of the camera to be visible");
+        AssertTrue(sp::culling::IntersectsFrustum(frustum, glm::vec3(-12, -1, -11), glm::vec3(-9, 1, -9)),
+            "Expected a box crossing the edge of the screen to be visible");
+        AssertTrue(sp::culling::IntersectsFrustum(frustum, glm::vec3(-1, -1, -1), glm::vec3(1, 1, 1)),
+            "Expected a box around the camera to be visible");
+        AssertTrue(!sp::culling::IntersectsFrustum(frustum, glm::vec3(-1, -1, 9), glm::vec3(1, 1, 11)),
+            "Expected a box behind the camera to be culled");
+        AssertTrue(!sp::culling::IntersectsFrustum(frustum, glm::vec3(-16, -1, -11), glm::vec3(-12, 1, -9)),
+            "Expected a box left of the screen to be culled");
+        AssertTrue(!sp::culling::IntersectsFrustum(frustum, glm::vec3(-1, 12, -11), glm::vec3(1, 16, -9)),
+            "Expected a box above the screen to be culled");
+        AssertTrue(!sp::culling::IntersectsFrustum(frustum, glm::vec3(-1, -1, -120), glm::vec3(1, 1, -110)),
+            "Expected a box past the far plane to be culled");
+
+        // A unit box rotated 90 degrees around Y, scaled, and moved in front of the camera
+        glm::vec3 boundsMin(0, 0, 0), boundsMax(1, 2, 3);
+        auto transform = glm::translate(glm::vec3(0, 0, -10)) * glm::rotate(glm::radians(90.0f), glm::vec3(0, 1, 0)) *
+                         glm::scale(glm::vec3(2));
+        sp::culling::TransformBounds(transform, boundsMin, boundsMax);
+        AssertTrue(glm::all(glm::lessThan(glm::abs(boundsMin - glm::vec3(0, 0, -12)), glm::vec3(0.0001f))),
+            "Unexpected transformed bounds min: " + glm::to_string(boundsMin));
+        AssertTrue(glm::all(glm::lessThan(glm::abs(boundsMax - glm::vec3(6, 4, -10)), glm::vec3(0.0001f))),
+            "Unexpected transformed bounds max: " + glm::to_string(boundsMax));
+    }
+
+    void TestDepthPyramid() {
+        Timer t("Test building a depth pyramid");
+        const glm::uvec2 extent(5, 3);
+        std::vector<float> depth(extent.x * extent.y, 0.25f);
+        depth[2 * extent.x + 4] = 0.75f; // The bottom right corner, which is clamped into the last texel of each level
+
+        auto pyramid = sp::culling::BuildDepthPyramid(depth, extent);
+        AssertEqual(pyramid.levels.size(), 3u, "Expected levels down to 1x1");
+        AssertTrue(pyramid.LevelExtent(0) == glm::uvec2(3, 2), "Unexpected level 0 extent");
+        AssertTrue(pyramid.LevelExtent(1) == glm::uvec2(2, 1), "Unexpected level 1 extent");
+        AssertTrue(pyramid.LevelExtent(2) == glm::uvec2(1, 1), "Unexpected level 2 extent");
+
+        AssertEqual(pyramid.Texel(0, {0, 0}), 0.25f, "Unexpected level 0 depth");
+        AssertEqual(pyramid.Texel(0, {2, 1}), 0.75f, "Expected the farthest depth in level 0");
+        AssertEqual(pyramid.Texel(1, {0, 0}), 0.25f, "Unexpected level 1 depth");
+        AssertEqual(pyramid.Texel(1, {1, 0}), 0.75f, "Expected the farthest depth in level 1");
+        AssertEqual(pyramid.Texel(2, {0, 0}), 0.75f, "Expected the farthest depth in level 2");
+    }
+
+    void TestOcclusionCulling() {
+        Timer t("Test occlusion culling against a depth pyramid");
+        auto viewProj = makeViewProj();
+
+        // A wall 5 units away covering the left half of the screen, with nothing on the right half
+        const glm::uvec2 extent(64, 64);
+        glm::vec4 wallClip = viewProj * glm::vec4(0, 0, -5, 1);
+        float wallDepth = wallClip.z / wallClip.w;
+        std::vector<float> depth(extent.x * extent.y, 1.0f);
+        for (uint32 y = 0; y < extent.y; y++) {
+            for (uint32 x = 0; x < extent.x / 2; x++) {
+                depth[y * extent.x + x] = wallDepth;
+            }
+        }
+        auto pyramid = sp::culling::BuildDepthPyramid(depth, extent);
+
+        sp::ScreenBounds screenBounds;
+        AssertTrue(sp::culling::ProjectBounds(viewProj,
+                       glm::vec3(-6, -1, -11),
+                       glm::vec3(-2, 1, -9),
+                       extent,
+                       screenBounds),
+            "Expected a box on screen to be projected");
+        AssertTrue(screenBounds.maxPixel.x < extent.x / 2, "Expected the box to be on the left half of the screen");
+        AssertTrue(screenBounds.nearestDepth > wallDepth, "Expected the box to be behind the wall");
+
+        AssertTrue(sp::culling::IsOccluded(pyramid, viewProj, glm::vec3(-6, -1, -11), glm::vec3(-2, 1, -9)),
+            "Expected a box behind the wall to be occluded");
+        AssertTrue(!sp::culling::IsOccluded(pyramid, viewProj, glm::vec3(2, -1, -11), glm::vec3(6, 1, -9)),
+            "Expected a box beside the wall to be visible");
+        AssertTrue(!sp::culling::IsOccluded(pyramid, viewProj, glm::vec3(-2, -1, -4), glm::vec3(-1, 1, -3)),
+            "Expected a box in front of the wall to be visible");
+        AssertTrue(!sp::culling::IsOccluded(pyramid, viewProj, glm::vec3(-2, -1, -11), glm::vec3(2, 1, -9)),
+            "Expected a box partially behind the wall to be visible");
+        AssertTrue(!sp::culling::IsOccluded(pyramid, viewProj, glm::vec3(-12, -1, -11), glm::vec3(-8, 1, -9)),
+            "Expected a box crossing the edge of the screen to be visible");
+        AssertTrue(!sp::culling::IsOccluded(pyramid, viewProj, glm::vec3(-6, -1, -11), glm::vec3(-2, 1, 1)),
+            "Expected a box crossing the near plane to be visible");
+    }
+
+    void TestOcclusionCullingRows() {
+        Timer t("Test occlusion culling against the top or bottom of a depth pyramid");
+        auto viewProj = makeViewProj();
+
+        // A floor 5 units away covering only the bottom half of the screen. The viewport is flipped, so the bottom of
+        // the screen is the last rows of the depth buffer.
+        const glm::uvec2 extent(64, 64);
+        glm::vec4 floorClip = viewProj * glm::vec4(0, 0, -5, 1);
+        float floorDepth = floorClip.z / floorClip.w;
+        std::vector<float> depth(extent.x * extent.y, 1.0f);
+        for (uint32 y = extent.y / 2; y < extent.y; y++) {
+            for (uint32 x = 0; x < extent.x; x++) {
+                depth[y * extent.x + x] = floorDepth;
+            }
+        }
+        auto pyramid = sp::culling::BuildDepthPyramid(depth, extent);
+
+        sp::ScreenBounds screenBounds;
+        AssertTrue(sp::culling::ProjectBounds(viewProj,
+                       glm::vec3(-1, 2, -11),
+                       glm::vec3(1, 6, -9),
+                       extent,
+                       screenBounds),
+            "Expected a box on screen to be projected");
+        AssertTrue(screenBounds.maxPixel.y < extent.y / 2, "Expected a box above the camera to be in the first rows");
+
+        AssertTrue(sp::culling::IsOccluded(pyramid, viewProj, glm::vec3(-1, -6, -11), glm::vec3(1, -2, -9)),
+            "Expected a box below the camera to be occluded by the floor");
+        AssertTrue(!sp::culling::IsOccluded(pyramid, viewProj, glm::vec3(-1, 2, -11), glm::vec3(1, 6, -9)),
+            "Expected a box above the camera to be visible");
+    }
+
+    Test test1(&TestFrustumCulling);
+    Test test2(&TestDepthPyramid);
+    Test test3(&TestOcclusionCulling);
+    Test test4(&TestOcclusionCullingRows);
+} // namespace CullingTests
@@ -0,0 +1,219 @@
+#include "core/DispatchQueue.hh"
+
+#include <atomic>
+#include <tests.hh>
+#include <thread>
+
+namespace DispatchQueueTests {
+    using namespace testing;
+
+    void TestDispatchQueue() {
+        {
+            Timer t("Test serial queue runs work in order");
+            sp::DispatchQueue queue("TestSerial", 1);
+            std::vector<int> order;
+            std::vector<sp::AsyncPtr<void>> results;
+            for (int i = 0; i < 100; i++) {
+                results.emplace_back(queue.Dispatch<void>([&order, i]() {
+                    order.emplace_back(i);
+                }));
+            }
+            for (auto &result : results) {
+                result->Get();
+            }
+            AssertEqual(order.size(), 100u, "Expected all work items to run");
+            for (int i = 0; i < (int)order.size(); i++) {
+                AssertEqual(order[i], i, "Expected serial work items to run in dispatch order");
+            }
+        }
+        {
+            Timer t("Test dependency chain across queues");
+            sp::DispatchQueue workerQueue("TestWorker", 4);
+            sp::DispatchQueue serialQueue("TestSerial", 1);
+
+            auto input = std::make_shared<sp::Async<int>>();
+            auto doubled = workerQueue.Dispatch<int>(input, [](std::shared_ptr<int> value) {
+                return std::make_shared<int>(*value * 2);
+            });
+            auto sum = serialQueue.Dispatch<int>(input, doubled, [](std::shared_ptr<int> a, std::shared_ptr<int> b) {
+                return std::make_shared<int>(*a + *b);
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            AssertTrue(!doubled->Ready(), "Expected work to wait for its input");
+
+            input->Set(std::make_shared<int>(7));
+            AssertEqual(*sum->Get(), 21, "Expected chained work to use its input values");
+        }
+        {
+            Timer t("Test forwarding a returned future");
+            sp::DispatchQueue queue("TestForward", 2);
+            auto inner = std::make_shared<sp::Async<int>>();
+            auto outer = queue.Dispatch<int>([inner]() {
+                return inner;
+            });
+            queue.Flush();
+            AssertTrue(!outer->Ready(), "Expected forwarded result to wait for the returned future");
+            inner->Set(std::make_shared<int>(42));
+            AssertEqual(*outer->Get(), 42, "Expected forwarded result to match the returned future");
+        }
+        {
+            Timer t("Test chained continuations");
+            sp::DispatchQueue queue("TestThen", 1);
+            const int chainLength = 100;
+
+            auto first = std::make_shared<sp::Async<int>>();
+            sp::AsyncPtr<int> last = first;
+            for (int i = 0; i < chainLength; i++) {
+                last = last->Then<int>(queue, [](std::shared_ptr<int> value) {
+                    return std::make_shared<int>(*value + 1);
+                });
+            }
+            AssertTrue(!last->Ready(), "Expected continuation to wait for its input");
+            {
+                Timer t2("Resolve " + std::to_string(chainLength) + " chained continuations");
+                first->Set(std::make_shared<int>(0));
+                AssertEqual(*last->Get(), chainLength, "Expected every continuation to run once");
+            }
+
+            auto ready = std::make_shared<sp::Async<int>>(std::make_shared<int>(5));
+            auto result = ready->Then<int>(queue, [](std::shared_ptr<int> value) {
+                return std::make_shared<int>(*value * 3);
+            });
+            AssertEqual(*result->Get(), 15, "Expected continuation on a ready value to run");
+        }
+        {
+            Timer t("Test manually flushed queue");
+            sp::DispatchQueue queue("TestManual", 0);
+            std::atomic_int count = 0;
+            for (int i = 0; i < 10; i++) {
+                queue.Dispatch<void>([&count]() {
+                    count++;
+                });
+            }
+            AssertEqual(count.load(), 0, "Expected manual queue to wait for Flush()");
+            queue.Flush();
+            AssertEqual(count.load(), 10, "Expected Flush() to run all ready work");
+        }
+        {
+            Timer t("Test parallel queue uses multiple workers");
+            sp::DispatchQueue queue("TestParallel", 4);
+            std::atomic_int running = 0, maxRunning = 0;
+            std::vector<sp::AsyncPtr<void>> results;
+            for (int i = 0; i < 16; i++) {
+                results.emplace_back(queue.Dispatch<void>([&]() {
+                    int current = ++running;
+                    int expected = maxRunning;
+                    while (current > expected && !maxRunning.compare_exchange_weak(expected, current)) {}
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                    running--;
+                }));
+            }
+            for (auto &result : results) {
+                result->Get();
+            }
+            AssertTrue(maxRunning > 1, "Expected work to run in parallel");
+            AssertTrue(maxRunning <= 4, "Expected parallel work to be limited by the queue's thread count");
+        }
+        {
+            Timer t("Test blocked work doesn't starve other queues");
+            const int blockingCount = 32;
+            sp::DispatchQueue blockingQueue("TestBlocking", blockingCount);
+            sp::DispatchQueue serialQueue("TestSerial", 1);
+
+            auto input = std::make_shared<sp::Async<int>>();
+            std::atomic_int started = 0;
+            std::vector<sp::AsyncPtr<int>> blocked;
+            for (int i = 0; i < blockingCount; i++) {
+                blocked.emplace_back(blockingQueue.Dispatch<int>([input, &started]() {
+                    started++;
+                    return input->Get();
+                }));
+            }
+            auto deadline = chrono_clock::now() + std::chrono::seconds(1);
+            while (started < blockingCount && chrono_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            AssertEqual(started.load(), blockingCount, "Expected every blocking item to run at once");
+            serialQueue.Dispatch<void>([input]() {
+                input->Set(std::make_shared<int>(3));
+            });
+            for (auto &result : blocked) {
+                AssertEqual(*result->Get(), 3, "Expected blocked work to see the other queue's result");
+            }
+        }
+        {
+            Timer t("Test destroyed queue drops pending work");
+            auto input = std::make_shared<sp::Async<int>>();
+            std::atomic_bool started = false, release = false;
+            sp::AsyncPtr<void> running, queued;
+            sp::AsyncPtr<int> waiting;
+            std::thread releaseThread;
+            {
+                sp::DispatchQueue queue("TestDrop", 1);
+                running = queue.Dispatch<void>([&]() {
+                    started = true;
+                    while (!release) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                });
+                queued = queue.Dispatch<void>([]() {});
+                waiting = queue.Dispatch<int>(input, [](std::shared_ptr<int> value) {
+                    return value;
+                });
+                while (!started) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                releaseThread = std::thread([&release]() {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    release = true;
+                });
+            }
+            releaseThread.join();
+            AssertTrue(running->Ready(), "Expected running work to finish before the queue is destroyed");
+            AssertTrue(queued->Ready(), "Expected dropped work to be resolved");
+            AssertTrue(!waiting->Ready(), "Expected work to wait for its input");
+            input->Set(std::make_shared<int>(1));
+            AssertTrue(waiting->Ready() && waiting->Get() == nullptr, "Expected dropped work to resolve to nullptr");
+        }
+        {
+            Timer t("Test controlled work priority and cancellation");
+            sp::DispatchQueue queue("TestPriority", 0);
+            std::vector<int> order;
+            auto low = std::make_shared<sp::DispatchControl>(-1);
+            auto high = std::make_shared<sp::DispatchControl>(1);
+            auto canceled = std::make_shared<sp::DispatchControl>(-1);
+
+            queue.DispatchControlled<void>(low, [&order]() {
+                order.emplace_back(1);
+            });
+            queue.Dispatch<void>([&order]() {
+                order.emplace_back(2);
+            });
+            queue.DispatchControlled<void>(high, [&order]() {
+                order.emplace_back(3);
+            });
+            auto canceledResult = queue.DispatchControlled<int>(canceled, [&order]() {
+                order.emplace_back(4);
+                return std::make_shared<int>(4);
+            });
+            AssertTrue(canceled->Cancel(), "Expected queued work to be cancelable");
+            AssertTrue(!low->Cancel(-2), "Expected work above the max priority to not be canceled");
+            low->Request(2);
+
+            queue.Flush();
+            AssertEqual(order.size(), 3u, "Expected canceled work to be skipped");
+            AssertEqual(order[0], 1, "Expected raised priority work to run first");
+            AssertEqual(order[1], 3, "Expected high priority work to run before default priority work");
+            AssertEqual(order[2], 2, "Expected default priority work to run last");
+            AssertTrue(canceledResult->Get() == nullptr, "Expected skipped work to resolve to nullptr");
+            AssertTrue(canceled->GetState() == sp::DispatchControl::State::Skipped, "Expected work to be skipped");
+            AssertTrue(!canceled->Request(0), "Expected skipped work to not be resumable");
+
+            auto stats = queue.GetStats();
+            AssertEqual(stats.processedCount, 3u, "Expected processed work to be counted");
+            AssertEqual(stats.skippedCount, 1u, "Expected skipped work to be counted");
+        }
+    }
+
+    Test test(&TestDispatchQueue);
+} // namespace DispatchQueueTests
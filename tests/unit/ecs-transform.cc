@@ -1,6 +1,8 @@
 #include "core/Logging.hh"
 #include "ecs/EcsImpl.hh"
+#include "ecs/TransformPropagation.hh"
 
+#include <algorithm>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_access.hpp>
 #include <glm/gtx/transform.hpp>
@@ -138,5 +140,79 @@ namespace EcsTransformTests {
         }
     }
 
+    void TestTransformPropagation() {
+        Tecs::Entity root, a, b;
+        ecs::TransformPropagation propagation;
+        {
+            Timer t("Create a chain of transform parents");
+            auto lock = ecs::StartTransaction<ecs::AddRemove>();
+
+            // Create the children first so the entity order doesn't match the tree order
+            b = lock.NewEntity();
+            b.Set<ecs::TransformTree>(lock, glm::vec3(0, 5, 0));
+            b.Set<ecs::TransformSnapshot>(lock);
+
+            a = lock.NewEntity();
+            a.Set<ecs::TransformTree>(lock, glm::vec3(4, 0, 0));
+            a.Set<ecs::TransformSnapshot>(lock);
+
+            root = lock.NewEntity();
+            root.Set<ecs::TransformTree>(lock, glm::vec3(1, 2, 3));
+            root.Set<ecs::TransformSnapshot>(lock);
+
+            ecs::EntityRef rootRef(ecs::Name("", "propagation_root"), root);
+            ecs::EntityRef aRef(ecs::Name("", "propagation_a"), a);
+            a.Get<ecs::TransformTree>(lock).parent = root;
+            b.Get<ecs::TransformTree>(lock).parent = a;
+        }
+        {
+            Timer t("Propagate transforms to snapshots");
+            auto lock = ecs::StartTransaction<ecs::Read<ecs::TransformTree>, ecs::Write<ecs::TransformSnapshot>>();
+
+            auto &changed = propagation.Update(lock);
+            AssertTrue(std::find(changed.begin(), changed.end(), b) != changed.end(), "Expected B to be updated");
+            AssertEqual(root.Get<ecs::TransformSnapshot>(lock).GetPosition(),
+                glm::vec3(1, 2, 3),
+                "Root entity has wrong snapshot position");
+            AssertEqual(a.Get<ecs::TransformSnapshot>(lock).GetPosition(),
+                glm::vec3(5, 2, 3),
+                "A entity has wrong snapshot position");
+            AssertEqual(b.Get<ecs::TransformSnapshot>(lock).GetPosition(),
+                glm::vec3(5, 7, 3),
+                "B entity has wrong snapshot position");
+
+            AssertTrue(propagation.Update(lock).empty(), "Expected no snapshots to change");
+        }
+        {
+            Timer t("Propagate a moved parent to its children");
+            {
+                auto lock = ecs::StartTransaction<ecs::Write<ecs::TransformTree>>();
+                a.Get<ecs::TransformTree>(lock).pose.SetPosition(glm::vec3(0, 0, 4));
+            }
+            auto lock = ecs::StartTransaction<ecs::Read<ecs::TransformTree>, ecs::Write<ecs::TransformSnapshot>>();
+
+            auto &changed = propagation.Update(lock);
+            AssertTrue(std::find(changed.begin(), changed.end(), root) == changed.end(), "Expected root to be clean");
+            AssertTrue(std::find(changed.begin(), changed.end(), b) != changed.end(), "Expected B to be updated");
+            AssertEqual(b.Get<ecs::TransformSnapshot>(lock).GetPosition(),
+                glm::vec3(1, 7, 7),
+                "B entity has wrong snapshot position");
+        }
+        {
+            Timer t("Propagate a reparented entity");
+            {
+                auto lock = ecs::StartTransaction<ecs::Write<ecs::TransformTree>>();
+                b.Get<ecs::TransformTree>(lock).parent = root;
+            }
+            auto lock = ecs::StartTransaction<ecs::Read<ecs::TransformTree>, ecs::Write<ecs::TransformSnapshot>>();
+
+            propagation.Update(lock);
+            AssertEqual(b.Get<ecs::TransformSnapshot>(lock).GetPosition(),
+                glm::vec3(1, 7, 3),
+                "B entity has wrong snapshot position");
+        }
+    }
+
     Test test1(&TestTransformTree);
+    Test test2(&TestTransformPropagation);
 } // namespace EcsTransformTests
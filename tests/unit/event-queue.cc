@@ -0,0 +1,107 @@
+#include "ecs/EventQueue.hh"
+
+#include <atomic>
+#include <tests.hh>
+#include <thread>
+
+namespace EventQueueTests {
+    using namespace testing;
+
+    const std::string TEST_EVENT_NAME = "/test/event";
+
+    void TestEventQueue() {
+        ecs::Event event;
+        {
+            Timer t("Test queue wraps around and rejects events when full");
+            ecs::EventQueue queue(5);
+            AssertEqual(queue.Capacity(), 8u, "Expected queue capacity to be rounded up");
+
+            for (int lap = 0; lap < 3; lap++) {
+                for (int i = 0; i < 8; i++) {
+                    AssertTrue(queue.Add(ecs::Event{TEST_EVENT_NAME, Tecs::Entity(), i}), "Expected event to be added");
+                }
+                AssertTrue(!queue.Add(ecs::Event{TEST_EVENT_NAME, Tecs::Entity(), 8}), "Expected queue to be full");
+                AssertEqual(queue.Size(), 8u, "Unexpected queue size");
+
+                for (int i = 0; i < 8; i++) {
+                    AssertTrue(queue.Poll(event), "Expected to receive an event");
+                    AssertEqual(event.name, TEST_EVENT_NAME, "Unexpected event name");
+                    AssertEqual(std::get<int>(event.data), i, "Expected events in order");
+                }
+                AssertTrue(!queue.Poll(event), "Expected queue to be empty");
+                AssertTrue(queue.Empty(), "Expected queue to be empty");
+            }
+        }
+        {
+            Timer t("Test events are hidden from the transaction that sent them");
+            ecs::EventQueue queue(4);
+            queue.Add(ecs::Event{TEST_EVENT_NAME, Tecs::Entity(), true}, 5);
+            AssertTrue(!queue.Poll(event, 5), "Expected event to be hidden from its own transaction");
+            AssertTrue(!queue.Poll(event, 4), "Expected event to be hidden from earlier transactions");
+            AssertTrue(queue.Poll(event, 6), "Expected event to be visible to later transactions");
+        }
+        {
+            Timer t("Test async events stay in order");
+            ecs::EventQueue queue(4);
+            auto filtered = std::make_shared<sp::Async<ecs::EventData>>();
+            auto delayed = std::make_shared<sp::Async<ecs::EventData>>();
+            queue.Add(ecs::AsyncEvent{"/test/filtered", Tecs::Entity(), filtered});
+            queue.Add(ecs::AsyncEvent{"/test/delayed", Tecs::Entity(), delayed});
+            queue.Add(ecs::Event{TEST_EVENT_NAME, Tecs::Entity(), 3});
+            AssertTrue(!queue.Poll(event), "Expected queue to wait for async event");
+
+            delayed->Set(std::make_shared<ecs::EventData>(2));
+            AssertTrue(!queue.Poll(event), "Expected queue to wait for first async event");
+
+            filtered->Set(std::shared_ptr<ecs::EventData>());
+            AssertTrue(queue.Poll(event), "Expected to receive delayed event");
+            AssertEqual(event.name, "/test/delayed", "Expected filtered event to be skipped");
+            AssertEqual(std::get<int>(event.data), 2, "Unexpected delayed event data");
+            AssertTrue(queue.Poll(event), "Expected to receive sync event");
+            AssertEqual(event.name, TEST_EVENT_NAME, "Unexpected event name");
+        }
+        {
+            Timer t("Test multiple producers and consumers");
+            ecs::EventQueue queue(64);
+            const int producerCount = 4, consumerCount = 2, eventCount = 10000;
+            std::atomic_int received = 0;
+            std::atomic_int64_t receivedSum = 0;
+            std::atomic_bool producersDone = false;
+
+            std::vector<std::thread> producers, consumers;
+            for (int i = 0; i < producerCount; i++) {
+                producers.emplace_back([&] {
+                    for (int j = 0; j < eventCount; j++) {
+                        while (!queue.Add(ecs::Event{TEST_EVENT_NAME, Tecs::Entity(), j})) {
+                            std::this_thread::yield();
+                        }
+                    }
+                });
+            }
+            for (int i = 0; i < consumerCount; i++) {
+                consumers.emplace_back([&] {
+                    ecs::Event consumerEvent;
+                    while (!producersDone || !queue.Empty()) {
+                        if (queue.Poll(consumerEvent)) {
+                            received++;
+                            receivedSum += std::get<int>(consumerEvent.data);
+                        }
+                    }
+                });
+            }
+            for (auto &thread : producers) {
+                thread.join();
+            }
+            producersDone = true;
+            for (auto &thread : consumers) {
+                thread.join();
+            }
+            AssertEqual(received.load(), producerCount * eventCount, "Expected every event to be received once");
+            AssertEqual(receivedSum.load(),
+                (int64_t)producerCount * eventCount * (eventCount - 1) / 2,
+                "Unexpected received event data");
+        }
+    }
+
+    Test test(&TestEventQueue);
+} // namespace EventQueueTests
@@ -0,0 +1,72 @@
+#include "assets/GltfImpl.hh"
+#include "core/Common.hh"
+
+#include <tests.hh>
+
+namespace GltfAccessorTests {
+    using namespace testing;
+
+    int addAccessor(tinygltf::Model &model, int type, int componentType, size_t count, size_t offset, int stride) {
+        auto &view = model.bufferViews.emplace_back();
+        view.buffer = 0;
+        view.byteOffset = offset;
+        view.byteLength = model.buffers[0].data.size() - offset;
+        view.byteStride = stride;
+
+        auto &accessor = model.accessors.emplace_back();
+        accessor.bufferView = model.bufferViews.size() - 1;
+        accessor.type = type;
+        accessor.componentType = componentType;
+        accessor.count = count;
+        return model.accessors.size() - 1;
+    }
+
+    void TestGltfAccessorConversion() {
+        Timer t("Test gltf accessor bulk conversion");
+        tinygltf::Model model;
+        auto &data = model.buffers.emplace_back().data;
+
+        // 3 uint16 indices, followed by 3 normalized u8vec2 texcoords interleaved with 2 padding bytes each
+        std::vector<uint16_t> indices = {0, 2, 65535};
+        data.resize(6 + 3 * 4);
+        std::memcpy(data.data(), indices.data(), 6);
+        uint8_t texcoords[3][4] = {{0, 255, 0xaa, 0xaa}, {51, 102, 0xaa, 0xaa}, {255, 0, 0xaa, 0xaa}};
+        std::memcpy(data.data() + 6, texcoords, sizeof(texcoords));
+
+        int indexAccessor = addAccessor(model,
+            TINYGLTF_TYPE_SCALAR,
+            TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT,
+            3,
+            0,
+            0);
+        int uvAccessor = addAccessor(model, TINYGLTF_TYPE_VEC2, TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE, 3, 6, 4);
+        model.accessors[uvAccessor].normalized = true;
+
+        sp::gltf::Accessor<uint32_t, uint16_t> indexBuffer(model, indexAccessor);
+        AssertTrue((bool)indexBuffer, "Expected index accessor to be valid");
+        auto readIndices = indexBuffer.ReadAll();
+        AssertEqual(readIndices.size(), 3u, "Expected 3 indices");
+        for (size_t i = 0; i < indices.size(); i++) {
+            AssertEqual(readIndices[i], (uint32_t)indices[i], "Unexpected index value");
+            AssertEqual(indexBuffer.Read(i), (uint32_t)indices[i], "Unexpected single index value");
+        }
+
+        struct Vertex {
+            glm::vec3 position;
+            glm::vec2 uv;
+        };
+        std::vector<Vertex> vertices(4, Vertex{glm::vec3(1), glm::vec2(-1)});
+        sp::gltf::Accessor<glm::vec2, glm::u16vec2, glm::u8vec2> uvBuffer(model, uvAccessor);
+        AssertTrue((bool)uvBuffer, "Expected texcoord accessor to be valid");
+        uvBuffer.ReadInto(&vertices[0].uv, sizeof(Vertex), 1, 2);
+
+        AssertEqual(vertices[0].uv.x, 0.2f, "Expected normalized texcoord");
+        AssertEqual(vertices[0].uv.y, 0.4f, "Expected normalized texcoord");
+        AssertEqual(vertices[1].uv, glm::vec2(1, 0), "Expected normalized texcoord");
+        AssertEqual(vertices[2].uv, glm::vec2(-1), "Expected vertex past the range to be untouched");
+        AssertEqual(vertices[0].position, glm::vec3(1), "Expected other vertex fields to be untouched");
+        AssertEqual(uvBuffer.Read(0), glm::vec2(0, 1), "Expected normalized texcoord");
+    }
+
+    Test test(&TestGltfAccessorConversion);
+} // namespace GltfAccessorTests
@@ -273,6 +273,42 @@ namespace SignalBindingTests {
             val = ecs::SignalRef(hand, TEST_SIGNAL_ACTION3).GetSignal(lock);
             AssertEqual(val, 5.0, "Expected binding to return signal value");
         }
+        {
+            Timer t("Test memoized bindings are invalidated by their dependencies");
+            auto lock = ecs::StartTransaction<ecs::ReadSignalsLock, ecs::Write<ecs::Signals>>();
+
+            ecs::SignalRef sourceRef(player, "test_source");
+            ecs::SignalRef middleRef(player, "test_middle");
+            ecs::SignalRef outerRef(player, "test_outer");
+            sourceRef.SetValue(lock, 1.0);
+            middleRef.SetBinding(lock, "player/test_source * 2", ecs::Name("player", ""));
+            outerRef.SetBinding(lock, "player/test_middle + 1", ecs::Name("player", ""));
+
+            double val = outerRef.GetSignal(lock);
+            AssertEqual(val, 3.0, "Expected chained binding value");
+            val = outerRef.GetSignal(lock);
+            AssertEqual(val, 3.0, "Expected memoized binding value");
+
+            sourceRef.SetValue(lock, 2.0);
+            val = outerRef.GetSignal(lock);
+            AssertEqual(val, 5.0, "Expected binding to update after source changed");
+
+            middleRef.SetBinding(lock, "player/test_source * 3", ecs::Name("player", ""));
+            val = outerRef.GetSignal(lock);
+            AssertEqual(val, 7.0, "Expected binding to update after dependency binding changed");
+
+            middleRef.SetValue(lock, 10.0);
+            val = outerRef.GetSignal(lock);
+            AssertEqual(val, 11.0, "Expected signal value to override dependency binding");
+
+            middleRef.ClearValue(lock);
+            val = outerRef.GetSignal(lock);
+            AssertEqual(val, 7.0, "Expected binding to update after dependency value was cleared");
+
+            middleRef.ClearBinding(lock);
+            val = outerRef.GetSignal(lock);
+            AssertEqual(val, 1.0, "Expected binding to update after dependency binding was cleared");
+        }
     }
 
     Test test(&TrySetSignals);
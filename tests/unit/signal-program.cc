@@ -0,0 +1,176 @@
+#include "core/Logging.hh"
+#include "ecs/EcsImpl.hh"
+#include "ecs/SignalBatch.hh"
+#include "ecs/SignalManager.hh"
+
+#include <tests.hh>
+
+namespace SignalProgramTests {
+    using namespace testing;
+
+    // Expressions based on bindings from the bundled scenes and input configs
+    const std::array benchmarkExpressions = {
+        "player/a + player/b + player/c + player/d",
+        "player/a ? 3 : (player/b ? 0 : 3 - player/c)",
+        "min(min(player/a, player/b), player/c)",
+        "(player/a + player/b) * player/c",
+        "player/d >= 1",
+        "if_focused(Game, player/a)",
+        "is_focused(Game) && player/b",
+        "player/a * 2 + player/a * 2 - player/a * 2",
+        "cos(max(2,3)/3 *3.14159265359) * -1 ? 42 : 0.1",
+        "3 +4 *2 /(1 - -5)+1",
+        "0 != 0.0 ? (1 ? 1 : (3 + 0.14)) : (3 + 0.14)",
+        "player/b ? (player/a + player/c) : (player/c - player/a)",
+        "player/missing + 1",
+    };
+
+    void TestProgramMatchesTree() {
+        Tecs::Entity player;
+        {
+            Timer t("Create a player with signal values");
+            auto lock = ecs::StartTransaction<ecs::AddRemove>();
+
+            lock.Set<ecs::FocusLock>(ecs::FocusLayer::Game);
+
+            player = lock.NewEntity();
+            ecs::EntityRef playerRef(ecs::Name("player", "player"), player);
+            player.Set<ecs::Name>(lock, "player", "player");
+            ecs::SignalRef(player, "a").SetValue(lock, 0.25);
+            ecs::SignalRef(player, "b").SetValue(lock, 1.0);
+            ecs::SignalRef(player, "c").SetValue(lock, 4.0);
+            ecs::SignalRef(player, "d").SetValue(lock, 2.0);
+        }
+        {
+            Timer t("Check constant folding");
+            ecs::SignalExpression expr("3 +4 *2 /(1 - -5)+1 /0");
+            AssertEqual(expr.program.size(), 1u, "Expected constant expression to fold into a single instruction");
+            AssertTrue(expr.program[0].opcode == ecs::SignalExpression::Instruction::Opcode::Constant,
+                "Expected constant expression to fold into a constant");
+
+            ecs::SignalExpression branchExpr("1 ? player/a : player/b", ecs::Name("player", ""));
+            for (auto &inst : branchExpr.program) {
+                AssertTrue(inst.opcode != ecs::SignalExpression::Instruction::Opcode::JumpIfFalse,
+                    "Expected constant branch condition to be folded");
+            }
+        }
+        {
+            auto lock = ecs::StartTransaction<ecs::ReadSignalsLock>();
+
+            std::vector<ecs::SignalExpression> expressions;
+            for (auto &exprStr : benchmarkExpressions) {
+                auto &expr = expressions.emplace_back(exprStr, ecs::Name("player", ""));
+                Assertf((bool)expr, "Expected expression to be valid: %s", exprStr);
+                AssertTrue(!expr.program.empty(), "Expected expression to compile to a program");
+
+                double treeValue = expr.EvaluateTree(lock);
+                double programValue = expr.Evaluate(lock);
+                AssertEqual(programValue, treeValue, "Expected program to match tree evaluation: " + expr.expr);
+            }
+
+            const size_t iterations = 10000;
+            double treeSum = 0.0, programSum = 0.0;
+            {
+                MultiTimer timer("Evaluate closure tree x" + std::to_string(iterations));
+                for (auto &expr : expressions) {
+                    Timer t(timer);
+                    for (size_t i = 0; i < iterations; i++) {
+                        treeSum += expr.EvaluateTree(lock);
+                    }
+                }
+            }
+            {
+                MultiTimer timer("Evaluate register program x" + std::to_string(iterations));
+                for (auto &expr : expressions) {
+                    Timer t(timer);
+                    for (size_t i = 0; i < iterations; i++) {
+                        programSum += expr.Evaluate(lock);
+                    }
+                }
+            }
+            AssertEqual(programSum, treeSum, "Expected benchmark results to match");
+        }
+    }
+
+    void TestBatchEvaluation() {
+        const size_t cellCount = 256;
+        std::vector<Tecs::Entity> cells;
+        {
+            Timer t("Create a board of cells with signal values");
+            auto lock = ecs::StartTransaction<ecs::AddRemove>();
+
+            for (size_t i = 0; i < cellCount; i++) {
+                auto &cell = cells.emplace_back(lock.NewEntity());
+                std::string name = "cell" + std::to_string(i);
+                ecs::EntityRef cellRef(ecs::Name("board", name), cell);
+                cell.Set<ecs::Name>(lock, "board", name);
+                ecs::SignalRef(cell, "alive").SetValue(lock, (double)(i % 3 == 0));
+                ecs::SignalRef(cell, "neighbors").SetValue(lock, (double)(i % 9));
+            }
+        }
+        {
+            auto lock = ecs::StartTransaction<ecs::ReadSignalsLock>();
+
+            {
+                Timer t("Check shared nodes are evaluated once");
+                auto shared = ecs::GetSignalManager().NewBatch({
+                    ecs::SignalExpression("cell0/alive + cell0/neighbors", ecs::Name("board", "")),
+                    ecs::SignalExpression("(cell0/alive + cell0/neighbors) * 2", ecs::Name("board", "")),
+                });
+                // 2 signal reads, 1 add, 1 constant, 1 multiply
+                AssertEqual(shared.ProgramSize(), 5u, "Expected the sum and its signal reads to be shared");
+                std::vector<double> output;
+                shared.Evaluate(lock, output);
+                AssertEqual(output[0], 1.0, "Expected the sum of cell0's signals");
+                AssertEqual(output[1], 2.0, "Expected the shared sum to be doubled");
+            }
+
+            std::vector<ecs::SignalExpression> expressions;
+            for (size_t i = 0; i < cellCount; i++) {
+                std::string name = "cell" + std::to_string(i);
+                std::string nextName = "cell" + std::to_string((i + 1) % cellCount);
+                // Two shapes without branches, sharing signal reads with each other and neighboring cells
+                expressions.emplace_back(name + "/alive * 2 + " + name + "/neighbors + " + nextName + "/alive",
+                    ecs::Name("board", ""));
+                expressions.emplace_back("max(" + name + "/neighbors - 1, 0) / 8", ecs::Name("board", ""));
+                // One shape with a branch, which keeps its own registers
+                expressions.emplace_back(name + "/alive ? " + name + "/neighbors == 3 : 0", ecs::Name("board", ""));
+            }
+            auto batch = ecs::GetSignalManager().NewBatch(expressions);
+            AssertEqual(batch.Size(), expressions.size(), "Expected all expressions to be added to the batch");
+            size_t programSize = 0;
+            for (auto &expr : expressions) {
+                programSize += expr.program.size();
+            }
+            AssertTrue(batch.ProgramSize() < programSize, "Expected signal reads to be shared between expressions");
+
+            std::vector<double> output;
+            {
+                MultiTimer timer("Evaluate batch of " + std::to_string(batch.Size()) + " expressions");
+                for (size_t i = 0; i < 100; i++) {
+                    Timer t(timer);
+                    batch.Evaluate(lock, output);
+                }
+            }
+            {
+                MultiTimer timer("Evaluate " + std::to_string(expressions.size()) + " expressions individually");
+                for (size_t i = 0; i < 100; i++) {
+                    Timer t(timer);
+                    for (auto &expr : expressions) {
+                        expr.Evaluate(lock);
+                    }
+                }
+            }
+
+            AssertEqual(output.size(), expressions.size(), "Expected an output for every expression");
+            for (size_t i = 0; i < expressions.size(); i++) {
+                AssertEqual(output[i],
+                    expressions[i].Evaluate(lock),
+                    "Expected batch output to match expression: " + expressions[i].expr);
+            }
+        }
+    }
+
+    Test test(&TestProgramMatchesTree);
+    Test batchTest(&TestBatchEvaluation);
+} // namespace SignalProgramTests
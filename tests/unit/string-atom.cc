@@ -0,0 +1,54 @@
+#include "core/StringAtom.hh"
+
+#include <tests.hh>
+#include <thread>
+#include <vector>
+
+namespace StringAtomTests {
+    using namespace testing;
+
+    void TestStringAtom() {
+        {
+            Timer t("Test atoms with the same string are equal");
+            sp::StringAtom a("/test/event");
+            sp::StringAtom b(std::string("/test/") + "event");
+            sp::StringAtom c(std::string_view("/test/other"));
+            AssertTrue(a == b, "Expected atoms to be equal");
+            AssertEqual(a.Id(), b.Id(), "Expected atoms to have the same id");
+            AssertTrue(a != c, "Expected atoms to differ");
+            AssertTrue(a.Id() != c.Id(), "Expected atoms to have different ids");
+            AssertEqual(a, "/test/event", "Expected atom to compare equal to its string");
+            AssertEqual(&a.String(), &b.String(), "Expected atoms to share storage");
+        }
+        {
+            Timer t("Test empty atoms");
+            sp::StringAtom empty;
+            AssertTrue(empty.empty(), "Expected default atom to be empty");
+            AssertEqual(empty.Id(), 0u, "Expected empty atom to have id 0");
+            AssertTrue(empty == sp::StringAtom(""), "Expected empty string to intern as the empty atom");
+            AssertEqual(empty.String(), "", "Expected empty atom to have an empty string");
+        }
+        {
+            Timer t("Test concurrent interning");
+            std::vector<std::vector<sp::StringAtom>> results(4);
+            std::vector<std::thread> threads;
+            for (auto &result : results) {
+                threads.emplace_back([&result] {
+                    for (int i = 0; i < 1000; i++) {
+                        result.emplace_back("/test/concurrent/" + std::to_string(i));
+                    }
+                });
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+            for (auto &result : results) {
+                for (size_t i = 0; i < result.size(); i++) {
+                    AssertTrue(result[i] == results[0][i], "Expected atoms from all threads to match");
+                }
+            }
+        }
+    }
+
+    Test test(&TestStringAtom);
+} // namespace StringAtomTests
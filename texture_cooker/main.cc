@@ -0,0 +1,168 @@
+#include "assets/Asset.hh"
+#include "assets/AssetManager.hh"
+#include "assets/Async.hh"
+#include "assets/CookedTexture.hh"
+#include "assets/Gltf.hh"
+#include "assets/GltfImpl.hh"
+#include "core/DispatchQueue.hh"
+#include "core/Logging.hh"
+
+#include <algorithm>
+#include <cxxopts.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <thread>
+
+namespace {
+    const sp::TextureType textureTypes[] = {
+        sp::TextureType::BaseColor,
+        sp::TextureType::MetallicRoughness,
+        sp::TextureType::Height,
+        sp::TextureType::Occlusion,
+        sp::TextureType::Emissive,
+    };
+
+    struct CookJob {
+        size_t modelIndex;
+        sp::TextureType type;
+        sp::GltfTextureSource texture;
+        std::shared_ptr<const sp::Gltf> model;
+        sp::Hash128 sourceHash;
+        bool updated = false;
+        bool failed = false;
+    };
+
+    // Returns true if the asset already contains exactly the given bytes
+    bool AssetMatches(const std::string &path, const std::vector<uint8_t> &data) {
+        std::ifstream in;
+        size_t size = 0;
+        if (!sp::Assets().InputStream(path, sp::AssetType::Bundled, in, &size) || size != data.size()) return false;
+        std::vector<uint8_t> existing(size);
+        in.read(reinterpret_cast<char *>(existing.data()), size);
+        return in && existing == data;
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("texture_cooker", "Converts gltf textures into mipmapped, block compressed textures");
+    options.positional_help("<model_name>...");
+    // clang-format off
+    options.add_options()
+        ("model-names", "", cxxopts::value<std::vector<std::string>>())
+        ("j,jobs", "Number of textures to cook in parallel (defaults to the CPU count)", cxxopts::value<size_t>())
+        ("high-quality", "Compress color textures with BC7 instead of BC1 and BC3")
+        ("uncompressed", "Only precompute mipmaps, leaving textures uncompressed");
+    // clang-format on
+    options.parse_positional({"model-names"});
+
+    auto optionsResult = options.parse(argc, argv);
+
+    if (!optionsResult.count("model-names")) {
+        std::cout << options.help() << std::endl;
+        return 1;
+    }
+
+    auto modelNames = optionsResult["model-names"].as<std::vector<std::string>>();
+    size_t jobCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+    if (optionsResult.count("jobs")) jobCount = std::max<size_t>(1, optionsResult["jobs"].as<size_t>());
+    sp::cookedtexture::CookOptions cookOptions;
+    cookOptions.highQuality = optionsResult.count("high-quality");
+    cookOptions.compress = !optionsResult.count("uncompressed");
+
+    sp::logging::SetLogLevel(sp::logging::Level::Warn);
+
+    std::vector<sp::AsyncPtr<sp::Gltf>> modelPtrs;
+    for (auto &modelName : modelNames) {
+        modelPtrs.emplace_back(sp::Assets().LoadGltf(modelName));
+    }
+
+    std::vector<CookJob> jobs;
+    for (size_t i = 0; i < modelNames.size(); i++) {
+        auto model = modelPtrs[i]->Get();
+        if (!model) {
+            Errorf("texture_cooker could not load Gltf model: %s", modelNames[i]);
+            return 1;
+        }
+
+        // Asset::Hash() computes the hash on first use, so it is read here before any jobs run in parallel
+        auto sourceHash = model->asset->Hash();
+
+        // Materials often share textures, and names only depend on the texture and its factor, so each is cooked once
+        std::set<std::string> textureNames;
+        for (size_t j = 0; j < model->gltfModel->materials.size(); j++) {
+            for (auto type : textureTypes) {
+                sp::GltfTextureSource texture;
+                if (!sp::cookedtexture::FindGltfTexture(*model, j, type, texture)) continue;
+                if (texture.textureIndex < 0 || !textureNames.insert(texture.name).second) continue;
+                jobs.emplace_back(CookJob{i, type, texture, model, sourceHash});
+            }
+        }
+    }
+
+    auto cookTexture = [&](CookJob &job) {
+        sp::CookedTexture cooked;
+        if (!sp::cookedtexture::CookGltfTexture(*job.model, job.texture, job.type, cookOptions, cooked)) {
+            // The runtime uploads these from the gltf instead
+            Warnf("texture_cooker skipped unsupported texture: %s", job.texture.name);
+            return;
+        }
+        Logf("Cooked texture %s, %ux%u with %u levels in format %u",
+            job.texture.name,
+            cooked.width,
+            cooked.height,
+            cooked.levelCount,
+            (uint32_t)cooked.format);
+
+        std::vector<uint8_t> data;
+        sp::cookedtexture::Serialize(cooked, job.sourceHash, data);
+
+        // Cooking is deterministic, so unchanged textures are left alone to avoid rebuilding the asset bundle
+        auto cachePath = sp::cookedtexture::CachePath(job.texture.name);
+        if (AssetMatches(cachePath, data)) return;
+
+        std::ofstream out;
+        if (!sp::Assets().OutputStream(cachePath, out)) {
+            Errorf("texture_cooker failed to write: %s", cachePath);
+            job.failed = true;
+            return;
+        }
+        out.write(reinterpret_cast<const char *>(data.data()), data.size());
+        out.close();
+        if (out.fail()) {
+            Errorf("texture_cooker failed to write: %s", cachePath);
+            job.failed = true;
+            return;
+        }
+        job.updated = true;
+    };
+
+    {
+        // Every texture of every model is an independent job, this thread only waits so at most jobCount run at once
+        sp::DispatchQueue workQueue("TextureCooker", jobCount);
+        std::vector<sp::AsyncPtr<void>> results;
+        for (auto &job : jobs) {
+            results.emplace_back(workQueue.Dispatch<void>([&cookTexture, &job]() {
+                cookTexture(job);
+            }));
+        }
+        for (auto &result : results) {
+            result->Get();
+        }
+    }
+
+    std::vector<bool> modelUpdated(modelNames.size());
+    for (auto &job : jobs) {
+        if (job.failed) return 1;
+        if (job.updated) modelUpdated[job.modelIndex] = true;
+    }
+    for (size_t i = 0; i < modelNames.size(); i++) {
+        std::filesystem::path markerPath("../assets/cache/textures/" + modelNames[i]);
+        if (modelUpdated[i] || !std::filesystem::exists(markerPath)) {
+            std::filesystem::create_directories(markerPath.parent_path());
+            std::ofstream(markerPath).close(); // Create or touch the marker file
+        }
+    }
+    return 0;
+}